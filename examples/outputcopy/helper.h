@@ -22,7 +22,6 @@ class WSeat;
 class WBackend;
 class WOutputItem;
 class WOutputViewport;
-class WOutputLayer;
 WAYLIB_SERVER_END_NAMESPACE
 
 QW_BEGIN_NAMESPACE
@@ -51,8 +50,6 @@ public:
     }
 
 private:
-    void updatePrimaryOutputHardwareLayers();
-
     WServer *m_server = nullptr;
 
     WBackend *m_backend = nullptr;
@@ -66,6 +63,5 @@ private:
     WOutputRenderWindow *m_renderWindow = nullptr;
     WOutputItem *m_primaryOutput = nullptr;
     QPointer<WOutputViewport> m_primaryOutputViewport;
-    QList<WOutputLayer*> m_hardwareLayersOfPrimaryOutput;
-    QList<std::pair<WOutputViewport*, QQuickItem*>> m_copyOutputs;
+    QList<WOutputViewport*> m_copyOutputs;
 };
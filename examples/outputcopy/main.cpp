@@ -13,8 +13,6 @@
 #include <woutputviewport.h>
 #include <wcursor.h>
 #include <woutputitem.h>
-#include <woutputlayer.h>
-#include <wquicktextureproxy.h>
 
 #include <qwbackend.h>
 #include <qwdisplay.h>
@@ -82,9 +80,6 @@ void Helper::initProtocols(QQmlEngine *qmlEngine)
             Q_ASSERT(m_primaryOutput);
 
             m_primaryOutputViewport = m_primaryOutput->findChild<WOutputViewport*>({}, Qt::FindDirectChildrenOnly);
-            updatePrimaryOutputHardwareLayers();
-            connect(m_primaryOutputViewport, &WOutputViewport::hardwareLayersChanged,
-                    this, &Helper::updatePrimaryOutputHardwareLayers);
         } else {
             auto component = new QQmlComponent(qmlEngine, "OutputCopy", "CopyOutputDelegate",
                                                QQmlComponent::PreferSynchronous, this);
@@ -99,18 +94,9 @@ void Helper::initProtocols(QQmlEngine *qmlEngine)
             obj->setParent(this);
             auto viewport = obj->findChild<WOutputViewport*>({}, Qt::FindDirectChildrenOnly);
             Q_ASSERT(viewport);
-            auto textureProxy = obj->findChild<WQuickTextureProxy*>();
-            Q_ASSERT(textureProxy);
 
-            m_copyOutputs << std::make_pair(viewport, textureProxy);
-
-            Q_ASSERT(m_primaryOutputViewport);
-            // copy layers
-            for (auto layer : std::as_const(m_hardwareLayersOfPrimaryOutput))
-                m_renderWindow->attach(layer, viewport, m_primaryOutputViewport, textureProxy);
-
-            // copy primary output
-            m_primaryOutputViewport->setCacheBuffer(true);
+            // The mirror shows the cursor layer too, see WOutputViewport::mirrorSource
+            m_copyOutputs << viewport;
         }
     });
 
@@ -121,7 +107,7 @@ void Helper::initProtocols(QQmlEngine *qmlEngine)
             m_copyOutputs.clear();
         } else {
             for (int i = 0; i < m_copyOutputs.size(); ++i) {
-                WOutputViewport *viewport = m_copyOutputs[i].first;
+                WOutputViewport *viewport = m_copyOutputs[i];
                 if (viewport->output() == output) {
                     m_copyOutputs.removeAt(i);
                     auto output = viewport->parent();
@@ -181,25 +167,6 @@ void Helper::initProtocols(QQmlEngine *qmlEngine)
     m_backend->handle()->start();
 }
 
-void Helper::updatePrimaryOutputHardwareLayers()
-{
-    const auto layers = m_primaryOutputViewport->hardwareLayers();
-    for (auto layer : layers) {
-        if (m_hardwareLayersOfPrimaryOutput.removeOne(layer))
-            continue;
-        for (auto copyOutput : std::as_const(m_copyOutputs))
-            m_renderWindow->attach(layer, copyOutput.first,
-                                   m_primaryOutputViewport, copyOutput.second);
-    }
-
-    for (auto oldLayer : std::as_const(m_hardwareLayersOfPrimaryOutput)) {
-        for (auto copyOutput : std::as_const(m_copyOutputs))
-            m_renderWindow->detach(oldLayer, copyOutput.first);
-    }
-
-    m_hardwareLayersOfPrimaryOutput = layers;
-}
-
 int main(int argc, char *argv[]) {
     qw_log::init();
     WServer::initializeQPA();
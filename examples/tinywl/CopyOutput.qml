@@ -12,46 +12,15 @@ OutputItem {
 
     devicePixelRatio: output?.scale ?? devicePixelRatio
 
-    Rectangle {
-        id: content
-        anchors.fill: parent
-        color: "gray"
-
-        TextureProxy {
-            id: proxy
-            sourceItem: screenViewport
-            anchors.centerIn: parent
-            rotation: targetOutputItem.keepAllOutputRotation ? 0 : screenViewport.rotation
-            width: screenViewport.implicitWidth
-            height: screenViewport.implicitHeight
-            smooth: true
-            transformOrigin: Item.Center
-            scale: {
-                const isize = targetOutputItem.keepAllOutputRotation
-                            ? Qt.size(width, height)
-                            : Qt.size(targetOutputItem.width, targetOutputItem.height);
-                const osize = Qt.size(outputItem.width, outputItem.height);
-                const size = WaylibHelper.scaleSize(isize, osize, Qt.KeepAspectRatio);
-                return size.width / isize.width;
-            }
-        }
-
-        Text {
-            anchors.horizontalCenter: parent.horizontalCenter
-            text: "I'm a duplicate of the primary screen"
-            font.pointSize: 18
-            color: "red"
-        }
-    }
-
+    // Shows the buffers of the primary screen without rendering the scene again
     OutputViewport {
         id: viewport
 
         anchors.centerIn: parent
-        depends: [screenViewport]
         devicePixelRatio: outputItem.devicePixelRatio
-        input: content
         output: outputItem.output
+        mirrorSource: screenViewport
+        mirrorFillMode: OutputViewport.PreserveAspectFit
         ignoreViewport: true
     }
 }
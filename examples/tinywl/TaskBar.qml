@@ -21,15 +21,17 @@ ListView {
     model: output.minimizedSurfaces
     delegate: Item {
         required property SurfaceWrapper surface
+        readonly property real thumbnailScale: Math.min(1, 250 / Math.max(1, surface.width),
+                                                        150 / Math.max(1, surface.height))
 
-        width: proxy.width
-        height: proxy.height
+        width: surface.width * thumbnailScale
+        height: surface.height * thumbnailScale
 
-        SurfaceProxy {
-            id: proxy
-            live: true
-            surface: parent.surface
-            maxSize: Qt.size(250, 150)
+        // Shares the thumbnail with the other proxies of the surface
+        TextureProxy {
+            anchors.fill: parent
+            sourceItem: parent.surface
+            thumbnail: true
         }
 
         MouseArea {
@@ -2,6 +2,7 @@
 // SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 import QtQuick
+import Waylib.Server
 import Tinywl
 
 Item {
@@ -25,9 +26,11 @@ Item {
             z: orderIndex
             active: surface.ownsOutput === output
                     && surface.surfaceState !== SurfaceWrapper.State.Minimized
-            sourceComponent: SurfaceProxy {
-                surface: loader.surface
-                fullProxy: true
+            sourceComponent: TextureProxy {
+                width: loader.surface.width
+                height: loader.surface.height
+                sourceItem: loader.surface
+                thumbnail: true
             }
         }
     }
@@ -45,9 +48,11 @@ Item {
             z: orderIndex
             active: surface.ownsOutput === output
                     && surface.surfaceState !== SurfaceWrapper.State.Minimized
-            sourceComponent: SurfaceProxy {
-                surface: loader.surface
-                fullProxy: true
+            sourceComponent: TextureProxy {
+                width: loader.surface.width
+                height: loader.surface.height
+                sourceItem: loader.surface
+                thumbnail: true
             }
         }
     }
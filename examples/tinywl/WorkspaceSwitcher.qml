@@ -21,6 +21,44 @@ Item {
         return from.index > to.index ? from : to;
     }
     property int duration: 200 * Helper.animationSpeed
+    readonly property QtObject thumbnailProvider: Window.window?.thumbnailProvider ?? null
+
+    // Animate the snapshots of the workspaces instead of the live surfaces
+    component WorkspaceSnapshot: Item {
+        id: snapshotItem
+
+        required property WorkspaceModel workspace
+        required property QtObject output
+        // The proxies are created again for every switch, so the cached
+        // snapshots are keyed by the workspace and the output
+        readonly property string cacheKey: workspace && output
+                                           ? workspace.snapshotKey(output.outputItem.output) : ""
+        // Show the snapshot captured when the workspace was left last time,
+        // Workspace drops it once the windows of the workspace change
+        property bool useCache: false
+        readonly property bool cached: useCache && cacheKey !== ""
+                                       && (root.thumbnailProvider?.cachedSnapshots.includes(cacheKey) ?? false)
+        property bool ready: cached
+        readonly property Item live: proxy
+
+        width: proxy.width
+        height: proxy.height
+
+        WorkspaceProxy {
+            id: proxy
+            workspace: snapshotItem.workspace
+            output: snapshotItem.output
+        }
+
+        TextureProxy {
+            anchors.fill: parent
+            sourceItem: proxy
+            snapshot: true
+            snapshotKey: snapshotItem.cached ? snapshotItem.cacheKey : ""
+            hideSource: snapshotItem.ready
+            visible: snapshotItem.ready
+        }
+    }
 
     anchors.fill: parent
     z: 1
@@ -67,17 +105,52 @@ Item {
 
                 spacing: 30
 
-                WorkspaceProxy {
+                WorkspaceSnapshot {
+                    id: leftSnapshot
                     workspace: root.leftWorkspace
                     output: rootItem.output
+                    useCache: root.to === root.leftWorkspace
                 }
 
-                WorkspaceProxy {
+                WorkspaceSnapshot {
+                    id: rightSnapshot
                     workspace: root.rightWorkspace
                     output: rootItem.output
+                    useCache: root.to === root.rightWorkspace
+                }
+            }
+
+            Connections {
+                target: root.thumbnailProvider
+                ignoreUnknownSignals: true
+
+                function onSnapshotReady(source) {
+                    if (source === leftSnapshot.live)
+                        leftSnapshot.ready = true;
+                    else if (source === rightSnapshot.live)
+                        rightSnapshot.ready = true;
+
+                    if (leftSnapshot.ready && rightSnapshot.ready)
+                        rootItem.startAnimation();
                 }
             }
 
+            // Don't wait forever if the snapshots can't be rendered
+            Timer {
+                id: snapshotTimeout
+                interval: 100
+                onTriggered: rootItem.startAnimation()
+            }
+
+            property bool animationStarted: false
+            function startAnimation() {
+                snapshotTimeout.stop();
+                if (animationStarted)
+                    return;
+                animationStarted = true;
+                animation.start();
+            }
+
             ParallelAnimation {
                 id: animation
 
@@ -113,7 +186,20 @@ Item {
                 workspacesAnimation.to = wallpapersAnimation.to;
 
                 rootItem.outputItem.wallpaperVisible = false;
-                animation.start();
+                if (!root.thumbnailProvider) {
+                    animation.start();
+                    return;
+                }
+
+                // Rendered together with the snapshot of this switch, and
+                // reused when switching back to the workspace being left
+                const fromSnapshot = root.from === root.leftWorkspace ? leftSnapshot : rightSnapshot;
+                root.thumbnailProvider.captureSnapshot(fromSnapshot.live, fromSnapshot.cacheKey);
+
+                if (leftSnapshot.ready && rightSnapshot.ready)
+                    startAnimation();
+                else
+                    snapshotTimeout.start();
             }
         }
     }
@@ -419,39 +419,23 @@ void Helper::init()
 
     connect(wOutputManager, &WOutputManagerV1::requestTestOrApply, this, [this, wOutputManager]
             (qw_output_configuration_v1 *config, bool onlyTest) {
-        QList<WOutputState> states = wOutputManager->stateListPending();
-        bool ok = true;
-        for (auto state : std::as_const(states)) {
-            WOutput *output = state.output;
-            qw_output_state newState;
-
-            newState.set_enabled(state.enabled);
-            if (state.enabled) {
-                if (state.mode)
-                    newState.set_mode(state.mode);
-                else
-                    newState.set_custom_mode(state.customModeSize.width(),
-                                             state.customModeSize.height(),
-                                             state.customModeRefresh);
-
-                newState.set_adaptive_sync_enabled(state.adaptiveSyncEnabled);
-                if (!onlyTest) {
-                    newState.set_transform(static_cast<wl_output_transform>(state.transform));
-                    newState.set_scale(state.scale);
-
-                    WOutputViewport *viewport = getOutput(output)->screenViewport();
-                    if (viewport) {
-                        viewport->setX(state.x);
-                        viewport->setY(state.y);
-                    }
+        const QList<WOutputState> states = wOutputManager->stateListPending();
+        const bool ok = wOutputManager->applyStates(states, onlyTest);
+
+        // The position only changes the layout, it's not a part of the output commit
+        if (ok && !onlyTest) {
+            for (const auto &state : states) {
+                if (!state.enabled)
+                    continue;
+                auto output = getOutput(state.output);
+                WOutputViewport *viewport = output ? output->screenViewport() : nullptr;
+                if (viewport) {
+                    viewport->setX(state.x);
+                    viewport->setY(state.y);
                 }
             }
-
-            if (onlyTest)
-                ok &= output->handle()->test_state(newState);
-            else
-                ok &= output->handle()->commit_state(newState);
         }
+
         wOutputManager->sendResult(config, ok);
     });
 
@@ -12,9 +12,9 @@
 #include <wxdgsurface.h>
 #include <wxdgpopupsurface.h>
 #include <wlayersurface.h>
+#include <wlayershellarranger.h>
 #include <winputpopupsurface.h>
 #include <woutputlayout.h>
-#include <wquicktextureproxy.h>
 #include <wxdgpopupsurfaceitem.h>
 
 #include <qwoutputlayout.h>
@@ -65,7 +65,18 @@ Output *Output::createPrimary(WOutput *output, QQmlEngine *engine, QObject *pare
 
     o->m_menuBar = Helper::instance()->qmlEngine()->createMenuBar(outputItem, contentItem);
     o->m_menuBar->setZ(RootSurfaceContainer::MenuBarZOrder);
-    o->setExclusiveZone(Qt::TopEdge, o->m_menuBar, o->m_menuBar->height());
+    auto updateMenuBarZone = [o] {
+        WLayerShellArranger::State state;
+        state.layer = WLayerSurface::LayerType::Top;
+        state.anchor = WLayerSurface::AnchorType::Top
+                       | WLayerSurface::AnchorType::Left
+                       | WLayerSurface::AnchorType::Right;
+        state.exclusiveZone = o->m_menuBar->height();
+        state.desiredSize = QSize(0, state.exclusiveZone);
+        o->m_layerArranger->setState(o->m_menuBar, state);
+    };
+    o->connect(o->m_menuBar, &QQuickItem::heightChanged, o, updateMenuBarZone);
+    updateMenuBarZone();
 
     return o;
 }
@@ -89,9 +100,6 @@ Output *Output::createCopy(WOutput *output, Output *proxy, QQmlEngine *engine, Q
 
     auto contentItem = Helper::instance()->window()->contentItem();
     outputItem->setParentItem(contentItem);
-    o->updatePrimaryOutputHardwareLayers();
-    connect(o->m_outputViewport, &WOutputViewport::hardwareLayersChanged,
-            o, &Output::updatePrimaryOutputHardwareLayers);
 
     return o;
 }
@@ -100,8 +108,14 @@ Output::Output(WOutputItem *output, QObject *parent)
     : SurfaceListModel(parent)
     , m_item(output)
     , minimizedSurfaces(new SurfaceFilterModel(this))
+    , m_layerArranger(new WLayerShellArranger(this))
 {
     m_outputViewport = output->property("screenViewport").value<WOutputViewport *>();
+
+    connect(m_layerArranger, &WLayerShellArranger::geometryChanged,
+            this, &Output::onLayerSurfaceGeometryChanged);
+    connect(m_layerArranger, &WLayerShellArranger::usableAreaChanged,
+            this, &Output::updateExclusiveZone);
 }
 
 Output::~Output()
@@ -134,9 +148,8 @@ void Output::addSurface(SurfaceWrapper *surface)
 
     if (surface->type() == SurfaceWrapper::Type::Layer) {
         auto layer = qobject_cast<WLayerSurface*>(surface->shellSurface());
-        layer->safeConnect(&WLayerSurface::layerPropertiesChanged, this, &Output::layoutLayerSurfaces);
-
-        layoutLayerSurfaces();
+        // Follows the commits of the surface, and places it on the geometryChanged
+        m_layerArranger->addSurface(layer);
     } else {
         auto layoutSurface = [surface, this] {
             layoutNonLayerSurface(surface, {});
@@ -162,11 +175,9 @@ void Output::removeSurface(SurfaceWrapper *surface)
     surface->disconnect(this);
 
     if (surface->type() == SurfaceWrapper::Type::Layer) {
-        if (auto ss = surface->shellSurface()) {
-            ss->safeDisconnect(this);
-            removeExclusiveZone(ss);
-        }
-        layoutLayerSurfaces();
+        auto layer = qobject_cast<WLayerSurface*>(surface->shellSurface());
+        if (layer && m_layerArranger->contains(layer))
+            m_layerArranger->removeSurface(layer);
     }
 }
 
@@ -182,154 +193,38 @@ WOutputItem *Output::outputItem() const
     return m_item;
 }
 
-void Output::setExclusiveZone(Qt::Edge edge, QObject *object, int value)
+void Output::layoutLayerSurfaces()
 {
-    Q_ASSERT(value > 0);
-    removeExclusiveZone(object);
-    switch (edge) {
-    case Qt::TopEdge:
-        m_topExclusiveZones.append(std::make_pair(object, value));
-        m_exclusiveZone.setTop(m_exclusiveZone.top() + value);
-        break;
-    case Qt::BottomEdge:
-        m_bottomExclusiveZones.append(std::make_pair(object, value));
-        m_exclusiveZone.setBottom(m_exclusiveZone.bottom() + value);
-        break;
-    case Qt::LeftEdge:
-        m_leftExclusiveZones.append(std::make_pair(object, value));
-        m_exclusiveZone.setLeft(m_exclusiveZone.left() + value);
-        break;
-    case Qt::RightEdge:
-        m_rightExclusiveZones.append(std::make_pair(object, value));
-        m_exclusiveZone.setRight(m_exclusiveZone.right() + value);
-        break;
-    default:
-        Q_UNREACHABLE_RETURN();
-    }
+    m_layerArranger->setOutputGeometry(rect().toRect());
 }
 
-bool Output::removeExclusiveZone(QObject *object)
+void Output::onLayerSurfaceGeometryChanged(QObject *key, const QRect &geometry)
 {
-    auto finder = [object](const auto &pair) { return pair.first == object; };
-    auto tmp = std::find_if(m_topExclusiveZones.begin(), m_topExclusiveZones.end(), finder);
-    if (tmp != m_topExclusiveZones.end()) {
-        m_topExclusiveZones.erase(tmp);
-        m_exclusiveZone.setTop(m_exclusiveZone.top() - tmp->second);
-        Q_ASSERT(m_exclusiveZone.top() >= 0);
-        return true;
-    }
-
-    tmp = std::find_if(m_bottomExclusiveZones.begin(), m_bottomExclusiveZones.end(), finder);
-    if (tmp != m_bottomExclusiveZones.end()) {
-        m_bottomExclusiveZones.erase(tmp);
-        m_exclusiveZone.setBottom(m_exclusiveZone.bottom() - tmp->second);
-        Q_ASSERT(m_exclusiveZone.bottom() >= 0);
-        return true;
-    }
-
-    tmp = std::find_if(m_leftExclusiveZones.begin(), m_leftExclusiveZones.end(), finder);
-    if (tmp != m_leftExclusiveZones.end()) {
-        m_leftExclusiveZones.erase(tmp);
-        m_exclusiveZone.setLeft(m_exclusiveZone.left() - tmp->second);
-        Q_ASSERT(m_exclusiveZone.left() >= 0);
-        return true;
-    }
-
-    tmp = std::find_if(m_rightExclusiveZones.begin(), m_rightExclusiveZones.end(), finder);
-    if (tmp != m_rightExclusiveZones.end()) {
-        m_rightExclusiveZones.erase(tmp);
-        m_exclusiveZone.setRight(m_exclusiveZone.right() - tmp->second);
-        Q_ASSERT(m_exclusiveZone.right() >= 0);
-        return true;
+    for (auto *s : surfaces()) {
+        if (s->type() != SurfaceWrapper::Type::Layer || s->shellSurface() != key)
+            continue;
+        s->setSize(geometry.size());
+        s->setPosition(geometry.topLeft());
+        break;
     }
-
-    return false;
 }
 
-void Output::layoutLayerSurface(SurfaceWrapper *surface)
+void Output::updateExclusiveZone()
 {
-    WLayerSurface* layer = qobject_cast<WLayerSurface*>(surface->shellSurface());
-    Q_ASSERT(layer);
-    if (!layer->handle()->handle()->initialized) {
+    const auto area = m_layerArranger->usableArea();
+    const auto bounds = m_layerArranger->outputGeometry();
+    // Wait for the size of the output item
+    if (bounds.isEmpty())
         return;
-    }
-
-    auto validGeo = layer->exclusiveZone() == -1 ? this->rect() : validRect();
-    validGeo = validGeo.marginsRemoved(QMargins(layer->leftMargin(),
-                                                layer->topMargin(),
-                                                layer->rightMargin(),
-                                                layer->bottomMargin()));
-    auto anchor = layer->ancher();
-    QRectF surfaceGeo(QPointF(0, 0), layer->desiredSize());
-
-    if (anchor.testFlags(WLayerSurface::AnchorType::Left | WLayerSurface::AnchorType::Right)) {
-        surfaceGeo.moveLeft(validGeo.left());
-        surfaceGeo.setWidth(validGeo.width());
-    } else if (anchor & WLayerSurface::AnchorType::Left) {
-        surfaceGeo.moveLeft(validGeo.left());
-    } else if (anchor & WLayerSurface::AnchorType::Right) {
-        surfaceGeo.moveRight(validGeo.right());
-    } else {
-        surfaceGeo.moveLeft(validGeo.left() + (validGeo.width() - surfaceGeo.width()) / 2);
-    }
-
-    if (anchor.testFlags(WLayerSurface::AnchorType::Top | WLayerSurface::AnchorType::Bottom)) {
-        surfaceGeo.moveTop(validGeo.top());
-        surfaceGeo.setHeight(validGeo.height());
-    } else if (anchor & WLayerSurface::AnchorType::Top) {
-        surfaceGeo.moveTop(validGeo.top());
-    } else if (anchor & WLayerSurface::AnchorType::Bottom) {
-        surfaceGeo.moveBottom(validGeo.bottom());
-    } else {
-        surfaceGeo.moveTop(validGeo.top() + (validGeo.height() - surfaceGeo.height()) / 2);
-    }
-
-    if (layer->exclusiveZone() > 0) {
-        // TODO:: support `set_exclusive_edge` in layer-shell v5, need wlroots 0.19
-        switch (layer->getExclusiveZoneEdge()) {
-            using enum WLayerSurface::AnchorType;
-        case Top:
-            setExclusiveZone(Qt::TopEdge, layer, layer->exclusiveZone());
-            break;
-        case Bottom:
-            setExclusiveZone(Qt::BottomEdge, layer, layer->exclusiveZone());
-            break;
-        case Left:
-            setExclusiveZone(Qt::LeftEdge, layer, layer->exclusiveZone());
-            break;
-        case Right:
-            setExclusiveZone(Qt::RightEdge, layer, layer->exclusiveZone());
-            break;
-        default:
-            qCWarning(qLcLayerShell) << layer->appId() << " has set exclusive zone, but exclusive edge is invalid!";
-            break;
-        }
-    }
-
-    surface->setSize(surfaceGeo.size());
-    surface->setPosition(surfaceGeo.topLeft());
-}
-
-void Output::layoutLayerSurfaces()
-{
-    auto oldExclusiveZone = m_exclusiveZone;
-
-    for (auto *s : surfaces()) {
-        if (s->type() != SurfaceWrapper::Type::Layer)
-            continue;
-        removeExclusiveZone(s->shellSurface());
-    }
 
-    for (auto *s : surfaces()) {
-        if (s->type() != SurfaceWrapper::Type::Layer)
-            continue;
-        layoutLayerSurface(s);
-    }
+    const QMargins zone(area.left() - bounds.left(), area.top() - bounds.top(),
+                        bounds.right() - area.right(), bounds.bottom() - area.bottom());
+    if (m_exclusiveZone == zone)
+        return;
 
-    if (oldExclusiveZone != m_exclusiveZone) {
-        layoutNonLayerSurfaces();
-        emit exclusiveZoneChanged();
-    }
+    m_exclusiveZone = zone;
+    layoutNonLayerSurfaces();
+    emit exclusiveZoneChanged();
 }
 
 void Output::layoutNonLayerSurface(SurfaceWrapper *surface, const QSizeF &sizeDiff)
@@ -449,34 +344,6 @@ void Output::updatePositionFromLayout()
     m_item->setPosition(pos);
 }
 
-std::pair<WOutputViewport*, QQuickItem*> Output::getOutputItemProperty()
-{
-    WOutputViewport *viewportCopy = outputItem()->findChild<WOutputViewport*>({}, Qt::FindDirectChildrenOnly);
-    Q_ASSERT(viewportCopy);
-    auto textureProxy = outputItem()->findChild<WQuickTextureProxy*>();
-    Q_ASSERT(textureProxy);
-
-    return std::make_pair(viewportCopy, textureProxy);
-}
-
-void Output::updatePrimaryOutputHardwareLayers()
-{
-    WOutputViewport *viewportPrimary = screenViewport();
-    std::pair<WOutputViewport*, QQuickItem*> copyOutput = getOutputItemProperty();
-    const auto layers = viewportPrimary->hardwareLayers();
-    for (auto layer : layers) {
-        if (m_hardwareLayersOfPrimaryOutput.removeOne(layer))
-            continue;
-        Helper::instance()->window()->attach(layer, copyOutput.first, viewportPrimary, copyOutput.second);
-    }
-
-    for (auto oldLayer : std::as_const(m_hardwareLayersOfPrimaryOutput)) {
-        Helper::instance()->window()->detach(oldLayer, copyOutput.first);
-    }
-
-    m_hardwareLayersOfPrimaryOutput = layers;
-}
-
 QMargins Output::exclusiveZone() const
 {
     return m_exclusiveZone;
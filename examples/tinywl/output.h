@@ -19,9 +19,8 @@ class WOutput;
 class WOutputItem;
 class WOutputViewport;
 class WOutputLayout;
-class WOutputLayer;
-class WQuickTextureProxy;
 class WSeat;
+class WLayerShellArranger;
 WAYLIB_SERVER_END_NAMESPACE
 
 WAYLIB_SERVER_USE_NAMESPACE
@@ -69,21 +68,16 @@ signals:
     void exclusiveZoneChanged();
     void moveResizeFinised();
 
-public Q_SLOTS:
-    void updatePrimaryOutputHardwareLayers();
-
 private:
     friend class SurfaceWrapper;
 
-    void setExclusiveZone(Qt::Edge edge, QObject *object, int value);
-    bool removeExclusiveZone(QObject *object);
-    void layoutLayerSurface(SurfaceWrapper *surface);
     void layoutLayerSurfaces();
+    void onLayerSurfaceGeometryChanged(QObject *key, const QRect &geometry);
+    void updateExclusiveZone();
     void layoutNonLayerSurface(SurfaceWrapper *surface, const QSizeF &sizeDiff);
     void layoutPopupSurface(SurfaceWrapper *surface);
     void layoutNonLayerSurfaces();
     void layoutAllSurfaces();
-    std::pair<WOutputViewport*, QQuickItem*> getOutputItemProperty();
 
     Type m_type;
     WOutputItem *m_item;
@@ -93,14 +87,10 @@ private:
     QPointer<QQuickItem> m_menuBar;
     WOutputViewport *m_outputViewport;
 
+    WLayerShellArranger *m_layerArranger;
     QMargins m_exclusiveZone;
-    QList<std::pair<QObject*, int>> m_topExclusiveZones;
-    QList<std::pair<QObject*, int>> m_bottomExclusiveZones;
-    QList<std::pair<QObject*, int>> m_leftExclusiveZones;
-    QList<std::pair<QObject*, int>> m_rightExclusiveZones;
 
     QSizeF m_lastSizeOnLayoutNonLayerSurfaces;
-    QList<WOutputLayer *> m_hardwareLayersOfPrimaryOutput;
 };
 
 Q_DECLARE_OPAQUE_POINTER(WAYLIB_SERVER_NAMESPACE::WOutputItem*)
@@ -7,6 +7,9 @@
 #include "helper.h"
 #include "rootsurfacecontainer.h"
 
+#include <woutputrenderwindow.h>
+#include <wthumbnailprovider.h>
+
 Workspace::Workspace(SurfaceContainer *parent)
     : SurfaceContainer(parent)
 {
@@ -74,6 +77,16 @@ int Workspace::createContainer(const QString &name, bool visible)
     auto newContainer = m_models.last();
     newContainer->setName(name);
     newContainer->setVisible(visible);
+
+    // The cached snapshot of a workspace is outdated once its windows change
+    auto drop = [this, newContainer] {
+        dropSnapshots(newContainer);
+    };
+    connect(newContainer, &WorkspaceModel::rowsInserted, this, drop);
+    connect(newContainer, &WorkspaceModel::rowsRemoved, this, drop);
+    connect(newContainer, &WorkspaceModel::rowsMoved, this, drop);
+    connect(newContainer, &WorkspaceModel::modelReset, this, drop);
+
     return newContainer->index();
 }
 
@@ -85,6 +98,8 @@ void Workspace::removeContainer(int index)
         return;
 
     auto container = m_models.at(index);
+    dropSnapshots(container);
+    container->disconnect(this);
     m_models.removeAt(index);
 
     // reset index
@@ -109,6 +124,22 @@ void Workspace::removeContainer(int index)
         emit currentChanged();
 }
 
+void Workspace::dropSnapshots(WorkspaceModel *container)
+{
+    auto window = Helper::instance()->window();
+    if (!window)
+        return;
+
+    // Every workspace shows the windows of showOnAllWorkspaceModel
+    const auto containers = container == showOnAllWorkspaceModel()
+                                ? m_models : QList<WorkspaceModel*>{container};
+    auto provider = window->thumbnailProvider();
+    for (auto output : rootContainer()->outputs()) {
+        for (auto c : containers)
+            provider->dropSnapshot(c->snapshotKey(output->output()));
+    }
+}
+
 WorkspaceModel *Workspace::container(int index) const
 {
     if (index < 0 || index >= m_models.size())
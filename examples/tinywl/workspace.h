@@ -46,6 +46,7 @@ signals:
 private:
     void updateSurfaceOwnsOutput(SurfaceWrapper *surface);
     void updateSurfacesOwnsOutput();
+    void dropSnapshots(WorkspaceModel *container);
 
     // Workspace id starts from 1, the WorkspaceModel with id 0 is used to
     // store the surface that is always in the visible workspace.
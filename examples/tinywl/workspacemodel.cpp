@@ -5,6 +5,8 @@
 #include "surfacewrapper.h"
 #include "helper.h"
 
+#include <woutput.h>
+
 WorkspaceModel::WorkspaceModel(QObject *parent, int index)
     : SurfaceListModel(parent)
     , m_index(index)
@@ -65,3 +67,8 @@ void WorkspaceModel::removeSurface(SurfaceWrapper *surface)
     SurfaceListModel::removeSurface(surface);
     surface->setWorkspaceId(-1);
 }
+
+QString WorkspaceModel::snapshotKey(WOutput *output) const
+{
+    return output ? m_name + "@" + output->name() : QString();
+}
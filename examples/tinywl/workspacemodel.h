@@ -4,6 +4,10 @@
 
 #include "surfacecontainer.h"
 
+WAYLIB_SERVER_BEGIN_NAMESPACE
+class WOutput;
+WAYLIB_SERVER_END_NAMESPACE
+
 class SurfaceWrapper;
 class Workspace;
 class WorkspaceModel : public SurfaceListModel
@@ -31,6 +35,9 @@ public:
     void addSurface(SurfaceWrapper *surface) override;
     void removeSurface(SurfaceWrapper *surface) override;
 
+    // The key of the cached snapshot of this workspace on the output
+    Q_INVOKABLE QString snapshotKey(WAYLIB_SERVER_NAMESPACE::WOutput *output) const;
+
 Q_SIGNALS:
     void nameChanged();
     void indexChanged();
@@ -10,10 +10,12 @@
 
 #include <QCursor>
 #include <QPointer>
+#include <QVarLengthArray>
 
 QW_BEGIN_NAMESPACE
 class qw_pointer;
 class qw_surface;
+class qw_touch;
 QW_END_NAMESPACE
 
 struct wlr_pointer_motion_event;
@@ -72,6 +74,7 @@ public:
 
     void connect();
     void processCursorMotion(QW_NAMESPACE::qw_pointer *device, uint32_t time);
+    void flushTouchMotions();
 
     W_DECLARE_PUBLIC(WCursor)
 
@@ -88,6 +91,16 @@ public:
     Qt::MouseButton button = Qt::NoButton;
     QPointF lastPressedOrTouchDownPosition;
     bool visible = true;
+
+    // The touch motions are merged by the touch id until the touch frame,
+    // the position is the ratio of the touch device's box
+    struct TouchMotion {
+        QW_NAMESPACE::qw_touch *device;
+        int32_t touchId;
+        QPointF position;
+        uint32_t timeMsec;
+    };
+    QVarLengthArray<TouchMotion, 10> pendingTouchMotions;
 };
 
 WAYLIB_SERVER_END_NAMESPACE
@@ -5,6 +5,7 @@
 #include "wglobal.h"
 #include <qwobject.h>
 #include <QPointer>
+#include <QHash>
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
@@ -52,7 +53,14 @@ protected:
     void invalidate();
     virtual void instantRelease() {}
 
-    QList<QMetaObject::Connection> connectionsWithHandle;
+    void addConnectionWithHandle(const QMetaObject::Connection &connection);
+    bool takeConnectionWithHandle(const QMetaObject::Connection &connection);
+
+    // Grouped by the receiver, safeDisconnect(receiver) only visits its own connections
+    QHash<const QObject*, QList<QMetaObject::Connection>> connectionsWithHandle;
+    // The connection's private data to its receiver at connecting time,
+    // the receiver in the connection is cleared once it's disconnected
+    QHash<const void*, const QObject*> receiverOfConnections;
     QPointer<QW_NAMESPACE::qw_object_basic> m_handle;
     uint invalidated:1;
 };
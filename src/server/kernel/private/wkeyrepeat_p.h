@@ -0,0 +1,66 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <functional>
+
+struct wl_event_loop;
+struct wl_event_source;
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// The key repeat source, driven by a timer of the wl_event_loop. The repeats are
+// scheduled on the deadlines of CLOCK_MONOTONIC from the start, so they don't drift
+// when the event loop is busy. The callback gets the time of the repeat's deadline,
+// in milliseconds of CLOCK_MONOTONIC like the time of the libinput's events.
+class WAYLIB_SERVER_EXPORT WKeyRepeat
+{
+public:
+    enum class Policy {
+        // Send all the missed repeats, at most MaxCatchUp of them
+        CatchUp,
+        // Only send the last one of the missed repeats
+        DropMissed,
+    };
+
+    static constexpr int MaxCatchUp = 8;
+
+    using Callback = std::function<void(uint32_t timeMsec)>;
+
+    WKeyRepeat(wl_event_loop *loop, Callback callback);
+    ~WKeyRepeat();
+
+    inline Policy policy() const {
+        return m_policy;
+    }
+    inline void setPolicy(Policy policy) {
+        m_policy = policy;
+    }
+
+    inline bool isActive() const {
+        return m_interval > 0;
+    }
+
+    // The delay is in milliseconds, the rate is the repeats per second
+    void start(int delay, int rate);
+    void stop();
+
+    static qint64 monotonicNsecs();
+
+private:
+    static int handleTimer(void *data);
+    void scheduleNext(qint64 now);
+
+    wl_event_source *m_source = nullptr;
+    Callback m_callback;
+    Policy m_policy = Policy::DropMissed;
+    qint64 m_deadline = 0;
+    qint64 m_interval = 0;
+    // Changed by start and stop, the callback may call them
+    quint32 m_serial = 0;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
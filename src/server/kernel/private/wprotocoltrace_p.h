@@ -0,0 +1,96 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QHash>
+
+struct wl_display;
+struct wl_client;
+struct wl_resource;
+struct wl_listener;
+struct wl_protocol_logger;
+struct wl_protocol_logger_message;
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// The trace file is a FileHeader followed by records, every record is a RecordHeader
+// and its payload. All the values are in the native byte order.
+namespace WProtocolTrace {
+
+inline constexpr char Magic[8] = { 'W', 'L', 'T', 'R', 'A', 'C', 'E', '\0' };
+inline constexpr quint32 Version = 1;
+
+struct FileHeader
+{
+    char magic[8];
+    quint32 version;
+    quint32 reserved;
+};
+
+enum RecordType : quint8 {
+    ClientConnected = 1,
+    ClientDisconnected,
+    // Payload: object id (u32), opcode (u16), padding (u16), arguments. The arguments
+    // follow the request's signature: 'i', 'u', 'f', 'o' (object id, 0 for null) and
+    // 'n' (new id) are 4 bytes, 's' and 'a' are the size (u32, 0 for a null string)
+    // followed by the data, the string includes its terminating null byte. The file
+    // descriptors ('h') aren't recorded.
+    Request,
+    // Payload: object id (u32), the object is destroyed, its id may be reused
+    ObjectDeleted,
+    // Payload: wl_buffer id (u32), width, height, stride (i32), format (u32), pixels.
+    // Written before the request which attaches the buffer when its contents changed.
+    ShmBufferContents,
+};
+
+struct RecordHeader
+{
+    // Nanoseconds since the start of the recording
+    quint64 timestamp;
+    quint32 size;
+    quint16 client;
+    RecordType type;
+    quint8 reserved;
+};
+
+static_assert(sizeof(FileHeader) == 16);
+static_assert(sizeof(RecordHeader) == 16);
+
+}
+
+class Q_DECL_HIDDEN WProtocolRecorder
+{
+public:
+    explicit WProtocolRecorder(wl_display *display);
+    ~WProtocolRecorder();
+
+    bool open(const QString &fileName);
+
+    void handleRequest(const wl_protocol_logger_message *message);
+    void handleEvent(const wl_protocol_logger_message *message);
+
+private:
+    struct ClientData;
+
+    static void handleClientDestroyed(wl_listener *listener, void *data);
+
+    ClientData *ensureClient(wl_client *client);
+    void recordRequest(ClientData *client, const wl_protocol_logger_message *message);
+    void recordShmBuffer(ClientData *client, wl_resource *buffer);
+    void writeRecord(WProtocolTrace::RecordType type, quint16 client, QByteArrayView payload);
+
+    wl_display *m_display;
+    wl_protocol_logger *m_logger = nullptr;
+    QFile m_file;
+    QElapsedTimer m_timer;
+    QHash<wl_client*, ClientData*> m_clients;
+    quint16 m_nextClient = 0;
+    QByteArray m_payload;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -18,6 +18,7 @@ QW_END_NAMESPACE
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+class WProtocolRecorder;
 class Q_DECL_HIDDEN WServerPrivate : public WObjectPrivate
 {
 public:
@@ -42,6 +43,8 @@ public:
 
     GlobalFilterFunc globalFilterFunc = nullptr;
     void *globalFilterFuncData = nullptr;
+
+    std::unique_ptr<WProtocolRecorder> recorder;
 };
 
 WAYLIB_SERVER_END_NAMESPACE
@@ -4,6 +4,7 @@
 #pragma once
 
 #include "wsurface.h"
+#include "wsocket.h"
 #include "private/wglobal_p.h"
 
 #include <qwcompositor.h>
@@ -11,8 +12,14 @@
 
 #include <QObject>
 #include <QPointer>
+#include <QHash>
+
+QT_BEGIN_NAMESPACE
+class QTimer;
+QT_END_NAMESPACE
 
 struct wlr_surface;
+struct wlr_buffer;
 struct wlr_subsurface;
 
 QW_BEGIN_NAMESPACE
@@ -44,6 +51,11 @@ public:
     void updateBufferOffset();
     void updatePreferredBufferScale();
     void preferredBufferScaleChange();
+    void sendFrameDone();
+    void updateFrameThrottle();
+    void accountResource(WClient::Resource resource, qint64 &accounted, qint64 usage);
+    void updateBufferUsage();
+    void updateFrameCallbackUsage();
 
     WSurface *ensureSubsurface(wlr_subsurface *subsurface);
     void setSubsurface(QW_NAMESPACE::qw_subsurface *newSubsurface);
@@ -62,6 +74,28 @@ public:
     QVector<WOutput*> outputs;
     QMetaObject::Connection frameDoneConnection;
     QPoint bufferOffset;
+
+    struct FrameThrottleRequest {
+        WSurface::FrameThrottle throttle;
+        QMetaObject::Connection destroyConnection;
+    };
+    QHash<const QObject*, FrameThrottleRequest> frameThrottleRequests;
+
+    struct HeldBuffers {
+        QList<wlr_buffer*> buffers;
+        QMetaObject::Connection destroyConnection;
+    };
+    QHash<const QObject*, HeldBuffers> heldBuffers;
+    WSurface::FrameThrottle frameThrottle = WSurface::FrameThrottle::FullRate;
+    int reducedFrameInterval = 1000;
+    QTimer *reducedFrameTimer = nullptr;
+
+    // The resources of this surface added to the client
+    QPointer<WClient> client;
+    qint64 accountedBufferBytes = 0;
+    qint64 accountedTextureBytes = 0;
+    qint64 accountedSubsurface = 0;
+    qint64 accountedFrameCallbacks = 0;
 };
 
 WAYLIB_SERVER_END_NAMESPACE
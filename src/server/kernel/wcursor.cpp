@@ -207,6 +207,7 @@ void WCursorPrivate::on_hold_end(wlr_pointer_hold_end_event *event)
 void WCursorPrivate::on_touch_down(wlr_touch_down_event *event)
 {
     auto device = qw_touch::from(event->touch);
+    flushTouchMotions();
 
     q_func()->setScalePosition(device, QPointF(event->x, event->y));
     lastPressedOrTouchDownPosition = q_func()->position();
@@ -221,17 +222,25 @@ void WCursorPrivate::on_touch_down(wlr_touch_down_event *event)
 void WCursorPrivate::on_touch_motion(wlr_touch_motion_event *event)
 {
     auto device = qw_touch::from(event->touch);
-
-    q_func()->setScalePosition(device, QPointF(event->x, event->y));
-
-    if (Q_LIKELY(seat)) {
-        seat->notifyTouchMotion(q_func(), WInputDevice::fromHandle(device),
-                                event->touch_id, event->time_msec);
+    const QPointF position(event->x, event->y);
+
+    // A touchscreen may report many motions for a point before the frame,
+    // only the last one is meaningful
+    for (auto &motion : pendingTouchMotions) {
+        if (motion.device == device && motion.touchId == event->touch_id) {
+            motion.position = position;
+            motion.timeMsec = event->time_msec;
+            return;
+        }
     }
+
+    pendingTouchMotions.append({ device, event->touch_id, position, event->time_msec });
 }
 
 void WCursorPrivate::on_touch_frame()
 {
+    flushTouchMotions();
+
     if (Q_LIKELY(seat)) {
         seat->notifyTouchFrame(q_func());
     }
@@ -240,6 +249,7 @@ void WCursorPrivate::on_touch_frame()
 void WCursorPrivate::on_touch_cancel(wlr_touch_cancel_event *event)
 {
     auto device = qw_touch::from(event->touch);
+    flushTouchMotions();
 
     if (Q_LIKELY(seat)) {
         seat->notifyTouchCancel(q_func(), WInputDevice::fromHandle(device),
@@ -250,6 +260,7 @@ void WCursorPrivate::on_touch_cancel(wlr_touch_cancel_event *event)
 void WCursorPrivate::on_touch_up(wlr_touch_up_event *event)
 {
     auto device = qw_touch::from(event->touch);
+    flushTouchMotions();
 
     if (Q_LIKELY(seat)) {
         seat->notifyTouchUp(q_func(), WInputDevice::fromHandle(device),
@@ -257,6 +268,22 @@ void WCursorPrivate::on_touch_up(wlr_touch_up_event *event)
     }
 }
 
+void WCursorPrivate::flushTouchMotions()
+{
+    W_Q(WCursor);
+
+    for (const auto &motion : std::as_const(pendingTouchMotions)) {
+        q->setScalePosition(motion.device, motion.position);
+
+        if (Q_LIKELY(seat)) {
+            seat->notifyTouchMotion(q, WInputDevice::fromHandle(motion.device),
+                                    motion.touchId, motion.timeMsec);
+        }
+    }
+
+    pendingTouchMotions.clear();
+}
+
 void WCursorPrivate::connect()
 {
     W_Q(WCursor);
@@ -596,6 +623,9 @@ void WCursor::detachInputDevice(WInputDevice *device)
 
     d->handle()->detach_input_device(device->handle()->handle());
     d->handle()->map_input_to_output(device->handle()->handle(), nullptr);
+    d->pendingTouchMotions.removeIf([device] (const WCursorPrivate::TouchMotion &motion) {
+        return motion.device == device->handle();
+    });
 
     if (d->eventWindow && device->seat()) {
         Q_ASSERT(d->seat);
@@ -119,6 +119,42 @@ static inline QObjectPrivate::Connection *getConnectionDPtr(const QMetaObject::C
     return *reinterpret_cast<QObjectPrivate::Connection**>(const_cast<QMetaObject::Connection*>(connection));
 }
 
+void WWrapObjectPrivate::addConnectionWithHandle(const QMetaObject::Connection &connection)
+{
+    auto c_d = getConnectionDPtr(&connection);
+    const QObject *receiver = c_d->receiver.loadRelaxed();
+    receiverOfConnections.insert(c_d, receiver);
+    connectionsWithHandle[receiver].append(connection);
+}
+
+bool WWrapObjectPrivate::takeConnectionWithHandle(const QMetaObject::Connection &connection)
+{
+    auto c_d = getConnectionDPtr(&connection);
+    auto it = receiverOfConnections.constFind(c_d);
+    if (it == receiverOfConnections.constEnd())
+        return false;
+
+    auto connections = connectionsWithHandle.find(it.value());
+    receiverOfConnections.erase(it);
+    Q_ASSERT(connections != connectionsWithHandle.end());
+
+    // The order of the connections is not important, swap with the last one
+    auto &list = connections.value();
+    for (qsizetype i = 0; i < list.size(); ++i) {
+        if (getConnectionDPtr(&list.at(i)) != c_d)
+            continue;
+        if (i != list.size() - 1)
+            list.swapItemsAt(i, list.size() - 1);
+        list.removeLast();
+        break;
+    }
+
+    if (list.isEmpty())
+        connectionsWithHandle.erase(connections);
+
+    return true;
+}
+
 void WWrapObjectPrivate::invalidate()
 {
     if (invalidated)
@@ -136,14 +172,16 @@ void WWrapObjectPrivate::invalidate()
     }
 
     instantRelease();
-    for (const auto &connection : std::as_const(connectionsWithHandle)) {
-        QObject::disconnect(connection);
+    for (const auto &connections : std::as_const(connectionsWithHandle)) {
+        for (const auto &connection : connections)
+            QObject::disconnect(connection);
     }
     if (m_handle) {
         m_handle->disconnect(q);
         m_handle = nullptr;
     }
     connectionsWithHandle.clear();
+    receiverOfConnections.clear();
 
     Q_EMIT q->invalidated();
 }
@@ -153,17 +191,11 @@ bool WWrapObject::safeDisconnect(const QObject *receiver)
     W_D(WWrapObject);
 
     bool ok = false;
-    for (int i = 0; i < d->connectionsWithHandle.size(); ++i) {
-        const QMetaObject::Connection &connection = d->connectionsWithHandle.at(i);
-        auto c_d = getConnectionDPtr(&connection);
-        if (c_d->receiver == receiver) {
-            if (QObject::disconnect(connection))
-                ok = true;
-
-            d->connectionsWithHandle.removeAt(i);
-            // reset index
-            --i;
-        }
+    const auto connections = d->connectionsWithHandle.take(receiver);
+    for (const auto &connection : connections) {
+        d->receiverOfConnections.remove(getConnectionDPtr(&connection));
+        if (QObject::disconnect(connection))
+            ok = true;
     }
 
     if (disconnect(receiver))
@@ -175,14 +207,12 @@ bool WWrapObject::safeDisconnect(const QObject *receiver)
 bool WWrapObject::safeDisconnect(const QMetaObject::Connection &connection)
 {
     W_D(WWrapObject);
-    int index = d->connectionsWithHandle.indexOf(connection);
-    if (index < 0) {
+    if (!d->takeConnectionWithHandle(connection)) {
         auto c_d = getConnectionDPtr(&connection);
         if (c_d->sender != this)
             return false;
         return disconnect(connection);
     }
-    d->connectionsWithHandle.removeAt(index);
     return QObject::disconnect(connection);
 }
 
@@ -226,7 +256,7 @@ void WWrapObject::endSafeConnect(const QMetaObject::Connection &connection)
 {
     W_D(WWrapObject);
     if (connection)
-        d->connectionsWithHandle.append(connection);
+        d->addConnectionWithHandle(connection);
 }
 
 #ifdef QT_DEBUG
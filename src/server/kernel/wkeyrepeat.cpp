@@ -0,0 +1,94 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "private/wkeyrepeat_p.h"
+
+#include <wayland-server-core.h>
+
+#include <time.h>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+static constexpr qint64 NsecsPerMsec = 1000000;
+
+WKeyRepeat::WKeyRepeat(wl_event_loop *loop, Callback callback)
+    : m_source(wl_event_loop_add_timer(loop, handleTimer, this))
+    , m_callback(std::move(callback))
+{
+    Q_ASSERT(m_source);
+}
+
+WKeyRepeat::~WKeyRepeat()
+{
+    wl_event_source_remove(m_source);
+}
+
+void WKeyRepeat::start(int delay, int rate)
+{
+    ++m_serial;
+
+    if (rate <= 0) {
+        stop();
+        return;
+    }
+
+    m_interval = 1000000000 / rate;
+    const qint64 now = monotonicNsecs();
+    m_deadline = now + qMax(delay, 0) * NsecsPerMsec;
+    scheduleNext(now);
+}
+
+void WKeyRepeat::stop()
+{
+    ++m_serial;
+    m_interval = 0;
+    wl_event_source_timer_update(m_source, 0);
+}
+
+qint64 WKeyRepeat::monotonicNsecs()
+{
+    timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return qint64(ts.tv_sec) * 1000000000 + ts.tv_nsec;
+}
+
+int WKeyRepeat::handleTimer(void *data)
+{
+    auto self = static_cast<WKeyRepeat*>(data);
+    if (!self->isActive())
+        return 0;
+
+    const qint64 now = monotonicNsecs();
+    if (now < self->m_deadline) {
+        self->scheduleNext(now);
+        return 0;
+    }
+
+    // The event loop may be blocked for more than an interval
+    const qint64 dueCount = (now - self->m_deadline) / self->m_interval + 1;
+    const qint64 first = self->m_policy == Policy::CatchUp
+                             ? qMax<qint64>(0, dueCount - MaxCatchUp)
+                             : dueCount - 1;
+    const quint32 serial = self->m_serial;
+
+    for (qint64 i = first; i < dueCount; ++i) {
+        const qint64 deadline = self->m_deadline + i * self->m_interval;
+        self->m_callback(uint32_t(deadline / NsecsPerMsec));
+        if (self->m_serial != serial)
+            return 0;
+    }
+
+    self->m_deadline += dueCount * self->m_interval;
+    self->scheduleNext(monotonicNsecs());
+    return 0;
+}
+
+void WKeyRepeat::scheduleNext(qint64 now)
+{
+    // The timer is in milliseconds, round up to not wake up before the deadline,
+    // and 0 disarms the timer
+    const qint64 remaining = (m_deadline - now + NsecsPerMsec - 1) / NsecsPerMsec;
+    wl_event_source_timer_update(m_source, int(qMax<qint64>(remaining, 1)));
+}
+
+WAYLIB_SERVER_END_NAMESPACE
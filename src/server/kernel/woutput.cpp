@@ -90,6 +90,9 @@ WOutput::WOutput(qw_output *handle, WBackend *backend)
             Q_EMIT this->effectiveSizeChanged();
         }
 
+        if (event->state->committed & WLR_OUTPUT_STATE_ADAPTIVE_SYNC_ENABLED)
+            Q_EMIT this->adaptiveSyncEnabledChanged();
+
         if (event->state->committed & WLR_OUTPUT_STATE_BUFFER)
             Q_EMIT this->bufferCommitted();
 
@@ -534,6 +537,12 @@ float WOutput::scale() const
     return d->nativeHandle()->scale;
 }
 
+bool WOutput::adaptiveSyncEnabled() const
+{
+    W_DC(WOutput);
+    return d->nativeHandle()->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED;
+}
+
 void WOutput::attach(QQuickWindow *window)
 {
     W_D(WOutput);
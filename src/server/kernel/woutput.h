@@ -44,6 +44,7 @@ class WAYLIB_SERVER_EXPORT WOutput : public WWrapObject
     Q_PROPERTY(QSize size READ effectiveSize NOTIFY effectiveSizeChanged)
     Q_PROPERTY(Transform orientation READ orientation NOTIFY orientationChanged)
     Q_PROPERTY(float scale READ scale NOTIFY scaleChanged)
+    Q_PROPERTY(bool adaptiveSyncEnabled READ adaptiveSyncEnabled NOTIFY adaptiveSyncEnabledChanged FINAL)
     Q_PROPERTY(bool forceSoftwareCursor READ forceSoftwareCursor WRITE setForceSoftwareCursor NOTIFY forceSoftwareCursorChanged)
     Q_PROPERTY(QString name READ name CONSTANT)
     QML_NAMED_ELEMENT(WaylandOutput)
@@ -91,6 +92,7 @@ public:
     QSize effectiveSize() const;
     Transform orientation() const;
     float scale() const;
+    bool adaptiveSyncEnabled() const;
 
     void attach(QQuickWindow *window);
     QQuickWindow *attachedWindow() const;
@@ -113,6 +115,7 @@ Q_SIGNALS:
     void effectiveSizeChanged();
     void orientationChanged();
     void scaleChanged();
+    void adaptiveSyncEnabledChanged();
     void forceSoftwareCursorChanged();
     void bufferCommitted();
     void cursorAdded(WAYLIB_SERVER_NAMESPACE::WCursor *cursor);
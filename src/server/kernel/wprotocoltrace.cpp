@@ -0,0 +1,238 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "private/wprotocoltrace_p.h"
+
+#include <QLoggingCategory>
+
+#include <wayland-server-core.h>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcProtocolTrace, "waylib.server.trace", QtWarningMsg)
+
+using namespace WProtocolTrace;
+
+struct WProtocolRecorder::ClientData
+{
+    wl_listener destroyListener;
+    WProtocolRecorder *recorder;
+    wl_client *client;
+    quint16 index;
+    // The hash of the contents of the shm buffers last recorded, by the buffer's id
+    QHash<quint32, size_t> shmBufferHashes;
+};
+
+template<typename T>
+static inline void appendValue(QByteArray &data, T value)
+{
+    data.append(reinterpret_cast<const char*>(&value), sizeof(value));
+}
+
+static void logMessage(void *data, wl_protocol_logger_type type, const wl_protocol_logger_message *message)
+{
+    auto recorder = static_cast<WProtocolRecorder*>(data);
+    if (type == WL_PROTOCOL_LOGGER_REQUEST)
+        recorder->handleRequest(message);
+    else
+        recorder->handleEvent(message);
+}
+
+WProtocolRecorder::WProtocolRecorder(wl_display *display)
+    : m_display(display)
+{
+
+}
+
+WProtocolRecorder::~WProtocolRecorder()
+{
+    if (m_logger)
+        wl_protocol_logger_destroy(m_logger);
+
+    for (auto client : std::as_const(m_clients)) {
+        wl_list_remove(&client->destroyListener.link);
+        delete client;
+    }
+}
+
+bool WProtocolRecorder::open(const QString &fileName)
+{
+    Q_ASSERT(!m_logger);
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(qLcProtocolTrace) << "Can't open the trace file" << fileName << m_file.errorString();
+        return false;
+    }
+
+    FileHeader header {};
+    memcpy(header.magic, Magic, sizeof(Magic));
+    header.version = Version;
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    m_timer.start();
+    m_logger = wl_display_add_protocol_logger(m_display, logMessage, this);
+    return m_logger;
+}
+
+void WProtocolRecorder::handleRequest(const wl_protocol_logger_message *message)
+{
+    auto client = ensureClient(wl_resource_get_client(message->resource));
+
+    // Such as wl_surface.attach, the contents is needed to replay the buffer
+    if (qstrcmp(message->message->name, "attach") == 0
+        && qstrcmp(wl_resource_get_class(message->resource), "wl_surface") == 0
+        && message->arguments[0].o) {
+        recordShmBuffer(client, reinterpret_cast<wl_resource*>(message->arguments[0].o));
+    }
+
+    recordRequest(client, message);
+}
+
+void WProtocolRecorder::handleEvent(const wl_protocol_logger_message *message)
+{
+    // Only wl_display.delete_id is needed, the replay doesn't wait for the events
+    if (wl_resource_get_id(message->resource) != 1 || message->message_opcode != 1)
+        return;
+
+    auto client = m_clients.value(wl_resource_get_client(message->resource));
+    if (!client)
+        return;
+
+    const quint32 id = message->arguments[0].u;
+    client->shmBufferHashes.remove(id);
+    m_payload.clear();
+    appendValue(m_payload, id);
+    writeRecord(ObjectDeleted, client->index, m_payload);
+}
+
+void WProtocolRecorder::handleClientDestroyed(wl_listener *listener, void *)
+{
+    ClientData *client = wl_container_of(listener, client, destroyListener);
+    auto recorder = client->recorder;
+
+    recorder->writeRecord(ClientDisconnected, client->index, {});
+    wl_list_remove(&client->destroyListener.link);
+    recorder->m_clients.remove(client->client);
+    delete client;
+}
+
+WProtocolRecorder::ClientData *WProtocolRecorder::ensureClient(wl_client *client)
+{
+    auto data = m_clients.value(client);
+    if (data)
+        return data;
+
+    data = new ClientData {
+        .destroyListener = {},
+        .recorder = this,
+        .client = client,
+        .index = m_nextClient++,
+    };
+    data->destroyListener.notify = handleClientDestroyed;
+    wl_client_add_destroy_listener(client, &data->destroyListener);
+    m_clients.insert(client, data);
+
+    writeRecord(ClientConnected, data->index, {});
+    return data;
+}
+
+void WProtocolRecorder::recordRequest(ClientData *client, const wl_protocol_logger_message *message)
+{
+    m_payload.clear();
+    appendValue(m_payload, quint32(wl_resource_get_id(message->resource)));
+    appendValue(m_payload, quint16(message->message_opcode));
+    appendValue(m_payload, quint16(0));
+
+    int i = 0;
+    for (const char *signature = message->message->signature; *signature; ++signature) {
+        const wl_argument &arg = message->arguments[i];
+
+        switch (*signature) {
+        case 'i':
+        case 'f':
+            appendValue(m_payload, qint32(arg.i));
+            break;
+        case 'u':
+        case 'n':
+            appendValue(m_payload, quint32(arg.u));
+            break;
+        case 'o':
+            appendValue(m_payload, quint32(arg.o ? wl_resource_get_id(reinterpret_cast<wl_resource*>(arg.o)) : 0));
+            break;
+        case 's': {
+            const quint32 size = arg.s ? qstrlen(arg.s) + 1 : 0;
+            appendValue(m_payload, size);
+            m_payload.append(arg.s, size);
+            break;
+        }
+        case 'a': {
+            const quint32 size = arg.a ? arg.a->size : 0;
+            appendValue(m_payload, size);
+            if (size)
+                m_payload.append(static_cast<const char*>(arg.a->data), size);
+            break;
+        }
+        case 'h':
+            break;
+        default:
+            // The version and the nullable marks
+            continue;
+        }
+
+        ++i;
+    }
+
+    Q_ASSERT(i == message->arguments_count);
+    writeRecord(Request, client->index, m_payload);
+}
+
+void WProtocolRecorder::recordShmBuffer(ClientData *client, wl_resource *buffer)
+{
+    auto shmBuffer = wl_shm_buffer_get(buffer);
+    if (!shmBuffer)
+        return;
+
+    const qint32 width = wl_shm_buffer_get_width(shmBuffer);
+    const qint32 height = wl_shm_buffer_get_height(shmBuffer);
+    const qint32 stride = wl_shm_buffer_get_stride(shmBuffer);
+    const quint32 id = wl_resource_get_id(buffer);
+
+    wl_shm_buffer_begin_access(shmBuffer);
+    const QByteArrayView pixels(static_cast<const char*>(wl_shm_buffer_get_data(shmBuffer)),
+                                qsizetype(stride) * height);
+    const size_t hash = qHash(pixels);
+
+    auto lastHash = client->shmBufferHashes.constFind(id);
+    if (lastHash == client->shmBufferHashes.constEnd() || *lastHash != hash) {
+        client->shmBufferHashes.insert(id, hash);
+
+        m_payload.clear();
+        m_payload.reserve(sizeof(quint32) * 5 + pixels.size());
+        appendValue(m_payload, id);
+        appendValue(m_payload, width);
+        appendValue(m_payload, height);
+        appendValue(m_payload, stride);
+        appendValue(m_payload, quint32(wl_shm_buffer_get_format(shmBuffer)));
+        m_payload.append(pixels);
+        writeRecord(ShmBufferContents, client->index, m_payload);
+    }
+
+    wl_shm_buffer_end_access(shmBuffer);
+}
+
+void WProtocolRecorder::writeRecord(RecordType type, quint16 client, QByteArrayView payload)
+{
+    const RecordHeader header {
+        .timestamp = quint64(m_timer.nsecsElapsed()),
+        .size = quint32(payload.size()),
+        .client = client,
+        .type = type,
+        .reserved = 0,
+    };
+
+    m_file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    if (!payload.isEmpty())
+        m_file.write(payload.data(), payload.size());
+}
+
+WAYLIB_SERVER_END_NAMESPACE
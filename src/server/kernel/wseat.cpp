@@ -9,6 +9,7 @@
 #include "wxdgsurface.h"
 #include "platformplugin/qwlrootsintegration.h"
 #include "private/wglobal_p.h"
+#include "private/wkeyrepeat_p.h"
 
 #include <qwseat.h>
 #include <qwkeyboard.h>
@@ -24,7 +25,7 @@
 #include <QGuiApplication>
 #include <QQuickItem>
 #include <QDebug>
-#include <QTimer>
+#include <QSet>
 
 #include <qpa/qwindowsysteminterface.h>
 #include <private/qxkbcommon_p.h>
@@ -82,24 +83,6 @@ public:
         , name(name)
     {
         pendingEvents.reserve(2);
-
-        m_repeatTimer.callOnTimeout([&](){
-            if (!focusWindow) {
-                return;
-            }
-            auto rawdevice = qobject_cast<qw_keyboard*>(WInputDevice::from(m_repeatKey->device())->handle())->handle();
-            m_repeatTimer.setInterval(1000 / rawdevice->repeat_info.rate);
-            auto evPress = QKeyEvent(QEvent::KeyPress, m_repeatKey->key(), m_repeatKey->modifiers(),
-                m_repeatKey->nativeScanCode(), m_repeatKey->nativeVirtualKey(), m_repeatKey->nativeModifiers(),
-                m_repeatKey->text(), true, m_repeatKey->count(), m_repeatKey->device());
-            auto evRelease = QKeyEvent(QEvent::KeyRelease, m_repeatKey->key(), m_repeatKey->modifiers(),
-                m_repeatKey->nativeScanCode(), m_repeatKey->nativeVirtualKey(), m_repeatKey->nativeModifiers(),
-                m_repeatKey->text(), true, m_repeatKey->count(), m_repeatKey->device());
-            evPress.setTimestamp(m_repeatKey->timestamp());
-            evRelease.setTimestamp(m_repeatKey->timestamp());
-            handleKeyEvent(evPress);
-            handleKeyEvent(evRelease);
-        });
     }
     ~WSeatPrivate() {
         if (onEventObjectDestroy)
@@ -130,7 +113,15 @@ public:
         if (target) {
             if (pointerFocusSurface()) {
                 Q_ASSERT(pointerFocusEventObject == eventObject);
-                Q_ASSERT(pointerFocusSurface() == target->handle()->handle());
+                if (pointerFocusSurface() != target->handle()->handle()) {
+                    // Only an event object which flattens a subsurface tree covers several
+                    // surfaces, move the focus between the surfaces of that tree.
+                    Q_ASSERT(eventObjectCoversSubsurfaces);
+                    Q_ASSERT(wlr_surface_get_root_surface(pointerFocusSurface())
+                             == wlr_surface_get_root_surface(target->handle()->handle()));
+                    if (eventObjectCoversSubsurfaces)
+                        handle()->pointer_notify_enter(target->handle()->handle(), localPos.x(), localPos.y());
+                }
             } else {
                 // Maybe this seat is grabbed by a xdg popup surface, so the surface of under mouse
                 // can't take pointer focus, but maybe the popup is closed now, so we should try again
@@ -266,8 +257,9 @@ public:
             return;
 
         if (cursor->eventWindow()) {
-            QWindowSystemInterface::handleTouchEvent(cursor->eventWindow(), qwDevice, state->m_points,
-                                                     keyModifiers);
+            // Deliver it now, the wl_touch events of the points must be sent before the frame
+            QWindowSystemInterface::handleTouchEvent<QWindowSystemInterface::SynchronousDelivery>(
+                cursor->eventWindow(), qwDevice, state->m_points, keyModifiers);
         }
 
         for (int i = 0; i < state->m_points.size(); ++i) {
@@ -331,12 +323,21 @@ public:
     void on_keyboard_modifiers(WInputDevice *device);
     // end slot function
 
+    static inline quint64 shortcutKey(uint32_t keysym, Qt::KeyboardModifiers modifiers) {
+        constexpr auto mask = Qt::ShiftModifier | Qt::ControlModifier | Qt::AltModifier | Qt::MetaModifier;
+        return (quint64(xkb_keysym_to_lower(keysym)) << 32) | (modifiers & mask).toInt();
+    }
+    bool tryNotifyKeyDirectly(wlr_keyboard_key_event *event, WInputDevice *device, qw_keyboard *keyboard);
+
     void connect();
     void updateCapabilities();
     void attachInputDevice(WInputDevice *device);
     void detachInputDevice(WInputDevice *device);
     // handle spontaneous & synthetic key event for focusWindow
     void handleKeyEvent(QKeyEvent &e);
+    void startKeyRepeat(const QKeyEvent &press, int delay, int rate);
+    void stopKeyRepeat();
+    void sendRepeatKey(uint32_t timestamp);
 
     W_DECLARE_PUBLIC(WSeat)
 
@@ -348,6 +349,8 @@ public:
     QPointer<WSeatEventFilter> eventFilter;
     QPointer<QWindow> focusWindow;
     QPointer<QObject> pointerFocusEventObject;
+    // Set while sendEventToSubsurfaceTree is delivering an event
+    bool eventObjectCoversSubsurfaces = false;
     QPointer<WSurface> m_keyboardFocusSurface;
     QMetaObject::Connection onEventObjectDestroy;
     wlr_surface *oldPointerFocusSurface = nullptr;
@@ -409,8 +412,14 @@ public:
     };
 
     // for keyboard event
-    QTimer m_repeatTimer;
+    std::unique_ptr<WKeyRepeat> m_keyRepeat;
+    // Reused by every repeat of the key
     std::unique_ptr<QKeyEvent> m_repeatKey;
+    std::unique_ptr<QKeyEvent> m_repeatKeyRelease;
+    bool shortcutPreFilter = false;
+    QSet<quint64> shortcuts;
+    // The keys whose press is sent without Qt, their release must go the same way
+    QVarLengthArray<uint32_t, 8> directKeys;
 
     // for cursor data
     // TODO: make to QWSeatClient in wlroots
@@ -517,9 +526,81 @@ void WSeatPrivate::handleKeyEvent(QKeyEvent &e)
     }
     QCoreApplication::sendEvent(focusWindow, &e);
 }
+
+void WSeatPrivate::startKeyRepeat(const QKeyEvent &press, int delay, int rate)
+{
+    if (!m_keyRepeat || rate <= 0) {
+        stopKeyRepeat();
+        return;
+    }
+
+    m_repeatKey = std::make_unique<QKeyEvent>(QEvent::KeyPress, press.key(), press.modifiers(),
+        press.nativeScanCode(), press.nativeVirtualKey(), press.nativeModifiers(),
+        press.text(), true, press.count(), press.device());
+    m_repeatKeyRelease = std::make_unique<QKeyEvent>(QEvent::KeyRelease, press.key(), press.modifiers(),
+        press.nativeScanCode(), press.nativeVirtualKey(), press.nativeModifiers(),
+        press.text(), true, press.count(), press.device());
+    m_keyRepeat->start(delay, rate);
+}
+
+void WSeatPrivate::stopKeyRepeat()
+{
+    if (m_keyRepeat)
+        m_keyRepeat->stop();
+    m_repeatKey.reset();
+    m_repeatKeyRelease.reset();
+}
+
+void WSeatPrivate::sendRepeatKey(uint32_t timestamp)
+{
+    Q_ASSERT(m_repeatKey && m_repeatKeyRelease);
+    if (!focusWindow)
+        return;
+
+    m_repeatKey->setTimestamp(timestamp);
+    m_repeatKey->setAccepted(true);
+    handleKeyEvent(*m_repeatKey);
+    // The press may change the focus window
+    if (!focusWindow || !m_repeatKeyRelease)
+        return;
+    m_repeatKeyRelease->setTimestamp(timestamp);
+    m_repeatKeyRelease->setAccepted(true);
+    handleKeyEvent(*m_repeatKeyRelease);
+}
+
+bool WSeatPrivate::tryNotifyKeyDirectly(wlr_keyboard_key_event *event, WInputDevice *device, qw_keyboard *keyboard)
+{
+    if (event->state == WL_KEYBOARD_KEY_STATE_RELEASED) {
+        if (!directKeys.removeOne(event->keycode))
+            return false;
+        doNotifyKey(device, event->keycode, event->state, event->time_msec);
+        return true;
+    }
+
+    if (!shortcutPreFilter || !keyboardFocusSurface())
+        return false;
+    if (eventFilter && eventFilter->filterKeyEvents())
+        return false;
+
+    auto code = event->keycode + 8;
+    xkb_keysym_t sym = xkb_state_key_get_one_sym(keyboard->handle()->xkb_state, code);
+    if (shortcuts.contains(shortcutKey(sym, keyModifiers)))
+        return false;
+
+    // Same as a new key press in Qt's path, it stops the repeat of the last key
+    if (m_repeatKey)
+        stopKeyRepeat();
+    if (!directKeys.contains(event->keycode))
+        directKeys.append(event->keycode);
+    doNotifyKey(device, event->keycode, event->state, event->time_msec);
+    return true;
+}
+
 void WSeatPrivate::on_keyboard_key(wlr_keyboard_key_event *event, WInputDevice *device)
 {
     auto keyboard = qobject_cast<qw_keyboard*>(device->handle());
+    if (tryNotifyKeyDirectly(event, device, keyboard))
+        return;
 
     auto code = event->keycode + 8; // map to wl_keyboard::keymap_format::keymap_format_xkb_v1
     auto et = event->state == WL_KEYBOARD_KEY_STATE_PRESSED ? QEvent::KeyPress : QEvent::KeyRelease;
@@ -534,17 +615,10 @@ void WSeatPrivate::on_keyboard_key(wlr_keyboard_key_event *event, WInputDevice *
     if (focusWindow) {
         handleKeyEvent(e);
         if (et == QEvent::KeyPress && xkb_keymap_key_repeats(keyboard->handle()->keymap, code)) {
-            if (m_repeatKey) {
-                m_repeatTimer.stop();
-            }
-            m_repeatKey = std::make_unique<QKeyEvent>(et, qtkey, keyModifiers, code, event->keycode, keyboard->get_modifiers(),
-                text, false, 1, device->qtDevice());
-            m_repeatKey->setTimestamp(event->time_msec);
-            m_repeatTimer.setInterval(keyboard->handle()->repeat_info.delay);
-            m_repeatTimer.start();
+            const auto &info = keyboard->handle()->repeat_info;
+            startKeyRepeat(e, info.delay, info.rate);
         } else if (et == QEvent::KeyRelease && m_repeatKey && m_repeatKey->nativeScanCode() == code) {
-            m_repeatTimer.stop();
-            m_repeatKey.reset();
+            stopKeyRepeat();
         }
     } else {
         if (et == QEvent::KeyPress && qt_sendShortcutOverrideEvent((QObject*)qGuiApp,
@@ -810,6 +884,20 @@ inline static WSeat *getSeat(QInputEvent *event)
     return inputDevice->seat();
 }
 
+bool WSeat::sendEventToSubsurfaceTree(WSurface *target, QObject *shellObject, QObject *eventObject, QInputEvent *event)
+{
+    auto inputDevice = WInputDevice::from(event->device());
+    if (Q_UNLIKELY(!inputDevice))
+        return false;
+
+    auto d = inputDevice->seat()->d_func();
+    const bool oldCovers = std::exchange(d->eventObjectCoversSubsurfaces, true);
+    const bool ok = sendEvent(target, shellObject, eventObject, event);
+    d->eventObjectCoversSubsurfaces = oldCovers;
+
+    return ok;
+}
+
 bool WSeat::sendEvent(WSurface *target, QObject *shellObject, QObject *eventObject, QInputEvent *event)
 {
     auto inputDevice = WInputDevice::from(event->device());
@@ -1395,8 +1483,15 @@ void WSeat::notifyTouchCancel(WCursor *cursor, WInputDevice *device, int32_t tou
         << ", discard the following state: " << state->m_points;
 
     if (cursor->eventWindow()) {
-        QWindowSystemInterface::handleTouchCancelEvent(cursor->eventWindow(), time_msec, qwDevice, d->keyModifiers);
+        QWindowSystemInterface::handleTouchCancelEvent<QWindowSystemInterface::SynchronousDelivery>(
+            cursor->eventWindow(), time_msec, qwDevice, d->keyModifiers);
     }
+
+    // The wl_touch cancel is sent in the delivery if the points are on a surface,
+    // the remaining points can't be handled by the next frame
+    state->m_points.removeIf([] (const QWindowSystemInterface::TouchPoint &point) {
+        return point.state == static_cast<QEventPoint::State>(WEvent::PointCancelled);
+    });
 }
 
 void WSeat::notifyTouchFrame(WCursor *cursor)
@@ -1428,6 +1523,45 @@ WSeatEventFilter *WSeat::eventFilter() const
     return d->eventFilter.data();
 }
 
+bool WSeat::shortcutPreFilter() const
+{
+    W_DC(WSeat);
+    return d->shortcutPreFilter;
+}
+
+void WSeat::setShortcutPreFilter(bool on)
+{
+    W_D(WSeat);
+    if (d->shortcutPreFilter == on)
+        return;
+    d->shortcutPreFilter = on;
+    Q_EMIT shortcutPreFilterChanged();
+}
+
+void WSeat::addShortcut(uint32_t keysym, Qt::KeyboardModifiers modifiers)
+{
+    W_D(WSeat);
+    d->shortcuts.insert(WSeatPrivate::shortcutKey(keysym, modifiers));
+}
+
+void WSeat::removeShortcut(uint32_t keysym, Qt::KeyboardModifiers modifiers)
+{
+    W_D(WSeat);
+    d->shortcuts.remove(WSeatPrivate::shortcutKey(keysym, modifiers));
+}
+
+bool WSeat::hasShortcut(uint32_t keysym, Qt::KeyboardModifiers modifiers) const
+{
+    W_DC(WSeat);
+    return d->shortcuts.contains(WSeatPrivate::shortcutKey(keysym, modifiers));
+}
+
+void WSeat::clearShortcuts()
+{
+    W_D(WSeat);
+    d->shortcuts.clear();
+}
+
 void WSeat::setEventFilter(WSeatEventFilter *filter)
 {
     W_D(WSeat);
@@ -1452,6 +1586,10 @@ void WSeat::create(WServer *server)
             d->cursor->attachInputDevice(i);
     }
 
+    d->m_keyRepeat = std::make_unique<WKeyRepeat>(server->handle()->get_event_loop(), [d] (uint32_t timestamp) {
+        d->sendRepeatKey(timestamp);
+    });
+
     if (!qEnvironmentVariableIsSet("WAYLIB_DISABLE_GESTURE"))
         d->gesture = qw_pointer_gestures_v1::create(*server->handle());
 
@@ -1469,6 +1607,9 @@ void WSeat::destroy(WServer *)
 {
     W_D(WSeat);
 
+    d->stopKeyRepeat();
+    d->m_keyRepeat.reset();
+
     for (auto i : std::as_const(d->deviceList)) {
         i->setSeat(nullptr);
     }
@@ -1631,6 +1772,16 @@ WSeatEventFilter::WSeatEventFilter(QObject *parent)
 
 }
 
+bool WSeatEventFilter::filterKeyEvents() const
+{
+    return m_filterKeyEvents;
+}
+
+void WSeatEventFilter::setFilterKeyEvents(bool on)
+{
+    m_filterKeyEvents = on;
+}
+
 bool WSeatEventFilter::beforeHandleEvent(WSeat *, WSurface *, QObject *,
                                          QObject *, QInputEvent *)
 {
@@ -42,6 +42,11 @@ class WAYLIB_SERVER_EXPORT WSeatEventFilter : public QObject
 public:
     explicit WSeatEventFilter(QObject *parent = nullptr);
 
+    // If false, the key events which don't match any shortcut of WSeat
+    // can bypass this filter, see WSeat::shortcutPreFilter
+    bool filterKeyEvents() const;
+    void setFilterKeyEvents(bool on);
+
 protected:
     virtual bool beforeHandleEvent(WSeat *seat, WSurface *watched, QObject *shellObject,
                                         QObject *eventObject, QInputEvent *event);
@@ -49,6 +54,9 @@ protected:
                                        QObject *eventObject, QInputEvent *event);
     virtual bool beforeDisposeEvent(WSeat *seat, QWindow *watched, QInputEvent *event);
     virtual bool unacceptedEvent(WSeat *seat, QWindow *watched, QInputEvent *event);
+
+private:
+    bool m_filterKeyEvents = true;
 };
 
 class WCursor;
@@ -60,6 +68,7 @@ class WAYLIB_SERVER_EXPORT WSeat : public WWrapObject, public WServerInterface
     Q_PROPERTY(WInputDevice* keyboard READ keyboard WRITE setKeyboard NOTIFY keyboardChanged FINAL)
     Q_PROPERTY(WSurface* keyboardFocus READ keyboardFocusSurface WRITE setKeyboardFocusSurface NOTIFY keyboardFocusSurfaceChanged FINAL)
     Q_PROPERTY(bool alwaysUpdateHoverTarget READ alwaysUpdateHoverTarget WRITE setAlwaysUpdateHoverTarget NOTIFY alwaysUpdateHoverTargetChanged FINAL)
+    Q_PROPERTY(bool shortcutPreFilter READ shortcutPreFilter WRITE setShortcutPreFilter NOTIFY shortcutPreFilterChanged FINAL)
 
 public:
     WSeat(const QString &name = QStringLiteral("seat0"));
@@ -84,6 +93,9 @@ public:
 
     // WSurfaceItem is a kind of shellObject
     static bool sendEvent(WSurface *target, QObject *shellObject, QObject *eventObject, QInputEvent *event);
+    // The eventObject covers the whole subsurface tree of the target, such as a
+    // WSurfaceItem which flattens its subsurfaces, the target is any surface of it.
+    static bool sendEventToSubsurfaceTree(WSurface *target, QObject *shellObject, QObject *eventObject, QInputEvent *event);
     static WSeat *get(QInputEvent *event);
 
     WSeatEventFilter *eventFilter() const;
@@ -105,6 +117,17 @@ public:
     bool alwaysUpdateHoverTarget() const;
     void setAlwaysUpdateHoverTarget(bool newIgnoreSurfacePointerEventExclusiveGrabber);
 
+    // If enabled, the keys which don't match any registered shortcut are sent to
+    // the keyboard focus surface directly, without QKeyEvent and Qt's shortcut map
+    bool shortcutPreFilter() const;
+    void setShortcutPreFilter(bool on);
+    // The keysym is matched case insensitively, and only Shift, Control, Alt
+    // and Meta of the modifiers are compared
+    void addShortcut(uint32_t keysym, Qt::KeyboardModifiers modifiers);
+    void removeShortcut(uint32_t keysym, Qt::KeyboardModifiers modifiers);
+    bool hasShortcut(uint32_t keysym, Qt::KeyboardModifiers modifiers) const;
+    void clearShortcuts();
+
 Q_SIGNALS:
     void keyboardChanged();
     void keyboardFocusSurfaceChanged();
@@ -112,6 +135,7 @@ Q_SIGNALS:
     void requestCursorSurface(WAYLIB_SERVER_NAMESPACE::WSurface *surface, const QPoint &hotspot);
     void requestDrag(WAYLIB_SERVER_NAMESPACE::WSurface *surface);
     void alwaysUpdateHoverTargetChanged();
+    void shortcutPreFilterChanged();
 
 protected:
     using QObject::eventFilter;
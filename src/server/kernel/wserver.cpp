@@ -9,6 +9,7 @@
 
 #include "wserver.h"
 #include "private/wserver_p.h"
+#include "private/wprotocoltrace_p.h"
 #include "wsurface.h"
 #include "wsocket.h"
 #include "platformplugin/qwlrootsintegration.h"
@@ -120,6 +121,10 @@ void WServerPrivate::init()
     for (auto socket : std::as_const(sockets))
         initSocket(socket);
 
+    const QString traceFile = qEnvironmentVariable("WAYLIB_PROTOCOL_TRACE");
+    if (!traceFile.isEmpty() && !recorder)
+        q->startRecording(traceFile);
+
     Q_EMIT q->started();
 }
 
@@ -129,6 +134,7 @@ void WServerPrivate::stop()
 
     if (display)
         wl_display_destroy_clients(*display);
+    recorder.reset();
 
     auto list = interfaceList;
     interfaceList.clear();
@@ -382,4 +388,29 @@ void WServer::setGlobalFilter(GlobalFilterFunc filter, void *data)
     d->globalFilterFuncData = data;
 }
 
+bool WServer::startRecording(const QString &fileName)
+{
+    W_D(WServer);
+    Q_ASSERT(d->display);
+
+    std::unique_ptr<WProtocolRecorder> recorder(new WProtocolRecorder(d->display->handle()));
+    if (!recorder->open(fileName))
+        return false;
+
+    d->recorder = std::move(recorder);
+    return true;
+}
+
+void WServer::stopRecording()
+{
+    W_D(WServer);
+    d->recorder.reset();
+}
+
+bool WServer::isRecording() const
+{
+    W_DC(WServer);
+    return d->recorder.get();
+}
+
 WAYLIB_SERVER_END_NAMESPACE
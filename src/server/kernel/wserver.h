@@ -145,6 +145,12 @@ public:
 
     void setGlobalFilter(GlobalFilterFunc filter, void *data);
 
+    // Record the requests of all clients to the file for replaying them later, it's
+    // also started by the environment variable WAYLIB_PROTOCOL_TRACE=<file name>.
+    bool startRecording(const QString &fileName);
+    void stopRecording();
+    bool isRecording() const;
+
 Q_SIGNALS:
     void started();
 
@@ -2,14 +2,20 @@
 // SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
 
 #include "wsocket.h"
+#include "wsurface.h"
 #include "private/wglobal_p.h"
+#include "private/wsurface_p.h"
 
 #include <QDir>
 #include <QStandardPaths>
 #include <QStringDecoder>
 #include <QPointer>
+#include <QTimer>
+#include <QSet>
+#include <QLoggingCategory>
 
 #include <wayland-server-core.h>
+#include <wayland-server-protocol.h>
 
 #include <sys/fcntl.h>
 #include <sys/stat.h>
@@ -19,10 +25,14 @@
 #include <sys/un.h>
 #include <signal.h>
 
+#include <array>
+
 struct wl_event_source;
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcClient, "waylib.server.client", QtWarningMsg)
+
 #define LOCK_SUFFIX ".lock"
 
 // Copy from libwayland
@@ -220,6 +230,35 @@ void WSocketPrivate::addClient(WClient *client)
     Q_EMIT q->clientsChanged();
 }
 
+// Copy from wlroots, types/wlr_shm.c
+struct Q_DECL_HIDDEN way_shm_mapping {
+    void *data;
+    size_t size;
+    bool dropped;
+};
+
+struct Q_DECL_HIDDEN way_shm_pool {
+    struct wl_resource *resource; // may be NULL
+    struct wlr_shm *shm;
+    struct wl_list buffers; // wlr_shm_buffer.link
+    int fd;
+    struct way_shm_mapping *mapping;
+
+    struct wl_listener display_destroy;
+};
+
+class WClientPrivate;
+struct Q_DECL_HIDDEN WlShmPoolListener {
+    wl_listener destroy;
+    WClientPrivate *client;
+    wl_resource *resource;
+};
+
+struct Q_DECL_HIDDEN WlResourceCreatedListener {
+    wl_listener created;
+    WClientPrivate *client;
+};
+
 class Q_DECL_HIDDEN WClientPrivate : public WObjectPrivate
 {
 public:
@@ -230,9 +269,26 @@ public:
     {
         auto listener = new WlClientDestroyListener(qq);
         wl_client_add_destroy_listener(handle, &listener->destroy);
+
+        resourceCreated.client = this;
+        resourceCreated.created.notify = [] (wl_listener *listener, void *data) {
+            WlResourceCreatedListener *self = wl_container_of(listener, self, created);
+            self->client->addShmPool(static_cast<wl_resource*>(data));
+        };
+        wl_client_add_resource_created_listener(handle, &resourceCreated.created);
+        wl_client_for_each_resource(handle, [] (wl_resource *resource, void *data) {
+            static_cast<WClientPrivate*>(data)->addShmPool(resource);
+            return WL_ITERATOR_CONTINUE;
+        }, this);
     }
 
     ~WClientPrivate() {
+        wl_list_remove(&resourceCreated.created.link);
+        for (auto pool : std::as_const(shmPools)) {
+            wl_list_remove(&pool->destroy.link);
+            delete pool;
+        }
+
         if (pidFD >= 0)
             close(pidFD);
 
@@ -243,14 +299,180 @@ public:
         }
     }
 
+    void updateSuspendFreeze();
+    void checkResourceLimit(WClient::Resource resource);
+    void addShmPool(wl_resource *resource);
+    void removeShmPool(WlShmPoolListener *pool);
+    void setResourceThrottled(bool throttled);
+    void disconnectForResource();
+
     W_DECLARE_PUBLIC(WClient)
 
     wl_client *handle = nullptr;
     WSocket *socket = nullptr;
     mutable QSharedPointer<WClient::Credentials> credentials;
     mutable int pidFD = -1;
+
+    QHash<const WSurface*, bool> throttledSurfaces;
+    int suspendFreezeDelay = -1;
+    QTimer *suspendFreezeTimer = nullptr;
+    bool frozenBySuspend = false;
+
+    static constexpr int ResourceCount = int(WClient::Resource::PendingFrameCallbacks) + 1;
+    enum LimitLevel : quint8 {
+        UnderLimit,
+        OverSoftLimit,
+        OverHardLimit,
+    };
+
+    QSet<WSurface*> surfaces;
+    std::array<qint64, ResourceCount> usage = {};
+    std::array<qint64, ResourceCount> softLimits = {};
+    std::array<qint64, ResourceCount> hardLimits = {};
+    std::array<LimitLevel, ResourceCount> limitLevels = {};
+    WClient::LimitAction softLimitAction = WClient::LimitAction::Warn;
+    WClient::LimitAction hardLimitAction = WClient::LimitAction::Disconnect;
+    bool resourceThrottled = false;
+
+    WlResourceCreatedListener resourceCreated;
+    QList<WlShmPoolListener*> shmPools;
+    qint64 accountedShmPoolBytes = 0;
 };
 
+void WClientPrivate::updateSuspendFreeze()
+{
+    W_Q(WClient);
+
+    // A surface that was never throttled is rendering at the full rate
+    bool allSuspended = suspendFreezeDelay >= 0 && !surfaces.isEmpty();
+    for (auto surface : std::as_const(surfaces)) {
+        if (!throttledSurfaces.value(surface, false)) {
+            allSuspended = false;
+            break;
+        }
+    }
+
+    if (allSuspended) {
+        if (frozenBySuspend || (suspendFreezeTimer && suspendFreezeTimer->isActive()))
+            return;
+
+        if (!suspendFreezeTimer) {
+            suspendFreezeTimer = new QTimer(q);
+            suspendFreezeTimer->setSingleShot(true);
+            QObject::connect(suspendFreezeTimer, &QTimer::timeout, q, [this, q] {
+                // The socket will do it if it's disabled
+                if (!handle || !socket->isEnabled())
+                    return;
+                frozenBySuspend = true;
+                q->freeze();
+            });
+        }
+        suspendFreezeTimer->start(suspendFreezeDelay);
+        return;
+    }
+
+    if (suspendFreezeTimer)
+        suspendFreezeTimer->stop();
+    if (frozenBySuspend) {
+        frozenBySuspend = false;
+        if (handle && socket->isEnabled())
+            q->activate();
+    }
+}
+
+void WClientPrivate::checkResourceLimit(WClient::Resource resource)
+{
+    W_Q(WClient);
+
+    const int index = int(resource);
+    const qint64 value = usage[index];
+    LimitLevel level = UnderLimit;
+    if (hardLimits[index] > 0 && value > hardLimits[index])
+        level = OverHardLimit;
+    else if (softLimits[index] > 0 && value > softLimits[index])
+        level = OverSoftLimit;
+
+    const LimitLevel oldLevel = std::exchange(limitLevels[index], level);
+    if (level > oldLevel) {
+        const bool hard = level == OverHardLimit;
+        const auto action = hard ? hardLimitAction : softLimitAction;
+        qCWarning(qLcClient) << "Client" << q->credentials()->pid << "exceeds the"
+                             << (hard ? "hard" : "soft") << "limit of" << resource
+                             << ", usage:" << value << ", action:" << action;
+        Q_EMIT q->resourceLimitExceeded(resource, value, hard);
+
+        if (action == WClient::LimitAction::Throttle)
+            setResourceThrottled(true);
+        else if (action == WClient::LimitAction::Disconnect)
+            disconnectForResource();
+    } else if (level < oldLevel) {
+        bool needsThrottle = false;
+        for (int i = 0; i < ResourceCount; ++i) {
+            if ((limitLevels[i] == OverSoftLimit && softLimitAction == WClient::LimitAction::Throttle)
+                || (limitLevels[i] == OverHardLimit && hardLimitAction == WClient::LimitAction::Throttle)) {
+                needsThrottle = true;
+                break;
+            }
+        }
+        setResourceThrottled(needsThrottle);
+    }
+}
+
+void WClientPrivate::addShmPool(wl_resource *resource)
+{
+    if (qstrcmp(wl_resource_get_class(resource), wl_shm_pool_interface.name) != 0)
+        return;
+
+    auto pool = new WlShmPoolListener;
+    pool->client = this;
+    pool->resource = resource;
+    pool->destroy.notify = [] (wl_listener *listener, void *) {
+        WlShmPoolListener *self = wl_container_of(listener, self, destroy);
+        self->client->removeShmPool(self);
+    };
+    wl_resource_add_destroy_listener(resource, &pool->destroy);
+    shmPools.append(pool);
+
+    W_Q(WClient);
+    // The pool is bound to the resource after the resource is created
+    QMetaObject::invokeMethod(q, &WClient::updateShmPoolUsage, Qt::QueuedConnection);
+}
+
+void WClientPrivate::removeShmPool(WlShmPoolListener *pool)
+{
+    wl_list_remove(&pool->destroy.link);
+    bool ok = shmPools.removeOne(pool);
+    Q_ASSERT(ok);
+    delete pool;
+
+    W_Q(WClient);
+    q->updateShmPoolUsage();
+}
+
+void WClientPrivate::setResourceThrottled(bool throttled)
+{
+    if (resourceThrottled == throttled)
+        return;
+    resourceThrottled = throttled;
+
+    for (auto surface : std::as_const(surfaces))
+        static_cast<WSurfacePrivate*>(WObjectPrivate::get(surface))->updateFrameThrottle();
+
+    W_Q(WClient);
+    Q_EMIT q->resourceThrottledChanged();
+}
+
+void WClientPrivate::disconnectForResource()
+{
+    W_Q(WClient);
+
+    // Don't destroy the client in the middle of its requests
+    QMetaObject::invokeMethod(q, [q] {
+        if (auto handle = q->handle())
+            wl_client_destroy(handle);
+    }, Qt::QueuedConnection);
+}
+
 void WlClientDestroyListener::handle_destroy(wl_listener *listener, void *data)
 {
     WlClientDestroyListener *self = wl_container_of(listener, self, destroy);
@@ -325,6 +547,129 @@ WClient *WClient::get(const wl_client *client)
     return nullptr;
 }
 
+int WClient::suspendFreezeDelay() const
+{
+    W_DC(WClient);
+    return d->suspendFreezeDelay;
+}
+
+void WClient::setSuspendFreezeDelay(int msecs)
+{
+    W_D(WClient);
+    if (d->suspendFreezeDelay == msecs)
+        return;
+    d->suspendFreezeDelay = msecs;
+    if (d->suspendFreezeTimer)
+        d->suspendFreezeTimer->stop();
+    d->updateSuspendFreeze();
+}
+
+qint64 WClient::resourceUsage(Resource resource) const
+{
+    W_DC(WClient);
+    return d->usage[int(resource)];
+}
+
+qint64 WClient::softResourceLimit(Resource resource) const
+{
+    W_DC(WClient);
+    return d->softLimits[int(resource)];
+}
+
+qint64 WClient::hardResourceLimit(Resource resource) const
+{
+    W_DC(WClient);
+    return d->hardLimits[int(resource)];
+}
+
+void WClient::setResourceLimit(Resource resource, qint64 softLimit, qint64 hardLimit)
+{
+    W_D(WClient);
+    d->softLimits[int(resource)] = softLimit;
+    d->hardLimits[int(resource)] = hardLimit;
+    d->checkResourceLimit(resource);
+}
+
+WClient::LimitAction WClient::softLimitAction() const
+{
+    W_DC(WClient);
+    return d->softLimitAction;
+}
+
+WClient::LimitAction WClient::hardLimitAction() const
+{
+    W_DC(WClient);
+    return d->hardLimitAction;
+}
+
+void WClient::setLimitActions(LimitAction softAction, LimitAction hardAction)
+{
+    W_D(WClient);
+    d->softLimitAction = softAction;
+    d->hardLimitAction = hardAction;
+}
+
+bool WClient::isResourceThrottled() const
+{
+    W_DC(WClient);
+    return d->resourceThrottled;
+}
+
+void WClient::addSurface(WSurface *surface)
+{
+    W_D(WClient);
+    Q_ASSERT(!d->surfaces.contains(surface));
+    d->surfaces.insert(surface);
+    d->updateSuspendFreeze();
+    addResourceUsage(Resource::Surfaces, 1);
+}
+
+void WClient::removeSurface(WSurface *surface)
+{
+    W_D(WClient);
+    if (!d->surfaces.remove(surface))
+        return;
+    d->throttledSurfaces.remove(surface);
+    d->updateSuspendFreeze();
+    addResourceUsage(Resource::Surfaces, -1);
+}
+
+void WClient::addResourceUsage(Resource resource, qint64 delta)
+{
+    W_D(WClient);
+    if (delta == 0)
+        return;
+
+    auto &value = d->usage[int(resource)];
+    value += delta;
+    Q_ASSERT(value >= 0);
+
+    Q_EMIT resourceUsageChanged(resource, value);
+    d->checkResourceLimit(resource);
+}
+
+// The pools can be resized by the client at any time, it's called on every buffer commit
+void WClient::updateShmPoolUsage()
+{
+    W_D(WClient);
+
+    qint64 bytes = 0;
+    for (auto pool : std::as_const(d->shmPools)) {
+        auto data = static_cast<way_shm_pool*>(wl_resource_get_user_data(pool->resource));
+        if (data && data->mapping)
+            bytes += data->mapping->size;
+    }
+
+    addResourceUsage(Resource::ShmPoolBytes, bytes - std::exchange(d->accountedShmPoolBytes, bytes));
+}
+
+void WClient::setSurfaceSuspended(const WSurface *surface, bool suspended)
+{
+    W_D(WClient);
+    d->throttledSurfaces[surface] = suspended;
+    d->updateSuspendFreeze();
+}
+
 void WClient::freeze()
 {
     W_D(WClient);
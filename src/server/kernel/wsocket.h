@@ -14,6 +14,7 @@ struct wl_client;
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
 class WSocket;
+class WSurface;
 class WClientPrivate;
 class WAYLIB_SERVER_EXPORT WClient : public QObject, public WObject
 {
@@ -23,6 +24,27 @@ class WAYLIB_SERVER_EXPORT WClient : public QObject, public WObject
     QML_ANONYMOUS
 
 public:
+    enum class Resource {
+        // The buffers locked by the surfaces, or kept for them by the compositor
+        BufferBytes,
+        // The memory of the wl_shm_pool objects
+        ShmPoolBytes,
+        // The textures uploaded from the buffers
+        TextureBytes,
+        Surfaces,
+        Subsurfaces,
+        PendingFrameCallbacks,
+    };
+    Q_ENUM(Resource)
+
+    enum class LimitAction {
+        Warn,
+        // Reduce the frame callbacks of all surfaces of the client
+        Throttle,
+        Disconnect,
+    };
+    Q_ENUM(LimitAction)
+
     WSocket *socket() const;
     wl_client *handle() const;
 
@@ -38,13 +60,41 @@ public:
     [[nodiscard]] static QSharedPointer<Credentials> getCredentials(const wl_client *client);
     static WClient *get(const wl_client *client);
 
+    // Freeze the client after all its throttled surfaces are suspended for msecs,
+    // it's disabled if msecs is negative
+    int suspendFreezeDelay() const;
+    void setSuspendFreezeDelay(int msecs);
+
+    qint64 resourceUsage(Resource resource) const;
+    qint64 softResourceLimit(Resource resource) const;
+    qint64 hardResourceLimit(Resource resource) const;
+    // The limit isn't applied if it's not positive
+    void setResourceLimit(Resource resource, qint64 softLimit, qint64 hardLimit);
+    LimitAction softLimitAction() const;
+    LimitAction hardLimitAction() const;
+    void setLimitActions(LimitAction softAction, LimitAction hardAction);
+    bool isResourceThrottled() const;
+
 public Q_SLOTS:
     void freeze();
     void activate();
 
+Q_SIGNALS:
+    void resourceUsageChanged(WAYLIB_SERVER_NAMESPACE::WClient::Resource resource, qint64 usage);
+    void resourceLimitExceeded(WAYLIB_SERVER_NAMESPACE::WClient::Resource resource, qint64 usage, bool hardLimit);
+    void resourceThrottledChanged();
+
 private:
     friend class WSocket;
     friend class WlClientDestroyListener;
+    friend class WSurfacePrivate;
+
+    void addSurface(WSurface *surface);
+    void removeSurface(WSurface *surface);
+    void setSurfaceSuspended(const WSurface *surface, bool suspended);
+    void addResourceUsage(Resource resource, qint64 delta);
+    void updateShmPoolUsage();
+
     explicit WClient(wl_client *client, WSocket *socket);
     ~WClient() = default;
     using QObject::deleteLater;
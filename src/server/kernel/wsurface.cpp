@@ -6,6 +6,7 @@
 #include "wseat.h"
 #include "private/wsurface_p.h"
 #include "woutput.h"
+#include "wsocket.h"
 
 #include <qwoutput.h>
 #include <qwcompositor.h>
@@ -14,11 +15,15 @@
 #include <qwbuffer.h>
 #include <qwfractionalscalemanagerv1.h>
 #include <QDebug>
+#include <QTimer>
+#include <QVarLengthArray>
 
 extern "C" {
 #include <wlr/util/edges.h>
 }
 
+#include <unistd.h>
+
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
@@ -52,6 +57,15 @@ void WSurfacePrivate::on_commit()
 
     if (hasSubsurface) // Will make to true when qw_surface::newSubsurface
         updateHasSubsurface();
+
+    updateFrameCallbackUsage();
+}
+
+void WSurfacePrivate::on_client_commit()
+{
+    // Count the new buffer before it's applied or cached
+    if (nativeHandle()->pending.committed & WLR_SURFACE_STATE_BUFFER)
+        updateBufferUsage();
 }
 
 void WSurfacePrivate::init()
@@ -59,6 +73,10 @@ void WSurfacePrivate::init()
     W_Q(WSurface);
     handle()->set_data(this, q);
 
+    client = WClient::get(waylandClient());
+    if (client)
+        client->addSurface(q);
+
     connect();
     updateBuffer();
     updateHasSubsurface();
@@ -84,6 +102,9 @@ void WSurfacePrivate::connect()
     QObject::connect(handle(), &qw_surface::notify_commit, q, [this] {
         on_commit();
     });
+    QObject::connect(handle(), &qw_surface::notify_client_commit, q, [this] {
+        on_client_commit();
+    });
     QObject::connect(handle(), &qw_surface::notify_map, q, &WSurface::mappedChanged);
     QObject::connect(handle(), &qw_surface::notify_unmap, q, &WSurface::mappedChanged);
     QObject::connect(handle(), &qw_surface::notify_new_subsurface, q, [q, this] (wlr_subsurface *sub) {
@@ -144,6 +165,90 @@ void WSurfacePrivate::updateBuffer()
         buffer = qw_buffer::from(&nativeHandle()->buffer->base);
 
     setBuffer(buffer);
+    updateBufferUsage();
+}
+
+void WSurfacePrivate::accountResource(WClient::Resource resource, qint64 &accounted, qint64 usage)
+{
+    if (!client || accounted == usage)
+        return;
+    const qint64 delta = usage - std::exchange(accounted, usage);
+    client->addResourceUsage(resource, delta);
+}
+
+static qint64 bufferBytes(wlr_buffer *buffer)
+{
+    wlr_shm_attributes shm;
+    if (wlr_buffer_get_shm(buffer, &shm))
+        return qint64(shm.stride) * shm.height;
+
+    wlr_dmabuf_attributes dmabuf;
+    if (wlr_buffer_get_dmabuf(buffer, &dmabuf)) {
+        qint64 bytes = 0;
+        for (int i = 0; i < dmabuf.n_planes; ++i) {
+            // The planes of most formats are in the same dmabuf
+            bool counted = false;
+            for (int j = 0; j < i && !counted; ++j)
+                counted = dmabuf.fd[j] == dmabuf.fd[i];
+            if (counted)
+                continue;
+
+            // The real size of the allocation, the planes may be subsampled or padded
+            const off_t size = lseek(dmabuf.fd[i], 0, SEEK_END);
+            bytes += size > 0 ? size : qint64(dmabuf.stride[i]) * dmabuf.height;
+        }
+        return bytes;
+    }
+
+    return qint64(buffer->width) * buffer->height * 4;
+}
+
+void WSurfacePrivate::updateBufferUsage()
+{
+    if (!client || !handle())
+        return;
+
+    QVarLengthArray<wlr_buffer*, 4> buffers;
+    auto addBuffer = [&buffers] (wlr_buffer *buffer) {
+        // Don't count a client buffer and the buffer it's created from twice
+        if (auto clientBuffer = buffer ? wlr_client_buffer_get(buffer) : nullptr) {
+            if (clientBuffer->source)
+                buffer = clientBuffer->source;
+        }
+        if (buffer && !buffers.contains(buffer))
+            buffers.append(buffer);
+    };
+
+    if (buffer)
+        addBuffer(buffer->handle());
+    addBuffer(nativeHandle()->pending.buffer);
+    // Committed but not applied yet, e.g. for the synchronized subsurfaces
+    wlr_surface_state *cached;
+    wl_list_for_each(cached, &nativeHandle()->cached, cached_state_link)
+        addBuffer(cached->buffer);
+    for (const auto &held : std::as_const(heldBuffers)) {
+        for (auto buffer : held.buffers)
+            addBuffer(buffer);
+    }
+
+    qint64 bytes = 0;
+    for (auto buffer : std::as_const(buffers))
+        bytes += bufferBytes(buffer);
+    accountResource(WClient::Resource::BufferBytes, accountedBufferBytes, bytes);
+    client->updateShmPoolUsage();
+
+    qint64 textureBytes = 0;
+    if (auto texture = handle()->get_texture())
+        textureBytes = qint64(texture->width) * texture->height * 4;
+    accountResource(WClient::Resource::TextureBytes, accountedTextureBytes, textureBytes);
+}
+
+void WSurfacePrivate::updateFrameCallbackUsage()
+{
+    if (!client)
+        return;
+    const int count = wl_list_length(&nativeHandle()->current.frame_callback_list);
+    accountResource(WClient::Resource::PendingFrameCallbacks, accountedFrameCallbacks, count);
 }
 
 void WSurfacePrivate::updateBufferOffset()
@@ -179,6 +284,56 @@ void WSurfacePrivate::preferredBufferScaleChange()
     Q_EMIT q->preferredBufferScaleChanged();
 }
 
+void WSurfacePrivate::sendFrameDone()
+{
+    /* This lets the client know that we've displayed that frame and it can
+    * prepare another one now if it likes. */
+    struct timespec now;
+    clock_gettime(CLOCK_MONOTONIC, &now);
+    wlr_surface_send_frame_done(nativeHandle(), &now);
+    updateFrameCallbackUsage();
+}
+
+void WSurfacePrivate::updateFrameThrottle()
+{
+    W_Q(WSurface);
+
+    auto newThrottle = WSurface::FrameThrottle::FullRate;
+    if (!frameThrottleRequests.isEmpty()) {
+        newThrottle = WSurface::FrameThrottle::Suspended;
+        for (const auto &request : std::as_const(frameThrottleRequests))
+            newThrottle = std::min(newThrottle, request.throttle);
+    }
+    // The client is using too much resources
+    if (client && client->isResourceThrottled())
+        newThrottle = std::max(newThrottle, WSurface::FrameThrottle::Reduced);
+
+    if (frameThrottle == newThrottle)
+        return;
+    frameThrottle = newThrottle;
+
+    if (frameThrottle == WSurface::FrameThrottle::Reduced) {
+        if (!reducedFrameTimer) {
+            reducedFrameTimer = new QTimer(q);
+            QObject::connect(reducedFrameTimer, &QTimer::timeout, q, [this] {
+                sendFrameDone();
+            });
+        }
+        reducedFrameTimer->start(reducedFrameInterval);
+    } else if (reducedFrameTimer) {
+        reducedFrameTimer->stop();
+    }
+
+    // Don't let the client wait for the next rendering to draw again
+    if (frameThrottle == WSurface::FrameThrottle::FullRate)
+        sendFrameDone();
+
+    if (client)
+        client->setSurfaceSuspended(q, frameThrottle == WSurface::FrameThrottle::Suspended);
+
+    Q_EMIT q->frameThrottleChanged();
+}
+
 WSurface *WSurfacePrivate::ensureSubsurface(wlr_subsurface *subsurface)
 {
     if (auto surface = WSurface::fromHandle(subsurface->surface))
@@ -201,6 +356,7 @@ void WSurfacePrivate::setSubsurface(qw_subsurface *newSubsurface)
 
     if (isSubsurface != !subsurface.isNull()){
         isSubsurface = !subsurface.isNull();
+        accountResource(WClient::Resource::Subsurfaces, accountedSubsurface, isSubsurface ? 1 : 0);
         Q_EMIT q->isSubsurfaceChanged();
     }
 }
@@ -302,11 +458,10 @@ qw_buffer *WSurface::buffer() const
 void WSurface::notifyFrameDone()
 {
     W_D(WSurface);
-    /* This lets the client know that we've displayed that frame and it can
-    * prepare another one now if it likes. */
-    struct timespec now;
-    clock_gettime(CLOCK_MONOTONIC, &now);
-    wlr_surface_send_frame_done(d->nativeHandle(), &now);
+    // The throttled surfaces aren't driven by the rendering
+    if (d->frameThrottle != FrameThrottle::FullRate)
+        return;
+    d->sendFrameDone();
 }
 
 void WSurface::enterOutput(WOutput *output)
@@ -425,6 +580,100 @@ void WSurface::resetPreferredBufferScale()
     setPreferredBufferScale(0);
 }
 
+WSurface::FrameThrottle WSurface::frameThrottle() const
+{
+    W_DC(WSurface);
+    return d->frameThrottle;
+}
+
+void WSurface::requestFrameThrottle(const QObject *requester, FrameThrottle throttle)
+{
+    W_D(WSurface);
+    Q_ASSERT(requester);
+    if (isInvalidated())
+        return;
+
+    auto it = d->frameThrottleRequests.find(requester);
+    if (it != d->frameThrottleRequests.end()) {
+        if (it->throttle == throttle)
+            return;
+        it->throttle = throttle;
+    } else {
+        auto connection = connect(requester, &QObject::destroyed, this, [this, requester] {
+            removeFrameThrottleRequest(requester);
+        });
+        d->frameThrottleRequests.insert(requester, { throttle, connection });
+    }
+
+    d->updateFrameThrottle();
+}
+
+void WSurface::removeFrameThrottleRequest(const QObject *requester)
+{
+    W_D(WSurface);
+
+    auto it = d->frameThrottleRequests.find(requester);
+    if (it == d->frameThrottleRequests.end())
+        return;
+    disconnect(it->destroyConnection);
+    d->frameThrottleRequests.erase(it);
+
+    d->updateFrameThrottle();
+}
+
+void WSurface::setHeldBuffers(const QObject *holder, const QList<qw_buffer*> &buffers)
+{
+    W_D(WSurface);
+    Q_ASSERT(holder);
+    if (isInvalidated())
+        return;
+
+    QList<wlr_buffer*> list;
+    for (auto buffer : buffers) {
+        if (buffer)
+            list.append(buffer->handle());
+    }
+
+    auto it = d->heldBuffers.find(holder);
+    if (list.isEmpty()) {
+        if (it == d->heldBuffers.end())
+            return;
+        disconnect(it->destroyConnection);
+        d->heldBuffers.erase(it);
+    } else if (it != d->heldBuffers.end()) {
+        if (it->buffers == list)
+            return;
+        it->buffers = list;
+    } else {
+        auto connection = connect(holder, &QObject::destroyed, this, [this, holder] {
+            setHeldBuffers(holder, {});
+        });
+        d->heldBuffers.insert(holder, { list, connection });
+    }
+
+    d->updateBufferUsage();
+}
+
+int WSurface::reducedFrameInterval() const
+{
+    W_DC(WSurface);
+    return d->reducedFrameInterval;
+}
+
+void WSurface::setReducedFrameInterval(int msecs)
+{
+    W_D(WSurface);
+    Q_ASSERT(msecs > 0);
+    if (d->reducedFrameInterval == msecs)
+        return;
+    d->reducedFrameInterval = msecs;
+
+    if (d->reducedFrameTimer && d->reducedFrameTimer->isActive())
+        d->reducedFrameTimer->start(msecs);
+
+    Q_EMIT reducedFrameIntervalChanged();
+}
+
 void WSurface::map()
 {
     W_D(WSurface);
@@ -440,6 +689,24 @@ void WSurface::unmap()
 void WSurfacePrivate::instantRelease()
 {
     W_Q(WSurface);
+    if (reducedFrameTimer)
+        reducedFrameTimer->stop();
+    for (const auto &request : std::as_const(frameThrottleRequests))
+        QObject::disconnect(request.destroyConnection);
+    frameThrottleRequests.clear();
+    for (const auto &held : std::as_const(heldBuffers))
+        QObject::disconnect(held.destroyConnection);
+    heldBuffers.clear();
+
+    if (client) {
+        accountResource(WClient::Resource::BufferBytes, accountedBufferBytes, 0);
+        accountResource(WClient::Resource::TextureBytes, accountedTextureBytes, 0);
+        accountResource(WClient::Resource::Subsurfaces, accountedSubsurface, 0);
+        accountResource(WClient::Resource::PendingFrameCallbacks, accountedFrameCallbacks, 0);
+        client->removeSurface(q);
+        client = nullptr;
+    }
+
     if (handle()) {
         handle()->set_data(nullptr, nullptr);
         handle()->disconnect(q);
@@ -32,10 +32,20 @@ class WAYLIB_SERVER_EXPORT WSurface : public WWrapObject
     Q_PROPERTY(bool hasSubsurface READ hasSubsurface NOTIFY hasSubsurfaceChanged)
     Q_PROPERTY(QList<WSurface*> subsurfaces READ subsurfaces NOTIFY newSubsurface)
     Q_PROPERTY(uint32_t preferredBufferScale READ preferredBufferScale WRITE setPreferredBufferScale RESET resetPreferredBufferScale NOTIFY preferredBufferScaleChanged FINAL)
+    Q_PROPERTY(FrameThrottle frameThrottle READ frameThrottle NOTIFY frameThrottleChanged FINAL)
+    Q_PROPERTY(int reducedFrameInterval READ reducedFrameInterval WRITE setReducedFrameInterval NOTIFY reducedFrameIntervalChanged FINAL)
     QML_NAMED_ELEMENT(WaylandSurface)
     QML_UNCREATABLE("Only create in C++")
 
 public:
+    enum class FrameThrottle {
+        FullRate,
+        // The frame callbacks are sent in reducedFrameInterval
+        Reduced,
+        Suspended,
+    };
+    Q_ENUM(FrameThrottle)
+
     explicit WSurface(QW_NAMESPACE::qw_surface *handle, QObject *parent = nullptr);
 
     QW_NAMESPACE::qw_surface *handle() const;
@@ -62,6 +72,17 @@ public:
     void setPreferredBufferScale(uint32_t newPreferredBufferScale);
     void resetPreferredBufferScale();
 
+    FrameThrottle frameThrottle() const;
+    // Use the least throttled one of all requests, FullRate if there is no request
+    void requestFrameThrottle(const QObject *requester, FrameThrottle throttle);
+    void removeFrameThrottleRequest(const QObject *requester);
+    // The buffers locked by the holder for this surface, e.g. the last frame kept by
+    // an item, they are counted to the client's BufferBytes like the current buffer
+    void setHeldBuffers(const QObject *holder, const QList<QW_NAMESPACE::qw_buffer*> &buffers);
+
+    int reducedFrameInterval() const;
+    void setReducedFrameInterval(int msecs);
+
 public Q_SLOTS:
     void enterOutput(WOutput *output);
     void leaveOutput(WOutput *output);
@@ -79,6 +100,8 @@ Q_SIGNALS:
     void hasSubsurfaceChanged();
     void newSubsurface(WSurface *subsurface);
     void preferredBufferScaleChanged();
+    void frameThrottleChanged();
+    void reducedFrameIntervalChanged();
     void outputEntered(WOutput *output);
     void outputLeave(WOutput *output);
 
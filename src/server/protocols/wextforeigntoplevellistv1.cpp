@@ -11,6 +11,7 @@
 #include <qwextforeigntoplevellistv1.h>
 
 #include <map>
+#include <utility>
 
 #define EXT_FOREIGN_TOPLEVEL_LIST_V1_VERSION 1
 
@@ -45,27 +46,62 @@ public:
         auto handle = qw_ext_foreign_toplevel_handle_v1::create(
             *q->nativeInterface<qw_ext_foreign_toplevel_list_v1>(), &state);
 
-        surface->safeConnect(&WToplevelSurface::titleChanged, handle, [this, handle, surface] {
-            updateState(surface, handle);
+        surface->safeConnect(&WToplevelSurface::titleChanged, handle, [this, surface] {
+            markDirty(surface);
         });
 
-        surface->safeConnect(&WToplevelSurface::appIdChanged, handle, [this, handle, surface] {
-            updateState(surface, handle);
+        surface->safeConnect(&WToplevelSurface::appIdChanged, handle, [this, surface] {
+            markDirty(surface);
         });
-        
+
         surfaces.insert({ surface, std::unique_ptr<qw_ext_foreign_toplevel_handle_v1>(handle) });
     }
 
     void remove(WToplevelSurface *surface)
     {
+        dirtySurfaces.remove(surface);
         surfaces.erase(surface);
     }
 
 private:
+    // Every update_state sends the whole state and a `done` event,
+    // so only send it once per event loop iteration.
+    void markDirty(WToplevelSurface *surface)
+    {
+        W_Q(WExtForeignToplevelListV1);
+
+        dirtySurfaces.insert(surface);
+        if (flushScheduled)
+            return;
+
+        flushScheduled = true;
+        QMetaObject::invokeMethod(q, [this] {
+            flush();
+        }, Qt::QueuedConnection);
+    }
+
+    void flush()
+    {
+        flushScheduled = false;
+        const auto dirty = std::exchange(dirtySurfaces, {});
+
+        for (auto surface : dirty) {
+            auto handle = surfaces.find(surface);
+            if (handle == surfaces.end())
+                continue;
+            updateState(surface, handle->second.get());
+        }
+    }
+
     void updateState(WToplevelSurface *surface, qw_ext_foreign_toplevel_handle_v1 *handle)
     {
         const auto title = surface->title().toUtf8();
         const auto appId = surface->appId().toLatin1();
+        if (qstrcmp(handle->handle()->title, title.constData()) == 0
+            && qstrcmp(handle->handle()->app_id, appId.constData()) == 0) {
+            return;
+        }
+
         wlr_ext_foreign_toplevel_handle_v1_state state = {
             .title = title.constData(),
             .app_id = appId.constData(),
@@ -76,6 +112,8 @@ private:
     W_DECLARE_PUBLIC(WExtForeignToplevelListV1)
 
     std::map<WToplevelSurface *, std::unique_ptr<qw_ext_foreign_toplevel_handle_v1>> surfaces;
+    QSet<WToplevelSurface *> dirtySurfaces;
+    bool flushScheduled = false;
 };
 
 WExtForeignToplevelListV1::WExtForeignToplevelListV1(QObject *parent)
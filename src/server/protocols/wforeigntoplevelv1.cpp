@@ -15,6 +15,7 @@
 #include <qwxdgshell.h>
 
 #include <map>
+#include <utility>
 
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
@@ -28,89 +29,66 @@ public:
     {
     }
 
+    enum Change {
+        Title = 1 << 0,
+        AppId = 1 << 1,
+        Minimized = 1 << 2,
+        Maximized = 1 << 3,
+        Fullscreen = 1 << 4,
+        Activated = 1 << 5,
+        Parent = 1 << 6,
+        Outputs = 1 << 7,
+        AllChanges = 0xff,
+    };
+    Q_DECLARE_FLAGS(Changes, Change)
+
     void initSurface(WToplevelSurface *surface)
     {
         W_Q(WForeignToplevel);
         auto handle = surfaces.at(surface).get();
-        surface->safeConnect(&WToplevelSurface::titleChanged, handle, [handle, surface] {
-            const auto title = surface->title().toUtf8();
-            handle->set_title(title);
+        surface->safeConnect(&WToplevelSurface::titleChanged, handle, [this, surface] {
+            markDirty(surface, Title);
         });
 
-        surface->safeConnect(&WToplevelSurface::appIdChanged, handle, [handle, surface] {
-            const auto appId = surface->appId().toLatin1();
-            handle->set_app_id(appId);
+        surface->safeConnect(&WToplevelSurface::appIdChanged, handle, [this, surface] {
+            markDirty(surface, AppId);
         });
 
-        surface->safeConnect(&WToplevelSurface::minimizeChanged, handle, [handle, surface] {
-            handle->set_minimized(surface->isMinimized());
+        surface->safeConnect(&WToplevelSurface::minimizeChanged, handle, [this, surface] {
+            markDirty(surface, Minimized);
         });
 
-        surface->safeConnect(&WToplevelSurface::maximizeChanged, handle, [handle, surface] {
-            handle->set_maximized(surface->isMaximized());
+        surface->safeConnect(&WToplevelSurface::maximizeChanged, handle, [this, surface] {
+            markDirty(surface, Maximized);
         });
 
-        surface->safeConnect(&WToplevelSurface::fullscreenChanged, handle, [handle, surface] {
-            handle->set_fullscreen(surface->isFullScreen());
+        surface->safeConnect(&WToplevelSurface::fullscreenChanged, handle, [this, surface] {
+            markDirty(surface, Fullscreen);
         });
 
-        surface->safeConnect(&WToplevelSurface::activateChanged, handle, [handle, surface] {
-            handle->set_activated(surface->isActivated());
+        surface->safeConnect(&WToplevelSurface::activateChanged, handle, [this, surface] {
+            markDirty(surface, Activated);
         });
 
         if (auto *xdgSurface = qobject_cast<WXdgToplevelSurface *>(surface)) {
-            auto updateSurfaceParent = [this, handle, xdgSurface] {
-                WToplevelSurface *p = xdgSurface->parentXdgSurface();
-                if (!p) {
-                    handle->set_parent(nullptr);
-                    return;
-                }
-                if (!surfaces.contains(p)) {
-                    qCCritical(qLcWlrForeignToplevel)
-                        << "Xdg toplevel surface " << xdgSurface
-                        << "has set parent surface, but foreign_toplevel_handle for parent surface "
-                           "not found!";
-                    return;
-                }
-                handle->set_parent(*surfaces.at(p));
-            };
             xdgSurface->safeConnect(&WXdgToplevelSurface::parentXdgSurfaceChanged,
-                                    handle,
-                                    updateSurfaceParent);
-            updateSurfaceParent();
+                                    handle, [this, surface] {
+                markDirty(surface, Parent);
+            });
         } else if (auto *xwaylandSurface = qobject_cast<WXWaylandSurface *>(surface)) {
-            auto updateSurfaceParent = [this, handle, xwaylandSurface] {
-                WToplevelSurface *p = xwaylandSurface->parentXWaylandSurface();
-                if (!p) {
-                    handle->set_parent(nullptr);
-                    return;
-                }
-                if (!surfaces.contains(p)) {
-                    qCCritical(qLcWlrForeignToplevel)
-                        << "X11 surface " << xwaylandSurface
-                        << "has set parent surface, but foreign_toplevel_handle for parent surface "
-                           "not found!";
-                    return;
-                }
-                handle->set_parent(*surfaces.at(p));
-            };
             xwaylandSurface->safeConnect(&WXWaylandSurface::parentXWaylandSurfaceChanged,
-                                         handle,
-                                         updateSurfaceParent);
-            updateSurfaceParent();
+                                         handle, [this, surface] {
+                markDirty(surface, Parent);
+            });
         }
 
-        surface->surface()->safeConnect(&WSurface::outputEntered,
-                                        handle,
-                                        [this, handle](WOutput *output) {
-                                            handle->output_enter(output->nativeHandle());
-                                        });
+        surface->surface()->safeConnect(&WSurface::outputEntered, handle, [this, surface] {
+            markDirty(surface, Outputs);
+        });
 
-        surface->surface()->safeConnect(&WSurface::outputLeave,
-                                        handle,
-                                        [this, handle](WOutput *output) {
-                                            handle->output_leave(output->nativeHandle());
-                                        });
+        surface->surface()->safeConnect(&WSurface::outputLeave, handle, [this, surface] {
+            markDirty(surface, Outputs);
+        });
 
         QObject::connect(handle,
                          &qw_foreign_toplevel_handle_v1::notify_request_activate,
@@ -156,14 +134,117 @@ public:
                                  QRect{ event->x, event->y, event->width, event->height });
                          });
 
-        const auto title = surface->title().toUtf8();
-        const auto appId = surface->appId().toLatin1();
-        handle->set_title(title);
-        handle->set_app_id(appId);
-        handle->set_minimized(surface->isMinimized());
-        handle->set_maximized(surface->isMaximized());
-        handle->set_fullscreen(surface->isFullScreen());
-        handle->set_activated(surface->isActivated());
+        applyChanges(surface, handle, AllChanges);
+    }
+
+    // Collect the changes, they are sent to the clients once per event loop
+    // iteration, so a batch of changes only produces one `done` event.
+    void markDirty(WToplevelSurface *surface, Changes changes)
+    {
+        W_Q(WForeignToplevel);
+
+        pendingChanges[surface] |= changes;
+        if (flushScheduled)
+            return;
+
+        flushScheduled = true;
+        QMetaObject::invokeMethod(q, [this] {
+            flush();
+        }, Qt::QueuedConnection);
+    }
+
+    void flush()
+    {
+        flushScheduled = false;
+        const auto pending = std::exchange(pendingChanges, {});
+
+        for (auto it = pending.cbegin(); it != pending.cend(); ++it) {
+            auto handle = surfaces.find(it.key());
+            if (handle == surfaces.end())
+                continue;
+            applyChanges(it.key(), handle->second.get(), it.value());
+        }
+    }
+
+    void applyChanges(WToplevelSurface *surface, qw_foreign_toplevel_handle_v1 *handle, Changes changes)
+    {
+        // wlroots doesn't skip the unchanged title and app id
+        if (changes.testFlag(Title)) {
+            const auto title = surface->title().toUtf8();
+            if (qstrcmp(handle->handle()->title, title.constData()) != 0)
+                handle->set_title(title);
+        }
+
+        if (changes.testFlag(AppId)) {
+            const auto appId = surface->appId().toLatin1();
+            if (qstrcmp(handle->handle()->app_id, appId.constData()) != 0)
+                handle->set_app_id(appId);
+        }
+
+        if (changes.testFlag(Minimized))
+            handle->set_minimized(surface->isMinimized());
+        if (changes.testFlag(Maximized))
+            handle->set_maximized(surface->isMaximized());
+        if (changes.testFlag(Fullscreen))
+            handle->set_fullscreen(surface->isFullScreen());
+        if (changes.testFlag(Activated))
+            handle->set_activated(surface->isActivated());
+
+        if (changes.testFlag(Parent))
+            updateParent(surface, handle);
+
+        if (changes.testFlag(Outputs))
+            updateOutputs(surface, handle);
+    }
+
+    void updateParent(WToplevelSurface *surface, qw_foreign_toplevel_handle_v1 *handle)
+    {
+        WToplevelSurface *parent = nullptr;
+        if (auto *xdgSurface = qobject_cast<WXdgToplevelSurface *>(surface)) {
+            parent = xdgSurface->parentXdgSurface();
+        } else if (auto *xwaylandSurface = qobject_cast<WXWaylandSurface *>(surface)) {
+            parent = xwaylandSurface->parentXWaylandSurface();
+        } else {
+            return;
+        }
+
+        if (!parent) {
+            handle->set_parent(nullptr);
+            return;
+        }
+
+        if (!surfaces.contains(parent)) {
+            qCCritical(qLcWlrForeignToplevel)
+                << "Toplevel surface " << surface
+                << "has set parent surface, but foreign_toplevel_handle for parent surface "
+                   "not found!";
+            return;
+        }
+        handle->set_parent(*surfaces.at(parent));
+    }
+
+    void updateOutputs(WToplevelSurface *surface, qw_foreign_toplevel_handle_v1 *handle)
+    {
+        // Only send the difference, an output entered and left in the same
+        // iteration produces nothing.
+        QList<wlr_output*> entered;
+        for (auto output : surface->surface()->outputs())
+            entered.append(output->nativeHandle());
+
+        QList<wlr_output*> published;
+        wlr_foreign_toplevel_handle_v1_output *toplevelOutput;
+        wl_list_for_each(toplevelOutput, &handle->handle()->outputs, link)
+            published.append(toplevelOutput->output);
+
+        for (auto output : std::as_const(published)) {
+            if (!entered.contains(output))
+                handle->output_leave(output);
+        }
+
+        for (auto output : std::as_const(entered)) {
+            if (!published.contains(output))
+                handle->output_enter(output);
+        }
     }
 
     void add(WToplevelSurface *surface)
@@ -184,12 +265,15 @@ public:
 
     void remove(WToplevelSurface *surface)
     {
+        pendingChanges.remove(surface);
         surfaces.erase(surface);
     }
 
     W_DECLARE_PUBLIC(WForeignToplevel)
 
     std::map<WToplevelSurface *, std::unique_ptr<qw_foreign_toplevel_handle_v1>> surfaces;
+    QHash<WToplevelSurface *, Changes> pendingChanges;
+    bool flushScheduled = false;
 };
 
 WForeignToplevel::WForeignToplevel(QObject *parent)
@@ -33,14 +33,20 @@ struct Q_DECL_HIDDEN GrabHandlerArg {
     qw_input_method_keyboard_grab_v2 *grab;
 };
 
+// The keys of the virtual keyboards bypass the input method, it's checked on
+// the device instead of searching the helper's virtual keyboards for every key
+static inline bool isVirtualKeyboardActive(const wlr_seat *seat)
+{
+    auto keyboard = seat->keyboard_state.keyboard;
+    return keyboard && wlr_input_device_get_virtual_keyboard(&keyboard->base);
+}
+
 void handleKey(struct wlr_seat_keyboard_grab *grab, uint32_t time_msec, uint32_t key, uint32_t state)
 {
     auto arg = reinterpret_cast<GrabHandlerArg*>(grab->data);
-    for (auto vk: arg->helper->virtualKeyboards()) {
-        if (wlr_keyboard_from_input_device(vk->handle()->handle()) == grab->seat->keyboard_state.keyboard) {
-            grab->seat->keyboard_state.default_grab->interface->key(grab, time_msec, key, state);
-            return;
-        }
+    if (isVirtualKeyboardActive(grab->seat)) {
+        grab->seat->keyboard_state.default_grab->interface->key(grab, time_msec, key, state);
+        return;
     }
     arg->grab->send_key(time_msec, Qt::Key(key), state);
 }
@@ -48,11 +54,9 @@ void handleKey(struct wlr_seat_keyboard_grab *grab, uint32_t time_msec, uint32_t
 void handleModifiers(struct wlr_seat_keyboard_grab *grab, const struct wlr_keyboard_modifiers *modifiers)
 {
     auto arg = reinterpret_cast<GrabHandlerArg*>(grab->data);
-    for (auto vk: arg->helper->virtualKeyboards()) {
-        if (wlr_keyboard_from_input_device(vk->handle()->handle()) == grab->seat->keyboard_state.keyboard) {
-            grab->seat->keyboard_state.default_grab->interface->modifiers(grab, modifiers);
-            return;
-        }
+    if (isVirtualKeyboardActive(grab->seat)) {
+        grab->seat->keyboard_state.default_grab->interface->modifiers(grab, modifiers);
+        return;
     }
     arg->grab->send_modifiers(const_cast<struct wlr_keyboard_modifiers *>(modifiers));
 }
@@ -103,6 +107,22 @@ public:
     QList<WTextInput *> textInputs;
     QList<WInputDevice *> virtualKeyboards;
     QList<WInputPopupSurface *> popupSurfaces;
+
+    // The state of the enabled text input last sent to the input method, the
+    // default values are the initial state of the input method after activate.
+    struct {
+        bool hasSurroundingText = false;
+        QString surroundingText;
+        int surroundingCursor = 0;
+        int surroundingAnchor = 0;
+        IME::ContentHints contentHints = IME::CH_None;
+        IME::ContentPurpose contentPurpose = IME::CP_Normal;
+    } sentState;
+    QRect sentCursorRect;
+
+    inline void resetSentState() {
+        sentState = {};
+    }
 };
 
 WInputMethodHelper::WInputMethodHelper(WServer *server, WSeat *seat)
@@ -154,7 +174,8 @@ void WInputMethodHelper::setEnabledTextInput(WTextInput *ti)
     }
     d->enabledTextInput = ti;
     if (ti) {
-        updateAllPopupSurfaces(ti->cursorRect()); // Note: if this is necessary
+        d->sentCursorRect = ti->cursorRect();
+        updateAllPopupSurfaces(d->sentCursorRect); // Note: if this is necessary
         connect(ti, &WTextInput::committed, this, &WInputMethodHelper::handleFocusedTICommitted, Qt::UniqueConnection);
     }
 }
@@ -173,6 +194,7 @@ void WInputMethodHelper::setInputMethod(WInputMethodV2 *im)
     if (d->activeInputMethod)
         d->activeInputMethod->safeDisconnect(this);
     d->activeInputMethod = im;
+    d->resetSentState();
     if (d->activeInputMethod)
         d->activeInputMethod->safeConnect(&qw_input_method_v2::before_destroy, this, &WInputMethodHelper::handleActiveIMDestroyed);
 }
@@ -386,6 +408,8 @@ void WInputMethodHelper::handleTIEnabled()
     setEnabledTextInput(ti);
     // Try to activate input method.
     if (im) {
+        // The input method resets its state of the text input on activate
+        d->resetSentState();
         im->sendActivate();
         im->sendDone();
     }
@@ -407,19 +431,48 @@ void WInputMethodHelper::handleFocusedTICommitted()
     }
     qCDebug(qLcInputMethod) << "Focused text input" << ti << "committed."
                             << "Cursor rectangle:" << ti->cursorRect();
+    W_D(WInputMethodHelper);
     auto im = inputMethod();
     if (im) {
+        auto &sent = d->sentState;
+        bool changed = false;
         IME::Features features = ti->features();
         if (features.testFlag(IME::F_SurroundingText)) {
-            im->sendSurroundingText(ti->surroundingText(), ti->surroundingCursor(), ti->surroundingAnchor());
+            const QString text = ti->surroundingText();
+            const int cursor = ti->surroundingCursor();
+            const int anchor = ti->surroundingAnchor();
+            if (!sent.hasSurroundingText || sent.surroundingCursor != cursor
+                || sent.surroundingAnchor != anchor || sent.surroundingText != text) {
+                im->sendSurroundingText(text, cursor, anchor);
+                sent.hasSurroundingText = true;
+                sent.surroundingText = text;
+                sent.surroundingCursor = cursor;
+                sent.surroundingAnchor = anchor;
+                // The cause isn't kept by the input method, it's reset to
+                // input_method after every done
+                im->sendTextChangeCause(ti->textChangeCause());
+                changed = true;
+            }
         }
-        im->sendTextChangeCause(ti->textChangeCause());
         if (features.testFlag(IME::F_ContentType)) {
-            im->sendContentType(ti->contentHints().toInt(), ti->contentPurpose());
+            const auto hints = ti->contentHints();
+            const auto purpose = ti->contentPurpose();
+            if (sent.contentHints != hints || sent.contentPurpose != purpose) {
+                im->sendContentType(hints.toInt(), purpose);
+                sent.contentHints = hints;
+                sent.contentPurpose = purpose;
+                changed = true;
+            }
         }
-        im->sendDone();
+        if (changed)
+            im->sendDone();
+    }
+
+    const QRect cursorRect = ti->cursorRect();
+    if (d->sentCursorRect != cursorRect) {
+        d->sentCursorRect = cursorRect;
+        updateAllPopupSurfaces(cursorRect);
     }
-    updateAllPopupSurfaces(ti->cursorRect());
 }
 
 void WInputMethodHelper::handleIMCommitted()
@@ -0,0 +1,409 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wlayershellarranger.h"
+#include "wsurface.h"
+#include "private/wglobal_p.h"
+
+#include <qwlayershellv1.h>
+#include <qwcompositor.h>
+
+#include <QLoggingCategory>
+#include <QPointer>
+
+#include <memory>
+#include <tuple>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcLayerShellArranger, "waylib.server.layershell.arranger", QtWarningMsg)
+
+using LayerType = WLayerSurface::LayerType;
+using AnchorType = WLayerSurface::AnchorType;
+
+static AnchorType resolveExclusiveEdge(const WLayerShellArranger::State &state)
+{
+    using enum WLayerSurface::AnchorType;
+
+    if (state.exclusiveZone <= 0)
+        return None;
+
+    // The edge set by set_exclusive_edge must be one of the anchors
+    if (state.exclusiveEdge != None)
+        return state.anchor.testFlag(state.exclusiveEdge) ? state.exclusiveEdge : None;
+
+    const auto anchor = state.anchor;
+    if (anchor == Top || anchor == (Top | Left | Right))
+        return Top;
+    if (anchor == Bottom || anchor == (Bottom | Left | Right))
+        return Bottom;
+    if (anchor == Left || anchor == (Left | Top | Bottom))
+        return Left;
+    if (anchor == Right || anchor == (Right | Top | Bottom))
+        return Right;
+
+    return None;
+}
+
+static int edgeMargin(const QMargins &margins, AnchorType edge)
+{
+    switch (edge) {
+    case AnchorType::Top:
+        return margins.top();
+    case AnchorType::Bottom:
+        return margins.bottom();
+    case AnchorType::Left:
+        return margins.left();
+    case AnchorType::Right:
+        return margins.right();
+    default:
+        return 0;
+    }
+}
+
+struct Q_DECL_HIDDEN LayerShellEntry
+{
+    QObject *key = nullptr;
+    QPointer<WLayerSurface> surface;
+    WLayerShellArranger::State state;
+    bool ready = false;
+
+    AnchorType edge = AnchorType::None;
+    // The area used by the last placement
+    QRect bounds;
+    QRect geometry;
+    QSize configuredSize;
+
+    inline bool isExclusive() const {
+        return ready && edge != AnchorType::None;
+    }
+
+    // Everything affects the usable area and the order of exclusive surfaces
+    inline auto exclusiveKey() const {
+        return isExclusive()
+                   ? std::make_tuple(true, state.layer, edge, state.exclusiveZone,
+                                     edgeMargin(state.margins, edge))
+                   : std::make_tuple(false, LayerType::Background, AnchorType::None, 0, 0);
+    }
+};
+
+class Q_DECL_HIDDEN WLayerShellArrangerPrivate : public WObjectPrivate
+{
+public:
+    WLayerShellArrangerPrivate(WLayerShellArranger *qq)
+        : WObjectPrivate(qq)
+    {
+
+    }
+
+    void update(LayerShellEntry *entry, const WLayerShellArranger::State &state, bool ready);
+    void arrangeAll();
+    void place(LayerShellEntry *entry, const QRect &bounds);
+    void setUsableArea(const QRect &area);
+
+    W_DECLARE_PUBLIC(WLayerShellArranger)
+
+    QRect outputGeometry;
+    QRect usableArea;
+    // In the order of adding, it's the order of the surfaces in the same layer
+    std::vector<std::unique_ptr<LayerShellEntry>> entries;
+    QHash<QObject*, LayerShellEntry*> entryIndex;
+};
+
+void WLayerShellArrangerPrivate::update(LayerShellEntry *entry, const WLayerShellArranger::State &state, bool ready)
+{
+    if (entry->state == state && entry->ready == ready)
+        return;
+
+    const auto oldKey = entry->exclusiveKey();
+    entry->state = state;
+    entry->ready = ready;
+    entry->edge = resolveExclusiveEdge(state);
+    // The surface is unmapped, it waits for a new configure to map again
+    if (!ready)
+        entry->configuredSize = QSize();
+
+    if (ready && state.exclusiveZone > 0 && entry->edge == AnchorType::None) {
+        qCWarning(qLcLayerShellArranger) << entry->key << "has set exclusive zone"
+                                         << state.exclusiveZone << ", but the exclusive edge is invalid";
+    }
+
+    if (oldKey != entry->exclusiveKey()) {
+        // The usable area or the order of the exclusive surfaces is changed
+        arrangeAll();
+        return;
+    }
+
+    if (!ready)
+        return;
+
+    // Others are not affected, only place this one again
+    if (entry->isExclusive())
+        place(entry, entry->bounds);
+    else
+        place(entry, state.exclusiveZone == -1 ? outputGeometry : usableArea);
+}
+
+void WLayerShellArrangerPrivate::arrangeAll()
+{
+    static constexpr LayerType layers[] = {
+        LayerType::Overlay,
+        LayerType::Top,
+        LayerType::Bottom,
+        LayerType::Background,
+    };
+
+    // The exclusive surfaces of the upper layers take the area first,
+    // the others are placed in the area left by all exclusive surfaces.
+    QRect area = outputGeometry;
+    for (auto layer : layers) {
+        for (const auto &entry : entries) {
+            if (!entry->isExclusive() || entry->state.layer != layer)
+                continue;
+
+            place(entry.get(), area);
+
+            const int size = entry->state.exclusiveZone + edgeMargin(entry->state.margins, entry->edge);
+            switch (entry->edge) {
+            case AnchorType::Top:
+                area.setTop(area.top() + size);
+                break;
+            case AnchorType::Bottom:
+                area.setBottom(area.bottom() - size);
+                break;
+            case AnchorType::Left:
+                area.setLeft(area.left() + size);
+                break;
+            case AnchorType::Right:
+                area.setRight(area.right() - size);
+                break;
+            default:
+                Q_UNREACHABLE();
+            }
+        }
+    }
+
+    // Don't let the exclusive zones make the area invalid
+    if (area.width() < 0)
+        area.setWidth(0);
+    if (area.height() < 0)
+        area.setHeight(0);
+    setUsableArea(area);
+
+    for (const auto &entry : entries) {
+        if (!entry->ready || entry->isExclusive())
+            continue;
+        place(entry.get(), entry->state.exclusiveZone == -1 ? outputGeometry : area);
+    }
+}
+
+void WLayerShellArrangerPrivate::place(LayerShellEntry *entry, const QRect &bounds)
+{
+    W_Q(WLayerShellArranger);
+
+    entry->bounds = bounds;
+
+    const auto &state = entry->state;
+    const auto &margins = state.margins;
+    QRect geometry(QPoint(0, 0), state.desiredSize);
+
+    // Same as wlr_scene_layer_surface_v1_configure
+    if (geometry.width() == 0) {
+        geometry.setX(bounds.x() + margins.left());
+        geometry.setWidth(bounds.width() - margins.left() - margins.right());
+    } else if (state.anchor.testFlags(AnchorType::Left | AnchorType::Right)) {
+        geometry.moveLeft(bounds.x() + (bounds.width() - geometry.width()) / 2);
+    } else if (state.anchor.testFlag(AnchorType::Left)) {
+        geometry.moveLeft(bounds.x() + margins.left());
+    } else if (state.anchor.testFlag(AnchorType::Right)) {
+        geometry.moveLeft(bounds.x() + bounds.width() - geometry.width() - margins.right());
+    } else {
+        geometry.moveLeft(bounds.x() + (bounds.width() - geometry.width()) / 2);
+    }
+
+    if (geometry.height() == 0) {
+        geometry.setY(bounds.y() + margins.top());
+        geometry.setHeight(bounds.height() - margins.top() - margins.bottom());
+    } else if (state.anchor.testFlags(AnchorType::Top | AnchorType::Bottom)) {
+        geometry.moveTop(bounds.y() + (bounds.height() - geometry.height()) / 2);
+    } else if (state.anchor.testFlag(AnchorType::Top)) {
+        geometry.moveTop(bounds.y() + margins.top());
+    } else if (state.anchor.testFlag(AnchorType::Bottom)) {
+        geometry.moveTop(bounds.y() + bounds.height() - geometry.height() - margins.bottom());
+    } else {
+        geometry.moveTop(bounds.y() + (bounds.height() - geometry.height()) / 2);
+    }
+
+    if (geometry.width() < 0)
+        geometry.setWidth(0);
+    if (geometry.height() < 0)
+        geometry.setHeight(0);
+
+    if (entry->surface && entry->configuredSize != geometry.size()) {
+        entry->configuredSize = geometry.size();
+        entry->surface->configureSize(geometry.size());
+    }
+
+    if (entry->geometry == geometry)
+        return;
+    entry->geometry = geometry;
+
+    Q_EMIT q->geometryChanged(entry->key, geometry);
+}
+
+void WLayerShellArrangerPrivate::setUsableArea(const QRect &area)
+{
+    if (usableArea == area)
+        return;
+    usableArea = area;
+
+    W_Q(WLayerShellArranger);
+    Q_EMIT q->usableAreaChanged();
+}
+
+WLayerShellArranger::WLayerShellArranger(QObject *parent)
+    : QObject(parent)
+    , WObject(*new WLayerShellArrangerPrivate(this))
+{
+
+}
+
+WLayerShellArranger::~WLayerShellArranger()
+{
+    W_D(WLayerShellArranger);
+
+    for (const auto &entry : d->entries) {
+        if (!entry->surface)
+            continue;
+        entry->surface->safeDisconnect(this);
+        entry->surface->surface()->safeDisconnect(this);
+    }
+}
+
+WLayerShellArranger::State WLayerShellArranger::stateOf(WLayerSurface *surface)
+{
+    State state;
+    state.layer = surface->layer();
+    state.anchor = surface->ancher();
+    state.exclusiveZone = surface->exclusiveZone();
+    state.exclusiveEdge = static_cast<AnchorType>(surface->nativeHandle()->current.exclusive_edge);
+    state.margins = QMargins(surface->leftMargin(), surface->topMargin(),
+                             surface->rightMargin(), surface->bottomMargin());
+    state.desiredSize = surface->desiredSize();
+
+    return state;
+}
+
+QRect WLayerShellArranger::outputGeometry() const
+{
+    W_DC(WLayerShellArranger);
+    return d->outputGeometry;
+}
+
+void WLayerShellArranger::setOutputGeometry(const QRect &newOutputGeometry)
+{
+    W_D(WLayerShellArranger);
+    if (d->outputGeometry == newOutputGeometry)
+        return;
+    d->outputGeometry = newOutputGeometry;
+    d->arrangeAll();
+
+    Q_EMIT outputGeometryChanged();
+}
+
+QRect WLayerShellArranger::usableArea() const
+{
+    W_DC(WLayerShellArranger);
+    return d->usableArea;
+}
+
+void WLayerShellArranger::addSurface(WLayerSurface *surface)
+{
+    W_D(WLayerShellArranger);
+    Q_ASSERT(!d->entryIndex.contains(surface));
+
+    auto entry = new LayerShellEntry;
+    entry->key = surface;
+    entry->surface = surface;
+    d->entries.emplace_back(entry);
+    d->entryIndex.insert(surface, entry);
+
+    auto updateState = [d, entry] {
+        // Can't configure before the initial commit
+        const bool ready = entry->surface->nativeHandle()->initialized;
+        d->update(entry, stateOf(entry->surface), ready);
+    };
+
+    // Connect after the WLayerSurface's connection, the properties are already updated
+    surface->surface()->safeConnect(&qw_surface::notify_commit, this, updateState);
+    surface->safeConnect(&WLayerSurface::aboutToBeInvalidated, this, [this, surface] {
+        removeSurface(surface);
+    });
+    updateState();
+}
+
+void WLayerShellArranger::removeSurface(WLayerSurface *surface)
+{
+    surface->safeDisconnect(this);
+    surface->surface()->safeDisconnect(this);
+    remove(surface);
+}
+
+void WLayerShellArranger::setState(QObject *key, const State &state)
+{
+    W_D(WLayerShellArranger);
+
+    auto entry = d->entryIndex.value(key);
+    if (!entry) {
+        entry = new LayerShellEntry;
+        entry->key = key;
+        d->entries.emplace_back(entry);
+        d->entryIndex.insert(key, entry);
+    }
+
+    d->update(entry, state, true);
+}
+
+void WLayerShellArranger::remove(QObject *key)
+{
+    W_D(WLayerShellArranger);
+
+    auto entry = d->entryIndex.take(key);
+    if (!entry)
+        return;
+
+    const bool wasExclusive = entry->isExclusive();
+    auto it = std::find_if(d->entries.begin(), d->entries.end(), [entry] (const auto &e) {
+        return e.get() == entry;
+    });
+    Q_ASSERT(it != d->entries.end());
+    d->entries.erase(it);
+
+    if (wasExclusive)
+        d->arrangeAll();
+}
+
+bool WLayerShellArranger::contains(QObject *key) const
+{
+    W_DC(WLayerShellArranger);
+    return d->entryIndex.contains(key);
+}
+
+QRect WLayerShellArranger::geometry(QObject *key) const
+{
+    W_DC(WLayerShellArranger);
+    auto entry = d->entryIndex.value(key);
+    return entry ? entry->geometry : QRect();
+}
+
+WLayerSurface::AnchorType WLayerShellArranger::exclusiveEdge(QObject *key) const
+{
+    W_DC(WLayerShellArranger);
+    auto entry = d->entryIndex.value(key);
+    return entry && entry->isExclusive() ? entry->edge : AnchorType::None;
+}
+
+WAYLIB_SERVER_END_NAMESPACE
+
+#include "moc_wlayershellarranger.cpp"
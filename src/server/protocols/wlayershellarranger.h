@@ -0,0 +1,62 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wlayersurface.h>
+
+#include <QObject>
+#include <QRect>
+#include <QMargins>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WLayerShellArrangerPrivate;
+class WAYLIB_SERVER_EXPORT WLayerShellArranger : public QObject, public WObject
+{
+    Q_OBJECT
+    W_DECLARE_PRIVATE(WLayerShellArranger)
+    Q_PROPERTY(QRect outputGeometry READ outputGeometry WRITE setOutputGeometry NOTIFY outputGeometryChanged FINAL)
+    Q_PROPERTY(QRect usableArea READ usableArea NOTIFY usableAreaChanged FINAL)
+
+public:
+    struct State {
+        WLayerSurface::LayerType layer = WLayerSurface::LayerType::Background;
+        WLayerSurface::AnchorTypes anchor;
+        int32_t exclusiveZone = 0;
+        // None means deducing from the anchor
+        WLayerSurface::AnchorType exclusiveEdge = WLayerSurface::AnchorType::None;
+        QMargins margins;
+        QSize desiredSize;
+
+        bool operator==(const State &other) const = default;
+    };
+
+    explicit WLayerShellArranger(QObject *parent = nullptr);
+    ~WLayerShellArranger() override;
+
+    static State stateOf(WLayerSurface *surface);
+
+    QRect outputGeometry() const;
+    void setOutputGeometry(const QRect &newOutputGeometry);
+    QRect usableArea() const;
+
+    // Follow the committed state of the surface, and configure it when its size changed
+    void addSurface(WLayerSurface *surface);
+    void removeSurface(WLayerSurface *surface);
+
+    // For the objects not backed by WLayerSurface, the key is only an identity
+    void setState(QObject *key, const State &state);
+    void remove(QObject *key);
+    bool contains(QObject *key) const;
+
+    QRect geometry(QObject *key) const;
+    WLayerSurface::AnchorType exclusiveEdge(QObject *key) const;
+
+Q_SIGNALS:
+    void outputGeometryChanged();
+    void usableAreaChanged();
+    void geometryChanged(QObject *key, const QRect &geometry);
+};
+
+WAYLIB_SERVER_END_NAMESPACE
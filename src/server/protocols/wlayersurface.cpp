@@ -407,6 +407,11 @@ WLayerSurface::AnchorType WLayerSurface::getExclusiveZoneEdge() const
     using enum WLayerSurface::AnchorType;
 
     auto ancher = d->ancher;
+    // Set by set_exclusive_edge, it must be one of the anchors
+    const auto edge = static_cast<AnchorType>(nativeHandle()->current.exclusive_edge);
+    if (edge != None)
+        return ancher.testFlag(edge) ? edge : None;
+
     if (ancher == Top || ancher == (Top|Left|Right))
         return Top;
     if (ancher == Bottom || ancher == (Bottom|Left|Right))
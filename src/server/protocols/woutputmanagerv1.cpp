@@ -3,14 +3,27 @@
 
 #include "woutputmanagerv1.h"
 #include "woutputitem.h"
+#include "wbackend.h"
 #include "private/wglobal_p.h"
 
 #include <qwoutput.h>
 #include <qwoutputmanagementv1.h>
 #include <qwdisplay.h>
+#include <qwbackend.h>
+
+#include <QLoggingCategory>
+
+extern "C" {
+#include <wlr/backend.h>
+#include <wlr/render/swapchain.h>
+#include <wlr/render/wlr_renderer.h>
+#include <wlr/types/wlr_output_swapchain_manager.h>
+}
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+Q_LOGGING_CATEGORY(qLcOutputManager, "waylib.protocols.outputmanager", QtWarningMsg)
+
 using QW_NAMESPACE::qw_output_manager_v1;
 using QW_NAMESPACE::qw_output_configuration_v1;
 using QW_NAMESPACE::qw_output_configuration_head_v1;
@@ -36,12 +49,88 @@ public:
         return handle()->handle();
     }
 
+    void scheduleUpdateConfig();
+
     qw_output_manager_v1 *manager { nullptr };
     QPointer<WBackend> backend;
     QList<WOutputState> stateList;
     QList<WOutputState> stateListPending;
+    // The states in the configuration of the manager
+    QList<WOutputState> configStateList;
+    bool updateConfigScheduled = false;
 };
 
+void WOutputManagerV1Private::scheduleUpdateConfig()
+{
+    if (updateConfigScheduled)
+        return;
+    updateConfigScheduled = true;
+
+    W_Q(WOutputManagerV1);
+    QMetaObject::invokeMethod(q, [this, q] {
+        updateConfigScheduled = false;
+        q->updateConfig();
+    }, Qt::QueuedConnection);
+}
+
+// Only fill the changed properties, the state is empty if nothing changed
+static void fillOutputState(const WOutputState &state, wlr_output_state *outputState)
+{
+    const wlr_output *output = state.output->nativeHandle();
+
+    if (state.enabled != output->enabled)
+        wlr_output_state_set_enabled(outputState, state.enabled);
+    if (!state.enabled)
+        return;
+
+    if (state.mode) {
+        if (state.mode != output->current_mode)
+            wlr_output_state_set_mode(outputState, state.mode);
+    } else if (!state.customModeSize.isEmpty()) {
+        if (state.customModeSize != QSize(output->width, output->height)
+            || (state.customModeRefresh > 0 && state.customModeRefresh != output->refresh)) {
+            wlr_output_state_set_custom_mode(outputState, state.customModeSize.width(),
+                                             state.customModeSize.height(), state.customModeRefresh);
+        }
+    }
+
+    const auto transform = static_cast<wl_output_transform>(state.transform);
+    if (transform != output->transform)
+        wlr_output_state_set_transform(outputState, transform);
+    if (state.scale != output->scale)
+        wlr_output_state_set_scale(outputState, state.scale);
+
+    const bool adaptiveSyncEnabled = output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED;
+    if (state.adaptiveSyncEnabled != adaptiveSyncEnabled)
+        wlr_output_state_set_adaptive_sync_enabled(outputState, state.adaptiveSyncEnabled);
+}
+
+// The backend like DRM needs a buffer to modeset
+static bool renderBlackFrame(wlr_output *output, wlr_swapchain *swapchain, wlr_output_state *state)
+{
+    wlr_buffer *buffer = wlr_swapchain_acquire(swapchain);
+    if (!buffer)
+        return false;
+
+    wlr_render_pass *pass = wlr_renderer_begin_buffer_pass(output->renderer, buffer, nullptr);
+    if (!pass) {
+        wlr_buffer_unlock(buffer);
+        return false;
+    }
+
+    const wlr_render_rect_options options {
+        .box = { 0, 0, buffer->width, buffer->height },
+        .color = { 0, 0, 0, 1 },
+    };
+    wlr_render_pass_add_rect(pass, &options);
+    const bool ok = wlr_render_pass_submit(pass);
+    if (ok)
+        wlr_output_state_set_buffer(state, buffer);
+    wlr_buffer_unlock(buffer);
+
+    return ok;
+}
+
 WOutputManagerV1::WOutputManagerV1()
     : WObject(*new WOutputManagerV1Private(this))
 {
@@ -84,10 +173,86 @@ const QList<WOutputState> &WOutputManagerV1::stateListPending()
     return d->stateListPending;
 }
 
+bool WOutputManagerV1::applyStates(const QList<WOutputState> &states, bool onlyTest)
+{
+    W_D(WOutputManagerV1);
+
+    if (!d->backend) {
+        qCWarning(qLcOutputManager) << "Can't apply the output states without WBackend";
+        return false;
+    }
+
+    QVarLengthArray<wlr_backend_output_state, 4> backendStates;
+    backendStates.reserve(states.size());
+    for (const auto &state : states) {
+        Q_ASSERT(state.output);
+        wlr_backend_output_state backendState {
+            .output = state.output->nativeHandle(),
+        };
+        wlr_output_state_init(&backendState.base);
+        fillOutputState(state, &backendState.base);
+
+        if (backendState.base.committed == 0) {
+            wlr_output_state_finish(&backendState.base);
+            continue;
+        }
+        backendStates.append(backendState);
+    }
+
+    // Only the layout is changed
+    if (backendStates.isEmpty())
+        return true;
+
+    wlr_backend *backend = d->backend->handle()->handle();
+    wlr_output_swapchain_manager swapchainManager;
+    wlr_output_swapchain_manager_init(&swapchainManager, backend);
+
+    bool ok = wlr_output_swapchain_manager_prepare(&swapchainManager, backendStates.data(),
+                                                   backendStates.size());
+    for (auto &backendState : backendStates) {
+        if (!ok)
+            break;
+        if (!backendState.base.enabled && (backendState.base.committed & WLR_OUTPUT_STATE_ENABLED))
+            continue;
+        if (!(backendState.base.committed & (WLR_OUTPUT_STATE_ENABLED | WLR_OUTPUT_STATE_MODE)))
+            continue;
+
+        auto swapchain = wlr_output_swapchain_manager_get_swapchain(&swapchainManager, backendState.output);
+        ok = swapchain && renderBlackFrame(backendState.output, swapchain, &backendState.base);
+    }
+
+    if (ok)
+        ok = wlr_backend_test(backend, backendStates.data(), backendStates.size());
+    if (ok && !onlyTest) {
+        ok = wlr_backend_commit(backend, backendStates.data(), backendStates.size());
+        if (ok)
+            wlr_output_swapchain_manager_apply(&swapchainManager);
+    }
+
+    if (!ok) {
+        qCDebug(qLcOutputManager) << "Failed to" << (onlyTest ? "test" : "commit")
+                                  << backendStates.size() << "outputs";
+    }
+
+    wlr_output_swapchain_manager_finish(&swapchainManager);
+    for (auto &backendState : backendStates)
+        wlr_output_state_finish(&backendState.base);
+
+    return ok;
+}
+
 void WOutputManagerV1::updateConfig()
 {
     W_D(WOutputManagerV1);
 
+    // Nothing changed since the last configuration
+    if (d->configStateList == d->stateList)
+        return;
+    d->configStateList = d->stateList;
+
+    // The whole configuration is built again, wlr_output_manager_v1 compares
+    // it with the current heads and only sends the changed properties.
+
     auto *config = qw_output_configuration_v1::create();
 
     for (const WOutputState &state : std::as_const(d->stateList)) {
@@ -113,7 +278,9 @@ void WOutputManagerV1::sendResult(qw_output_configuration_v1 *config, bool ok)
     if (ok)
         d->stateList.swap(d->stateListPending);
     d->stateListPending.clear();
-    updateConfig();
+    // The manager needs a new configuration for the new serial even without changes
+    d->configStateList.clear();
+    d->scheduleUpdateConfig();
 }
 
 void WOutputManagerV1::newOutput(WOutput *output)
@@ -136,7 +303,7 @@ void WOutputManagerV1::newOutput(WOutput *output)
         .adaptiveSyncEnabled = (wlr_output->adaptive_sync_status == WLR_OUTPUT_ADAPTIVE_SYNC_ENABLED)
     };
     d->stateList.append(state);
-    updateConfig();
+    d->scheduleUpdateConfig();
 }
 
 void WOutputManagerV1::removeOutput(WOutput *output)
@@ -146,7 +313,7 @@ void WOutputManagerV1::removeOutput(WOutput *output)
         return s.output == output;
     });
 
-    updateConfig();
+    d->scheduleUpdateConfig();
 }
 
 qw_output_manager_v1 *WOutputManagerV1::handle() const
@@ -163,6 +330,7 @@ void WOutputManagerV1::create(WServer *server)
 {
     W_D(WOutputManagerV1);
 
+    d->backend = server->findInterface<WBackend>();
     d->manager = qw_output_manager_v1::create(*server->handle());
     connect(d->manager, &qw_output_manager_v1::notify_test, this, [d](wlr_output_configuration_v1 *config) {
         d->outputMgrApplyOrTest(qw_output_configuration_v1::from(config), true);
@@ -40,6 +40,8 @@ public:
     WOutput::Transform transform;
     float scale;
     bool adaptiveSyncEnabled;
+
+    bool operator==(const WOutputState &other) const = default;
 };
 
 class WOutputManagerV1Private;
@@ -51,6 +53,9 @@ public:
     explicit WOutputManagerV1();
 
     const QList<WOutputState> &stateListPending();
+    // Test and commit all outputs' states in one backend commit, the outputs without
+    // any change are skipped. The position is only for layout, it doesn't need commit.
+    bool applyStates(const QList<WOutputState> &states, bool onlyTest = false);
 
     void sendResult(QW_NAMESPACE::qw_output_configuration_v1 *config, bool ok);
     void newOutput(WOutput *output);
@@ -15,7 +15,11 @@
 #include <qwdisplay.h>
 #include <qwcompositor.h>
 
+#include <QAbstractEventDispatcher>
+#include <QThread>
+
 #include <xcb/xcb.h>
+#include <xcb/xcbext.h>
 
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
@@ -35,6 +39,11 @@ public:
     }
 
     void init();
+    void cacheAtom(const QByteArray &name, xcb_atom_t atom) const;
+    void pollAtomReplies();
+    void failPendingAtoms();
+    void scheduleWriteSupportedAtoms();
+    void writeSupportedAtoms();
 
     wl_client *waylandClient() const override {
         return q_func()->handle()->handle()->server->client;
@@ -53,8 +62,25 @@ public:
     bool lazy = true;
     QVector<WXWaylandSurface*> surfaceList;
     QVector<xcb_atom_t> atoms;
+    QHash<xcb_atom_t, WXWayland::XcbAtom> atomTypes;
+    mutable QHash<QByteArray, xcb_atom_t> atomCache;
     QList<WXWaylandSurface*> toplevelSurfaces;
 
+    struct PendingAtom {
+        QByteArray name;
+        xcb_intern_atom_cookie_t cookie;
+        QPointer<QObject> context;
+        std::function<void(xcb_atom_t)> callback;
+    };
+    QList<PendingAtom> pendingAtoms;
+    QMetaObject::Connection pendingAtomsWatcher;
+    // Interned in background after every start of the X server
+    QByteArrayList preloadAtoms;
+
+    // The local copy of _NET_SUPPORTED, avoid to read it from X server
+    QVarLengthArray<xcb_atom_t> supportedAtoms;
+    bool supportedAtomsDirty = false;
+
     WSocket *socket = nullptr;
 };
 
@@ -65,6 +91,10 @@ void WXWaylandPrivate::init()
     auto screen_iterator = xcb_setup_roots_iterator(xcb_get_setup(q->xcbConnection()));
     screen = screen_iterator.data;
 
+    // The atoms are invalid after the X server restarted
+    atomCache.clear();
+    failPendingAtoms();
+
     xcb_intern_atom_cookie_t cookies[WXWayland::AtomCount];
     const auto atomEnum = QMetaEnum::fromType<WXWayland::XcbAtom>();
     for (int i = WXWayland::AtomNone + 1; i < WXWayland::AtomCount; ++i) {
@@ -75,6 +105,7 @@ void WXWaylandPrivate::init()
     }
 
     atoms.resize(WXWayland::AtomCount);
+    atomTypes.clear();
     for (int i = WXWayland::AtomNone + 1; i < WXWayland::AtomCount; ++i) {
         xcb_generic_error_t *error;
         xcb_intern_atom_reply_t *reply =
@@ -88,9 +119,107 @@ void WXWaylandPrivate::init()
             free(error);
             continue;
         }
+
+        cacheAtom(atomEnum.valueToKey(i), atoms[i]);
+        atomTypes.insert(atoms[i], static_cast<WXWayland::XcbAtom>(i));
+    }
+
+    // Read _NET_SUPPORTED only once, it's maintained locally after this
+    supportedAtoms.clear();
+    supportedAtomsDirty = false;
+    auto cookie = xcb_get_property(q->xcbConnection(), 0, screen->root,
+                                   atoms[WXWayland::_NET_SUPPORTED], XCB_ATOM_ATOM, 0, 4096);
+    if (auto reply = xcb_get_property_reply(q->xcbConnection(), cookie, nullptr)) {
+        auto values = reinterpret_cast<xcb_atom_t*>(xcb_get_property_value(reply));
+        supportedAtoms.append(values, xcb_get_property_value_length(reply) / sizeof(xcb_atom_t));
+        free(reply);
+    }
+
+    for (const auto &name : std::as_const(preloadAtoms)) {
+        if (!atomCache.contains(name))
+            q->requestAtom(name, q, nullptr);
+    }
+}
+
+void WXWaylandPrivate::cacheAtom(const QByteArray &name, xcb_atom_t atom) const
+{
+    if (atom != XCB_ATOM_NONE)
+        atomCache.insert(name, atom);
+}
+
+void WXWaylandPrivate::pollAtomReplies()
+{
+    W_Q(WXWayland);
+
+    if (!q->handle() || !q->xcbConnection()) {
+        failPendingAtoms();
+        return;
+    }
+
+    // The replies are read by the xwm of wlroots, here only takes them
+    while (!pendingAtoms.isEmpty()) {
+        auto &pending = pendingAtoms.first();
+        void *reply = nullptr;
+        xcb_generic_error_t *error = nullptr;
+        if (!xcb_poll_for_reply(q->xcbConnection(), pending.cookie.sequence, &reply, &error))
+            break;
+
+        xcb_atom_t atom = XCB_ATOM_NONE;
+        if (reply) {
+            atom = static_cast<xcb_intern_atom_reply_t*>(reply)->atom;
+            cacheAtom(pending.name, atom);
+            free(reply);
+        }
+        free(error);
+
+        const auto finished = pendingAtoms.takeFirst();
+        if (finished.context && finished.callback)
+            finished.callback(atom);
+    }
+
+    if (pendingAtoms.isEmpty())
+        QObject::disconnect(pendingAtomsWatcher);
+}
+
+void WXWaylandPrivate::failPendingAtoms()
+{
+    QObject::disconnect(pendingAtomsWatcher);
+
+    // The replies will never come from a closed connection
+    const auto list = std::exchange(pendingAtoms, {});
+    for (const auto &pending : list) {
+        if (pending.context && pending.callback)
+            pending.callback(XCB_ATOM_NONE);
     }
 }
 
+void WXWaylandPrivate::scheduleWriteSupportedAtoms()
+{
+    if (supportedAtomsDirty)
+        return;
+    supportedAtomsDirty = true;
+
+    // Merge all changes in this event loop iteration to one request
+    QMetaObject::invokeMethod(q_func(), [this] {
+        writeSupportedAtoms();
+    }, Qt::QueuedConnection);
+}
+
+void WXWaylandPrivate::writeSupportedAtoms()
+{
+    W_Q(WXWayland);
+
+    if (!supportedAtomsDirty || !q->handle() || !q->xcbConnection())
+        return;
+    supportedAtomsDirty = false;
+
+    auto xcb_conn = q->xcbConnection();
+    xcb_change_property(xcb_conn, XCB_PROP_MODE_REPLACE, screen->root,
+                        atoms[WXWayland::_NET_SUPPORTED], XCB_ATOM_ATOM, 32,
+                        supportedAtoms.size(), supportedAtoms.constData());
+    xcb_flush(xcb_conn);
+}
+
 void WXWaylandPrivate::on_new_surface(wlr_xwayland_surface *xwl_surface)
 {
     W_Q(WXWayland);
@@ -143,6 +272,14 @@ xcb_atom_t WXWayland::atom(XcbAtom type) const
 
 xcb_atom_t WXWayland::atom(const QByteArray &name) const
 {
+    W_DC(WXWayland);
+    if (auto a = d->atomCache.value(name))
+        return a;
+
+    if (!handle() || !xcbConnection())
+        return XCB_ATOM_NONE;
+
+    // Blocks until the X server replied, prefer requestAtom
     auto cookie = xcb_intern_atom(xcbConnection(), 0, name.size(), name.constData());
     xcb_generic_error_t *error;
     xcb_intern_atom_reply_t *reply =
@@ -155,67 +292,93 @@ xcb_atom_t WXWayland::atom(const QByteArray &name) const
     if (error)
         free(error);
 
+    d->cacheAtom(name, a);
     return a;
 }
 
-WXWayland::XcbAtom WXWayland::atomType(xcb_atom_t atom) const
+void WXWayland::requestAtom(const QByteArray &name, QObject *context,
+                            std::function<void (xcb_atom_t)> callback)
 {
-    W_DC(WXWayland);
-    for (int i = AtomNone; i < AtomCount; ++i) {
-        if (d->atoms.at(i) == atom)
-            return static_cast<XcbAtom>(i);
+    W_D(WXWayland);
+    Q_ASSERT(context);
+
+    if (auto a = d->atomCache.value(name)) {
+        if (callback)
+            callback(a);
+        return;
+    }
+
+    if (!handle() || !xcbConnection()) {
+        if (callback)
+            callback(XCB_ATOM_NONE);
+        return;
     }
 
-    return AtomNone;
+    auto cookie = xcb_intern_atom(xcbConnection(), 0, name.size(), name.constData());
+    xcb_flush(xcbConnection());
+    d->pendingAtoms.append({name, cookie, context, std::move(callback)});
+
+    if (!d->pendingAtomsWatcher) {
+        auto dispatcher = QThread::currentThread()->eventDispatcher();
+        d->pendingAtomsWatcher = connect(dispatcher, &QAbstractEventDispatcher::aboutToBlock,
+                                         this, [d] {
+            d->pollAtomReplies();
+        });
+    }
 }
 
-QVarLengthArray<xcb_atom_t> WXWayland::supportedAtoms() const
+void WXWayland::preloadAtoms(const QByteArrayList &names)
 {
-    auto xcb_conn = xcbConnection();
-    auto root = xcbScreen()->root;
+    W_D(WXWayland);
 
-    auto cookie = xcb_get_property(xcb_conn, 0, root, atom(_NET_SUPPORTED), XCB_ATOM_ATOM, 0, 4096);
-    auto reply = xcb_get_property_reply(xcb_conn, cookie, nullptr);
-    if (!reply) {
-        return {};
-    }
+    for (const auto &name : names) {
+        if (d->preloadAtoms.contains(name))
+            continue;
+        d->preloadAtoms.append(name);
 
-    xcb_atom_t *atoms = reinterpret_cast<xcb_atom_t*>(xcb_get_property_value(reply));
-    size_t atoms_len = reply->value_len;
+        if (d->screen)
+            requestAtom(name, this, nullptr);
+    }
+}
 
-    QVarLengthArray<xcb_atom_t> atomList;
-    atomList.append(atoms, atoms_len);
+WXWayland::XcbAtom WXWayland::atomType(xcb_atom_t atom) const
+{
+    W_DC(WXWayland);
+    if (atom == XCB_ATOM_NONE)
+        return AtomNone;
+    return d->atomTypes.value(atom, AtomNone);
+}
 
-    return atomList;
+QVarLengthArray<xcb_atom_t> WXWayland::supportedAtoms() const
+{
+    W_DC(WXWayland);
+    return d->supportedAtoms;
 }
 
 void WXWayland::setSupportedAtoms(const QVarLengthArray<xcb_atom_t> &atoms)
 {
     W_D(WXWayland);
-    auto xcb_conn = xcbConnection();
-    auto root = xcbScreen()->root;
+    if (d->supportedAtoms == atoms)
+        return;
 
-    xcb_change_property(xcb_conn, XCB_PROP_MODE_REPLACE, root, atom(_NET_SUPPORTED),
-                        XCB_ATOM_ATOM, 32, atoms.size(), atoms.constData());
-    xcb_flush(xcb_conn);
+    d->supportedAtoms = atoms;
+    d->scheduleWriteSupportedAtoms();
 }
 
 void WXWayland::setAtomSupported(xcb_atom_t atom, bool supported)
 {
     W_D(WXWayland);
-    auto xcb_conn = xcbConnection();
-    auto root = xcbScreen()->root;
 
     if (supported) {
-        xcb_change_property(xcb_conn, XCB_PROP_MODE_APPEND, root,
-                            this->atom(_NET_SUPPORTED),
-                            XCB_ATOM_ATOM, 32, 1, &atom);
-        xcb_flush(xcb_conn);
+        if (d->supportedAtoms.contains(atom))
+            return;
+        d->supportedAtoms.append(atom);
     } else {
-        auto atoms = supportedAtoms();
-        atoms.removeOne(atom);
-        setSupportedAtoms(atoms);
+        if (!d->supportedAtoms.removeOne(atom))
+            return;
     }
+
+    d->scheduleWriteSupportedAtoms();
 }
 
 void WXWayland::setSeat(WSeat *seat)
@@ -339,6 +502,9 @@ void WXWayland::create(WServer *server)
 
     auto s = qw_xwayland_server::from(handle->handle()->server);
     QObject::connect(s, &qw_xwayland_server::notify_start, this, [d] {
+        // A new X server is starting, the old connection has gone
+        d->screen = nullptr;
+        d->failPendingAtoms();
         d->socket->addClient(d->waylandClient());
     });
 }
@@ -351,6 +517,7 @@ void WXWayland::destroy(WServer *server)
     auto list = d->surfaceList;
     d->surfaceList.clear();
     d->screen = nullptr;
+    d->failPendingAtoms();
 
     for (auto surface : std::as_const(list)) {
         removeSurface(surface);
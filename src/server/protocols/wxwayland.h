@@ -5,6 +5,8 @@
 
 #include <WServer>
 
+#include <functional>
+
 QW_BEGIN_NAMESPACE
 class qw_xwayland;
 class qw_compositor;
@@ -50,7 +52,15 @@ public:
     QByteArray displayName() const;
 
     xcb_atom_t atom(XcbAtom type) const;
+    // Blocks on a cache miss, use preloadAtoms or requestAtom in hot paths.
     xcb_atom_t atom(const QByteArray &name) const;
+    // The callback is called in the event loop once the X server replied,
+    // or immediately if the atom is cached. Not called if context is destroyed,
+    // called with XCB_ATOM_NONE if the X server is gone before replying.
+    void requestAtom(const QByteArray &name, QObject *context,
+                     std::function<void(xcb_atom_t)> callback);
+    // Interns the atoms in background, and again every time the X server is ready
+    void preloadAtoms(const QByteArrayList &names);
     XcbAtom atomType(xcb_atom_t atom) const;
     QVarLengthArray<xcb_atom_t> supportedAtoms() const;
     void setSupportedAtoms(const QVarLengthArray<xcb_atom_t> &atoms);
@@ -17,6 +17,7 @@
 
 #include <QSGImageNode>
 #include <QSGSimpleRectNode>
+#include <QtMath>
 
 #define protected public
 #define private public
@@ -83,6 +84,53 @@ static const wlr_drm_format *pickFormat(qw_renderer *renderer, uint32_t format)
     return wlr_drm_format_set_get(format_set, format);
 }
 
+// The wl_output_transform of an axis aligned transform, and its scale
+static bool toOutputTransform(const QTransform &t, uint32_t *transform, qreal *scale)
+{
+    if (t.type() > QTransform::TxRotate)
+        return false;
+
+    if (qFuzzyIsNull(t.m12()) && qFuzzyIsNull(t.m21())) {
+        if (!qFuzzyCompare(qAbs(t.m11()), qAbs(t.m22())))
+            return false;
+        *scale = qAbs(t.m11());
+        if (t.m11() > 0)
+            *transform = t.m22() > 0 ? WL_OUTPUT_TRANSFORM_NORMAL : WL_OUTPUT_TRANSFORM_FLIPPED_180;
+        else
+            *transform = t.m22() > 0 ? WL_OUTPUT_TRANSFORM_FLIPPED : WL_OUTPUT_TRANSFORM_180;
+        return true;
+    }
+
+    if (qFuzzyIsNull(t.m11()) && qFuzzyIsNull(t.m22())) {
+        if (!qFuzzyCompare(qAbs(t.m12()), qAbs(t.m21())))
+            return false;
+        *scale = qAbs(t.m12());
+        if (t.m21() < 0)
+            *transform = t.m12() > 0 ? WL_OUTPUT_TRANSFORM_90 : WL_OUTPUT_TRANSFORM_FLIPPED_270;
+        else
+            *transform = t.m12() > 0 ? WL_OUTPUT_TRANSFORM_FLIPPED_90 : WL_OUTPUT_TRANSFORM_270;
+        return true;
+    }
+
+    return false;
+}
+
+// QTransform::map maps every rectangle to a polygon for the rotations, and unites them
+static QRegion mapRegion(const QRegion &region, const QTransform &t)
+{
+    uint32_t transform;
+    qreal scale;
+    if (region.isEmpty() || !toOutputTransform(t, &transform, &scale))
+        return t.map(region);
+
+    const QRect bounding = region.boundingRect();
+    QRegion result = WTools::transformRegion(region.translated(-bounding.topLeft()),
+                                             transform, bounding.size());
+    result = WTools::scaleRegion(result, scale);
+    const QPointF offset = t.mapRect(QRectF(bounding)).topLeft();
+    return result.translated(qFloor(offset.x()), qFloor(offset.y()));
+}
+
 static void applyTransform(QSGSoftwareRenderer *renderer, const QTransform &t)
 {
     if (t.isIdentity())
@@ -94,7 +142,7 @@ static void applyTransform(QSGSoftwareRenderer *renderer, const QTransform &t)
         node->setTransform(node->transform() * t);
 
         if (node->m_hasClipRegion)
-            node->setClipRegion(t.map(node->clipRegion()), true);
+            node->setClipRegion(mapRegion(node->clipRegion(), t), true);
 
         ++nodeIter;
     }
@@ -330,11 +378,30 @@ QTransform WBufferRenderer::inputMapToOutput(const QRectF &sourceRect, const QRe
     return t;
 }
 
+qw_renderer *WBufferRenderer::wlrRenderer() const
+{
+    if (m_output)
+        return m_output->renderer();
+    auto rw = qobject_cast<WOutputRenderWindow*>(window());
+    Q_ASSERT(rw);
+    return rw->renderer();
+}
+
+qw_allocator *WBufferRenderer::wlrAllocator() const
+{
+    if (m_output)
+        return m_output->allocator();
+    auto rw = qobject_cast<WOutputRenderWindow*>(window());
+    Q_ASSERT(rw);
+    return rw->allocator();
+}
+
 qw_buffer *WBufferRenderer::beginRender(const QSize &pixelSize, qreal devicePixelRatio,
                                         uint32_t format, RenderFlags flags)
 {
     Q_ASSERT(!state.buffer);
-    Q_ASSERT(m_output);
+    // Without an output only the offscreen swapchain is usable
+    Q_ASSERT(m_output || flags.testFlag(RenderFlag::DontConfigureSwapchain));
 
     if (pixelSize.isEmpty())
         return nullptr;
@@ -343,7 +410,7 @@ qw_buffer *WBufferRenderer::beginRender(const QSize &pixelSize, qreal devicePixe
 
     // configure swapchain
     if (flags.testFlag(RenderFlag::DontConfigureSwapchain)) {
-        auto renderFormat = pickFormat(m_output->renderer(), format);
+        auto renderFormat = pickFormat(wlrRenderer(), format);
         if (!renderFormat) {
             qWarning("wlr_renderer doesn't support format 0x%s", drmGetFormatName(format));
             return nullptr;
@@ -353,7 +420,7 @@ qw_buffer *WBufferRenderer::beginRender(const QSize &pixelSize, qreal devicePixe
             || m_swapchain->handle()->format.format != renderFormat->format) {
             if (m_swapchain)
                 delete m_swapchain;
-            m_swapchain = qw_swapchain::create(m_output->allocator()->handle(), pixelSize.width(), pixelSize.height(), renderFormat);
+            m_swapchain = qw_swapchain::create(wlrAllocator()->handle(), pixelSize.width(), pixelSize.height(), renderFormat);
         }
     } else if (flags.testFlag(RenderFlag::UseCursorFormats)) {
         bool ok = m_output->configureCursorSwapchain(pixelSize, format, &m_swapchain);
@@ -373,7 +440,7 @@ qw_buffer *WBufferRenderer::beginRender(const QSize &pixelSize, qreal devicePixe
     auto buffer = qw_buffer::from(wbuffer);
 
     if (!m_renderHelper)
-        m_renderHelper = new WRenderHelper(m_output->renderer());
+        m_renderHelper = new WRenderHelper(wlrRenderer());
     m_renderHelper->setSize(pixelSize);
 
     auto wd = QQuickWindowPrivate::get(window());
@@ -595,8 +662,7 @@ void WBufferRenderer::render(int sourceIndex, const QMatrix4x4 &renderMatrix,
             auto currentImage = getImageFrom(state.renderTarget);
             Q_ASSERT(currentImage && currentImage == softwareRenderer->m_rt.paintDevice);
             currentImage->setDevicePixelRatio(1.0);
-            const auto scaleTF = QTransform::fromScale(devicePixelRatio, devicePixelRatio);
-            const auto scaledFlushRegion = scaleTF.map(softwareRenderer->flushRegion());
+            const auto scaledFlushRegion = WTools::scaleRegion(softwareRenderer->flushRegion(), devicePixelRatio);
             PixmanRegion scaledFlushDamage;
             bool ok = WTools::toPixmanRegion(scaledFlushRegion, scaledFlushDamage);
             Q_ASSERT(ok);
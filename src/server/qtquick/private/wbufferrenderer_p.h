@@ -40,6 +40,8 @@ class WAYLIB_SERVER_EXPORT WBufferRenderer : public QQuickItem
     friend class WOutputRenderWindow;
     friend class WOutputRenderWindowPrivate;
     friend class OutputHelper;
+    friend class WThumbnailProvider;
+    friend class WThumbnailProviderPrivate;
     Q_OBJECT
 
 public:
@@ -108,6 +110,9 @@ private:
         return qobject_cast<WOutputRenderWindow*>(parent());
     }
 
+    QW_NAMESPACE::qw_renderer *wlrRenderer() const;
+    QW_NAMESPACE::qw_allocator *wlrAllocator() const;
+
     inline bool shouldCacheBuffer() const {
         return m_cacheBuffer || !m_cacheBufferLocker.isEmpty();
     }
@@ -51,6 +51,7 @@ public:
     void init();
     void initForOutput();
     void update();
+    void updateMirrorSourceOutput();
 
     // call in WOutputRenderWindow
     inline void notifyLayersChanged() {
@@ -71,6 +72,11 @@ public:
 
     W_DECLARE_PUBLIC(WOutputViewport)
     QList<WOutputViewport*> depends;
+    QPointer<WOutputViewport> mirrorSource;
+    WOutputViewport::MirrorFillMode mirrorFillMode = WOutputViewport::PreserveAspectFit;
+    QMetaObject::Connection mirrorSourceEnabledConnection;
+    // the number of viewports mirroring this one
+    int mirrorCount = 0;
 
     QQuickItem *input = nullptr;
     WOutput *output = nullptr;
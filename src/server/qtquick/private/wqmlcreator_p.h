@@ -37,6 +37,7 @@ class WAYLIB_SERVER_EXPORT WQmlCreatorComponent : public WAbstractCreatorCompone
     Q_PROPERTY(QString chooserRole READ chooserRole WRITE setChooserRole NOTIFY chooserRoleChanged FINAL)
     Q_PROPERTY(QVariant chooserRoleValue READ chooserRoleValue WRITE setChooserRoleValue NOTIFY chooserRoleValueChanged FINAL)
     Q_PROPERTY(bool autoDestroy READ autoDestroy WRITE setAutoDestroy NOTIFY autoDestroyChanged FINAL)
+    Q_PROPERTY(int poolSize READ poolSize WRITE setPoolSize NOTIFY poolSizeChanged FINAL)
     QML_NAMED_ELEMENT(DynamicCreatorComponent)
     Q_CLASSINFO("DefaultProperty", "delegate")
 
@@ -60,6 +61,9 @@ public:
     bool autoDestroy() const;
     void setAutoDestroy(bool newAutoDestroy);
 
+    int poolSize() const;
+    void setPoolSize(int newPoolSize);
+
     QObject *parent() const;
     void setParent(QObject *newParent);
 
@@ -72,6 +76,7 @@ Q_SIGNALS:
     void chooserRoleChanged();
     void chooserRoleValueChanged();
     void autoDestroyChanged();
+    void poolSizeChanged();
 
     void objectAdded(QObject *object, const QJSValue &initialProperties);
     void objectRemoved(QObject *object, const QJSValue &initialProperties);
@@ -85,6 +90,11 @@ private:
 
     void clear();
     void reset();
+    bool recycle(QObject *object, const QJSValue &properties);
+    bool canReuse(const QObject *object, const QStringList &lastProperties,
+                  const QJSValue &properties) const;
+    QObject *reuse(QObject *parent, const QJSValue &properties);
+    void trimPool(int size);
     void create(QSharedPointer<WQmlCreatorDelegateData> data);
     Q_SLOT void create(QSharedPointer<WQmlCreatorDelegateData> data, QObject *parent, const QJSValue &initialProperties);
 
@@ -96,6 +106,16 @@ private:
     QList<QQmlContext::PropertyPair> m_contextProperties;
 
     QList<QSharedPointer<WQmlCreatorDelegateData>> m_datas;
+
+    // The released objects waiting to reuse, only if autoDestroy is enabled
+    struct PooledObject {
+        QPointer<QObject> object;
+        QPointer<QQmlContext> context;
+        // The properties assigned by the last owner
+        QStringList properties;
+    };
+    QList<PooledObject> m_pool;
+    int m_poolSize = 0;
 };
 
 class Q_DECL_HIDDEN WAbstractCreatorComponentPrivate : public WObjectPrivate
@@ -117,8 +137,30 @@ public:
 
     W_DECLARE_PUBLIC(WQmlCreator)
 
+    inline static QObject *objectOf(const WQmlCreatorData *data, WAbstractCreatorComponent *delegate) {
+        for (const auto &d : std::as_const(data->delegateDatas)) {
+            if (d.first != delegate)
+                continue;
+            return d.second ? d.second.lock()->object.get() : nullptr;
+        }
+
+        return nullptr;
+    }
+
+    // The object created by the first delegate in the order of delegates
+    inline QObject *firstObjectOf(const WQmlCreatorData *data) const {
+        for (auto delegate : std::as_const(delegates)) {
+            if (auto obj = objectOf(data, delegate))
+                return obj;
+        }
+
+        return nullptr;
+    }
+
     QList<WAbstractCreatorComponent*> delegates;
     QList<QSharedPointer<WQmlCreatorData>> datas;
+    // Index of datas by owner, keeps the order of adding
+    QHash<QObject*, QList<QSharedPointer<WQmlCreatorData>>> ownerDatas;
 };
 
 WAYLIB_SERVER_END_NAMESPACE
@@ -8,6 +8,9 @@
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+class WBufferRenderer;
+class WThumbnailProvider;
+class WSGTextureProvider;
 class Q_DECL_HIDDEN WQuickTextureProxyPrivate : public WObjectPrivate
 {
 public:
@@ -21,6 +24,11 @@ public:
 
     void initSourceItem(QQuickItem *old, QQuickItem *item);
     void updateImplicitSize();
+    void reinitSourceItem();
+    QSGTextureProvider *sourceTextureProvider() const;
+    QRectF textureSourceRect(const QSGTexture *texture) const;
+    int calculateLodLevel() const;
+    void updateLodConnection();
 
     W_DECLARE_PUBLIC(WQuickTextureProxy)
 
@@ -28,6 +36,19 @@ public:
     QRectF sourceRect;
     bool hideSource = false;
     bool mipmap = false;
+    bool thumbnail = false;
+    bool snapshot = false;
+    QString snapshotKey;
+
+    // only valid in thumbnail or snapshot mode
+    QPointer<WThumbnailProvider> thumbnailProvider;
+    QPointer<WBufferRenderer> thumbnailRenderer;
+    // only valid if a cached snapshot of snapshotKey is used
+    QPointer<WSGTextureProvider> snapshotTextureProvider;
+
+    // level of detail, only used if mipmap is enabled
+    int lodLevel = 0;
+    QMetaObject::Connection lodConnection;
 };
 
 WAYLIB_SERVER_END_NAMESPACE
@@ -0,0 +1,166 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wrhipipelinecache_p.h"
+
+#include <QCryptographicHash>
+#include <QDir>
+#include <QFile>
+#include <QLoggingCategory>
+#include <QSaveFile>
+#include <QStandardPaths>
+#include <QSysInfo>
+#include <QTimerEvent>
+
+#include <private/qrhi_p.h>
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcPipelineCache, "waylib.server.pipelinecache", QtWarningMsg)
+
+namespace {
+struct CacheHeader
+{
+    char magic[4];
+    quint32 version;
+    quint32 dataSize;
+    quint16 checksum;
+    quint16 reserved;
+};
+}
+
+static constexpr char CacheMagic[4] = { 'W', 'P', 'L', 'C' };
+static constexpr quint32 CacheVersion = 1;
+static constexpr qint64 DefaultMaxSize = 32 * 1024 * 1024;
+// The first save is after the effects used at startup are created,
+// the pipelines created later are saved in a while.
+static constexpr int FirstSaveDelay = 10 * 1000;
+static constexpr int SaveInterval = 5 * 60 * 1000;
+
+static qint64 maxCacheSize()
+{
+    bool ok = false;
+    const int size = qEnvironmentVariableIntValue("WAYLIB_PIPELINE_CACHE_MAX_SIZE", &ok);
+    return ok && size > 0 ? qint64(size) * 1024 * 1024 : DefaultMaxSize;
+}
+
+WRhiPipelineCache::WRhiPipelineCache(QRhi *rhi, QObject *parent)
+    : QObject(parent)
+    , m_rhi(rhi)
+{
+    const QRhiDriverInfo info = rhi->driverInfo();
+    // The shaders of Qt Quick may change in the other Qt versions. The driver's version is
+    // in the device name of OpenGL, and in the pipeline cache's header of Vulkan.
+    const QByteArray key = QByteArray(rhi->backendName())
+        + ' ' + QSysInfo::buildAbi().toLatin1()
+        + ' ' + QT_VERSION_STR
+        + ' ' + QByteArray::number(info.vendorId, 16)
+        + ':' + QByteArray::number(info.deviceId, 16)
+        + ' ' + info.deviceName;
+    const auto keyHash = QCryptographicHash::hash(key, QCryptographicHash::Sha1).toHex().left(16);
+
+    m_fileName = QStringLiteral("%1/%2-%3.bin").arg(cacheDirectory(),
+                                                   QString::fromLatin1(rhi->backendName()).toLower(),
+                                                   QString::fromLatin1(keyHash));
+    m_saveTimer.start(FirstSaveDelay, this);
+}
+
+bool WRhiPipelineCache::isEnabled()
+{
+    return !qEnvironmentVariableIntValue("WAYLIB_DISABLE_PIPELINE_CACHE");
+}
+
+QString WRhiPipelineCache::cacheDirectory()
+{
+    return QStandardPaths::writableLocation(QStandardPaths::GenericCacheLocation)
+        + QStringLiteral("/waylib/pipelinecache");
+}
+
+bool WRhiPipelineCache::load()
+{
+    QFile file(m_fileName);
+    if (!file.open(QIODevice::ReadOnly))
+        return false;
+
+    CacheHeader header;
+    const qint64 dataSize = file.size() - qint64(sizeof(header));
+    bool valid = dataSize > 0 && dataSize <= maxCacheSize()
+        && file.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)
+        && memcmp(header.magic, CacheMagic, sizeof(CacheMagic)) == 0
+        && header.version == CacheVersion
+        && header.dataSize == dataSize;
+
+    QByteArray data;
+    if (valid) {
+        data = file.read(dataSize);
+        valid = data.size() == dataSize && qChecksum(data) == header.checksum;
+    }
+
+    if (!valid) {
+        qCWarning(qLcPipelineCache) << "Remove the invalid pipeline cache" << m_fileName;
+        file.remove();
+        return false;
+    }
+
+    // The QRhi ignores the data of the other driver or device
+    m_rhi->setPipelineCacheData(data);
+    m_savedDataHash = qHash(data);
+    qCDebug(qLcPipelineCache) << "Loaded" << data.size() << "bytes of pipeline cache from" << m_fileName;
+
+    return true;
+}
+
+bool WRhiPipelineCache::save()
+{
+    const QByteArray data = m_rhi->pipelineCacheData();
+    if (data.isEmpty())
+        return false;
+
+    const size_t dataHash = qHash(data);
+    if (dataHash == m_savedDataHash)
+        return true;
+
+    if (data.size() > maxCacheSize()) {
+        qCWarning(qLcPipelineCache) << "Don't save the pipeline cache of" << data.size()
+                                    << "bytes, it's larger than the limit" << maxCacheSize();
+        return false;
+    }
+
+    if (!QDir().mkpath(cacheDirectory()))
+        return false;
+
+    CacheHeader header {};
+    memcpy(header.magic, CacheMagic, sizeof(CacheMagic));
+    header.version = CacheVersion;
+    header.dataSize = data.size();
+    header.checksum = qChecksum(data);
+
+    // Write to a temporary file first, the other compositor may be loading it
+    QSaveFile file(m_fileName);
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(qLcPipelineCache) << "Can't save the pipeline cache to" << m_fileName << file.errorString();
+        return false;
+    }
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(data);
+    if (!file.commit()) {
+        qCWarning(qLcPipelineCache) << "Can't save the pipeline cache to" << m_fileName << file.errorString();
+        return false;
+    }
+
+    m_savedDataHash = dataHash;
+    qCDebug(qLcPipelineCache) << "Saved" << data.size() << "bytes of pipeline cache to" << m_fileName;
+
+    return true;
+}
+
+void WRhiPipelineCache::timerEvent(QTimerEvent *event)
+{
+    if (event->timerId() != m_saveTimer.timerId())
+        return QObject::timerEvent(event);
+
+    save();
+    m_saveTimer.start(SaveInterval, this);
+}
+
+WAYLIB_SERVER_END_NAMESPACE
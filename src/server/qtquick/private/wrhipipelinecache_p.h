@@ -0,0 +1,47 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QObject>
+#include <QBasicTimer>
+
+QT_BEGIN_NAMESPACE
+class QRhi;
+QT_END_NAMESPACE
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+// Keep the QRhi's pipeline cache on disk, the shaders and pipelines don't need to be
+// compiled again after the compositor restarts. The QRhi must be created with
+// QRhi::EnablePipelineCacheDataSave. The file is keyed by the backend, the driver and
+// the device, the data is validated before it's given to the QRhi.
+// WAYLIB_DISABLE_PIPELINE_CACHE=1 disables it, WAYLIB_PIPELINE_CACHE_MAX_SIZE is the
+// size limit of the file in MiB.
+class Q_DECL_HIDDEN WRhiPipelineCache : public QObject
+{
+public:
+    explicit WRhiPipelineCache(QRhi *rhi, QObject *parent = nullptr);
+
+    static bool isEnabled();
+    static QString cacheDirectory();
+
+    inline QString fileName() const {
+        return m_fileName;
+    }
+
+    bool load();
+    bool save();
+
+private:
+    void timerEvent(QTimerEvent *event) override;
+
+    QRhi *m_rhi;
+    QString m_fileName;
+    QBasicTimer m_saveTimer;
+    size_t m_savedDataHash = 0;
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -38,6 +38,8 @@ public:
     void updateContentPosition();
     WSurfaceItem *ensureSubsurfaceItem(WSurface *subsurfaceSurface, QQuickItem *parent);
     void updateSubsurfaceContainers();
+    void clearSubsurfaceItems();
+    bool sendEventToFlattenedSurface(QInputEvent *event);
 
     void resizeSurfaceToItemSize(const QSize &itemSize, const QSize &sizeDiff);
     void updateEventItem(bool forceDestroy);
@@ -62,6 +64,10 @@ public:
         return content;
     }
 
+    inline bool flattensSubsurfaces() const {
+        return surfaceFlags.testFlag(WSurfaceItem::FlattenSubsurfaces) && getItemContent();
+    }
+
     Q_DECLARE_PUBLIC(WSurfaceItem)
     QPointer<WSurface> surface;
     QPointer<WToplevelSurface> shellSurface;
@@ -79,6 +85,7 @@ public:
     qreal surfaceSizeRatio = 1.0;
     bool live = true;
     bool subsurfacesVisible = true;
+    WSurface::FrameThrottle invisibleFrameThrottle = WSurface::FrameThrottle::Reduced;
 
     uint32_t beforeRequestResizeSurfaceStateSeq = 0;
     QRectF boundingRect;
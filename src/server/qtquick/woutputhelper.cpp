@@ -19,6 +19,8 @@
 
 #include <QWindow>
 #include <QQuickWindow>
+#include <QTimer>
+#include <QElapsedTimer>
 #ifndef QT_NO_OPENGL
 #include <QOpenGLContext>
 #endif
@@ -37,6 +39,7 @@ public:
         , renderable(r)
         , contentIsDirty(c)
         , needsFrame(n)
+        , adaptiveSync(output->adaptiveSyncEnabled())
     {
         wlr_output_state_init(&state);
 
@@ -58,6 +61,16 @@ public:
             if (renderHelper)
                 renderHelper->setSize(this->output->size());
         }, Qt::QueuedConnection); // reset buffer on later, because it's rendering
+        output->safeConnect(&WOutput::adaptiveSyncEnabledChanged, qq, [this] {
+            adaptiveSync = this->output->adaptiveSyncEnabled();
+        });
+
+        adaptiveSyncTimer.setSingleShot(true);
+        adaptiveSyncTimer.setTimerType(Qt::PreciseTimer);
+        adaptiveSyncTimer.callOnTimeout(qq, [this] {
+            if (renderable && contentIsDirty)
+                Q_EMIT q_func()->requestRender();
+        });
     }
 
     ~WOutputHelperPrivate() {
@@ -87,9 +100,21 @@ public:
 
     inline void update() {
         setContentIsDirty(true);
-        qwoutput()->schedule_frame();
+        // With adaptive sync, the display waits for the next buffer, don't wait
+        // for a frame event if the last one is received
+        if (adaptiveSync && renderable)
+            scheduleAdaptiveSyncRender();
+        else
+            qwoutput()->schedule_frame();
     }
 
+    // The shortest frame interval of the current mode, in nanoseconds
+    inline qint64 minimumFrameInterval() const {
+        const int refresh = qwoutput()->handle()->refresh;
+        return refresh > 0 ? 1000000000000ll / refresh : 0;
+    }
+    void scheduleAdaptiveSyncRender();
+
     W_DECLARE_PUBLIC(WOutputHelper)
     WOutput *output;
     wlr_output_state state;
@@ -100,6 +125,11 @@ public:
     uint renderable:1;
     uint contentIsDirty:1;
     uint needsFrame:1;
+
+    // for adaptive sync
+    bool adaptiveSync = false;
+    QTimer adaptiveSyncTimer;
+    QElapsedTimer lastBufferCommit;
 };
 
 void WOutputHelperPrivate::setRenderable(bool newValue)
@@ -129,9 +159,24 @@ void WOutputHelperPrivate::setNeedsFrame(bool newNeedsFrame)
 void WOutputHelperPrivate::on_frame()
 {
     setRenderable(true);
+    // Let the display stretch the refresh interval when idle
+    if (adaptiveSync && !contentIsDirty && !needsFrame)
+        return;
     Q_EMIT q_func()->requestRender();
 }
 
+void WOutputHelperPrivate::scheduleAdaptiveSyncRender()
+{
+    if (adaptiveSyncTimer.isActive())
+        return;
+
+    // Don't render faster than the highest refresh rate of the display
+    qint64 remaining = 0;
+    if (lastBufferCommit.isValid())
+        remaining = minimumFrameInterval() - lastBufferCommit.nsecsElapsed();
+    adaptiveSyncTimer.start(remaining > 0 ? int((remaining + 999999) / 1000000) : 0);
+}
+
 void WOutputHelperPrivate::on_damage()
 {
     setContentIsDirty(true);
@@ -258,6 +303,8 @@ bool WOutputHelper::commit()
     wlr_output_state state = d->state;
     wlr_output_state_init(&d->state);
     bool ok = d->qwoutput()->commit_state(&state);
+    if (ok && (state.committed & WLR_OUTPUT_STATE_BUFFER))
+        d->lastBufferCommit.start();
     wlr_output_state_finish(&state);
 
     return ok;
@@ -11,10 +11,13 @@
 #include "wqmlhelper_p.h"
 #include "woutputlayer.h"
 #include "wbufferrenderer_p.h"
+#include "wrhipipelinecache_p.h"
 #include "wquicktextureproxy.h"
+#include "wthumbnailprovider.h"
 #include "weventjunkman.h"
 #include "winputdevice.h"
 #include "wseat.h"
+#include "wtools.h"
 
 #include "platformplugin/qwlrootsintegration.h"
 #include "platformplugin/qwlrootscreen.h"
@@ -67,6 +70,9 @@ extern "C" {
 #include <wlr/render/vulkan.h>
 #endif
 #include <wlr/render/gles2.h>
+#include <wlr/render/pass.h>
+#include <wlr/util/box.h>
+#include <wlr/util/region.h>
 }
 
 #include <drm_fourcc.h>
@@ -123,6 +129,7 @@ private:
 };
 
 class OutputLayer;
+class MirrorGeometry;
 class Q_DECL_HIDDEN OutputHelper : public WOutputHelper
 {
     friend class WOutputRenderWindowPrivate;
@@ -132,6 +139,7 @@ public:
             : layer(l)
             , wlrLayer(layer)
             , contentsIsDirty(true)
+            , outsideOutput(false)
         {
 
         }
@@ -149,6 +157,10 @@ public:
         // dirty state
         uint contentsIsDirty:1;
         // end
+        // The layer's item isn't in this output at the last rendering
+        uint outsideOutput:1;
+        // Increase when the renderer renders a new buffer
+        quint64 renderSerial = 0;
 
         QRectF mapRect;
         QRectF noClipMapRect;
@@ -174,6 +186,8 @@ public:
         cleanLayerCompositor();
         cleanCursorRender();
         qDeleteAll(m_layers);
+        clearMirrorTextures();
+        delete m_mirrorSwapchain;
     }
 
     inline void init() {
@@ -242,7 +256,29 @@ public:
     WBufferRenderer *afterRender();
     WBufferRenderer *compositeLayers(const QVector<LayerData*> layers, bool forceShadowRenderer);
     bool commit(WBufferRenderer *buffer);
+    OutputHelper *mirrorSource();
+    bool commitMirror(const OutputHelper *source);
+    qw_buffer *blitMirror(qw_buffer *source, const MirrorGeometry &geometry);
+    qw_texture *mirrorTexture(qw_buffer *source);
+    void clearMirrorTextures();
     bool tryToHardwareCursor(const LayerData *layer);
+    inline bool isHardwareCursor(const LayerData *layer) const {
+        return m_hardwareCursorRenderComplete && layer && m_hardwareCursorLayer == layer;
+    }
+    bool moveHardwareCursor(LayerData *layer, bool onlyTest);
+    inline bool hasPendingCursorMove() const {
+        return m_cursorMoved;
+    }
+    inline void clearCursorMove() {
+        m_cursorMoved = false;
+    }
+    void commitCursorMove();
+
+    inline bool hardwareLayersDisabled() const {
+        // A mirrored output must composite everything into its primary buffer
+        return output()->disableHardwareLayers()
+               || WOutputViewportPrivate::get(output())->mirrorCount > 0;
+    }
 
 private:
     WOutputViewport *m_output = nullptr;
@@ -253,11 +289,32 @@ private:
     BufferRendererProxy *m_cursorLayerProxy = nullptr;
     bool m_cursorDirty = false;
     bool m_hardwareCursorRenderComplete = false;
+    // The state of the last set_cursor, don't set again if it isn't changed
+    const LayerData *m_hardwareCursorLayer = nullptr;
+    wlr_buffer *m_cursorBuffer = nullptr;
+    quint64 m_cursorBufferSerial = 0;
+    QPoint m_cursorHotSpot;
+    // The cursor plane is moved without rendering, it needs a commit
+    bool m_cursorMoved = false;
+
+    bool moveCursorPlane(const LayerData *layer, const QPoint &hotSpot);
 
     // for compositeLayers
     QPointer<WOutputViewport> m_output2;
     QPointer<QQuickItem> m_layerPorxyContainer;
     QList<QPointer<BufferRendererProxy>> m_layerProxys;
+
+    // for mirrors, the last committed buffer and its damage, the
+    // empty damage means the whole buffer is damaged.
+    QPointer<qw_buffer> m_committedBuffer;
+    QRegion m_commitDamage;
+    quint64 m_commitSerial = 0;
+    // only for the mirror output
+    QPointer<OutputHelper> m_mirrorSource;
+    quint64 m_mirrorSerial = 0;
+    qw_swapchain *m_mirrorSwapchain = nullptr;
+    // the textures of the source's buffers, they keep the buffers locked
+    QHash<qw_buffer*, qw_texture*> m_mirrorTextures;
 };
 
 class Q_DECL_HIDDEN OutputLayer
@@ -400,10 +457,24 @@ public:
     inline OutputLayer *ensureOutputLayer(WOutputLayer *layer) {
         if (auto l = getOutputLayer(layer))
             return l;
-        layers.append(new OutputLayer(layer));
-        return layers.last();
+        auto outputLayer = new OutputLayer(layer);
+        layers.append(outputLayer);
+
+        auto onMoved = [this, outputLayer] {
+            onLayerItemMoved(outputLayer);
+        };
+        QObject::connect(layer->parent(), &QQuickItem::xChanged, layer, onMoved);
+        QObject::connect(layer->parent(), &QQuickItem::yChanged, layer, onMoved);
+
+        return outputLayer;
     }
 
+    // for the hardware cursor without rendering
+    bool moveHardwareCursor(OutputLayer *layer, bool onlyTest);
+    bool onlyHardwareCursorsDirty();
+    void onLayerItemMoved(OutputLayer *layer);
+    bool commitHardwareCursorMoves(const QList<OutputHelper*> &outputs);
+
     inline RenderControl *rc() const {
         return static_cast<RenderControl*>(q_func()->renderControl());
     }
@@ -457,11 +528,13 @@ public:
     bool disableLayers = false;
 
     QOpenGLContext *glContext = nullptr;
+    WRhiPipelineCache *pipelineCache = nullptr;
 #ifdef ENABLE_VULKAN_RENDER
     QScopedPointer<QVulkanInstance> vkInstance;
 #endif
 
     QStack<WBufferRenderer*> rendererList;
+    mutable QPointer<WThumbnailProvider> thumbnailProvider;
 };
 
 WOutputRenderWindowPrivate *OutputHelper::renderWindowD() const
@@ -512,7 +585,8 @@ void OutputHelper::detachLayer(OutputLayer *layer)
     Q_ASSERT(index >= 0);
     auto l = m_layers.takeAt(index);
 
-    if (m_cursorLayerProxy && m_cursorLayerProxy->sourceItem() == l->renderer) {
+    if ((m_cursorLayerProxy && m_cursorLayerProxy->sourceItem() == l->renderer)
+        || m_hardwareCursorLayer == l) {
         // Clear hardware cursor
         tryToHardwareCursor(nullptr);
         cleanCursorRender();
@@ -704,6 +778,7 @@ qw_buffer *OutputHelper::renderLayer(LayerData *layer, bool *dontEndRenderAndRet
         }
 
         if (mapRect.isEmpty()) {
+            layer->outsideOutput = true;
             return nullptr;
         }
         Q_ASSERT(!pixelSize.isEmpty());
@@ -747,6 +822,7 @@ qw_buffer *OutputHelper::renderLayer(LayerData *layer, bool *dontEndRenderAndRet
                                               alpha ? DRM_FORMAT_ARGB8888 : DRM_FORMAT_XRGB8888,
                                               WBufferRenderer::DontConfigureSwapchain);
         if (buffer) {
+            ++layer->renderSerial;
             const QRectF sr = QRectF(layer->mapRect.topLeft() - layer->noClipMapRect.topLeft(), layer->mapRect.size());
             const QRectF tr(QPointF(0, 0), layer->mapRect.size());
 
@@ -795,6 +871,7 @@ WBufferRenderer *OutputHelper::afterRender()
     int firstCantRejectLayerIndex = m_layers.size();
 
     for (LayerData *i : std::as_const(m_layers)) {
+        i->outsideOutput = false;
         if (!i->layer->isEnabled())
             continue;
 
@@ -855,7 +932,7 @@ WBufferRenderer *OutputHelper::afterRender()
     {
         // try fallback to cursor plane for the top layer
         auto topLayer = needsCompositeLayers.last();
-        if ((!output()->disableHardwareLayers() || topLayer->layer->forceLayer())
+        if ((!hardwareLayersDisabled() || topLayer->layer->forceLayer())
             && !(ok && layers.last().accepted)
             && (topLayer->layer->layer->flags() & WOutputLayer::Cursor)) {
             if (tryToHardwareCursor(topLayer)) {
@@ -880,7 +957,7 @@ WBufferRenderer *OutputHelper::afterRender()
         // and this layer doesn't want force layer, should fallback
         // to software composite.
         if (needsSoftwareCompositeEndIndex == -1
-            && output()->disableHardwareLayers()
+            && hardwareLayersDisabled()
             && !layer->forceLayer()) {
             needsSoftwareCompositeEndIndex = i;
         }
@@ -1060,15 +1137,269 @@ bool OutputHelper::commit(WBufferRenderer *buffer)
     }
 
     setBuffer(buffer->currentBuffer());
+    const bool keepDamage = m_lastCommitBuffer == buffer;
 
-    if (m_lastCommitBuffer == buffer) {
+    if (keepDamage) {
         if (pixman_region32_not_empty(&buffer->damageRing()->handle()->current))
             setDamage(&buffer->damageRing()->handle()->current);
     }
 
     m_lastCommitBuffer = buffer;
 
-    return WOutputHelper::commit();
+    const bool ok = WOutputHelper::commit();
+    if (ok && WOutputViewportPrivate::get(output())->mirrorCount > 0) {
+        m_committedBuffer = buffer->currentBuffer();
+        m_commitDamage = keepDamage ? WTools::fromPixmanRegion(&buffer->damageRing()->handle()->current)
+                                    : QRegion();
+        ++m_commitSerial;
+    }
+
+    return ok;
+}
+
+class Q_DECL_HIDDEN MirrorGeometry
+{
+public:
+    MirrorGeometry(const QSize &sourceSize, wl_output_transform sourceTransform,
+                   const QSize &targetSize, wl_output_transform targetTransform,
+                   WOutputViewport::MirrorFillMode fillMode)
+        : m_sourceSize(sourceSize)
+        , m_sourceTransform(sourceTransform)
+        , m_targetSize(targetSize)
+        , m_targetTransform(targetTransform)
+        , m_targetLogicalSize(transformedSize(targetSize, targetTransform))
+    {
+        const QSize sourceLogicalSize = transformedSize(sourceSize, sourceTransform);
+        QSize size = m_targetLogicalSize;
+
+        if (fillMode == WOutputViewport::PreserveAspectFit)
+            size = sourceLogicalSize.scaled(m_targetLogicalSize, Qt::KeepAspectRatio);
+        else if (fillMode == WOutputViewport::PreserveAspectCrop)
+            size = sourceLogicalSize.scaled(m_targetLogicalSize, Qt::KeepAspectRatioByExpanding);
+
+        m_logicalRect = QRect(QPoint((m_targetLogicalSize.width() - size.width()) / 2,
+                                     (m_targetLogicalSize.height() - size.height()) / 2),
+                              size);
+        m_xScale = qreal(size.width()) / sourceLogicalSize.width();
+        m_yScale = qreal(size.height()) / sourceLogicalSize.height();
+    }
+
+    inline bool isIdentity() const {
+        return m_sourceSize == m_targetSize && m_sourceTransform == m_targetTransform;
+    }
+
+    inline bool hasBorder() const {
+        return !m_logicalRect.contains(QRect(QPoint(0, 0), m_targetLogicalSize));
+    }
+
+    inline wl_output_transform textureTransform() const {
+        return wlr_output_transform_compose(wlr_output_transform_invert(m_sourceTransform),
+                                            m_targetTransform);
+    }
+
+    wlr_box targetBox() const {
+        wlr_box box {
+            .x = m_logicalRect.x(),
+            .y = m_logicalRect.y(),
+            .width = m_logicalRect.width(),
+            .height = m_logicalRect.height(),
+        };
+        wlr_box_transform(&box, &box, wlr_output_transform_invert(m_targetTransform),
+                          m_targetLogicalSize.width(), m_targetLogicalSize.height());
+        return box;
+    }
+
+    // map the damage of the source buffer to the target buffer
+    void mapDamage(pixman_region32_t *damage) const {
+        wlr_region_transform(damage, damage, m_sourceTransform,
+                             m_sourceSize.width(), m_sourceSize.height());
+        wlr_region_scale_xy(damage, damage, m_xScale, m_yScale);
+        pixman_region32_translate(damage, m_logicalRect.x(), m_logicalRect.y());
+        wlr_region_transform(damage, damage, wlr_output_transform_invert(m_targetTransform),
+                             m_targetLogicalSize.width(), m_targetLogicalSize.height());
+        pixman_region32_intersect_rect(damage, damage, 0, 0,
+                                       m_targetSize.width(), m_targetSize.height());
+    }
+
+private:
+    static inline QSize transformedSize(const QSize &size, wl_output_transform t) {
+        return (t & WL_OUTPUT_TRANSFORM_90) ? size.transposed() : size;
+    }
+
+    QSize m_sourceSize;
+    wl_output_transform m_sourceTransform;
+    QSize m_targetSize;
+    wl_output_transform m_targetTransform;
+    QSize m_targetLogicalSize;
+    QRect m_logicalRect;
+    qreal m_xScale;
+    qreal m_yScale;
+};
+
+// The helper of the mirrored output, nullptr if the scene should be rendered
+OutputHelper *OutputHelper::mirrorSource()
+{
+    auto source = output()->mirrorSource();
+    const int index = source ? renderWindowD()->indexOfOutputHelper(source) : -1;
+    OutputHelper *helper = index >= 0 ? renderWindowD()->outputs.at(index) : nullptr;
+    // The disabled output doesn't commit any buffer
+    if (helper && !source->output()->isEnabled())
+        helper = nullptr;
+
+    if (m_mirrorSource != helper) {
+        m_mirrorSource = helper;
+        m_mirrorSerial = 0;
+        clearMirrorTextures();
+        // The last frame is of the old source
+        update();
+    }
+
+    return helper;
+}
+
+// Present the source's last committed buffer without rendering the scene,
+// scan out it directly if possible, otherwise do a scaled blit.
+bool OutputHelper::commitMirror(const OutputHelper *source)
+{
+    const bool hasNewContent = m_mirrorSerial != source->m_commitSerial;
+    if (!hasNewContent && !contentIsDirty()) {
+        if (!needsFrame() || !renderable())
+            return false;
+
+        const bool ok = WOutputHelper::commit();
+        resetState(ok);
+        return ok;
+    }
+
+    qw_buffer *sourceBuffer = source->m_committedBuffer;
+    if (!sourceBuffer)
+        return false;
+
+    if (!renderable()) {
+        // Wait for the frame event of this output
+        if (hasNewContent)
+            update();
+        return false;
+    }
+
+    const bool fullDamage = contentIsDirty() || source->m_commitDamage.isEmpty()
+                            || m_mirrorSerial + 1 != source->m_commitSerial;
+    m_mirrorSerial = source->m_commitSerial;
+
+    const MirrorGeometry geometry(QSize(sourceBuffer->handle()->width, sourceBuffer->handle()->height),
+                                  source->qwoutput()->handle()->transform,
+                                  output()->output()->size(),
+                                  qwoutput()->handle()->transform,
+                                  output()->mirrorFillMode());
+
+    pixman_region32_t damage;
+    pixman_region32_init(&damage);
+    if (!fullDamage)
+        WTools::toPixmanRegion(source->m_commitDamage, &damage);
+
+    bool ok = false;
+    if (geometry.isIdentity() && testCommit(sourceBuffer, {})) {
+        setBuffer(sourceBuffer);
+        if (!fullDamage)
+            setDamage(&damage);
+        ok = WOutputHelper::commit();
+    } else if (auto buffer = blitMirror(sourceBuffer, geometry)) {
+        setBuffer(buffer);
+        buffer->unlock();
+
+        if (!fullDamage) {
+            geometry.mapDamage(&damage);
+            setDamage(&damage);
+        }
+        ok = WOutputHelper::commit();
+    }
+
+    pixman_region32_fini(&damage);
+    resetState(ok);
+
+    return ok;
+}
+
+qw_buffer *OutputHelper::blitMirror(qw_buffer *source, const MirrorGeometry &geometry)
+{
+    const QSize pixelSize = output()->output()->size();
+    if (!output()->output()->configurePrimarySwapchain(pixelSize, qwoutput()->handle()->render_format,
+                                                       &m_mirrorSwapchain)) {
+        return nullptr;
+    }
+
+    auto wbuffer = m_mirrorSwapchain->acquire();
+    if (!wbuffer)
+        return nullptr;
+    auto buffer = qw_buffer::from(wbuffer);
+
+    auto renderer = renderWindow()->renderer()->handle();
+    auto texture = mirrorTexture(source);
+    auto pass = texture ? wlr_renderer_begin_buffer_pass(renderer, wbuffer, nullptr) : nullptr;
+    if (!pass) {
+        buffer->unlock();
+        return nullptr;
+    }
+
+    if (geometry.hasBorder()) {
+        wlr_render_rect_options rect {};
+        rect.box = { .x = 0, .y = 0, .width = pixelSize.width(), .height = pixelSize.height() };
+        rect.color = { .r = 0, .g = 0, .b = 0, .a = 1 };
+        rect.blend_mode = WLR_RENDER_BLEND_MODE_NONE;
+        wlr_render_pass_add_rect(pass, &rect);
+    }
+
+    wlr_render_texture_options options {};
+    options.texture = texture->handle();
+    options.dst_box = geometry.targetBox();
+    options.transform = geometry.textureTransform();
+    options.filter_mode = WLR_SCALE_FILTER_BILINEAR;
+    options.blend_mode = WLR_RENDER_BLEND_MODE_NONE;
+    wlr_render_pass_add_texture(pass, &options);
+
+    if (!wlr_render_pass_submit(pass)) {
+        buffer->unlock();
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+// The source output reuses the buffers of its swapchain, import each of them once
+qw_texture *OutputHelper::mirrorTexture(qw_buffer *source)
+{
+    // The textures hold the buffers, release the ones the source's swapchain dropped
+    for (auto i = m_mirrorTextures.begin(); i != m_mirrorTextures.end();) {
+        if (i.key() != source && i.key()->handle()->dropped) {
+            delete i.value();
+            i = m_mirrorTextures.erase(i);
+        } else {
+            ++i;
+        }
+    }
+
+    if (auto texture = m_mirrorTextures.value(source))
+        return texture;
+
+    auto texture = qw_texture::from_buffer(*renderWindow()->renderer(), *source);
+    if (!texture)
+        return nullptr;
+
+    m_mirrorTextures.insert(source, texture);
+    connect(source, &qw_buffer::before_destroy, this, [this, source] {
+        delete m_mirrorTextures.take(source);
+    });
+
+    return texture;
+}
+
+void OutputHelper::clearMirrorTextures()
+{
+    for (auto i = m_mirrorTextures.constBegin(); i != m_mirrorTextures.constEnd(); ++i) {
+        i.key()->disconnect(this);
+        delete i.value();
+    }
+    m_mirrorTextures.clear();
 }
 
 bool OutputHelper::tryToHardwareCursor(const LayerData *layer)
@@ -1085,6 +1416,8 @@ bool OutputHelper::tryToHardwareCursor(const LayerData *layer)
             if (set_cursor)
                 set_cursor(qwoutput()->handle(), buffer, 0, 0);
             m_hardwareCursorRenderComplete = false;
+            m_hardwareCursorLayer = nullptr;
+            m_cursorBuffer = nullptr;
             return true;
         }
 
@@ -1100,6 +1433,7 @@ bool OutputHelper::tryToHardwareCursor(const LayerData *layer)
         auto get_cursor_sizes = qwoutput()->handle()->impl->get_cursor_sizes;
         auto get_cursor_formsts = qwoutput()->handle()->impl->get_cursor_formats;
         bool needsRepaintCursor = get_cursor_sizes && get_cursor_formsts;
+        bool cursorRepainted = false;
 
         if (get_cursor_sizes) {
             bool foundTargetSize = false;
@@ -1158,6 +1492,7 @@ bool OutputHelper::tryToHardwareCursor(const LayerData *layer)
                 if (newBuffer) {
                     m_cursorRenderer->render(0, {});
                     m_cursorRenderer->endRender();
+                    cursorRepainted = true;
                 }
 
                 m_cursorDirty = false;
@@ -1174,34 +1509,89 @@ bool OutputHelper::tryToHardwareCursor(const LayerData *layer)
 
         const auto hotSpot = layer->renderMatrix.map(layer->layer->layer->cursorHotSpot()
                                                      * devicePixelRatio()).toPoint();
-        if (!set_cursor(qwoutput()->handle(), buffer, hotSpot.x(), hotSpot.y())) {
-            break;
-        } else {
+        const bool cursorChanged = !isHardwareCursor(layer) || cursorRepainted
+                                   || buffer != m_cursorBuffer || hotSpot != m_cursorHotSpot
+                                   || layer->renderSerial != m_cursorBufferSerial;
+        if (cursorChanged) {
+            if (!set_cursor(qwoutput()->handle(), buffer, hotSpot.x(), hotSpot.y()))
+                break;
+
             m_hardwareCursorRenderComplete = true;
+            m_hardwareCursorLayer = layer;
+            m_cursorBuffer = buffer;
+            m_cursorBufferSerial = layer->renderSerial;
+            m_cursorHotSpot = hotSpot;
             resetGlState();
         }
 
-        const auto pos = layer->mapToOutput.topLeft() + hotSpot;
-        wlr_box cleanTransform {.x = pos.x(), .y = pos.y()};
-        const auto outputSize = output()->output()->size();
-        // the layer->mapRect has been transform in renderLayer, but
-        // wlroot's move_cursor also will transform the cursor's position.
-        // so revert transform here.
-        wlr_box_transform(&cleanTransform, &cleanTransform,
-                          qwoutput()->handle()->transform,
-                          outputSize.width(), outputSize.height());
-        if (!move_cursor(qwoutput()->handle(), cleanTransform.x, cleanTransform.y)) {
+        if (!moveCursorPlane(layer, hotSpot))
             break;
-        }
 
         return true;
     } while (false);
 
+    m_hardwareCursorLayer = nullptr;
+    m_cursorBuffer = nullptr;
     resetGlState();
 
     return false;
 }
 
+bool OutputHelper::moveCursorPlane(const LayerData *layer, const QPoint &hotSpot)
+{
+    const auto pos = layer->mapToOutput.topLeft() + hotSpot;
+    wlr_box cleanTransform {.x = pos.x(), .y = pos.y()};
+    const auto outputSize = output()->output()->size();
+    // the layer->mapRect has been transform in renderLayer, but
+    // wlroot's move_cursor also will transform the cursor's position.
+    // so revert transform here.
+    wlr_box_transform(&cleanTransform, &cleanTransform,
+                      qwoutput()->handle()->transform,
+                      outputSize.width(), outputSize.height());
+    return qwoutput()->handle()->impl->move_cursor(qwoutput()->handle(),
+                                                   cleanTransform.x, cleanTransform.y);
+}
+
+// Move the cursor plane to the new position of the layer's item without rendering,
+// return false if this output needs to render the scene for the new position.
+bool OutputHelper::moveHardwareCursor(LayerData *layer, bool onlyTest)
+{
+    auto source = layer->layer->layer->parent();
+    if (layer->mapFrom || !source->parentItem() || source->window() != renderWindow())
+        return false;
+
+    const auto outputMatrix = output()->mapToViewport(source->parentItem())
+                              * output()->sourceRectToTargetRectTransfrom();
+    const QRectF newRect = outputMatrix.mapRect(QRectF(source->position(), source->size()));
+    const QRectF outputRect(QPointF(0, 0), output()->size());
+
+    if (!isHardwareCursor(layer))
+        return layer->outsideOutput && !newRect.intersects(outputRect);
+
+    // The cursor clipped by the output's edge needs to render again, see renderLayer
+    const QRectF mapRect(newRect.topLeft(), layer->mapRect.size());
+    if (layer->mapRect != layer->noClipMapRect || !outputRect.contains(mapRect))
+        return false;
+    if (onlyTest || mapRect == layer->mapRect)
+        return true;
+
+    layer->mapRect = mapRect;
+    layer->noClipMapRect = mapRect;
+    layer->mapToOutput.moveTopLeft((mapRect.topLeft() * devicePixelRatio()).toPoint());
+    if (!moveCursorPlane(layer, m_cursorHotSpot))
+        return false;
+
+    m_cursorMoved = true;
+    return true;
+}
+
+void OutputHelper::commitCursorMove()
+{
+    m_cursorMoved = false;
+    const bool ok = WOutputHelper::commit();
+    resetState(ok);
+}
+
 int WOutputRenderWindowPrivate::indexOfOutputHelper(const WOutputViewport *output) const
 {
     for (int i = 0; i < outputs.size(); ++i) {
@@ -1268,6 +1658,9 @@ void WOutputRenderWindowPrivate::init()
                      q, [q, this] {
         if (inRendering)
             return;
+        // The hardware cursors are moved without rendering, see onLayerItemMoved
+        if (dirtyItemList && itemsToPolish.isEmpty() && onlyHardwareCursorsDirty())
+            return;
         q->update();
     });
 
@@ -1353,12 +1746,31 @@ bool WOutputRenderWindowPrivate::initRCWithRhi()
     QOffscreenSurface *offscreenSurface = new QW::OffscreenSurface(nullptr, q);
     offscreenSurface->create();
 
+    const bool pipelineCacheEnabled = WRhiPipelineCache::isEnabled();
+    QQuickGraphicsConfiguration config = q->graphicsConfiguration();
+    if (pipelineCacheEnabled) {
+        // Only let the QRhi be created with QRhi::EnablePipelineCacheDataSave, the
+        // cache file is loaded and saved by WRhiPipelineCache instead of Qt Quick.
+        config.setPipelineCacheSaveFile(WRhiPipelineCache::cacheDirectory());
+        config.setAutomaticPipelineCache(false);
+        q->setGraphicsConfiguration(config);
+    }
+
     QSGRhiSupport::RhiCreateResult result = rhiSupport->createRhi(q, offscreenSurface);
+    if (pipelineCacheEnabled) {
+        config.setPipelineCacheSaveFile(QString());
+        q->setGraphicsConfiguration(config);
+    }
     if (!result.rhi) {
         qWarning("WOutput::initRhi: Failed to initialize QRhi");
         return false;
     }
 
+    if (pipelineCacheEnabled && result.rhi->flags().testFlag(QRhi::EnablePipelineCacheDataSave)) {
+        pipelineCache = new WRhiPipelineCache(result.rhi, q);
+        pipelineCache->load();
+    }
+
     rcd->rhi = result.rhi;
     // Ensure the QQuickRenderControl don't reinit the RHI
     rcd->ownRhi = true;
@@ -1405,6 +1817,10 @@ WOutputRenderWindowPrivate::doRenderOutputs(const QList<OutputHelper*> &outputs,
     QVector<OutputHelper*> renderResults;
     renderResults.reserve(outputs.size());
     for (OutputHelper *helper : std::as_const(outputs)) {
+        // Mirrors reuse the buffer committed by their source, see doRender
+        if (helper->mirrorSource())
+            continue;
+
         if (Q_LIKELY(!forceRender)) {
             if (!helper->renderable()
                 || Q_UNLIKELY(!WOutputViewportPrivate::get(helper->output())->renderable())
@@ -1470,11 +1886,95 @@ static void QQuickAnimatorController_advance(QQuickAnimatorController *ac)
         ac->m_window->update();
 }
 
+bool WOutputRenderWindowPrivate::moveHardwareCursor(OutputLayer *layer, bool onlyTest)
+{
+    if (!(layer->layer->flags() & WOutputLayer::Cursor))
+        return false;
+
+    for (OutputHelper *helper : std::as_const(outputs)) {
+        if (helper->mirrorSource())
+            continue;
+        // The item without layer on this output is rendered in the scene
+        auto layerData = helper->getLayer(layer);
+        if (!layerData || !helper->moveHardwareCursor(layerData, onlyTest))
+            return false;
+    }
+
+    return true;
+}
+
+bool WOutputRenderWindowPrivate::onlyHardwareCursorsDirty()
+{
+    for (QQuickItem *item = dirtyItemList; item; item = QQuickItemPrivate::get(item)->nextDirtyItem) {
+        if (QQuickItemPrivate::get(item)->dirtyAttributes & ~QQuickItemPrivate::Position)
+            return false;
+
+        auto it = std::find_if(layers.constBegin(), layers.constEnd(), [item] (const OutputLayer *layer) {
+            return layer->layer->parent() == item;
+        });
+        if (it == layers.constEnd() || !moveHardwareCursor(*it, true))
+            return false;
+    }
+
+    return true;
+}
+
+void WOutputRenderWindowPrivate::onLayerItemMoved(OutputLayer *layer)
+{
+    if (inRendering || !isInitialized()
+        || !(layer->layer->flags() & WOutputLayer::Cursor)) {
+        return;
+    }
+
+    if (!moveHardwareCursor(layer, false))
+        q_func()->update();
+}
+
+// Commit the outputs which need a frame only for the moved hardware cursors,
+// without polishing, syncing and rendering the scene.
+bool WOutputRenderWindowPrivate::commitHardwareCursorMoves(const QList<OutputHelper*> &outputs)
+{
+    if (!itemsToPolish.isEmpty() || !onlyHardwareCursorsDirty())
+        return false;
+
+    bool hasCursorMove = false;
+    for (OutputHelper *helper : outputs) {
+        if (helper->contentIsDirty())
+            return false;
+        if (helper->hasPendingCursorMove())
+            hasCursorMove = true;
+        else if (helper->needsFrame() && helper->renderable())
+            return false;
+    }
+
+    if (!hasCursorMove)
+        return false;
+
+    for (OutputHelper *helper : outputs) {
+        if (!helper->hasPendingCursorMove())
+            continue;
+        if (!helper->needsFrame()) {
+            helper->clearCursorMove();
+            continue;
+        }
+        // Wait for the frame event
+        if (!helper->renderable())
+            continue;
+        helper->commitCursorMove();
+    }
+
+    return true;
+}
+
 void WOutputRenderWindowPrivate::doRender(const QList<OutputHelper *> &outputs,
                                           bool forceRender, bool doCommit)
 {
     Q_ASSERT(rendererList.isEmpty());
     Q_ASSERT(!inRendering);
+
+    if (!forceRender && doCommit && commitHardwareCursorMoves(outputs))
+        return;
+
     inRendering = true;
 
     W_Q(WOutputRenderWindow);
@@ -1510,8 +2010,20 @@ void WOutputRenderWindowPrivate::doRender(const QList<OutputHelper *> &outputs,
 
             i.first->resetState(ok);
         }
+
+        for (OutputHelper *helper : std::as_const(outputs)) {
+            auto source = helper->mirrorSource();
+            if (!source || !helper->output()->output()->isEnabled())
+                continue;
+
+            helper->commitMirror(source);
+        }
     }
 
+    // The cursor plane's position is committed by the above
+    for (OutputHelper *helper : outputs)
+        helper->clearCursorMove();
+
     resetGlState();
 
     // On Intel&Nvidia multi-GPU environment, wlroots using Intel card do render for all
@@ -1549,8 +2061,16 @@ WOutputRenderWindow::WOutputRenderWindow(QObject *parent)
 
 WOutputRenderWindow::~WOutputRenderWindow()
 {
+    Q_D(WOutputRenderWindow);
     qGuiApp->removeEventFilter(this);
 
+    // Before the QRhi is destroyed in QQuickRenderControl::invalidate
+    if (d->pipelineCache) {
+        d->pipelineCache->save();
+        delete d->pipelineCache;
+        d->pipelineCache = nullptr;
+    }
+
     renderControl()->disconnect(this);
     renderControl()->invalidate();
     renderControl()->deleteLater();
@@ -1846,6 +2366,14 @@ void WOutputRenderWindow::setDisableLayers(bool newDisableLayers)
     Q_EMIT disableLayersChanged();
 }
 
+WThumbnailProvider *WOutputRenderWindow::thumbnailProvider() const
+{
+    Q_D(const WOutputRenderWindow);
+    if (!d->thumbnailProvider)
+        d->thumbnailProvider = new WThumbnailProvider(const_cast<WOutputRenderWindow*>(this));
+    return d->thumbnailProvider;
+}
+
 void WOutputRenderWindow::render()
 {
     Q_D(WOutputRenderWindow);
@@ -11,12 +11,14 @@
 #include <QQmlParserStatus>
 
 Q_MOC_INCLUDE(<wquickoutputlayout.h>)
+Q_MOC_INCLUDE(<wthumbnailprovider.h>)
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
 class WOutputViewport;
 class WOutputLayer;
 class WBufferRenderer;
+class WThumbnailProvider;
 class WOutputRenderWindowPrivate;
 class WAYLIB_SERVER_EXPORT WOutputRenderWindow : public QQuickWindow, public QQmlParserStatus
 {
@@ -25,6 +27,7 @@ class WAYLIB_SERVER_EXPORT WOutputRenderWindow : public QQuickWindow, public QQm
     Q_PROPERTY(qreal width READ width WRITE setWidth NOTIFY widthChanged)
     Q_PROPERTY(qreal height READ height WRITE setHeight NOTIFY heightChanged)
     Q_PROPERTY(bool disableLayers READ disableLayers WRITE setDisableLayers NOTIFY disableLayersChanged FINAL)
+    Q_PROPERTY(WAYLIB_SERVER_NAMESPACE::WThumbnailProvider* thumbnailProvider READ thumbnailProvider CONSTANT FINAL)
     QML_NAMED_ELEMENT(OutputRenderWindow)
     Q_INTERFACES(QQmlParserStatus)
 
@@ -60,6 +63,8 @@ public:
     bool disableLayers() const;
     void setDisableLayers(bool newDisableLayers);
 
+    WThumbnailProvider *thumbnailProvider() const;
+
 public Q_SLOTS:
     void render();
     void render(WOutputViewport *output, bool doCommit);
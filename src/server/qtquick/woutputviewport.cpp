@@ -103,6 +103,19 @@ void WOutputViewportPrivate::setExtraRenderSource(QQuickItem *source)
     updateRenderBufferSource();
 }
 
+void WOutputViewportPrivate::updateMirrorSourceOutput()
+{
+    QObject::disconnect(mirrorSourceEnabledConnection);
+    if (auto sourceOutput = mirrorSource ? mirrorSource->output() : nullptr) {
+        mirrorSourceEnabledConnection = QObject::connect(sourceOutput, &WOutput::enabledChanged,
+                                                         q_func(), [this] {
+            update();
+        });
+    }
+
+    update();
+}
+
 WOutputViewport::WOutputViewport(QQuickItem *parent)
     : QQuickItem(*new WOutputViewportPrivate(), parent)
 {
@@ -111,6 +124,13 @@ WOutputViewport::WOutputViewport(QQuickItem *parent)
 
 WOutputViewport::~WOutputViewport()
 {
+    W_D(WOutputViewport);
+    if (d->mirrorSource) {
+        --WOutputViewportPrivate::get(d->mirrorSource)->mirrorCount;
+        d->mirrorSource->disconnect(this);
+    }
+    QObject::disconnect(d->mirrorSourceEnabledConnection);
+
     invalidate();
 }
 
@@ -493,6 +513,72 @@ void WOutputViewport::setDepends(const QList<WOutputViewport *> &newDepends)
     Q_EMIT dependsChanged();
 }
 
+WOutputViewport *WOutputViewport::mirrorSource() const
+{
+    W_DC(WOutputViewport);
+    return d->mirrorSource;
+}
+
+void WOutputViewport::setMirrorSource(WOutputViewport *newMirrorSource)
+{
+    W_D(WOutputViewport);
+    if (d->mirrorSource == newMirrorSource)
+        return;
+
+    if (newMirrorSource == this) {
+        qmlWarning(this) << "Can't mirror itself.";
+        return;
+    }
+
+    // The source must composite all layers into its primary buffer while mirrored
+    if (d->mirrorSource) {
+        auto sd = WOutputViewportPrivate::get(d->mirrorSource);
+        --sd->mirrorCount;
+        sd->update();
+        d->mirrorSource->disconnect(this);
+    }
+    QObject::disconnect(d->mirrorSourceEnabledConnection);
+    d->mirrorSource = newMirrorSource;
+    if (d->mirrorSource) {
+        auto sd = WOutputViewportPrivate::get(d->mirrorSource);
+        ++sd->mirrorCount;
+        sd->update();
+
+        // Render the scene again when the source can't be mirrored
+        connect(d->mirrorSource, &QObject::destroyed, this, [this] {
+            W_D(WOutputViewport);
+            QObject::disconnect(d->mirrorSourceEnabledConnection);
+            d->mirrorSource = nullptr;
+            d->update();
+            Q_EMIT mirrorSourceChanged();
+        });
+        connect(d->mirrorSource, &WOutputViewport::outputChanged, this, [this] {
+            W_D(WOutputViewport);
+            d->updateMirrorSourceOutput();
+        });
+        d->updateMirrorSourceOutput();
+    }
+
+    d->update();
+    Q_EMIT mirrorSourceChanged();
+}
+
+WOutputViewport::MirrorFillMode WOutputViewport::mirrorFillMode() const
+{
+    W_DC(WOutputViewport);
+    return d->mirrorFillMode;
+}
+
+void WOutputViewport::setMirrorFillMode(MirrorFillMode newMirrorFillMode)
+{
+    W_D(WOutputViewport);
+    if (d->mirrorFillMode == newMirrorFillMode)
+        return;
+    d->mirrorFillMode = newMirrorFillMode;
+    d->update();
+    Q_EMIT mirrorFillModeChanged();
+}
+
 void WOutputViewport::setOutputScale(float scale)
 {
     W_D(WOutputViewport);
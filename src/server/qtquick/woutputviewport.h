@@ -35,9 +35,18 @@ class WAYLIB_SERVER_EXPORT WOutputViewport : public QQuickItem, public virtual W
     Q_PROPERTY(QList<WAYLIB_SERVER_NAMESPACE::WOutputLayer*> layers READ layers NOTIFY layersChanged FINAL)
     Q_PROPERTY(QList<WAYLIB_SERVER_NAMESPACE::WOutputLayer*> hardwareLayers READ hardwareLayers NOTIFY hardwareLayersChanged FINAL)
     Q_PROPERTY(QList<WAYLIB_SERVER_NAMESPACE::WOutputViewport*> depends READ depends WRITE setDepends NOTIFY dependsChanged FINAL)
+    Q_PROPERTY(WAYLIB_SERVER_NAMESPACE::WOutputViewport* mirrorSource READ mirrorSource WRITE setMirrorSource NOTIFY mirrorSourceChanged FINAL)
+    Q_PROPERTY(MirrorFillMode mirrorFillMode READ mirrorFillMode WRITE setMirrorFillMode NOTIFY mirrorFillModeChanged FINAL)
     QML_NAMED_ELEMENT(OutputViewport)
 
 public:
+    enum MirrorFillMode {
+        Stretch,
+        PreserveAspectFit,
+        PreserveAspectCrop,
+    };
+    Q_ENUM(MirrorFillMode)
+
     explicit WOutputViewport(QQuickItem *parent = nullptr);
     ~WOutputViewport();
 
@@ -103,6 +112,12 @@ public:
     QList<WOutputViewport *> depends() const;
     void setDepends(const QList<WOutputViewport *> &newDepends);
 
+    WOutputViewport *mirrorSource() const;
+    void setMirrorSource(WOutputViewport *newMirrorSource);
+
+    MirrorFillMode mirrorFillMode() const;
+    void setMirrorFillMode(MirrorFillMode newMirrorFillMode);
+
 public Q_SLOTS:
     void setOutputScale(float scale);
     void rotateOutput(WOutput::Transform t);
@@ -126,6 +141,8 @@ Q_SIGNALS:
     void layersChanged();
     void hardwareLayersChanged();
     void dependsChanged();
+    void mirrorSourceChanged();
+    void mirrorFillModeChanged();
 
 private:
     void componentComplete() override;
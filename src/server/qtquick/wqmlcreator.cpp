@@ -5,8 +5,11 @@
 #include "wxdgsurface.h"
 
 #include <QJSValue>
+#include <QJSValueIterator>
 #include <QQuickItem>
 #include <QQmlInfo>
+#include <QQmlProperty>
+#include <private/qobject_p.h>
 #define private public
 #include <private/qqmlcomponent_p.h>
 #undef private
@@ -105,6 +108,7 @@ WQmlCreatorComponent::~WQmlCreatorComponent()
         creator()->removeDelegate(this);
 
     clear();
+    trimPool(0);
 }
 
 bool WQmlCreatorComponent::checkByChooser(const QJSValue &properties) const
@@ -161,7 +165,7 @@ void WQmlCreatorComponent::destroy(QSharedPointer<WQmlCreatorDelegateData> data)
         Q_EMIT objectRemoved(obj, p);
         notifyCreatorObjectRemoved(creator(), obj, p);
 
-        if (m_autoDestroy) {
+        if (m_autoDestroy && !recycle(obj, p)) {
             obj->setParent(nullptr);
             delete obj;
             obj = nullptr;
@@ -240,47 +244,50 @@ void WQmlCreatorComponent::create(QSharedPointer<WQmlCreatorDelegateData> data,
     // the QVariantMap's property would not update, you will get a invalid QObject pointer
     // if you using it after it's destroyed, but the QJSValue will watching that QObjects,
     // you will get a null pointer if you using after it's destroyed.
-    const auto tmp = qvariant_cast<QVariantMap>(initialProperties.toVariant());
-
+    if (auto obj = reuse(parent, initialProperties)) {
+        data->object = obj;
+    } else {
+        const auto tmp = qvariant_cast<QVariantMap>(initialProperties.toVariant());
 #if QT_VERSION >= QT_VERSION_CHECK(6, 5, 0)
-    auto context = new QQmlContext(qmlContext(this), this);
-    context->setContextProperties(m_contextProperties);
-    data->object = d->createWithProperties(parent, tmp, context);
-    context->setParent(data->object);
+        auto context = new QQmlContext(qmlContext(this), this);
+        context->setContextProperties(m_contextProperties);
+        data->object = d->createWithProperties(parent, tmp, context);
+        context->setParent(data->object);
 #else
-    // The `createWithInitialProperties` provided by QQmlComponent cannot set parent
-    // during the creation process. use `setParent` will too late as the creation has
-    // complete, lead to the windows of WOutputRenderWindow get empty...
-
-    // for Qt 6.5 The createWithInitialProperties with the parent parameter provided by
-    // QQmlComponentPrivate can solve this problem.
-    // Qt 6.4 requires beginCreate -> setInitialProperties/setParent -> completeCreate
-
-    QObject *rv = m_delegate->beginCreate(qmlContext(this));
-    if (rv) {
-        m_delegate->setInitialProperties(rv, tmp);
-        rv->setParent(parent);
-        if (auto item = qobject_cast<QQuickItem*>(rv))
-            item->setParentItem(qobject_cast<QQuickItem*>(parent));
-        m_delegate->completeCreate();
-        if (!d->requiredProperties().empty()) {
-            for (const auto &unsetRequiredProperty : std::as_const(d->requiredProperties())) {
-                const QQmlError error = QQmlComponentPrivate::unsetRequiredPropertyToQQmlError(unsetRequiredProperty);
-                qmlWarning(rv, error);
+        // The `createWithInitialProperties` provided by QQmlComponent cannot set parent
+        // during the creation process. use `setParent` will too late as the creation has
+        // complete, lead to the windows of WOutputRenderWindow get empty...
+
+        // for Qt 6.5 The createWithInitialProperties with the parent parameter provided by
+        // QQmlComponentPrivate can solve this problem.
+        // Qt 6.4 requires beginCreate -> setInitialProperties/setParent -> completeCreate
+
+        QObject *rv = m_delegate->beginCreate(qmlContext(this));
+        if (rv) {
+            m_delegate->setInitialProperties(rv, tmp);
+            rv->setParent(parent);
+            if (auto item = qobject_cast<QQuickItem*>(rv))
+                item->setParentItem(qobject_cast<QQuickItem*>(parent));
+            m_delegate->completeCreate();
+            if (!d->requiredProperties().empty()) {
+                for (const auto &unsetRequiredProperty : std::as_const(d->requiredProperties())) {
+                    const QQmlError error = QQmlComponentPrivate::unsetRequiredPropertyToQQmlError(unsetRequiredProperty);
+                    qmlWarning(rv, error);
+                }
+                d->requiredProperties().clear();
+                rv->deleteLater();
+                rv = nullptr;
             }
-            d->requiredProperties().clear();
-            rv->deleteLater();
-            rv = nullptr;
         }
-    }
-    data->object = rv;
+        data->object = rv;
 #endif
+    }
 
     if (data->object) {
         Q_EMIT objectAdded(data->object, initialProperties);
         notifyCreatorObjectAdded(creator(), data->object, initialProperties);
     } else {
-        qWarning() << "WQmlCreatorComponent::create failed" << "parent=" << parent << "initialProperties=" << tmp;
+        qWarning() << "WQmlCreatorComponent::create failed" << "parent=" << parent << "initialProperties=" << initialProperties.toVariant();
 #if QT_VERSION >= QT_VERSION_CHECK(6, 10, 0)
         for (auto e: d->m_state.errors)
 #else
@@ -368,6 +375,132 @@ void WQmlCreatorComponent::setAutoDestroy(bool newAutoDestroy)
     Q_EMIT autoDestroyChanged();
 }
 
+int WQmlCreatorComponent::poolSize() const
+{
+    return m_poolSize;
+}
+
+// The maximum number of the released objects to keep for reusing, 0 to disable the pool.
+// A pooled object is only reused when the new initial properties contain all of its
+// required properties, and the properties given by its last owner are either given
+// again or resettable. A delegate can define `function resetForReuse()` to restore its
+// own default state instead, it's called before the new properties are assigned.
+void WQmlCreatorComponent::setPoolSize(int newPoolSize)
+{
+    newPoolSize = qMax(0, newPoolSize);
+    if (m_poolSize == newPoolSize)
+        return;
+    m_poolSize = newPoolSize;
+    trimPool(m_poolSize);
+
+    Q_EMIT poolSizeChanged();
+}
+
+bool WQmlCreatorComponent::recycle(QObject *object, const QJSValue &properties)
+{
+    if (m_pool.size() >= m_poolSize)
+        return false;
+
+    // The object is being destroyed by its parent
+    if (QObjectPrivate::get(object)->wasDeleted)
+        return false;
+
+    // Take it out of the scene, keep it alive by this
+    if (auto item = qobject_cast<QQuickItem*>(object))
+        item->setParentItem(nullptr);
+    object->setParent(this);
+
+    QStringList names;
+    QJSValueIterator it(properties);
+    while (it.next())
+        names << it.name();
+
+    m_pool.append({object, object->findChild<QQmlContext*>(QString(), Qt::FindDirectChildrenOnly), names});
+    return true;
+}
+
+bool WQmlCreatorComponent::canReuse(const QObject *object, const QStringList &lastProperties,
+                                    const QJSValue &properties) const
+{
+    const auto mo = object->metaObject();
+
+    // Like creating a new object, all required properties must be given
+    for (int i = 0; i < mo->propertyCount(); ++i) {
+        const auto property = mo->property(i);
+        if (property.isRequired() && !properties.hasOwnProperty(QString::fromUtf8(property.name())))
+            return false;
+    }
+
+    // The delegate restores its default state by itself
+    if (mo->indexOfMethod("resetForReuse()") >= 0)
+        return true;
+
+    // Otherwise every property left by the last owner must be overwritten or resettable
+    for (const auto &name : lastProperties) {
+        if (properties.hasOwnProperty(name))
+            continue;
+        const int index = mo->indexOfProperty(name.toUtf8().constData());
+        if (index < 0 || !mo->property(index).isResettable())
+            return false;
+    }
+
+    return true;
+}
+
+QObject *WQmlCreatorComponent::reuse(QObject *parent, const QJSValue &properties)
+{
+    for (int i = m_pool.size() - 1; i >= 0; --i) {
+        if (!m_pool.at(i).object) {
+            m_pool.removeAt(i);
+            continue;
+        }
+
+        if (!canReuse(m_pool.at(i).object, m_pool.at(i).properties, properties))
+            continue;
+
+        const auto pooled = m_pool.takeAt(i);
+        auto object = pooled.object.get();
+        if (pooled.context)
+            pooled.context->setContextProperties(m_contextProperties);
+
+        // Drop the state of the last owner before assigning the new one
+        const auto mo = object->metaObject();
+        for (const auto &name : pooled.properties) {
+            if (properties.hasOwnProperty(name))
+                continue;
+            const int index = mo->indexOfProperty(name.toUtf8().constData());
+            if (index >= 0 && mo->property(index).isResettable())
+                mo->property(index).reset(object);
+        }
+        if (mo->indexOfMethod("resetForReuse()") >= 0)
+            QMetaObject::invokeMethod(object, "resetForReuse");
+
+        // Reassign the initial and required properties like creating a new object
+        QJSValueIterator it(properties);
+        while (it.next()) {
+            QQmlProperty property(object, it.name());
+            if (!property.isValid() || !property.write(it.value().toVariant()))
+                qmlWarning(object) << "Can't reassign the property" << it.name() << "for the reused object";
+        }
+
+        object->setParent(parent);
+        if (auto item = qobject_cast<QQuickItem*>(object))
+            item->setParentItem(qobject_cast<QQuickItem*>(parent));
+
+        return object;
+    }
+
+    return nullptr;
+}
+
+void WQmlCreatorComponent::trimPool(int size)
+{
+    while (m_pool.size() > size) {
+        const auto pooled = m_pool.takeFirst();
+        delete pooled.object;
+    }
+}
+
 WQmlCreator::WQmlCreator(QObject *parent)
     : QObject{parent}
     , WObject(*new WQmlCreatorPrivate(this))
@@ -420,10 +553,11 @@ void WQmlCreator::add(QObject *owner, const QJSValue &initialProperties)
     d->datas << data;
 
     if (owner) {
-        connect(owner, &QObject::destroyed, this, [this] {
-            bool ok = removeByOwner(sender());
-            Q_ASSERT(ok);
-        });
+        auto &ownerDatas = d->ownerDatas[owner];
+        // All datas of the owner share one connection
+        if (ownerDatas.isEmpty())
+            connect(owner, &QObject::destroyed, this, &WQmlCreator::onOwnerDestroyed);
+        ownerDatas.append(data);
     }
 
     Q_EMIT countChanged();
@@ -436,7 +570,19 @@ bool WQmlCreator::removeIf(QJSValue function)
 
 bool WQmlCreator::removeByOwner(QObject *owner)
 {
-    return remove(indexOfOwner(owner));
+    W_D(WQmlCreator);
+
+    const auto data = d->ownerDatas.value(owner).value(0);
+    if (!data)
+        return false;
+
+    bool ok = d->datas.removeOne(data);
+    Q_ASSERT(ok);
+    destroy(data);
+
+    Q_EMIT countChanged();
+
+    return true;
 }
 
 void WQmlCreator::clear(bool notify)
@@ -450,6 +596,7 @@ void WQmlCreator::clear(bool notify)
         destroy(data);
 
     d->datas.clear();
+    Q_ASSERT(d->ownerDatas.isEmpty());
 
     if (notify)
         Q_EMIT countChanged();
@@ -475,26 +622,19 @@ QObject *WQmlCreator::get(WAbstractCreatorComponent *delegate, int index) const
     if (index < 0 || index >= d->datas.size())
         return nullptr;
 
-    auto data = d->datas.at(index);
-    for (const auto &d : std::as_const(data->delegateDatas)) {
-        if (d.first != delegate)
-            continue;
-        return d.second ? d.second.lock()->object.get() : nullptr;
-    }
-
-    return nullptr;
+    return d->objectOf(d->datas.at(index).get(), delegate);
 }
 
 QObject *WQmlCreator::getIf(QJSValue function) const
 {
     W_DC(WQmlCreator);
 
-    for (auto delegate : std::as_const(d->delegates)) {
-        auto obj = getIf(delegate, function);
-        if (obj)
-            return obj;
-    }
-    return nullptr;
+    // Call the function only once for every data, not once per delegate
+    const int index = indexOf(function);
+    if (index < 0)
+        return nullptr;
+
+    return d->firstObjectOf(d->datas.at(index).get());
 }
 
 QObject *WQmlCreator::getIf(WAbstractCreatorComponent *delegate, QJSValue function) const
@@ -506,26 +646,34 @@ QObject *WQmlCreator::getByOwner(QObject *owner) const
 {
     W_DC(WQmlCreator);
 
-    for (auto delegate : std::as_const(d->delegates)) {
-        auto obj = getByOwner(delegate, owner);
-        if (obj)
-            return obj;
-    }
-    return nullptr;
+    const auto data = d->ownerDatas.value(owner).value(0);
+    return data ? d->firstObjectOf(data.get()) : nullptr;
 }
 
 QObject *WQmlCreator::getByOwner(WAbstractCreatorComponent *delegate, QObject *owner) const
 {
-    return get(delegate, indexOfOwner(owner));
+    W_DC(WQmlCreator);
+
+    const auto data = d->ownerDatas.value(owner).value(0);
+    return data ? d->objectOf(data.get(), delegate) : nullptr;
 }
 
 void WQmlCreator::destroy(QSharedPointer<WQmlCreatorData> data)
 {
-    if (data->owner)
-        data->owner->disconnect(this);
-
     W_D(WQmlCreator);
 
+    if (data->owner) {
+        auto it = d->ownerDatas.find(data->owner);
+        Q_ASSERT(it != d->ownerDatas.end());
+        bool ok = it->removeOne(data);
+        Q_ASSERT(ok);
+
+        if (it->isEmpty()) {
+            d->ownerDatas.erase(it);
+            disconnect(data->owner, &QObject::destroyed, this, &WQmlCreator::onOwnerDestroyed);
+        }
+    }
+
     for (auto delegate : std::as_const(d->delegates))
         delegate->remove(data);
 }
@@ -544,16 +692,13 @@ bool WQmlCreator::remove(int index)
     return true;
 }
 
-int WQmlCreator::indexOfOwner(QObject *owner) const
+void WQmlCreator::onOwnerDestroyed(QObject *owner)
 {
-    W_DC(WQmlCreator);
-
-    for (int i = 0; i < d->datas.size(); ++i) {
-        if (d->datas.at(i)->owner == owner)
-            return i;
-    }
+    W_D(WQmlCreator);
 
-    return -1;
+    Q_ASSERT(d->ownerDatas.contains(owner));
+    while (d->ownerDatas.contains(owner))
+        removeByOwner(owner);
 }
 
 int WQmlCreator::indexOf(QJSValue function) const
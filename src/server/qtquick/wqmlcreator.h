@@ -95,7 +95,7 @@ private:
     void destroy(QSharedPointer<WQmlCreatorData> data);
     bool remove(int index);
 
-    int indexOfOwner(QObject *owner) const;
+    void onOwnerDestroyed(QObject *owner);
     int indexOf(QJSValue function) const;
 
     void addDelegate(WAbstractCreatorComponent *delegate);
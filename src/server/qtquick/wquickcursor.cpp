@@ -23,6 +23,45 @@
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
+// A frame in the atlas of an animated cursor, the frames share the
+// uploaded atlas texture.
+class Q_DECL_HIDDEN CursorFrameTexture : public QSGTexture
+{
+public:
+    void setAtlas(QSGTexture *atlas, const QRect &rect) {
+        this->atlas = atlas;
+        this->rect = rect;
+    }
+
+    qint64 comparisonKey() const override {
+        return atlas->comparisonKey();
+    }
+    QRhiTexture *rhiTexture() const override {
+        return atlas->rhiTexture();
+    }
+    QSize textureSize() const override {
+        return rect.size();
+    }
+    bool hasAlphaChannel() const override {
+        return atlas->hasAlphaChannel();
+    }
+    bool hasMipmaps() const override {
+        return false;
+    }
+    bool isAtlasTexture() const override {
+        return true;
+    }
+    QRectF normalizedTextureSubRect() const override {
+        const QSizeF size = atlas->textureSize();
+        return QRectF(rect.x() / size.width(), rect.y() / size.height(),
+                      rect.width() / size.width(), rect.height() / size.height());
+    }
+
+private:
+    QSGTexture *atlas = nullptr;
+    QRect rect;
+};
+
 class Q_DECL_HIDDEN CursorTextureProvider : public WSGTextureProvider
 {
 public:
@@ -38,10 +77,15 @@ public:
             return;
         }
 
+        // The frames of an animated cursor share the same atlas image
+        if (buffer && image.cacheKey() == imageKey)
+            return;
+
         // WImageBufferImpl destroy following qw_buffer
         auto buffer = qw_buffer::create(new WImageBufferImpl(image),
                                        image.width(), image.height());
         this->buffer.reset(buffer);
+        imageKey = image.cacheKey();
         setBuffer(this->buffer.get());
     }
 
@@ -64,6 +108,14 @@ public:
         Q_EMIT textureChanged();
     }
 
+    void setFrameRect(const QRect &rect) {
+        if (frameRect == rect)
+            return;
+        frameRect = rect;
+        if (!proxy)
+            Q_EMIT textureChanged();
+    }
+
     void resetBuffer() {
         setBuffer(nullptr);
         buffer.reset();
@@ -76,7 +128,13 @@ public:
     QSGTexture *texture() const override {
         if (proxy)
             return proxy->texture();
-        return WSGTextureProvider::texture();
+
+        auto atlas = WSGTextureProvider::texture();
+        if (!atlas || frameRect.isEmpty() || frameRect.size() == atlas->textureSize())
+            return atlas;
+        // Only the current frame of the atlas
+        frameTexture.setAtlas(atlas, frameRect);
+        return &frameTexture;
     }
     qw_texture *qwTexture() const override {
         if (proxy)
@@ -90,6 +148,9 @@ public:
     }
 
     std::unique_ptr<qw_buffer, qw_buffer::droper> buffer;
+    qint64 imageKey = 0;
+    QRect frameRect;
+    mutable CursorFrameTexture frameTexture;
     QPointer<WSGTextureProvider> proxy;
 };
 
@@ -376,7 +437,8 @@ WSGTextureProvider *WQuickCursor::wTextureProvider() const
         if (d->cursorSurfaceItem && d->cursorSurfaceItem->surface())
             d->textureProvider->setProxy(d->cursorSurfaceItem->wTextureProvider());
         else
-            d->textureProvider->setImage(d->cursorImage->image());
+            d->textureProvider->setImage(d->cursorImage->atlas());
+        d->textureProvider->setFrameRect(d->cursorImage->frameRect());
     }
     return d->textureProvider;
 }
@@ -570,8 +632,9 @@ QSGNode *WQuickCursor::updatePaintNode(QSGNode *node, UpdatePaintNodeData *)
     if (d->cursorSurfaceItem && d->cursorSurfaceItem->surface()) {
         tp->setProxy(d->cursorSurfaceItem->wTextureProvider());
     } else {
-        tp->setImage(d->cursorImage->image());
+        tp->setImage(d->cursorImage->atlas());
     }
+    tp->setFrameRect(d->cursorImage->frameRect());
 
     // Ignore the tp->proxy, Don't use tp->qwBuffer()
     if (!tp->buffer) {
@@ -586,7 +649,8 @@ QSGNode *WQuickCursor::updatePaintNode(QSGNode *node, UpdatePaintNodeData *)
 
     imageNode->setTexture(texture);
     imageNode->setOwnsTexture(false);
-    imageNode->setSourceRect(QRectF(QPointF(0, 0), texture->textureSize()));
+    // Switch the frame of animated cursor doesn't need to upload the texture
+    imageNode->setSourceRect(tp->frameRect);
     imageNode->setRect(QRectF(QPointF(0, 0), QSizeF(width(), height())));
     imageNode->setFiltering(smooth() ? QSGTexture::Linear : QSGTexture::Nearest);
     imageNode->setMipmapFiltering(QSGTexture::None);
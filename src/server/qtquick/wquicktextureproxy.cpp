@@ -4,9 +4,18 @@
 
 #include "wquicktextureproxy.h"
 #include "wquicktextureproxy_p.h"
+#include "woutputrenderwindow.h"
+#include "wthumbnailprovider.h"
+#include "wbufferrenderer_p.h"
+#include "wsgtextureprovider.h"
 
 #include <QSGImageNode>
+#include <QQuickWindow>
+#include <rhi/qrhi.h>
 #include <private/qquickitem_p.h>
+#include <private/qsgplaintexture_p.h>
+
+#include <cmath>
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
@@ -21,12 +30,21 @@ void WQuickTextureProxyPrivate::initSourceItem(QQuickItem *old, QQuickItem *item
 {
     W_Q(WQuickTextureProxy);
 
+    // The thumbnail outlives its source, release it even if the source is gone
+    const bool usedThumbnail = thumbnailProvider;
+    if (thumbnailProvider) {
+        thumbnailProvider->release(q);
+        thumbnailRenderer = nullptr;
+        snapshotTextureProvider = nullptr;
+        thumbnailProvider = nullptr;
+    }
+
     if (old) {
         old->disconnect(q);
         QQuickItemPrivate *sd = QQuickItemPrivate::get(old);
         sd->derefFromEffectItem(hideSource);
 
-        if (old->property(LAYER).toBool()) {
+        if (!usedThumbnail && old->property(LAYER).toBool()) {
             sd->layer()->setEnabled(false);
             old->setProperty(LAYER, QVariant());
         }
@@ -36,7 +54,17 @@ void WQuickTextureProxyPrivate::initSourceItem(QQuickItem *old, QQuickItem *item
         QQuickItemPrivate *sd = QQuickItemPrivate::get(item);
         sd->refFromEffectItem(hideSource);
 
-        if (!item->isTextureProvider()) {
+        auto renderWindow = thumbnail || snapshot ? qobject_cast<WOutputRenderWindow*>(q->window())
+                                                  : nullptr;
+        if (renderWindow) {
+            // Shared copy of the source, refreshed at a low rate or frozen for snapshots
+            thumbnailProvider = renderWindow->thumbnailProvider();
+            // Don't render the source again if its snapshot is cached
+            if (snapshot && !snapshotKey.isEmpty())
+                snapshotTextureProvider = thumbnailProvider->snapshot(snapshotKey);
+            if (!snapshotTextureProvider)
+                thumbnailRenderer = thumbnailProvider->acquire(item, q, !snapshot);
+        } else if (!item->isTextureProvider()) {
             item->setProperty(LAYER, true);
             sd->layer()->setEnabled(true);
         }
@@ -47,6 +75,85 @@ void WQuickTextureProxyPrivate::initSourceItem(QQuickItem *old, QQuickItem *item
     updateImplicitSize();
 }
 
+void WQuickTextureProxyPrivate::reinitSourceItem()
+{
+    if (!sourceItem || !q_func()->isComponentComplete())
+        return;
+
+    initSourceItem(sourceItem, nullptr);
+    initSourceItem(nullptr, sourceItem);
+}
+
+QRectF WQuickTextureProxyPrivate::textureSourceRect(const QSGTexture *texture) const
+{
+    if (!sourceRect.isValid())
+        return QRectF(QPointF(0, 0), texture->textureSize());
+
+    if ((thumbnailRenderer || snapshotTextureProvider) && !sourceItem->size().isEmpty()) {
+        // sourceRect is in pixels of the full size source, map it to the thumbnail
+        W_QC(WQuickTextureProxy);
+        const QSizeF fullSize = sourceItem->size() * q->window()->effectiveDevicePixelRatio();
+        const QSizeF textureSize = texture->textureSize();
+        return QTransform::fromScale(textureSize.width() / fullSize.width(),
+                                     textureSize.height() / fullSize.height()).mapRect(sourceRect);
+    }
+
+    return sourceRect;
+}
+
+int WQuickTextureProxyPrivate::calculateLodLevel() const
+{
+    W_QC(WQuickTextureProxy);
+    if (!mipmap || !q->window())
+        return 0;
+
+    const auto tp = sourceTextureProvider();
+    const auto texture = tp ? tp->texture() : nullptr;
+    if (!texture)
+        return 0;
+
+    const QSizeF sourceSize = textureSourceRect(texture).size();
+    if (sourceSize.isEmpty())
+        return 0;
+
+    const QTransform t = QQuickItemPrivate::get(q)->itemToWindowTransform();
+    const qreal dpr = q->window()->effectiveDevicePixelRatio();
+    const qreal xScale = q->width() * std::hypot(t.m11(), t.m12()) * dpr / sourceSize.width();
+    const qreal yScale = q->height() * std::hypot(t.m21(), t.m22()) * dpr / sourceSize.height();
+    const qreal scale = qMax(xScale, yScale);
+
+    // Sampling at up to 2x minification is fine without mipmaps
+    if (scale <= 0 || scale >= 0.5)
+        return 0;
+
+    return qFloor(std::log2(1.0 / scale));
+}
+
+void WQuickTextureProxyPrivate::updateLodConnection()
+{
+    W_Q(WQuickTextureProxy);
+    QObject::disconnect(lodConnection);
+
+    if (!mipmap || !q->window())
+        return;
+
+    // Follow the scale changes of the ancestors
+    lodConnection = QObject::connect(q->window(), &QQuickWindow::beforeSynchronizing, q, [this] {
+        if (calculateLodLevel() != lodLevel)
+            q_func()->update();
+    });
+}
+
+QSGTextureProvider *WQuickTextureProxyPrivate::sourceTextureProvider() const
+{
+    if (thumbnailRenderer)
+        return thumbnailRenderer->textureProvider();
+    if (snapshotTextureProvider)
+        return snapshotTextureProvider;
+
+    return sourceItem ? sourceItem->textureProvider() : nullptr;
+}
+
 void WQuickTextureProxyPrivate::updateImplicitSize()
 {
     if (sourceItem) {
@@ -111,16 +218,78 @@ void WQuickTextureProxy::setMipmap(bool newMipmap)
     if (d->mipmap == newMipmap)
         return;
     d->mipmap = newMipmap;
+    d->updateLodConnection();
     update();
     Q_EMIT mipmapChanged();
 }
 
+bool WQuickTextureProxy::thumbnail() const
+{
+    W_DC(WQuickTextureProxy);
+    return d->thumbnail;
+}
+
+void WQuickTextureProxy::setThumbnail(bool newThumbnail)
+{
+    W_D(WQuickTextureProxy);
+    if (d->thumbnail == newThumbnail)
+        return;
+
+    d->thumbnail = newThumbnail;
+    d->reinitSourceItem();
+
+    update();
+    Q_EMIT thumbnailChanged();
+}
+
+bool WQuickTextureProxy::snapshot() const
+{
+    W_DC(WQuickTextureProxy);
+    return d->snapshot;
+}
+
+void WQuickTextureProxy::setSnapshot(bool newSnapshot)
+{
+    W_D(WQuickTextureProxy);
+    if (d->snapshot == newSnapshot)
+        return;
+
+    d->snapshot = newSnapshot;
+    d->reinitSourceItem();
+
+    update();
+    Q_EMIT snapshotChanged();
+}
+
+QString WQuickTextureProxy::snapshotKey() const
+{
+    W_DC(WQuickTextureProxy);
+    return d->snapshotKey;
+}
+
+void WQuickTextureProxy::setSnapshotKey(const QString &newSnapshotKey)
+{
+    W_D(WQuickTextureProxy);
+    if (d->snapshotKey == newSnapshotKey)
+        return;
+
+    d->snapshotKey = newSnapshotKey;
+    if (d->snapshot)
+        d->reinitSourceItem();
+
+    update();
+    Q_EMIT snapshotKeyChanged();
+}
+
 bool WQuickTextureProxy::isTextureProvider() const
 {
     if (QQuickItem::isTextureProvider())
         return true;
 
     W_DC(WQuickTextureProxy);
+    if (d->thumbnailRenderer || d->snapshotTextureProvider)
+        return true;
+
     return d->sourceItem && d->sourceItem->isTextureProvider();
 }
 
@@ -130,10 +299,7 @@ QSGTextureProvider *WQuickTextureProxy::textureProvider() const
         return QQuickItem::textureProvider();
 
     W_DC(WQuickTextureProxy);
-    if (!d->sourceItem)
-        return nullptr;
-
-    return d->sourceItem->textureProvider();
+    return d->sourceTextureProvider();
 }
 
 void WQuickTextureProxy::setSourceItem(QQuickItem *sourceItem)
@@ -163,12 +329,116 @@ void WQuickTextureProxy::setSourceRect(const QRectF &sourceRect)
     update();
 }
 
+// A mipmapped copy of the source texture, updated only when the source changed
+class Q_DECL_HIDDEN MipmapTexture : public QSGTexture
+{
+public:
+    ~MipmapTexture() override {
+        delete m_texture;
+    }
+
+    void setSource(QSGTexture *source) {
+        if (m_source == source)
+            return;
+        m_source = source;
+        m_dirty = true;
+    }
+
+    inline void markDirty() {
+        m_dirty = true;
+    }
+
+    qint64 comparisonKey() const override {
+        return qint64(qintptr(m_texture));
+    }
+    QRhiTexture *rhiTexture() const override {
+        return m_texture;
+    }
+    QSize textureSize() const override {
+        return m_source ? m_source->textureSize() : QSize();
+    }
+    bool hasAlphaChannel() const override {
+        return m_source ? m_source->hasAlphaChannel() : true;
+    }
+    bool hasMipmaps() const override {
+        return true;
+    }
+
+    void commitTextureOperations(QRhi *rhi, QRhiResourceUpdateBatch *resourceUpdates) override {
+        if (!m_dirty || !m_source)
+            return;
+
+        m_source->commitTextureOperations(rhi, resourceUpdates);
+        auto source = m_source->rhiTexture();
+        if (!source)
+            return;
+
+        if (!m_texture || m_texture->pixelSize() != source->pixelSize()
+            || m_texture->format() != source->format()) {
+            delete m_texture;
+            m_texture = rhi->newTexture(source->format(), source->pixelSize(), 1,
+                                        QRhiTexture::MipMapped | QRhiTexture::UsedWithGenerateMips);
+            if (!m_texture->create()) {
+                delete m_texture;
+                m_texture = nullptr;
+                return;
+            }
+        }
+
+        resourceUpdates->copyTexture(m_texture, source);
+        resourceUpdates->generateMips(m_texture);
+        m_dirty = false;
+    }
+
+private:
+    QPointer<QSGTexture> m_source;
+    QRhiTexture *m_texture = nullptr;
+    bool m_dirty = true;
+};
+
+// Halve the image 'level' times, every pixel is the average of a 2x2 block
+static QImage boxDownscale(const QImage &source, int level)
+{
+    QImage image = source.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+
+    for (int i = 0; i < level && (image.width() > 1 || image.height() > 1); ++i) {
+        QImage result(qMax(1, image.width() / 2), qMax(1, image.height() / 2),
+                      QImage::Format_ARGB32_Premultiplied);
+        const int xStep = image.width() > 1 ? 1 : 0;
+        const int yStep = image.height() > 1 ? 1 : 0;
+
+        for (int y = 0; y < result.height(); ++y) {
+            auto line0 = reinterpret_cast<const QRgb*>(image.constScanLine(y * 2));
+            auto line1 = reinterpret_cast<const QRgb*>(image.constScanLine(y * 2 + yStep));
+            auto target = reinterpret_cast<QRgb*>(result.scanLine(y));
+
+            for (int x = 0; x < result.width(); ++x) {
+                const QRgb p[4] = { line0[x * 2], line0[x * 2 + xStep],
+                                    line1[x * 2], line1[x * 2 + xStep] };
+                int a = 0, r = 0, g = 0, b = 0;
+                for (QRgb c : p) {
+                    a += qAlpha(c);
+                    r += qRed(c);
+                    g += qGreen(c);
+                    b += qBlue(c);
+                }
+                target[x] = qRgba((r + 2) / 4, (g + 2) / 4, (b + 2) / 4, (a + 2) / 4);
+            }
+        }
+
+        image = std::move(result);
+    }
+
+    return image;
+}
+
 class Q_DECL_HIDDEN SGTextureProviderNode : public QObject, public QSGNode
 {
     Q_OBJECT
 public:
-    SGTextureProviderNode()
-        : m_tp(nullptr)
+    SGTextureProviderNode(QQuickWindow *window)
+        : m_window(window)
+        , m_tp(nullptr)
         , m_image(nullptr)
     {
 
@@ -199,7 +469,7 @@ public:
         appendChildNode(image);
         image->setFlag(QSGNode::OwnedByParent);
         if (m_tp) {
-            m_image->setTexture(m_tp->texture());
+            m_image->setTexture(lodTexture(m_tp->texture()));
             Q_ASSERT(m_image->texture());
         }
     }
@@ -208,23 +478,79 @@ public:
         return m_image;
     }
 
+    // 0 means sampling the source texture directly
+    void setLodLevel(int level) {
+        if (m_lodLevel == level)
+            return;
+        m_lodLevel = level;
+
+        // Release the levels once the item grows again
+        if (level == 0) {
+            m_mipmapTexture.reset();
+            m_downscaledTexture.reset();
+        }
+
+        if (m_image && m_tp && m_tp->texture())
+            m_image->setTexture(lodTexture(m_tp->texture()));
+    }
+
+    inline bool usingMipmaps() const {
+        return m_lodLevel > 0 && m_mipmapTexture;
+    }
+
 private:
     void onTextureChanged() {
+        if (m_mipmapTexture)
+            m_mipmapTexture->markDirty();
+        m_downscaledTexture.reset();
+
         if (!m_image)
             return;
 
         auto texture = m_tp ? m_tp->texture() : nullptr;
 
         if (texture) {
-            m_image->setTexture(m_tp->texture());
+            m_image->setTexture(lodTexture(texture));
         } else {
             delete m_image;
             m_image = nullptr;
         }
     }
 
+    QSGTexture *lodTexture(QSGTexture *source) {
+        if (m_lodLevel == 0)
+            return source;
+
+        if (m_window->rendererInterface()->graphicsApi() == QSGRendererInterface::Software) {
+            // No mipmaps in software, use a cached downscaled image instead
+            auto plainTexture = qobject_cast<QSGPlainTexture*>(source);
+            if (!plainTexture || plainTexture->image().isNull())
+                return source;
+
+            if (!m_downscaledTexture || m_downscaledLevel != m_lodLevel) {
+                m_downscaledTexture.reset(m_window->createTextureFromImage(boxDownscale(plainTexture->image(),
+                                                                                        m_lodLevel)));
+                m_downscaledLevel = m_lodLevel;
+            }
+
+            return m_downscaledTexture.get();
+        }
+
+        if (!m_mipmapTexture)
+            m_mipmapTexture.reset(new MipmapTexture);
+        m_mipmapTexture->setSource(source);
+
+        return m_mipmapTexture.get();
+    }
+
+    QQuickWindow *m_window;
     QPointer<QSGTextureProvider> m_tp;
     QSGImageNode *m_image;
+
+    int m_lodLevel = 0;
+    std::unique_ptr<MipmapTexture> m_mipmapTexture;
+    std::unique_ptr<QSGTexture> m_downscaledTexture;
+    int m_downscaledLevel = 0;
 };
 
 QSGNode *WQuickTextureProxy::updatePaintNode(QSGNode *old, QQuickItem::UpdatePaintNodeData *)
@@ -236,7 +562,7 @@ QSGNode *WQuickTextureProxy::updatePaintNode(QSGNode *old, QQuickItem::UpdatePai
         return nullptr;
     }
 
-    const auto tp = d->sourceItem->textureProvider();
+    const auto tp = d->sourceTextureProvider();
     if (Q_LIKELY(!tp || !tp->texture())) {
         if (tp) {
             connect(tp, &QSGTextureProvider::textureChanged,
@@ -248,24 +574,31 @@ QSGNode *WQuickTextureProxy::updatePaintNode(QSGNode *old, QQuickItem::UpdatePai
 
     auto node = static_cast<SGTextureProviderNode*>(old);
     if (Q_UNLIKELY(!node)) {
-        node = new SGTextureProviderNode();
+        node = new SGTextureProviderNode(window());
         node->setImageNode(window()->createImageNode());
     } else if (Q_UNLIKELY(!node->image())) {
         node->setImageNode(window()->createImageNode());
     }
 
+    d->lodLevel = d->calculateLodLevel();
     node->setTextureProvider(tp);
+    node->setLodLevel(d->lodLevel);
     QSGImageNode *imageNode = node->image();
     Q_ASSERT(imageNode);
 
-    QRectF sourceRect = d->sourceRect;
-    if (!sourceRect.isValid())
-        sourceRect = QRectF(QPointF(0, 0), tp->texture()->textureSize());
+    QRectF sourceRect = d->textureSourceRect(tp->texture());
+    // The downscaled texture of software renderer has a smaller size
+    const QSizeF textureSize = tp->texture()->textureSize();
+    const QSizeF imageSize = imageNode->texture()->textureSize();
+    if (imageSize != textureSize && !textureSize.isEmpty()) {
+        sourceRect = QTransform::fromScale(imageSize.width() / textureSize.width(),
+                                           imageSize.height() / textureSize.height()).mapRect(sourceRect);
+    }
 
     imageNode->setSourceRect(sourceRect);
     imageNode->setRect(QRectF(QPointF(0, 0), size()));
     imageNode->setFiltering(smooth() ? QSGTexture::Linear : QSGTexture::Nearest);
-    imageNode->setMipmapFiltering(d->mipmap ? imageNode->filtering() : QSGTexture::None);
+    imageNode->setMipmapFiltering(node->usingMipmaps() ? imageNode->filtering() : QSGTexture::None);
     imageNode->setAnisotropyLevel(antialiasing() ? QSGTexture::Anisotropy4x : QSGTexture::AnisotropyNone);
 
     return node;
@@ -285,8 +618,15 @@ void WQuickTextureProxy::itemChange(ItemChange change, const ItemChangeData &dat
 {
     QQuickItem::itemChange(change, data);
 
+    W_D(WQuickTextureProxy);
+    // The thumbnail provider belongs to the render window
+    if (change == ItemSceneChange && (d->thumbnail || d->snapshot))
+        d->reinitSourceItem();
+    if (change == ItemSceneChange)
+        d->updateLodConnection();
+
     if (change == ItemDevicePixelRatioHasChanged || change == ItemSceneChange)
-        d_func()->updateImplicitSize();
+        d->updateImplicitSize();
 }
 
 WAYLIB_SERVER_END_NAMESPACE
@@ -18,6 +18,9 @@ class WAYLIB_SERVER_EXPORT WQuickTextureProxy : public QQuickItem, public WObjec
     Q_PROPERTY(qreal implicitHeight READ implicitHeight NOTIFY implicitHeightChanged FINAL)
     Q_PROPERTY(bool hideSource READ hideSource WRITE setHideSource NOTIFY hideSourceChanged)
     Q_PROPERTY(bool mipmap READ mipmap WRITE setMipmap NOTIFY mipmapChanged)
+    Q_PROPERTY(bool thumbnail READ thumbnail WRITE setThumbnail NOTIFY thumbnailChanged FINAL)
+    Q_PROPERTY(bool snapshot READ snapshot WRITE setSnapshot NOTIFY snapshotChanged FINAL)
+    Q_PROPERTY(QString snapshotKey READ snapshotKey WRITE setSnapshotKey NOTIFY snapshotKeyChanged FINAL)
     W_DECLARE_PRIVATE(WQuickTextureProxy)
     QML_NAMED_ELEMENT(TextureProxy)
 
@@ -40,12 +43,24 @@ public:
     bool mipmap() const;
     void setMipmap(bool newMipmap);
 
+    bool thumbnail() const;
+    void setThumbnail(bool newThumbnail);
+
+    bool snapshot() const;
+    void setSnapshot(bool newSnapshot);
+
+    QString snapshotKey() const;
+    void setSnapshotKey(const QString &newSnapshotKey);
+
 Q_SIGNALS:
     void sourceItemChanged();
     void sourceRectChanged();
     void fixedChanged();
     void hideSourceChanged();
     void mipmapChanged();
+    void thumbnailChanged();
+    void snapshotChanged();
+    void snapshotKeyChanged();
 
 protected:
     QSGNode *updatePaintNode(QSGNode *old, UpdatePaintNodeData *) override;
@@ -5,6 +5,7 @@
 #include "wsurfaceitem_p.h"
 #include "wsurface.h"
 #include "wseat.h"
+#include "winputdevice.h"
 #include "wcursor.h"
 #include "woutput.h"
 #include "woutputviewport.h"
@@ -18,11 +19,13 @@
 #include <qwrenderer.h>
 #include <qwbox.h>
 #include <qwalphamodifierv1.h>
+#include <qwseat.h>
 
 #include <QQuickWindow>
 #include <QSGImageNode>
 #include <QSGRenderNode>
 #include <private/qquickitem_p.h>
+#include <private/qeventpoint_p.h>
 
 QW_USE_NAMESPACE
 WAYLIB_SERVER_BEGIN_NAMESPACE
@@ -105,6 +108,11 @@ public:
         if (Q_UNLIKELY(!isValid()))
             return false;
 
+        if (d()->flattensSubsurfaces()) {
+            return wlr_surface_surface_at(d()->surface->handle()->handle(),
+                                          point.x(), point.y(), nullptr, nullptr);
+        }
+
         return d()->surface->inputRegionContains(point);
     }
 
@@ -166,6 +174,7 @@ public:
         W_Q(WSurfaceItemContent);
         if (surface) {
             surface->safeDisconnect(q);
+            surface->setHeldBuffers(q, {});
             if (textureProvider) {
                 surface->safeDisconnect(textureProvider);
             }
@@ -180,7 +189,11 @@ public:
         if (dontCacheLastBuffer) {
             buffer.reset();
             cleanTextureProvider();
+            clearFlattenedSurfaces();
             q->update();
+        } else {
+            for (auto s : std::as_const(flattenedSurfaces))
+                detachFlattenedSurface(s);
         }
     }
 
@@ -192,6 +205,8 @@ public:
         });
         surface->safeConnect(&qw_surface::notify_commit, q, [this] {
             updateSurfaceState();
+            if (flattenSubsurfaces)
+                updateFlattenedSurfaces();
         });
 
         Q_ASSERT(!updateTextureConnection);
@@ -207,13 +222,42 @@ public:
                     buffer->lock();
                 q->update();
             }
+            updateHeldBuffers();
         });
 
         updateFrameDoneConnection();
         updateSurfaceState();
+        if (flattenSubsurfaces)
+            updateFlattenedSurfaces();
+        updateFrameThrottle();
         rendered = true;
     }
 
+    void updateFrameThrottle() {
+        W_Q(WSurfaceItemContent);
+
+        if (!surface || surface->isInvalidated())
+            return;
+
+        // The non-live item doesn't send frame done
+        if (!live) {
+            surface->removeFrameThrottleRequest(q);
+            for (auto s : std::as_const(flattenedSurfaces)) {
+                if (s->surface)
+                    s->surface->removeFrameThrottleRequest(q);
+            }
+            return;
+        }
+
+        const bool visible = q->isVisible() && q->window();
+        const auto throttle = visible ? WSurface::FrameThrottle::FullRate : invisibleFrameThrottle;
+        surface->requestFrameThrottle(q, throttle);
+        for (auto s : std::as_const(flattenedSurfaces)) {
+            if (s->surface)
+                s->surface->requestFrameThrottle(q, throttle);
+        }
+    }
+
     void updateFrameDoneConnection() {
         W_Q(WSurfaceItemContent);
 
@@ -226,6 +270,10 @@ public:
         frameDoneConnection = QObject::connect(q->window(), &QQuickWindow::afterRendering, q, [this, q](){
             if ((rendered || q->isVisible()) && live) {
                 surface->notifyFrameDone();
+                for (auto s : std::as_const(flattenedSurfaces)) {
+                    if (s->surface)
+                        s->surface->notifyFrameDone();
+                }
                 rendered = false;
             }
         }); // if signal is emitted from seperated rendering thread, default QueuedConnection is used
@@ -264,9 +312,23 @@ public:
     inline void swapBufferIfNeeded() {
         if (pendingBuffer) {
             buffer.reset(pendingBuffer.release());
+            updateHeldBuffers();
         }
     }
 
+    // Count the buffers kept by this item to the surface's client
+    void updateHeldBuffers() {
+        if (!surface || surface->isInvalidated())
+            return;
+
+        QList<qw_buffer*> held;
+        if (buffer && buffer.get() != surface->buffer())
+            held << buffer.get();
+        if (pendingBuffer && pendingBuffer.get() != surface->buffer())
+            held << pendingBuffer.get();
+        surface->setHeldBuffers(q_func(), held);
+    }
+
     inline void setDevicePixelRatio(qreal dpr) {
         if (dpr == devicePixelRatio)
             return;
@@ -286,6 +348,24 @@ public:
         Q_EMIT q->alphaModifierChanged();
     }
 
+    struct FlattenedSurface {
+        QPointer<WSurface> surface;
+        // Relative to the root surface
+        QPointF position;
+        QSizeF size;
+        QRectF bufferSourceBox;
+        std::unique_ptr<qw_buffer, qw_buffer::unlocker> buffer;
+        WSGTextureProvider *textureProvider = nullptr;
+    };
+
+    void setFlattenSubsurfaces(bool on);
+    void setFlattenedSubsurfacesVisible(bool visible);
+    void updateFlattenedSurfaces();
+    void detachFlattenedSurface(FlattenedSurface *s);
+    void clearFlattenedSurfaces();
+    QSGNode *updateFlattenedNode(QSGNode *oldNode, WSGTextureProvider *rootTextureProvider);
+    void releaseTextureProvider(WSGTextureProvider *provider);
+
     W_DECLARE_PUBLIC(WSurfaceItemContent)
     QPointer<WSurface> surface;
     QRectF bufferSourceBox;
@@ -302,6 +382,15 @@ public:
     bool live = true;
     bool ignoreBufferOffset = false;
     QAtomicInteger<bool> rendered = false;
+    WSurface::FrameThrottle invisibleFrameThrottle = WSurface::FrameThrottle::Reduced;
+
+    bool flattenSubsurfaces = false;
+    bool flattenedSubsurfacesVisible = true;
+    // The mapped subsurfaces of the whole tree in the rendering order, the
+    // root surface is rendered before flattenedSurfaces[flattenedRootIndex].
+    QList<FlattenedSurface*> flattenedSurfaces;
+    int flattenedRootIndex = 0;
+    QRectF flattenedRect;
 };
 
 
@@ -325,6 +414,7 @@ WSurfaceItemContent::~WSurfaceItemContent()
     //`d->window` will become nullptr in ~QQuickItem
     // Don't move this to private class
     d->cleanTextureProvider();
+    d->clearFlattenedSurfaces();
 }
 
 WSurface *WSurfaceItemContent::surface() const
@@ -343,6 +433,10 @@ void WSurfaceItemContent::setSurface(WSurface *surface)
 
     auto oldSurface = d->surface;
     d->surface = surface;
+    if (oldSurface) {
+        oldSurface->removeFrameThrottleRequest(this);
+        oldSurface->setHeldBuffers(this, {});
+    }
     if (isComponentComplete()) {
         if (oldSurface) {
             oldSurface->safeDisconnect(this);
@@ -440,6 +534,7 @@ void WSurfaceItemContent::setLive(bool live)
         d->swapBufferIfNeeded();
         update();
     }
+    d->updateFrameThrottle();
     Q_EMIT liveChanged();
 }
 
@@ -465,6 +560,22 @@ void WSurfaceItemContent::setIgnoreBufferOffset(bool newIgnoreBufferOffset)
 }
 
 
+WSurface::FrameThrottle WSurfaceItemContent::invisibleFrameThrottle() const
+{
+    W_DC(WSurfaceItemContent);
+    return d->invisibleFrameThrottle;
+}
+
+void WSurfaceItemContent::setInvisibleFrameThrottle(WSurface::FrameThrottle newInvisibleFrameThrottle)
+{
+    W_D(WSurfaceItemContent);
+    if (d->invisibleFrameThrottle == newInvisibleFrameThrottle)
+        return;
+    d->invisibleFrameThrottle = newInvisibleFrameThrottle;
+    d->updateFrameThrottle();
+    Q_EMIT invisibleFrameThrottleChanged();
+}
+
 QRectF WSurfaceItemContent::bufferSourceRect() const
 {
     W_DC(WSurfaceItemContent);
@@ -514,6 +625,234 @@ public:
     QPointer<WSurfaceItemContent> m_owner;
 };
 
+// Holds an image node for every surface of the flattened tree
+class Q_DECL_HIDDEN WSGFlattenedSurfaceNode : public QSGNode
+{
+public:
+    WSGFlattenedSurfaceNode(WSurfaceItemContent *owner)
+        : footprint(new WSGRenderFootprintNode(owner))
+    {
+        appendChildNode(footprint);
+    }
+
+    QSGNode *footprint;
+};
+
+void WSurfaceItemContentPrivate::setFlattenSubsurfaces(bool on)
+{
+    if (flattenSubsurfaces == on)
+        return;
+
+    W_Q(WSurfaceItemContent);
+    flattenSubsurfaces = on;
+    if (on && surface) {
+        updateFlattenedSurfaces();
+        updateFrameThrottle();
+    } else {
+        clearFlattenedSurfaces();
+    }
+
+    dirty(QQuickItemPrivate::Content);
+    q->update();
+}
+
+void WSurfaceItemContentPrivate::setFlattenedSubsurfacesVisible(bool visible)
+{
+    if (flattenedSubsurfacesVisible == visible)
+        return;
+    flattenedSubsurfacesVisible = visible;
+    if (flattenSubsurfaces)
+        q_func()->update();
+}
+
+void WSurfaceItemContentPrivate::updateFlattenedSurfaces()
+{
+    W_Q(WSurfaceItemContent);
+    Q_ASSERT(flattenSubsurfaces);
+
+    QHash<WSurface*, FlattenedSurface*> oldSurfaces;
+    // The destroyed surfaces, they are kept for the last frame until now
+    QList<FlattenedSurface*> removedSurfaces;
+    oldSurfaces.reserve(flattenedSurfaces.size());
+    for (auto s : std::as_const(flattenedSurfaces)) {
+        if (s->surface)
+            oldSurfaces.insert(s->surface, s);
+        else
+            removedSurfaces.append(s);
+    }
+
+    const QList<FlattenedSurface*> previousSurfaces = std::exchange(flattenedSurfaces, {});
+    const QRectF oldFlattenedRect = std::exchange(flattenedRect, {});
+    flattenedRootIndex = 0;
+
+    struct IteratorData {
+        WSurfaceItemContentPrivate *d;
+        QHash<WSurface*, FlattenedSurface*> *oldSurfaces;
+        wlr_surface *root;
+    } iteratorData { this, &oldSurfaces, surface ? surface->handle()->handle() : nullptr };
+
+    auto iterator = [] (wlr_surface *handle, int sx, int sy, void *data) {
+        auto iteratorData = static_cast<IteratorData*>(data);
+        auto d = iteratorData->d;
+        if (handle == iteratorData->root) {
+            d->flattenedRootIndex = d->flattenedSurfaces.size();
+            return;
+        }
+
+        WSurface *ws = WSurface::fromHandle(handle);
+        if (!ws || ws->isInvalidated())
+            return;
+
+        FlattenedSurface *s = iteratorData->oldSurfaces->take(ws);
+        if (!s) {
+            s = new FlattenedSurface;
+            s->surface = ws;
+
+            auto q = d->q_func();
+            ws->safeConnect(&qw_surface::notify_commit, q, [d] {
+                d->updateFlattenedSurfaces();
+            });
+            ws->safeConnect(&WSurface::aboutToBeInvalidated, q, [d, s] {
+                d->detachFlattenedSurface(s);
+                if (d->dontCacheLastBuffer) {
+                    s->buffer.reset();
+                    d->q_func()->update();
+                }
+            });
+        }
+
+        s->position = QPointF(sx, sy);
+        s->size = ws->size();
+        if (d->live) {
+            qw_fbox box;
+            ws->handle()->get_buffer_source_box(box);
+            s->bufferSourceBox = box.toQRectF();
+
+            if (s->buffer.get() != ws->buffer()) {
+                s->buffer.reset(ws->buffer());
+                if (s->buffer)
+                    s->buffer->lock();
+            }
+        }
+
+        d->flattenedRect |= QRectF(s->position, s->size);
+        d->flattenedSurfaces.append(s);
+    };
+
+    if (iteratorData.root)
+        wlr_surface_for_each_surface(iteratorData.root, iterator, &iteratorData);
+
+    // The surfaces are not in the tree now
+    removedSurfaces.append(oldSurfaces.values());
+    for (auto s : std::as_const(removedSurfaces)) {
+        detachFlattenedSurface(s);
+        releaseTextureProvider(s->textureProvider);
+        delete s;
+    }
+
+    if (previousSurfaces != flattenedSurfaces)
+        updateFrameThrottle();
+
+    if (flattenedRect != oldFlattenedRect) {
+        if (auto item = qobject_cast<WSurfaceItem*>(q->parentItem()))
+            WSurfaceItemPrivate::get(item)->updateBoundingRect();
+    }
+
+    q->update();
+}
+
+void WSurfaceItemContentPrivate::detachFlattenedSurface(FlattenedSurface *s)
+{
+    if (!s->surface)
+        return;
+
+    W_Q(WSurfaceItemContent);
+    s->surface->safeDisconnect(q);
+    s->surface->removeFrameThrottleRequest(q);
+    s->surface = nullptr;
+}
+
+void WSurfaceItemContentPrivate::clearFlattenedSurfaces()
+{
+    for (auto s : std::as_const(flattenedSurfaces)) {
+        detachFlattenedSurface(s);
+        releaseTextureProvider(s->textureProvider);
+        delete s;
+    }
+
+    flattenedSurfaces.clear();
+    flattenedRootIndex = 0;
+    flattenedRect = {};
+}
+
+QSGNode *WSurfaceItemContentPrivate::updateFlattenedNode(QSGNode *oldNode, WSGTextureProvider *rootTextureProvider)
+{
+    W_Q(WSurfaceItemContent);
+
+    auto node = dynamic_cast<WSGFlattenedSurfaceNode*>(oldNode);
+    if (!node) {
+        delete oldNode;
+        node = new WSGFlattenedSurfaceNode(q);
+    }
+
+    const auto filtering = q->smooth() ? QSGTexture::Linear : QSGTexture::Nearest;
+    QSGNode *child = node->firstChild();
+    auto addQuad = [&] (QSGTexture *texture, const QRectF &sourceRect, const QRectF &rect) {
+        QSGImageNode *imageNode;
+        if (child != node->footprint) {
+            imageNode = static_cast<QSGImageNode*>(child);
+            child = child->nextSibling();
+        } else {
+            imageNode = q->window()->createImageNode();
+            imageNode->setOwnsTexture(false);
+            node->insertChildNodeBefore(imageNode, node->footprint);
+        }
+
+        imageNode->setTexture(texture);
+        imageNode->setSourceRect(sourceRect);
+        imageNode->setRect(rect);
+        imageNode->setFiltering(filtering);
+    };
+
+    auto w = qobject_cast<WOutputRenderWindow*>(window);
+    for (int i = 0; i <= flattenedSurfaces.size(); ++i) {
+        if (i == flattenedRootIndex && rootTextureProvider->texture() && q->width() > 0 && q->height() > 0) {
+            addQuad(rootTextureProvider->texture(), bufferSourceBox,
+                    QRectF(ignoreBufferOffset ? QPointF() : bufferOffset, q->size()));
+        }
+
+        if (i == flattenedSurfaces.size() || !flattenedSubsurfacesVisible)
+            continue;
+
+        auto s = flattenedSurfaces.at(i);
+        if (!s->textureProvider) {
+            s->textureProvider = new WSGTextureProvider(w);
+            s->textureProvider->setSmooth(q->smooth());
+        }
+
+        if (live || !s->textureProvider->texture()) {
+            auto texture = s->surface ? s->surface->handle()->get_texture() : nullptr;
+            if (texture)
+                s->textureProvider->setTexture(qw_texture::from(texture), s->buffer.get());
+            else
+                s->textureProvider->setBuffer(s->buffer.get());
+        }
+
+        if (!s->textureProvider->texture() || s->size.isEmpty())
+            continue;
+        addQuad(s->textureProvider->texture(), s->bufferSourceBox, QRectF(s->position, s->size));
+    }
+
+    while (child != node->footprint) {
+        auto next = child->nextSibling();
+        node->removeChildNode(child);
+        delete child;
+        child = next;
+    }
+
+    return node;
+}
+
 QSGNode *WSurfaceItemContent::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeData *)
 {
     W_D(WSurfaceItemContent);
@@ -528,12 +867,19 @@ QSGNode *WSurfaceItemContent::updatePaintNode(QSGNode *oldNode, UpdatePaintNodeD
         }
     }
 
+    if (d->flattenSubsurfaces)
+        return d->updateFlattenedNode(oldNode, tp);
+
     if (!tp->texture() || width() <= 0 || height() <= 0) {
         delete oldNode;
         return nullptr;
     }
 
-    auto node = static_cast<QSGImageNode*>(oldNode);
+    auto node = dynamic_cast<QSGImageNode*>(oldNode);
+    if (Q_UNLIKELY(!node && oldNode)) {
+        // It was the node of the flattened subsurfaces
+        delete oldNode;
+    }
     if (Q_UNLIKELY(!node)) {
         node = window()->createImageNode();
         node->setOwnsTexture(false);
@@ -570,6 +916,9 @@ void WSurfaceItemContent::itemChange(ItemChange change, const ItemChangeData &da
     if (change == QQuickItem::ItemSceneChange) {
         d->updateFrameDoneConnection();
         d->setDevicePixelRatio(data.window ? data.window->effectiveDevicePixelRatio() : 1.0);
+        d->updateFrameThrottle();
+    } else if (change == QQuickItem::ItemVisibleHasChanged) {
+        d->updateFrameThrottle();
     } else if (change == QQuickItem::ItemDevicePixelRatioHasChanged) {
         d->setDevicePixelRatio(data.realValue);
     }
@@ -581,6 +930,11 @@ void WSurfaceItemContent::invalidateSceneGraph()
     if (d->textureProvider)
         delete d->textureProvider;
     d->textureProvider = nullptr;
+
+    for (auto s : std::as_const(d->flattenedSurfaces)) {
+        delete s->textureProvider;
+        s->textureProvider = nullptr;
+    }
 }
 
 WSurfaceItem::WSurfaceItem(QQuickItem *parent)
@@ -720,11 +1074,15 @@ void WSurfaceItem::setFlags(const Flags &newFlags)
     if (auto content = d->getItemContent()) {
         content->setCacheLastBuffer(!newFlags.testFlag(DontCacheLastBuffer));
         content->setLive(!newFlags.testFlag(NonLive));
+        content->d_func()->setFlattenSubsurfaces(newFlags.testFlag(FlattenSubsurfaces));
     }
 
     for (auto sub : std::as_const(d->subsurfaces))
         sub->setFlags(newFlags);
 
+    if (d->surface && d->componentComplete)
+        d->updateSubsurfaceItem();
+
     Q_EMIT flagsChanged();
 }
 
@@ -959,9 +1317,109 @@ bool WSurfaceItem::sendEvent(QInputEvent *event)
     if (!d->surface)
         return false;
 
+    if (d->flattensSubsurfaces())
+        return d->sendEventToFlattenedSurface(event);
+
     return WSeat::sendEvent(d->surface.get(), this, d->eventItem, event);
 }
 
+// The position of the surface in the subsurface tree of root
+static bool positionInTree(wlr_surface *root, wlr_surface *surface, QPointF *pos)
+{
+    struct Data {
+        wlr_surface *surface;
+        QPointF *pos;
+        bool found;
+    } data { surface, pos, false };
+
+    wlr_surface_for_each_surface(root, [] (wlr_surface *s, int sx, int sy, void *data) {
+        auto d = static_cast<Data*>(data);
+        if (s == d->surface) {
+            *d->pos = QPointF(sx, sy);
+            d->found = true;
+        }
+    }, &data);
+
+    return data.found;
+}
+
+bool WSurfaceItemPrivate::sendEventToFlattenedSurface(QInputEvent *event)
+{
+    Q_Q(WSurfaceItem);
+
+    auto root = surface->handle()->handle();
+    auto inputDevice = WInputDevice::from(event->device());
+    auto seat = inputDevice ? inputDevice->seat() : nullptr;
+    WSurface *target = surface;
+
+    switch (event->type()) {
+    case QEvent::HoverEnter: Q_FALLTHROUGH();
+    case QEvent::HoverMove: Q_FALLTHROUGH();
+    case QEvent::MouseMove: Q_FALLTHROUGH();
+    case QEvent::MouseButtonPress: Q_FALLTHROUGH();
+    case QEvent::MouseButtonRelease: {
+        // The positions are local to the root surface, map them to the subsurface under them
+        auto e = static_cast<QSinglePointEvent*>(event);
+        auto &point = e->point(0);
+        QPointF subPos;
+        auto handle = wlr_surface_surface_at(root, point.position().x(), point.position().y(),
+                                             &subPos.rx(), &subPos.ry());
+        if (handle && handle != root) {
+            if (auto ws = WSurface::fromHandle(handle)) {
+                target = ws;
+                QMutableEventPoint::setPosition(point, subPos);
+            }
+        }
+        break;
+    }
+    case QEvent::HoverLeave: {
+        // The pointer focus maybe is any surface of the tree
+        auto focus = seat ? seat->pointerFocusSurface() : nullptr;
+        QPointF pos;
+        if (focus && positionInTree(root, focus->handle()->handle(), &pos))
+            target = focus;
+        break;
+    }
+    case QEvent::TouchBegin: Q_FALLTHROUGH();
+    case QEvent::TouchUpdate: Q_FALLTHROUGH();
+    case QEvent::TouchEnd: {
+        auto e = static_cast<QTouchEvent*>(event);
+        bool hasTarget = false;
+        for (qsizetype i = 0; i < e->pointCount(); ++i) {
+            auto &point = e->point(i);
+            QPointF offset;
+
+            if (point.state() == QEventPoint::Pressed) {
+                // The new touch point enters the surface under it, all the new points
+                // of this event are sent to the same surface.
+                if (!hasTarget) {
+                    QPointF subPos;
+                    auto handle = wlr_surface_surface_at(root, point.position().x(), point.position().y(),
+                                                         &subPos.rx(), &subPos.ry());
+                    if (auto ws = handle ? WSurface::fromHandle(handle) : nullptr)
+                        target = ws;
+                    hasTarget = true;
+                }
+                positionInTree(root, target->handle()->handle(), &offset);
+            } else if (seat) {
+                // The motions are local to the surface which the point is down on
+                auto touchPoint = seat->handle()->touch_get_point(point.id());
+                if (touchPoint && touchPoint->surface)
+                    positionInTree(root, touchPoint->surface, &offset);
+            }
+
+            if (!offset.isNull())
+                QMutableEventPoint::setPosition(point, point.position() - offset);
+        }
+        break;
+    }
+    default:
+        break;
+    }
+
+    return WSeat::sendEventToSubsurfaceTree(target, q, eventItem, event);
+}
+
 bool WSurfaceItem::doResizeSurface(const QSize &newSize)
 {
     Q_D(WSurfaceItem);
@@ -1129,6 +1587,9 @@ void WSurfaceItemPrivate::initForDelegate()
         contentItem->setCacheLastBuffer(!surfaceFlags.testFlag(WSurfaceItem::DontCacheLastBuffer));
         contentItem->setSmooth(q->smooth());
         contentItem->setLive(!q->flags().testFlag(WSurfaceItem::NonLive));
+        contentItem->setInvisibleFrameThrottle(invisibleFrameThrottle);
+        contentItem->d_func()->setFlattenedSubsurfacesVisible(subsurfacesVisible);
+        contentItem->d_func()->setFlattenSubsurfaces(surfaceFlags.testFlag(WSurfaceItem::FlattenSubsurfaces));
         QObject::connect(q, &WSurfaceItem::smoothChanged, contentItem, &WSurfaceItemContent::setSmooth);
         newContentContainer.reset(contentItem);
     } else if (delegateIsDirty) {
@@ -1191,6 +1652,14 @@ void WSurfaceItemPrivate::updateSubsurfaceItem()
     auto surface = this->surface->handle()->handle();
     Q_ASSERT(surface);
     Q_ASSERT(contentContainer);
+
+    if (flattensSubsurfaces()) {
+        // The content item renders the subsurfaces
+        clearSubsurfaceItems();
+        updateBoundingRect();
+        return;
+    }
+
     updateSubsurfaceContainers();
     auto updateForContainer = [this](wl_list *subsurfaceList, QQuickItem *container) {
         wlr_subsurface *subsurface;
@@ -1271,6 +1740,7 @@ WSurfaceItem *WSurfaceItemPrivate::ensureSubsurfaceItem(WSurface *subsurfaceSurf
     }, Qt::QueuedConnection);
     surfaceItem->setDelegate(delegate);
     surfaceItem->setFlags(surfaceFlags);
+    surfaceItem->setInvisibleFrameThrottle(invisibleFrameThrottle);
     surfaceItem->setSurface(subsurfaceSurface);
     surfaceItem->setSmooth(q->smooth());
     QObject::connect(q, &WSurfaceItem::smoothChanged, surfaceItem, &WSurfaceItem::setSmooth);
@@ -1321,6 +1791,23 @@ void WSurfaceItemPrivate::updateSubsurfaceContainers()
     }
 }
 
+void WSurfaceItemPrivate::clearSubsurfaceItems()
+{
+    Q_Q(WSurfaceItem);
+
+    const auto items = std::exchange(subsurfaces, {});
+    for (auto item : items) {
+        if (item->surface())
+            QObject::disconnect(item->surface(), &WSurface::destroyed, q, nullptr);
+        // Emits subsurfaceRemoved from its container
+        item->setParentItem(nullptr);
+        item->deleteLater();
+    }
+
+    delete belowSubsurfaceContainer;
+    delete aboveSubsurfaceContainer;
+}
+
 void WSurfaceItemPrivate::resizeSurfaceToItemSize(const QSize &itemSize, const QSize &sizeDiff)
 {
     Q_Q(WSurfaceItem);
@@ -1420,6 +1907,11 @@ QRectF WSurfaceItemPrivate::calculateBoundingRect() const
     if (contentContainer)
         rect |= q->mapFromItem(contentContainer, contentContainer->boundingRect());
 
+    if (flattensSubsurfaces()) {
+        auto content = getItemContent();
+        rect |= q->mapFromItem(content, content->d_func()->flattenedRect);
+    }
+
     for (auto sub : std::as_const(subsurfaces))
         rect |= sub->boundingRect().translated(sub->position());
 
@@ -1460,7 +1952,18 @@ bool WSurfaceItem::setShellSurface(WToplevelSurface *surface)
 
 void WSurfaceItemContentPrivate::cleanTextureProvider()
 {
-    if (textureProvider) {
+    releaseTextureProvider(textureProvider);
+    textureProvider = nullptr;
+
+    for (auto s : std::as_const(flattenedSurfaces)) {
+        releaseTextureProvider(s->textureProvider);
+        s->textureProvider = nullptr;
+    }
+}
+
+void WSurfaceItemContentPrivate::releaseTextureProvider(WSGTextureProvider *provider)
+{
+    if (provider) {
         // needs check window, because maybe this item's window always is nullptr,
         // so not call WSurfaceItemContent::releaseResources before destroy.
         if (window) {
@@ -1475,13 +1978,11 @@ void WSurfaceItemContentPrivate::cleanTextureProvider()
             };
 
                    // Delay clean the textures on the next render after.
-            window->scheduleRenderJob(new WSurfaceItemContentCleanupJob(textureProvider),
+            window->scheduleRenderJob(new WSurfaceItemContentCleanupJob(provider),
                                       QQuickWindow::AfterRenderingStage);
         } else {
-            delete textureProvider;
+            delete provider;
         }
-
-        textureProvider = nullptr;
     }
 }
 
@@ -1501,9 +2002,33 @@ void WSurfaceItem::setSubsurfacesVisible(bool newSubsurfacesVisible)
         d->belowSubsurfaceContainer->setVisible(d->subsurfacesVisible);
     if (d->aboveSubsurfaceContainer)
         d->aboveSubsurfaceContainer->setVisible(d->subsurfacesVisible);
+    if (auto content = d->getItemContent())
+        content->d_func()->setFlattenedSubsurfacesVisible(d->subsurfacesVisible);
     Q_EMIT subsurfacesVisibleChanged();
 }
 
+WSurface::FrameThrottle WSurfaceItem::invisibleFrameThrottle() const
+{
+    Q_D(const WSurfaceItem);
+    return d->invisibleFrameThrottle;
+}
+
+void WSurfaceItem::setInvisibleFrameThrottle(WSurface::FrameThrottle newInvisibleFrameThrottle)
+{
+    Q_D(WSurfaceItem);
+    if (d->invisibleFrameThrottle == newInvisibleFrameThrottle)
+        return;
+    d->invisibleFrameThrottle = newInvisibleFrameThrottle;
+
+    if (auto content = d->getItemContent())
+        content->setInvisibleFrameThrottle(newInvisibleFrameThrottle);
+
+    for (auto sub : std::as_const(d->subsurfaces))
+        sub->setInvisibleFrameThrottle(newInvisibleFrameThrottle);
+
+    Q_EMIT invisibleFrameThrottleChanged();
+}
+
 WAYLIB_SERVER_END_NAMESPACE
 
 #include "wsurfaceitem.moc"
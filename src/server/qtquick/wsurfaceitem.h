@@ -34,6 +34,7 @@ class WAYLIB_SERVER_EXPORT WSurfaceItemContent : public QQuickItem, public virtu
     Q_PROPERTY(QRectF bufferSourceRect READ bufferSourceRect NOTIFY bufferSourceRectChanged FINAL)
     Q_PROPERTY(qreal devicePixelRatio READ devicePixelRatio NOTIFY devicePixelRatioChanged FINAL)
     Q_PROPERTY(qreal alphaModifier READ alphaModifier NOTIFY alphaModifierChanged FINAL)
+    Q_PROPERTY(WSurface::FrameThrottle invisibleFrameThrottle READ invisibleFrameThrottle WRITE setInvisibleFrameThrottle NOTIFY invisibleFrameThrottleChanged FINAL)
     QML_NAMED_ELEMENT(SurfaceItemContent)
 
 public:
@@ -63,6 +64,9 @@ public:
     qreal devicePixelRatio() const;
     qreal alphaModifier() const;
 
+    WSurface::FrameThrottle invisibleFrameThrottle() const;
+    void setInvisibleFrameThrottle(WSurface::FrameThrottle newInvisibleFrameThrottle);
+
 Q_SIGNALS:
     void surfaceChanged();
     void cacheLastBufferChanged();
@@ -72,6 +76,7 @@ Q_SIGNALS:
     void bufferSourceRectChanged();
     void devicePixelRatioChanged();
     void alphaModifierChanged();
+    void invisibleFrameThrottleChanged();
 
 private:
     friend class WSurfaceItem;
@@ -116,6 +121,7 @@ class WAYLIB_SERVER_EXPORT WSurfaceItem : public QQuickItem
     Q_PROPERTY(QQmlComponent* delegate READ delegate WRITE setDelegate NOTIFY delegateChanged FINAL)
     Q_PROPERTY(QRectF boundingRect READ boundingRect NOTIFY boundingRectChanged)
     Q_PROPERTY(bool subsurfacesVisible READ subsurfacesVisible WRITE setSubsurfacesVisible NOTIFY subsurfacesVisibleChanged FINAL)
+    Q_PROPERTY(WSurface::FrameThrottle invisibleFrameThrottle READ invisibleFrameThrottle WRITE setInvisibleFrameThrottle NOTIFY invisibleFrameThrottleChanged FINAL)
     QML_NAMED_ELEMENT(SurfaceItem)
 
 public:
@@ -131,6 +137,9 @@ public:
         RejectEvent = 0x2,
         NonLive = 0x4,
         DelegateForSubsurface = 0x8,
+        // Render the subsurfaces by the content item instead of the child WSurfaceItems,
+        // not works with the delegate.
+        FlattenSubsurfaces = 0x10,
     };
     Q_ENUM(Flag)
     Q_DECLARE_FLAGS(Flags, Flag)
@@ -193,6 +202,9 @@ public:
     bool subsurfacesVisible() const;
     void setSubsurfacesVisible(bool newSubsurfacesVisible);
 
+    WSurface::FrameThrottle invisibleFrameThrottle() const;
+    void setInvisibleFrameThrottle(WSurface::FrameThrottle newInvisibleFrameThrottle);
+
 Q_SIGNALS:
     void surfaceChanged();
     void subsurfaceAdded(WAYLIB_SERVER_NAMESPACE::WSurfaceItem *item);
@@ -212,6 +224,7 @@ Q_SIGNALS:
     void shellSurfaceChanged();
     void boundingRectChanged();
     void subsurfacesVisibleChanged();
+    void invisibleFrameThrottleChanged();
 
 protected:
     explicit WSurfaceItem(WSurfaceItemPrivate &dd, QQuickItem *parent = nullptr);
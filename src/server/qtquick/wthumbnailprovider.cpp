@@ -0,0 +1,733 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "wthumbnailprovider.h"
+#include "woutputrenderwindow.h"
+#include "wbufferrenderer_p.h"
+#include "wsgtextureprovider.h"
+#include "wqmlhelper_p.h"
+#include "wsurfaceitem.h"
+#include "wsurface.h"
+
+#include <qwbuffer.h>
+
+#include <QElapsedTimer>
+#include <QPointer>
+#include <QQuickItem>
+#include <QTimer>
+#include <QLoggingCategory>
+
+#include <cmath>
+#include <drm_fourcc.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+Q_LOGGING_CATEGORY(qLcThumbnail, "waylib.server.thumbnail", QtWarningMsg)
+
+// Every thumbnail keeps two buffers in its swapchain at most
+static constexpr int BuffersPerThumbnail = 2;
+static constexpr int BytesPerPixel = 4;
+
+class Q_DECL_HIDDEN WThumbnailProviderPrivate : public WObjectPrivate
+{
+public:
+    struct SourceRef {
+        int refs = 0;
+        QMetaObject::Connection destroyed;
+    };
+
+    struct Entry {
+        // See WThumbnailProvider::sourceKey, nullptr if it's destroyed
+        QObject *key = nullptr;
+        // The rendered one of sources, the others show the same thing
+        QQuickItem *source = nullptr;
+        // Owned by the content item, it's gone with the window
+        QPointer<WBufferRenderer> renderer;
+        // The items of the owners and of the pending capture
+        QHash<QQuickItem*, SourceRef> sources;
+        QList<QMetaObject::Connection> sizeConnections;
+        QList<QObject*> owners;
+        QList<QObject*> snapshotOwners;
+        // The cached snapshots waiting for this source to be rendered
+        QStringList snapshotKeys;
+        QQuickItem *captureSource = nullptr;
+        QSize pixelSize;
+        QElapsedTimer lastRender;
+        qreal snapshotScale = 1.0;
+        bool dirty = true;
+        bool captureRequested = false;
+        bool captured = false;
+
+        inline bool isLive() const {
+            return !owners.isEmpty();
+        }
+        inline bool isUnused() const {
+            return owners.isEmpty() && snapshotOwners.isEmpty() && snapshotKeys.isEmpty();
+        }
+    };
+
+    WThumbnailProviderPrivate(WThumbnailProvider *qq, WOutputRenderWindow *window)
+        : WObjectPrivate(qq)
+        , window(window)
+    {
+        throttleTimer.setSingleShot(true);
+    }
+
+    struct Snapshot {
+        qw_buffer *buffer = nullptr;
+        WSGTextureProvider *textureProvider = nullptr;
+    };
+
+    ~WThumbnailProviderPrivate() {
+        for (auto entry : std::as_const(entries))
+            delete entry->renderer;
+        qDeleteAll(entries);
+        for (const auto &snapshot : std::as_const(snapshots)) {
+            delete snapshot.textureProvider;
+            snapshot.buffer->unlock();
+        }
+    }
+
+    void init();
+    Entry *ensureEntry(QQuickItem *source);
+    void addSource(Entry *entry, QQuickItem *source);
+    void removeSource(Entry *entry, QQuickItem *source);
+    void setRenderedSource(Entry *entry, QQuickItem *source);
+    void markDirty(Entry *entry);
+    void removeEntry(Entry *entry);
+    void tryRemoveEntry(Entry *entry);
+    void storeSnapshot(const QString &key, qw_buffer *buffer);
+    void removeSnapshot(const QString &key);
+    void trimSnapshotCache();
+    void notifyCachedSnapshotsChanged();
+    void render();
+    void updatePixelSizes();
+    QSize idealPixelSize(const Entry *entry) const;
+    void setMemoryUsage(qint64 usage);
+
+    W_DECLARE_PUBLIC(WThumbnailProvider)
+
+    WOutputRenderWindow *window;
+    QList<Entry*> entries;
+    QHash<QObject*, Entry*> keyedEntries;
+    QHash<QObject*, std::pair<Entry*, QQuickItem*>> ownerEntries;
+    // Keyed by the caller, so they outlive the items they were captured from
+    QHash<QString, Snapshot> snapshots;
+    // most recently captured first
+    QStringList snapshotCache;
+    qint64 snapshotMemory = 0;
+    bool cachedSnapshotsNotifying = false;
+    QTimer throttleTimer;
+
+    int refreshInterval = 200;
+    QSize maximumSize = QSize(512, 512);
+    qint64 memoryBudget = 64 * 1024 * 1024;
+    qint64 memoryUsage = 0;
+    int snapshotCacheSize = 4;
+};
+
+void WThumbnailProviderPrivate::init()
+{
+    W_Q(WThumbnailProvider);
+
+    // Thumbnails must be ready before the outputs start rendering
+    QObject::connect(window, &WOutputRenderWindow::beforeRendering,
+                     q, [this] { render(); }, Qt::DirectConnection);
+    QObject::connect(&throttleTimer, &QTimer::timeout,
+                     window, &WOutputRenderWindow::scheduleRender);
+}
+
+WThumbnailProviderPrivate::Entry *WThumbnailProviderPrivate::ensureEntry(QQuickItem *source)
+{
+    QObject *key = WThumbnailProvider::sourceKey(source);
+    if (auto entry = keyedEntries.value(key))
+        return entry;
+
+    W_Q(WThumbnailProvider);
+    auto entry = new Entry;
+    entry->key = key;
+    // Not owned by the source, any item showing the key can be rendered
+    entry->renderer = new WBufferRenderer(window->contentItem());
+    // Keep the buffer only while someone locks it
+    entry->renderer->setCacheBuffer(false);
+    entries.append(entry);
+    keyedEntries.insert(key, entry);
+
+    QObject::connect(entry->renderer, &WBufferRenderer::sceneGraphChanged, q, [this, entry] {
+        markDirty(entry);
+    });
+    // The owners still hold the entry until they release it
+    QObject::connect(key, &QObject::destroyed, q, [this, entry, key] {
+        if (keyedEntries.value(key) == entry)
+            keyedEntries.remove(key);
+        entry->key = nullptr;
+    });
+
+    Q_EMIT q->countChanged();
+    return entry;
+}
+
+void WThumbnailProviderPrivate::addSource(Entry *entry, QQuickItem *source)
+{
+    auto &ref = entry->sources[source];
+    if (ref.refs++ == 0) {
+        ref.destroyed = QObject::connect(source, &QObject::destroyed, q_func(), [this, entry, source] {
+            entry->sources.remove(source);
+            for (auto &i : ownerEntries) {
+                if (i.second == source)
+                    i.second = nullptr;
+            }
+            if (entry->captureSource == source)
+                entry->captureSource = nullptr;
+            // The renderer drops it by itself, render() picks another source
+            if (entry->source == source) {
+                entry->source = nullptr;
+                entry->sizeConnections.clear();
+            }
+        });
+    }
+
+    if (!entry->source)
+        setRenderedSource(entry, source);
+}
+
+void WThumbnailProviderPrivate::removeSource(Entry *entry, QQuickItem *source)
+{
+    auto ref = entry->sources.find(source);
+    if (ref == entry->sources.end() || --ref->refs > 0)
+        return;
+
+    QObject::disconnect(ref->destroyed);
+    entry->sources.erase(ref);
+    if (entry->source == source)
+        setRenderedSource(entry, entry->sources.isEmpty() ? nullptr : entry->sources.constBegin().key());
+}
+
+void WThumbnailProviderPrivate::setRenderedSource(Entry *entry, QQuickItem *source)
+{
+    for (const auto &connection : std::as_const(entry->sizeConnections))
+        QObject::disconnect(connection);
+    entry->sizeConnections.clear();
+
+    entry->source = source;
+    entry->dirty = true;
+    if (!source) {
+        entry->renderer->setSourceList({}, false);
+        return;
+    }
+
+    entry->renderer->setSourceList({source}, false);
+    entry->sizeConnections << QObject::connect(source, &QQuickItem::widthChanged, q_func(), [this] {
+        updatePixelSizes();
+    });
+    entry->sizeConnections << QObject::connect(source, &QQuickItem::heightChanged, q_func(), [this] {
+        updatePixelSizes();
+    });
+}
+
+void WThumbnailProviderPrivate::markDirty(Entry *entry)
+{
+    if (entry->dirty)
+        return;
+
+    entry->dirty = true;
+    if (!entry->isLive())
+        return;
+
+    // Usually emitted while syncing the scene graph, the render window ignores
+    // scheduleRender in that state, so let the next frame pick it up.
+    QMetaObject::invokeMethod(window, &WOutputRenderWindow::scheduleRender,
+                              Qt::QueuedConnection);
+}
+
+void WThumbnailProviderPrivate::tryRemoveEntry(Entry *entry)
+{
+    if (!entry->isUnused())
+        return;
+
+    removeEntry(entry);
+}
+
+static inline qint64 bufferBytes(const qw_buffer *buffer)
+{
+    return qint64(buffer->handle()->width) * buffer->handle()->height * BytesPerPixel;
+}
+
+void WThumbnailProviderPrivate::storeSnapshot(const QString &key, qw_buffer *buffer)
+{
+    Q_ASSERT(buffer);
+    buffer->lock();
+
+    auto &snapshot = snapshots[key];
+    if (snapshot.buffer) {
+        snapshotMemory -= bufferBytes(snapshot.buffer);
+        snapshot.buffer->unlock();
+    } else {
+        snapshot.textureProvider = new WSGTextureProvider(window);
+        notifyCachedSnapshotsChanged();
+    }
+    snapshot.buffer = buffer;
+    snapshotMemory += bufferBytes(buffer);
+    // The users of the old snapshot are updated by textureChanged
+    snapshot.textureProvider->setBuffer(buffer);
+
+    snapshotCache.removeOne(key);
+    snapshotCache.prepend(key);
+    trimSnapshotCache();
+}
+
+void WThumbnailProviderPrivate::removeSnapshot(const QString &key)
+{
+    const auto snapshot = snapshots.take(key);
+    if (!snapshot.buffer)
+        return;
+
+    snapshotCache.removeOne(key);
+    snapshotMemory -= bufferBytes(snapshot.buffer);
+    snapshot.textureProvider->setBuffer(nullptr);
+    snapshot.textureProvider->deleteLater();
+    snapshot.buffer->unlock();
+    notifyCachedSnapshotsChanged();
+}
+
+// Snapshots are stored in rendering, don't notify there
+void WThumbnailProviderPrivate::notifyCachedSnapshotsChanged()
+{
+    if (cachedSnapshotsNotifying)
+        return;
+
+    cachedSnapshotsNotifying = true;
+    QMetaObject::invokeMethod(q_func(), [this] {
+        cachedSnapshotsNotifying = false;
+        Q_EMIT q_func()->cachedSnapshotsChanged();
+    }, Qt::QueuedConnection);
+}
+
+void WThumbnailProviderPrivate::trimSnapshotCache()
+{
+    while (snapshotCache.size() > snapshotCacheSize)
+        removeSnapshot(snapshotCache.last());
+}
+
+void WThumbnailProviderPrivate::removeEntry(Entry *entry)
+{
+    if (!entries.removeOne(entry))
+        return;
+
+    if (entry->key) {
+        QObject::disconnect(entry->key, nullptr, q_func(), nullptr);
+        keyedEntries.remove(entry->key);
+    }
+    for (const auto &ref : std::as_const(entry->sources))
+        QObject::disconnect(ref.destroyed);
+    for (const auto &connection : std::as_const(entry->sizeConnections))
+        QObject::disconnect(connection);
+
+    if (entry->renderer)
+        entry->renderer->deleteLater();
+    delete entry;
+
+    updatePixelSizes();
+    Q_EMIT q_func()->countChanged();
+}
+
+QSize WThumbnailProviderPrivate::idealPixelSize(const Entry *entry) const
+{
+    if (!entry->source)
+        return {};
+
+    const QSizeF logicalSize = entry->source->size();
+    if (logicalSize.isEmpty())
+        return {};
+
+    // Snapshots aren't bounded by the thumbnail size, only by the memory budget
+    if (!entry->isLive()) {
+        return (logicalSize * window->effectiveDevicePixelRatio() * entry->snapshotScale)
+            .toSize().expandedTo(QSize(1, 1));
+    }
+
+    QSize size = (logicalSize * window->effectiveDevicePixelRatio()).toSize();
+    if (maximumSize.isValid()
+        && (size.width() > maximumSize.width() || size.height() > maximumSize.height())) {
+        size = size.scaled(maximumSize, Qt::KeepAspectRatio);
+    }
+
+    return size.expandedTo(QSize(1, 1));
+}
+
+void WThumbnailProviderPrivate::updatePixelSizes()
+{
+    qint64 total = 0;
+    QHash<Entry*, QSize> sizes;
+    sizes.reserve(entries.size());
+
+    for (auto entry : std::as_const(entries)) {
+        const QSize size = idealPixelSize(entry);
+        sizes.insert(entry, size);
+        total += qint64(size.width()) * size.height() * BytesPerPixel * BuffersPerThumbnail;
+    }
+
+    // Shrink all thumbnails uniformly to stay within the budget
+    const qreal scale = total > memoryBudget && memoryBudget > 0
+                            ? std::sqrt(qreal(memoryBudget) / total) : 1.0;
+    // The cached snapshots are already rendered, they can't be shrunk
+    qint64 usage = snapshotMemory;
+
+    for (auto i = sizes.constBegin(); i != sizes.constEnd(); ++i) {
+        Entry *entry = i.key();
+        QSize size = i.value();
+        if (!size.isEmpty() && scale < 1.0)
+            size = (QSizeF(size) * scale).toSize().expandedTo(QSize(1, 1));
+        usage += qint64(size.width()) * size.height() * BytesPerPixel * BuffersPerThumbnail;
+
+        if (entry->pixelSize == size)
+            continue;
+        entry->pixelSize = size;
+        entry->dirty = true;
+    }
+
+    setMemoryUsage(usage);
+}
+
+void WThumbnailProviderPrivate::setMemoryUsage(qint64 usage)
+{
+    if (memoryUsage == usage)
+        return;
+    memoryUsage = usage;
+    Q_EMIT q_func()->memoryUsageChanged();
+}
+
+void WThumbnailProviderPrivate::render()
+{
+    W_Q(WThumbnailProvider);
+    qint64 nextRender = -1;
+    QList<Entry*> finished;
+    bool snapshotStored = false;
+    bool firstRendered = false;
+
+    // The live thumbnails go first, a captured source may show them
+    QList<Entry*> renderList;
+    renderList.reserve(entries.size());
+    for (auto entry : std::as_const(entries)) {
+        if (!entry->source && !entry->sources.isEmpty()) {
+            setRenderedSource(entry, entry->sources.constBegin().key());
+            updatePixelSizes();
+        }
+        if (entry->captureRequested)
+            renderList.append(entry);
+        else
+            renderList.prepend(entry);
+    }
+
+    for (auto entry : std::as_const(renderList)) {
+        // Snapshots are only updated on request
+        const bool capture = entry->captureRequested;
+        if (!capture && !(entry->dirty && entry->isLive()))
+            continue;
+        if (entry->pixelSize.isEmpty())
+            continue;
+        // Hidden sources are rendered too, such as the minimized windows
+        if (!entry->source || entry->source->window() != window)
+            continue;
+        // The source is not synced to the scene graph yet
+        if (!WQmlHelper::getRootNode(entry->source))
+            continue;
+
+        // The thumbnails rendered just now are not in the scene graph until
+        // the next sync, don't capture a snapshot without them
+        if (capture && firstRendered) {
+            if (nextRender < 0)
+                nextRender = 0;
+            continue;
+        }
+
+        if (!capture && entry->lastRender.isValid()) {
+            const qint64 remaining = refreshInterval - entry->lastRender.elapsed();
+            if (remaining > 0) {
+                if (nextRender < 0 || remaining < nextRender)
+                    nextRender = remaining;
+                continue;
+            }
+        }
+
+        auto renderer = entry->renderer;
+        const qreal dpr = entry->pixelSize.width() / entry->source->width();
+        auto buffer = renderer->beginRender(entry->pixelSize, dpr, DRM_FORMAT_ARGB8888,
+                                            WBufferRenderer::DontConfigureSwapchain);
+        if (!buffer) {
+            qCWarning(qLcThumbnail) << "Failed to render the thumbnail of" << entry->source;
+            continue;
+        }
+
+        renderer->render(0, {});
+        renderer->endRender();
+
+        firstRendered = firstRendered || (!capture && !entry->lastRender.isValid());
+        entry->dirty = false;
+        entry->captureRequested = false;
+        entry->lastRender.start();
+
+        if (capture) {
+            entry->captured = true;
+            for (const auto &key : std::as_const(entry->snapshotKeys))
+                storeSnapshot(key, renderer->lastBuffer());
+            snapshotStored = snapshotStored || !entry->snapshotKeys.isEmpty();
+            entry->snapshotKeys.clear();
+
+            QPointer<QQuickItem> readySource = entry->captureSource ? entry->captureSource : entry->source;
+            if (auto source = std::exchange(entry->captureSource, nullptr))
+                removeSource(entry, source);
+            if (entry->isUnused())
+                finished.append(entry);
+
+            // Don't notify in rendering
+            QMetaObject::invokeMethod(q, [q, source = readySource] {
+                if (source)
+                    Q_EMIT q->snapshotReady(source);
+            }, Qt::QueuedConnection);
+        }
+    }
+
+    // Only kept alive for capturing the cached snapshots
+    for (auto entry : std::as_const(finished))
+        tryRemoveEntry(entry);
+
+    if (snapshotStored)
+        updatePixelSizes();
+
+    if (nextRender >= 0 && !throttleTimer.isActive())
+        throttleTimer.start(nextRender);
+}
+
+WThumbnailProvider::WThumbnailProvider(WOutputRenderWindow *window)
+    : QObject(window)
+    , WObject(*new WThumbnailProviderPrivate(this, window))
+{
+    W_D(WThumbnailProvider);
+    d->init();
+}
+
+WThumbnailProvider::~WThumbnailProvider()
+{
+
+}
+
+WOutputRenderWindow *WThumbnailProvider::window() const
+{
+    W_DC(WThumbnailProvider);
+    return d->window;
+}
+
+QObject *WThumbnailProvider::sourceKey(QQuickItem *source)
+{
+    if (auto surfaceItem = qobject_cast<WSurfaceItem*>(source)) {
+        if (surfaceItem->surface())
+            return surfaceItem->surface();
+    }
+
+    // Such as a window item wrapping its surface and decorations
+    if (auto surface = source->property("surface").value<WSurface*>())
+        return surface;
+
+    return source;
+}
+
+WBufferRenderer *WThumbnailProvider::acquire(QQuickItem *source, QObject *owner, bool live)
+{
+    W_D(WThumbnailProvider);
+    Q_ASSERT(source && owner);
+
+    auto entry = d->ownerEntries.value(owner).first;
+    if (!entry || d->ownerEntries.value(owner).second != source
+        || d->keyedEntries.value(sourceKey(source)) != entry) {
+        release(owner);
+        entry = d->ensureEntry(source);
+        d->ownerEntries.insert(owner, {entry, source});
+        d->addSource(entry, source);
+        entry->renderer->lockCacheBuffer(owner);
+    }
+
+    auto &owners = live ? entry->owners : entry->snapshotOwners;
+    auto &others = live ? entry->snapshotOwners : entry->owners;
+    others.removeOne(owner);
+    if (!owners.contains(owner))
+        owners.append(owner);
+
+    if (!live && !entry->captured)
+        entry->captureRequested = true;
+
+    d->updatePixelSizes();
+    d->window->scheduleRender();
+
+    return entry->renderer;
+}
+
+void WThumbnailProvider::release(QObject *owner)
+{
+    W_D(WThumbnailProvider);
+
+    const auto current = d->ownerEntries.take(owner);
+    auto entry = current.first;
+    if (!entry)
+        return;
+
+    entry->owners.removeOne(owner);
+    entry->snapshotOwners.removeOne(owner);
+    if (entry->renderer)
+        entry->renderer->unlockCacheBuffer(owner);
+    if (current.second)
+        d->removeSource(entry, current.second);
+    d->tryRemoveEntry(entry);
+    d->updatePixelSizes();
+}
+
+void WThumbnailProvider::captureSnapshot(QQuickItem *source, const QString &key, qreal scale)
+{
+    W_D(WThumbnailProvider);
+    if (!source || key.isEmpty() || scale <= 0)
+        return;
+
+    auto entry = d->ensureEntry(source);
+    entry->snapshotScale = scale;
+    entry->captureRequested = true;
+    if (!entry->snapshotKeys.contains(key))
+        entry->snapshotKeys.append(key);
+    if (!entry->captureSource) {
+        entry->captureSource = source;
+        d->addSource(entry, source);
+    }
+
+    d->updatePixelSizes();
+    d->window->scheduleRender();
+}
+
+void WThumbnailProvider::dropSnapshot(const QString &key)
+{
+    W_D(WThumbnailProvider);
+
+    for (auto entry : std::as_const(d->entries)) {
+        if (entry->snapshotKeys.removeOne(key)) {
+            if (entry->snapshotKeys.isEmpty()) {
+                if (auto source = std::exchange(entry->captureSource, nullptr))
+                    d->removeSource(entry, source);
+                entry->captureRequested = !entry->snapshotOwners.isEmpty() && !entry->captured;
+            }
+            d->tryRemoveEntry(entry);
+            break;
+        }
+    }
+
+    if (!d->snapshots.contains(key))
+        return;
+    d->removeSnapshot(key);
+    d->updatePixelSizes();
+}
+
+bool WThumbnailProvider::hasSnapshot(const QString &key) const
+{
+    W_DC(WThumbnailProvider);
+    return d->snapshots.contains(key);
+}
+
+WSGTextureProvider *WThumbnailProvider::snapshot(const QString &key) const
+{
+    W_DC(WThumbnailProvider);
+    return d->snapshots.value(key).textureProvider;
+}
+
+QStringList WThumbnailProvider::cachedSnapshots() const
+{
+    W_DC(WThumbnailProvider);
+    return d->snapshotCache;
+}
+
+void WThumbnailProvider::markDirty(QQuickItem *source)
+{
+    W_D(WThumbnailProvider);
+
+    if (auto entry = d->keyedEntries.value(sourceKey(source)))
+        d->markDirty(entry);
+}
+
+int WThumbnailProvider::refreshInterval() const
+{
+    W_DC(WThumbnailProvider);
+    return d->refreshInterval;
+}
+
+void WThumbnailProvider::setRefreshInterval(int newRefreshInterval)
+{
+    W_D(WThumbnailProvider);
+    newRefreshInterval = qMax(0, newRefreshInterval);
+    if (d->refreshInterval == newRefreshInterval)
+        return;
+    d->refreshInterval = newRefreshInterval;
+    Q_EMIT refreshIntervalChanged();
+}
+
+QSize WThumbnailProvider::maximumSize() const
+{
+    W_DC(WThumbnailProvider);
+    return d->maximumSize;
+}
+
+void WThumbnailProvider::setMaximumSize(const QSize &newMaximumSize)
+{
+    W_D(WThumbnailProvider);
+    if (d->maximumSize == newMaximumSize)
+        return;
+    d->maximumSize = newMaximumSize;
+    d->updatePixelSizes();
+    Q_EMIT maximumSizeChanged();
+}
+
+qint64 WThumbnailProvider::memoryBudget() const
+{
+    W_DC(WThumbnailProvider);
+    return d->memoryBudget;
+}
+
+void WThumbnailProvider::setMemoryBudget(qint64 newMemoryBudget)
+{
+    W_D(WThumbnailProvider);
+    if (d->memoryBudget == newMemoryBudget)
+        return;
+    d->memoryBudget = newMemoryBudget;
+    d->updatePixelSizes();
+    Q_EMIT memoryBudgetChanged();
+}
+
+qint64 WThumbnailProvider::memoryUsage() const
+{
+    W_DC(WThumbnailProvider);
+    return d->memoryUsage;
+}
+
+int WThumbnailProvider::count() const
+{
+    W_DC(WThumbnailProvider);
+    return d->entries.size();
+}
+
+int WThumbnailProvider::snapshotCacheSize() const
+{
+    W_DC(WThumbnailProvider);
+    return d->snapshotCacheSize;
+}
+
+void WThumbnailProvider::setSnapshotCacheSize(int newSnapshotCacheSize)
+{
+    W_D(WThumbnailProvider);
+    newSnapshotCacheSize = qMax(0, newSnapshotCacheSize);
+    if (d->snapshotCacheSize == newSnapshotCacheSize)
+        return;
+    d->snapshotCacheSize = newSnapshotCacheSize;
+    d->trimSnapshotCache();
+    d->updatePixelSizes();
+    Q_EMIT snapshotCacheSizeChanged();
+}
+
+WAYLIB_SERVER_END_NAMESPACE
+
+#include "moc_wthumbnailprovider.cpp"
@@ -0,0 +1,87 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wglobal.h>
+
+#include <QObject>
+#include <QSize>
+#include <QStringList>
+
+QT_BEGIN_NAMESPACE
+class QQuickItem;
+QT_END_NAMESPACE
+
+WAYLIB_SERVER_BEGIN_NAMESPACE
+
+class WOutputRenderWindow;
+class WBufferRenderer;
+class WSGTextureProvider;
+class WThumbnailProviderPrivate;
+class WAYLIB_SERVER_EXPORT WThumbnailProvider : public QObject, public WObject
+{
+    Q_OBJECT
+    W_DECLARE_PRIVATE(WThumbnailProvider)
+    Q_PROPERTY(int refreshInterval READ refreshInterval WRITE setRefreshInterval NOTIFY refreshIntervalChanged FINAL)
+    Q_PROPERTY(QSize maximumSize READ maximumSize WRITE setMaximumSize NOTIFY maximumSizeChanged FINAL)
+    Q_PROPERTY(qint64 memoryBudget READ memoryBudget WRITE setMemoryBudget NOTIFY memoryBudgetChanged FINAL)
+    Q_PROPERTY(qint64 memoryUsage READ memoryUsage NOTIFY memoryUsageChanged FINAL)
+    Q_PROPERTY(int count READ count NOTIFY countChanged FINAL)
+    Q_PROPERTY(int snapshotCacheSize READ snapshotCacheSize WRITE setSnapshotCacheSize NOTIFY snapshotCacheSizeChanged FINAL)
+    Q_PROPERTY(QStringList cachedSnapshots READ cachedSnapshots NOTIFY cachedSnapshotsChanged FINAL)
+    QML_NAMED_ELEMENT(ThumbnailProvider)
+    QML_UNCREATABLE("Use OutputRenderWindow.thumbnailProvider")
+
+public:
+    explicit WThumbnailProvider(WOutputRenderWindow *window);
+    ~WThumbnailProvider() override;
+
+    WOutputRenderWindow *window() const;
+
+    // The returned renderer is shared by all owners of the sources with the
+    // same sourceKey, it's a texture provider of the downscaled copy of one of
+    // them. If live is false, the owner only wants the snapshot of the source.
+    WBufferRenderer *acquire(QQuickItem *source, QObject *owner, bool live = true);
+    void release(QObject *owner);
+    // The WSurface shown by the source if any, otherwise the source itself
+    static QObject *sourceKey(QQuickItem *source);
+
+    // Render the source once and cache it as the snapshot of key, the key
+    // outlives the source, such as the id of a workspace.
+    Q_INVOKABLE void captureSnapshot(QQuickItem *source, const QString &key, qreal scale = 1.0);
+    Q_INVOKABLE void dropSnapshot(const QString &key);
+    Q_INVOKABLE bool hasSnapshot(const QString &key) const;
+    WSGTextureProvider *snapshot(const QString &key) const;
+    QStringList cachedSnapshots() const;
+
+    int refreshInterval() const;
+    void setRefreshInterval(int newRefreshInterval);
+
+    QSize maximumSize() const;
+    void setMaximumSize(const QSize &newMaximumSize);
+
+    qint64 memoryBudget() const;
+    void setMemoryBudget(qint64 newMemoryBudget);
+
+    qint64 memoryUsage() const;
+    int count() const;
+
+    int snapshotCacheSize() const;
+    void setSnapshotCacheSize(int newSnapshotCacheSize);
+
+public Q_SLOTS:
+    void markDirty(QQuickItem *source);
+
+Q_SIGNALS:
+    void refreshIntervalChanged();
+    void maximumSizeChanged();
+    void memoryBudgetChanged();
+    void memoryUsageChanged();
+    void countChanged();
+    void snapshotCacheSizeChanged();
+    void cachedSnapshotsChanged();
+    void snapshotReady(QQuickItem *source);
+};
+
+WAYLIB_SERVER_END_NAMESPACE
@@ -9,6 +9,7 @@
 #include <QDebug>
 #include <QLoggingCategory>
 #include <QTimer>
+#include <QMutex>
 #include <private/qobject_p.h>
 
 #include <memory>
@@ -478,6 +479,107 @@ static inline const char *qcursorShapeToType(std::underlying_type_t<WGlobal::Cur
     return nullptr;
 }
 
+// All frames of a cursor are decoded once into one image, every frame is
+// a rect of the atlas. It's immutable after created, so can be shared
+// between threads.
+struct Q_DECL_HIDDEN CursorAtlas
+{
+    struct Frame {
+        QRect rect;
+        QPoint hotSpot;
+        uint delay = 0;
+    };
+
+    QImage image;
+    QList<Frame> frames;
+};
+
+struct Q_DECL_HIDDEN CursorAtlasKey
+{
+    QByteArray theme;
+    uint32_t size;
+    float scale;
+    QByteArray name;
+
+    inline bool operator==(const CursorAtlasKey &other) const {
+        return theme == other.theme && size == other.size
+               && qFuzzyCompare(scale, other.scale) && name == other.name;
+    }
+};
+
+static inline size_t qHash(const CursorAtlasKey &key, size_t seed = 0)
+{
+    return qHashMulti(seed, key.theme, key.size, key.name);
+}
+
+static std::shared_ptr<const CursorAtlas> createAtlas(const QImage &image, const QPoint &hotSpot, float scale)
+{
+    auto atlas = std::make_shared<CursorAtlas>();
+    atlas->image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+    atlas->image.setDevicePixelRatio(scale);
+    atlas->frames.append({atlas->image.rect(), hotSpot, 0});
+
+    return atlas;
+}
+
+static std::shared_ptr<const CursorAtlas> createAtlas(const wlr_xcursor *xcursor, float scale)
+{
+    Q_ASSERT(xcursor->image_count > 0);
+
+    QSize size;
+    for (uint i = 0; i < xcursor->image_count; ++i) {
+        const auto ximage = xcursor->images[i];
+        size.rwidth() += ximage->width;
+        size.setHeight(qMax<int>(size.height(), ximage->height));
+    }
+
+    auto atlas = std::make_shared<CursorAtlas>();
+    atlas->image = QImage(size, QImage::Format_ARGB32_Premultiplied);
+    atlas->image.fill(Qt::transparent);
+    atlas->frames.reserve(xcursor->image_count);
+
+    int x = 0;
+    for (uint i = 0; i < xcursor->image_count; ++i) {
+        const auto ximage = xcursor->images[i];
+        const QRect rect(x, 0, ximage->width, ximage->height);
+        const auto bytesPerLine = ximage->width * sizeof(uint32_t);
+
+        for (uint y = 0; y < ximage->height; ++y) {
+            memcpy(atlas->image.scanLine(y) + x * sizeof(uint32_t),
+                   reinterpret_cast<const uchar*>(ximage->buffer) + y * bytesPerLine,
+                   bytesPerLine);
+        }
+
+        atlas->frames.append({rect, QPoint(ximage->hotspot_x, ximage->hotspot_y), ximage->delay});
+        x += ximage->width;
+    }
+    atlas->image.setDevicePixelRatio(scale);
+
+    return atlas;
+}
+
+// Shared by all WCursorImage of all threads, the atlas is released
+// when the last user is gone.
+static std::shared_ptr<const CursorAtlas> findOrCreateAtlas(const CursorAtlasKey &key,
+                                                            const wlr_xcursor *xcursor)
+{
+    static QMutex mutex;
+    static QHash<CursorAtlasKey, std::weak_ptr<const CursorAtlas>> cache;
+
+    QMutexLocker locker(&mutex);
+    if (auto atlas = cache.value(key).lock())
+        return atlas;
+
+    cache.removeIf([] (const auto &it) {
+        return it.value().expired();
+    });
+
+    auto atlas = createAtlas(xcursor, key.scale);
+    cache.insert(key, atlas);
+
+    return atlas;
+}
+
 class Q_DECL_HIDDEN WCursorImagePrivate : public QObjectPrivate {
 public:
     WCursorImagePrivate() {
@@ -489,54 +591,61 @@ public:
         Q_ASSERT(ok);
     }
 
-    void setImage(const QImage &image, const QPoint &hotspot);
+    void setAtlas(std::shared_ptr<const CursorAtlas> atlas, int frame = 0);
     void updateCursorImage();
     void playXCursor();
 
+    inline const CursorAtlas::Frame *currentFrame() const {
+        return atlas ? &atlas->frames.at(currentFrameIndex) : nullptr;
+    }
+
     W_DECLARE_PUBLIC(WCursorImage)
 
-    QImage image;// TODO: supports multi threads
-    QPoint hotSpot;
+    // The atlas and the frame index may be read from the other threads
+    mutable QMutex atlasMutex;
+    std::shared_ptr<const CursorAtlas> atlas;
+    int currentFrameIndex = 0;
 
     QCursor cursor;
     std::shared_ptr<qw_xcursor_manager> manager;
     float scale = 1.0;
 
-    wlr_xcursor *xcursor = nullptr;
-    int currentXCursorImageIndex = 0;
     QTimer *xcursorPlayTimer = nullptr;
 
     static thread_local QList<WCursorImagePrivate*> cursorImages;
 };
 thread_local QList<WCursorImagePrivate*> WCursorImagePrivate::cursorImages;
 
-void WCursorImagePrivate::setImage(const QImage &image, const QPoint &hotspot) {
-    this->image = image;
-    this->image.setDevicePixelRatio(scale);
-    this->hotSpot = hotspot;
+void WCursorImagePrivate::setAtlas(std::shared_ptr<const CursorAtlas> atlas, int frame)
+{
+    Q_ASSERT(!atlas || frame < atlas->frames.size());
+    {
+        QMutexLocker locker(&atlasMutex);
+        this->atlas = std::move(atlas);
+        currentFrameIndex = frame;
+    }
+
     Q_EMIT q_func()->imageChanged();
 }
 
 void WCursorImagePrivate::updateCursorImage()
 {
-    xcursor = nullptr;
-    currentXCursorImageIndex = 0;
-
     std::unique_ptr<QTimer, QScopedPointerObjectDeleteLater<QTimer>> tempTimer(xcursorPlayTimer);
     xcursorPlayTimer = nullptr;
     if (tempTimer)
         tempTimer->stop();
 
     if (cursor.shape() == Qt::BitmapCursor) {
-        setImage(cursor.pixmap().toImage(), cursor.hotSpot());
+        setAtlas(createAtlas(cursor.pixmap().toImage(), cursor.hotSpot(), scale));
         return;
     }
 
     if (!manager || cursor.shape() == Qt::BlankCursor) {
-        setImage(QImage(), {});
+        setAtlas(nullptr);
         return;
     }
 
+    wlr_xcursor *xcursor = nullptr;
     auto cursorName = qcursorShapeToType(cursor.shape());
     if (cursorName) {
         xcursor = getXCursorWithFallback(manager.get(), cursorName, scale);
@@ -547,16 +656,20 @@ void WCursorImagePrivate::updateCursorImage()
     }
 
     if (!xcursor || xcursor->image_count == 0) {
-        setImage(QImage(), {});
+        setAtlas(nullptr);
         return;
     }
 
-    if (xcursor->image_count == 1) {
-        auto ximage = xcursor->images[0];
-        setImage(QImage(static_cast<const uchar*>(ximage->buffer),
-                        ximage->width, ximage->height,
-                        QImage::Format_ARGB32_Premultiplied),
-                 QPoint(ximage->hotspot_x, ximage->hotspot_y));
+    const CursorAtlasKey key {
+        manager->handle()->name,
+        manager->handle()->size,
+        scale,
+        xcursor->name,
+    };
+    auto atlas = findOrCreateAtlas(key, xcursor);
+
+    if (atlas->frames.size() == 1) {
+        setAtlas(std::move(atlas));
         return;
     }
 
@@ -569,24 +682,21 @@ void WCursorImagePrivate::updateCursorImage()
         Q_ASSERT(ok);
     }
 
+    // Start from the last frame, so playXCursor will show the first frame
+    const int lastFrame = atlas->frames.size() - 1;
+    setAtlas(std::move(atlas), lastFrame);
     playXCursor();
 }
 
 void WCursorImagePrivate::playXCursor()
 {
-    Q_ASSERT(xcursor);
-    Q_ASSERT(currentXCursorImageIndex < xcursor->image_count);
+    Q_ASSERT(atlas && atlas->frames.size() > 1);
     Q_ASSERT(xcursorPlayTimer);
     Q_ASSERT(!xcursorPlayTimer->isActive());
 
-    auto ximage = xcursor->images[currentXCursorImageIndex];
-    setImage(QImage(static_cast<const uchar*>(ximage->buffer),
-                    ximage->width, ximage->height,
-                    QImage::Format_ARGB32_Premultiplied),
-             QPoint(ximage->hotspot_x, ximage->hotspot_y));
-
-    currentXCursorImageIndex = (currentXCursorImageIndex + 1) % xcursor->image_count;
-    xcursorPlayTimer->start(ximage->delay);
+    // Only the frame index is changed, the atlas keeps the same
+    setAtlas(atlas, (currentFrameIndex + 1) % atlas->frames.size());
+    xcursorPlayTimer->start(currentFrame()->delay);
 }
 
 WCursorImage::WCursorImage(QObject *parent)
@@ -598,13 +708,48 @@ WCursorImage::WCursorImage(QObject *parent)
 QImage WCursorImage::image() const
 {
     Q_D(const WCursorImage);
-    return d->image;
+    QMutexLocker locker(&d->atlasMutex);
+    auto frame = d->currentFrame();
+    if (!frame)
+        return {};
+
+    const QImage &atlas = d->atlas->image;
+    if (frame->rect == atlas.rect())
+        return atlas;
+
+    // Not a copy, the image shares the memory of the atlas and keeps it alive
+    auto owner = new std::shared_ptr<const CursorAtlas>(d->atlas);
+    QImage image(atlas.constScanLine(frame->rect.y()) + frame->rect.x() * atlas.depth() / 8,
+                 frame->rect.width(), frame->rect.height(), atlas.bytesPerLine(), atlas.format(),
+                 [] (void *owner) {
+                     delete static_cast<std::shared_ptr<const CursorAtlas>*>(owner);
+                 }, owner);
+    image.setDevicePixelRatio(atlas.devicePixelRatio());
+
+    return image;
 }
 
 QPoint WCursorImage::hotSpot() const
 {
     Q_D(const WCursorImage);
-    return d->hotSpot;
+    QMutexLocker locker(&d->atlasMutex);
+    auto frame = d->currentFrame();
+    return frame ? frame->hotSpot : QPoint();
+}
+
+QImage WCursorImage::atlas() const
+{
+    Q_D(const WCursorImage);
+    QMutexLocker locker(&d->atlasMutex);
+    return d->atlas ? d->atlas->image : QImage();
+}
+
+QRect WCursorImage::frameRect() const
+{
+    Q_D(const WCursorImage);
+    QMutexLocker locker(&d->atlasMutex);
+    auto frame = d->currentFrame();
+    return frame ? frame->rect : QRect();
 }
 
 QCursor WCursorImage::cursor() const
@@ -22,6 +22,9 @@ public:
 
     QImage image() const;
     QPoint hotSpot() const;
+    // All frames of the current cursor, the current frame is at frameRect
+    QImage atlas() const;
+    QRect frameRect() const;
 
     QCursor cursor() const;
     void setCursor(const QCursor &newCursor);
@@ -12,9 +12,12 @@ extern "C" {
 #include <qcolorspace.h>
 #include <QDebug>
 #include <QQuickItem>
+#include <QVarLengthArray>
 
 #include <pixman.h>
 #include <drm_fourcc.h>
+#include <wayland-server-protocol.h>
+#include <cmath>
 
 WAYLIB_SERVER_BEGIN_NAMESPACE
 
@@ -271,6 +274,159 @@ bool WTools::toPixmanRegion(const QRegion &region, pixman_region32 *pixmanRegion
     return ok;
 }
 
+// The rectangles must be y-x banded like the ones of a valid pixman region
+static QRegion fromBandedRects(const QRect *rects, int count)
+{
+    QRegion region;
+    if (count == 1)
+        region = rects[0];
+    else if (count > 1)
+        region.setRects(rects, count);
+    return region;
+}
+
+// Merge the band starting at band into the last band if they have the same
+// rectangles and touch, lastBand becomes the start of the last band
+static void coalesceBand(QVarLengthArray<QRect, 32> &rects, qsizetype &lastBand, qsizetype band)
+{
+    const qsizetype count = rects.size() - band;
+    if (count == 0)
+        return;
+
+    bool same = lastBand < band && band - lastBand == count
+                && rects.at(lastBand).bottom() + 1 == rects.at(band).top();
+    for (qsizetype i = 0; same && i < count; ++i) {
+        same = rects.at(lastBand + i).left() == rects.at(band + i).left()
+               && rects.at(lastBand + i).right() == rects.at(band + i).right();
+    }
+
+    if (!same) {
+        lastBand = band;
+        return;
+    }
+
+    const int bottom = rects.at(band).bottom();
+    for (qsizetype i = 0; i < count; ++i)
+        rects[lastBand + i].setBottom(bottom);
+    rects.resize(band);
+}
+
+static QRegion fromUnsortedBoxes(const pixman_box32_t *boxes, int count)
+{
+    pixman_region32_t region;
+    // It sorts the boxes and merges the overlapping ones
+    if (!pixman_region32_init_rects(&region, boxes, count))
+        return {};
+
+    auto qregion = WTools::fromPixmanRegion(&region);
+    pixman_region32_fini(&region);
+    return qregion;
+}
+
+QRegion WTools::transformRegion(const QRegion &region, uint32_t transform, const QSize &size)
+{
+    if (transform == WL_OUTPUT_TRANSFORM_NORMAL || region.isEmpty())
+        return region;
+
+    const int width = size.width();
+    const int height = size.height();
+    QVarLengthArray<pixman_box32_t, 32> boxes(region.rectCount());
+
+    int i = 0;
+    for (const QRect &r : region) {
+        const int x1 = r.x();
+        const int y1 = r.y();
+        const int x2 = r.right() + 1;
+        const int y2 = r.bottom() + 1;
+        pixman_box32_t &box = boxes[i++];
+
+        switch (transform) {
+        case WL_OUTPUT_TRANSFORM_90:
+            box = { height - y2, x1, height - y1, x2 };
+            break;
+        case WL_OUTPUT_TRANSFORM_180:
+            box = { width - x2, height - y2, width - x1, height - y1 };
+            break;
+        case WL_OUTPUT_TRANSFORM_270:
+            box = { y1, width - x2, y2, width - x1 };
+            break;
+        case WL_OUTPUT_TRANSFORM_FLIPPED:
+            box = { width - x2, y1, width - x1, y2 };
+            break;
+        case WL_OUTPUT_TRANSFORM_FLIPPED_90:
+            box = { y1, x1, y2, x2 };
+            break;
+        case WL_OUTPUT_TRANSFORM_FLIPPED_180:
+            box = { x1, height - y2, x2, height - y1 };
+            break;
+        case WL_OUTPUT_TRANSFORM_FLIPPED_270:
+            box = { height - y2, width - x2, height - y1, width - x1 };
+            break;
+        default:
+            Q_UNREACHABLE();
+        }
+    }
+
+    return fromUnsortedBoxes(boxes.constData(), boxes.size());
+}
+
+QRegion WTools::scaleRegion(const QRegion &region, qreal scale)
+{
+    if (qFuzzyCompare(scale, 1.0) || region.isEmpty())
+        return region;
+
+    if (scale == qRound(scale)) {
+        // The bands are kept, no need to sort them again
+        const int s = qRound(scale);
+        QVarLengthArray<QRect, 32> rects;
+        rects.reserve(region.rectCount());
+        for (const QRect &r : region)
+            rects.append(QRect(r.topLeft() * s, r.size() * s));
+        return fromBandedRects(rects.constData(), rects.size());
+    }
+
+    QVarLengthArray<pixman_box32_t, 32> boxes(region.rectCount());
+    int i = 0;
+    for (const QRect &r : region) {
+        boxes[i++] = {
+            int(std::floor(r.x() * scale)),
+            int(std::floor(r.y() * scale)),
+            int(std::ceil((r.right() + 1) * scale)),
+            int(std::ceil((r.bottom() + 1) * scale)),
+        };
+    }
+
+    return fromUnsortedBoxes(boxes.constData(), boxes.size());
+}
+
+QRegion WTools::clipRegion(const QRegion &region, const QRect &clip)
+{
+    if (region.isEmpty() || clip.isEmpty())
+        return {};
+
+    // Clipping every rectangle keeps the bands, and the rectangles of a band
+    // can't abut after being clipped. But the bands which were different only
+    // outside of the clip become the same, they're merged like pixman does.
+    QVarLengthArray<QRect, 32> rects;
+    rects.reserve(region.rectCount());
+    qsizetype lastBand = 0;
+    qsizetype band = 0;
+    for (const QRect &r : region) {
+        const QRect clipped = r & clip;
+        if (clipped.isEmpty())
+            continue;
+
+        if (band < rects.size() && rects.at(band).top() != clipped.top()) {
+            coalesceBand(rects, lastBand, band);
+            band = rects.size();
+        }
+        rects.append(clipped);
+    }
+    coalesceBand(rects, lastBand, band);
+
+    return fromBandedRects(rects.constData(), rects.size());
+}
+
 QRect WTools::fromWLRBox(void *box)
 {
     auto wlrBox = reinterpret_cast<wlr_box*>(box);
@@ -29,6 +29,12 @@ public:
     static wl_shm_format_t drmToShmFormat(uint32_t drmFmt);
     static QRegion fromPixmanRegion(pixman_region32 *region);
     static bool toPixmanRegion(const QRegion &region, pixman_region32 *pixmanRegion);
+    // Same as wlr_region_transform, the transform is a wl_output_transform, the size
+    // is the size of the untransformed area.
+    static QRegion transformRegion(const QRegion &region, uint32_t transform, const QSize &size);
+    // Same as wlr_region_scale, the rectangles are extended to the integer boundaries.
+    static QRegion scaleRegion(const QRegion &region, qreal scale);
+    static QRegion clipRegion(const QRegion &region, const QRect &clip);
     static QRect fromWLRBox(void *box);
     static void toWLRBox(const QRect &rect, void *box);
     static Qt::Edges toQtEdge(uint32_t edges);
@@ -0,0 +1,42 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+// Replay a trace recorded by WServer::startRecording (or WAYLIB_PROTOCOL_TRACE) against
+// a running compositor, such as a waylib compositor with WLR_BACKENDS=headless, and
+// report the time, the CPU usage of the compositor and the frame callback intervals.
+
+#include "protocolreplayer.h"
+
+#include <QCoreApplication>
+#include <QCommandLineParser>
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription("Replay a Wayland protocol trace recorded by waylib");
+    parser.addHelpOption();
+    QCommandLineOption maxSpeedOption("max-speed", "Replay the requests without the recorded delays.");
+    QCommandLineOption socketOption("socket", "The socket of the compositor, WAYLAND_DISPLAY by default.", "name");
+    QCommandLineOption strictOption("strict", "Fail if the trace binds an interface that can't be replayed.");
+    parser.addOption(maxSpeedOption);
+    parser.addOption(socketOption);
+    parser.addOption(strictOption);
+    parser.addPositionalArgument("trace", "The trace file.");
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1)
+        parser.showHelp(1);
+
+    Replayer replayer;
+    if (!replayer.open(parser.positionalArguments().first()))
+        return 1;
+    if (!replayer.run(parser.value(socketOption).toLocal8Bit(), parser.isSet(maxSpeedOption)))
+        return 1;
+
+    replayer.printReport();
+    if (parser.isSet(strictOption) && !replayer.unboundInterfaces().isEmpty())
+        return 2;
+    return 0;
+}
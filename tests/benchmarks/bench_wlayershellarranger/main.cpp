@@ -0,0 +1,98 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wlayershellarranger.h>
+
+#include <QTest>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+using Layer = WLayerSurface::LayerType;
+using Anchor = WLayerSurface::AnchorType;
+using State = WLayerShellArranger::State;
+
+static constexpr int SurfaceCount = 50;
+static constexpr int PanelCount = 8;
+
+class LayerShellArrangerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    static State stateAt(int index)
+    {
+        static constexpr Layer layers[] = { Layer::Background, Layer::Bottom, Layer::Top, Layer::Overlay };
+        static constexpr Anchor edges[] = { Anchor::Top, Anchor::Bottom, Anchor::Left, Anchor::Right };
+
+        State state;
+        state.layer = layers[index % 4];
+        if (index < PanelCount) {
+            const auto edge = edges[index % 4];
+            const bool horizontal = edge == Anchor::Top || edge == Anchor::Bottom;
+            state.anchor = edge | (horizontal ? Anchor::Left | Anchor::Right : Anchor::Top | Anchor::Bottom);
+            state.exclusiveZone = 24;
+            state.desiredSize = horizontal ? QSize(0, 24) : QSize(24, 0);
+        } else {
+            state.anchor = edges[index % 4] | edges[(index + 2) % 4];
+            state.margins = QMargins(4, 4, 4, 4);
+            state.desiredSize = QSize(200 + index, 100 + index);
+        }
+
+        return state;
+    }
+
+    void fill(WLayerShellArranger *arranger)
+    {
+        for (int i = 0; i < SurfaceCount; ++i)
+            arranger->setState(&m_keys[i], stateAt(i));
+    }
+
+private Q_SLOTS:
+    void benchArrange()
+    {
+        QBENCHMARK {
+            WLayerShellArranger arranger;
+            arranger.setOutputGeometry(QRect(0, 0, 3840, 2160));
+            fill(&arranger);
+        }
+    }
+
+    void benchCommitNonExclusive()
+    {
+        WLayerShellArranger arranger;
+        arranger.setOutputGeometry(QRect(0, 0, 3840, 2160));
+        fill(&arranger);
+
+        // Every surface commits a new size, like when they are animating
+        int frame = 0;
+        QBENCHMARK {
+            ++frame;
+            for (int i = PanelCount; i < SurfaceCount; ++i) {
+                auto state = stateAt(i);
+                state.desiredSize += QSize(frame % 2, frame % 2);
+                arranger.setState(&m_keys[i], state);
+            }
+        }
+    }
+
+    void benchCommitExclusive()
+    {
+        WLayerShellArranger arranger;
+        arranger.setOutputGeometry(QRect(0, 0, 3840, 2160));
+        fill(&arranger);
+
+        int frame = 0;
+        QBENCHMARK {
+            ++frame;
+            auto state = stateAt(0);
+            state.exclusiveZone += frame % 2;
+            arranger.setState(&m_keys[0], state);
+        }
+    }
+
+private:
+    QObject m_keys[SurfaceCount];
+};
+
+QTEST_MAIN(LayerShellArrangerBenchmark)
+#include "main.moc"
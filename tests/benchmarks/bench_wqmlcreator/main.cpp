@@ -0,0 +1,162 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wqmlcreator.h>
+
+#include <QTest>
+#include <QJSEngine>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+static constexpr int OwnerCount = 1000;
+
+// Like DynamicCreatorComponent, but uses the owner as the created object
+class BenchComponent : public WAbstractCreatorComponent
+{
+    Q_OBJECT
+public:
+    using WAbstractCreatorComponent::WAbstractCreatorComponent;
+    using WAbstractCreatorComponent::remove;
+
+    QSharedPointer<WQmlCreatorDelegateData> add(QSharedPointer<WQmlCreatorData> data) override {
+        QSharedPointer<WQmlCreatorDelegateData> d(new WQmlCreatorDelegateData());
+        d->object = data->owner;
+        d->data = data;
+        m_datas.insert(data.get(), d);
+        return d;
+    }
+
+    void remove(QSharedPointer<WQmlCreatorData> data) override {
+        m_datas.remove(data.get());
+    }
+
+    QList<QSharedPointer<WQmlCreatorDelegateData>> datas() const override {
+        return m_datas.values();
+    }
+
+private:
+    QHash<WQmlCreatorData*, QSharedPointer<WQmlCreatorDelegateData>> m_datas;
+};
+
+class QmlCreatorBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    void createOwners()
+    {
+        qDeleteAll(m_owners);
+        m_owners.clear();
+        m_owners.reserve(OwnerCount);
+        for (int i = 0; i < OwnerCount; ++i)
+            m_owners.append(new QObject(this));
+    }
+
+    void fill(WQmlCreator *creator)
+    {
+        for (int i = 0; i < OwnerCount; ++i) {
+            QJSValue properties = m_engine.newObject();
+            properties.setProperty("index", i);
+            creator->add(m_owners.at(i), properties);
+        }
+    }
+
+    void setDelegates(WQmlCreator *creator)
+    {
+        // Compositors usually have several delegates on one creator
+        for (int i = 0; i < 3; ++i)
+            (new BenchComponent(creator))->setCreator(creator);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        createOwners();
+    }
+
+    void benchAdd()
+    {
+        QBENCHMARK {
+            WQmlCreator creator;
+            setDelegates(&creator);
+            fill(&creator);
+            creator.clear(false);
+        }
+    }
+
+    void benchGetByOwner()
+    {
+        WQmlCreator creator;
+        setDelegates(&creator);
+        fill(&creator);
+        const auto lastDelegate = creator.delegates().last();
+
+        QBENCHMARK {
+            for (auto owner : std::as_const(m_owners)) {
+                QCOMPARE(creator.getByOwner(owner), owner);
+                QCOMPARE(creator.getByOwner(lastDelegate, owner), owner);
+            }
+        }
+
+        creator.clear(false);
+    }
+
+    void benchGetIf()
+    {
+        WQmlCreator creator;
+        setDelegates(&creator);
+        fill(&creator);
+
+        // Matches the last one, the worst case of the predicate
+        const QJSValue function = m_engine.evaluate(QStringLiteral("(function(p) { return p.index === %1 })")
+                                                       .arg(OwnerCount - 1));
+        QVERIFY(function.isCallable());
+
+        QBENCHMARK {
+            QCOMPARE(creator.getIf(function), m_owners.last());
+        }
+
+        creator.clear(false);
+    }
+
+    void benchAddAndRemoveByOwner()
+    {
+        QBENCHMARK {
+            WQmlCreator creator;
+            setDelegates(&creator);
+            fill(&creator);
+            for (auto owner : std::as_const(m_owners))
+                QVERIFY(creator.removeByOwner(owner));
+            QCOMPARE(creator.count(), 0);
+        }
+    }
+
+    void benchAddAndDestroyOwner()
+    {
+        QBENCHMARK {
+            WQmlCreator creator;
+            setDelegates(&creator);
+            fill(&creator);
+            qDeleteAll(m_owners);
+            m_owners.clear();
+            QCOMPARE(creator.count(), 0);
+
+            QBENCHMARK_SUSPEND {
+                createOwners();
+            }
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        qDeleteAll(m_owners);
+        m_owners.clear();
+    }
+
+private:
+    QJSEngine m_engine;
+    QList<QObject*> m_owners;
+};
+
+QTEST_MAIN(QmlCreatorBenchmark)
+#include "main.moc"
@@ -0,0 +1,204 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wseat.h>
+#include <wsurface.h>
+#include <winputdevice.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+#include <qwinputdevice.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QPointer>
+
+#include <wayland-client.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+extern "C" {
+#include <wlr/interfaces/wlr_keyboard.h>
+#include <linux/input-event-codes.h>
+#include <xkbcommon/xkbcommon-keysyms.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+static constexpr int KeyCount = 1000;
+
+class SeatKeysBenchmark : public QObject
+{
+    Q_OBJECT
+public:
+    SeatKeysBenchmark(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    void dispatchClient()
+    {
+        wl_display_flush(m_display);
+        QCoreApplication::processEvents();
+
+        if (wl_display_prepare_read(m_display) == 0) {
+            pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+            if (poll(&fd, 1, 10) > 0)
+                wl_display_read_events(m_display);
+            else
+                wl_display_cancel_read(m_display);
+        }
+        wl_display_dispatch_pending(m_display);
+    }
+
+    // Like typing fast, each key is pressed and released
+    void typeKeys()
+    {
+        static const uint32_t keys[] = { KEY_Q, KEY_W, KEY_E, KEY_R, KEY_T, KEY_Y };
+
+        for (int i = 0; i < KeyCount; ++i) {
+            wlr_keyboard_key_event event {
+                .time_msec = uint32_t(i),
+                .keycode = keys[i % std::size(keys)],
+                .update_state = true,
+                .state = WL_KEYBOARD_KEY_STATE_PRESSED,
+            };
+            wlr_keyboard_notify_key(&m_keyboard, &event);
+            event.state = WL_KEYBOARD_KEY_STATE_RELEASED;
+            wlr_keyboard_notify_key(&m_keyboard, &event);
+        }
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<SeatKeysBenchmark*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        } else if (qstrcmp(interface, wl_seat_interface.name) == 0) {
+            self->m_clientSeat = static_cast<wl_seat*>(
+                wl_registry_bind(registry, name, &wl_seat_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_seat = m_server->attach<WSeat>();
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        auto compositor = qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+        connect(compositor, &qw_compositor::notify_new_surface, this, [this] (wlr_surface *surface) {
+            m_wSurface = new WSurface(qw_surface::from(surface), this);
+            connect(m_wSurface->handle(), &qw_surface::before_destroy,
+                    m_wSurface, &WSurface::safeDeleteLater);
+        });
+
+        static const wlr_keyboard_impl keyboardImpl = {
+            .name = "bench-keyboard",
+        };
+        wlr_keyboard_init(&m_keyboard, &keyboardImpl, keyboardImpl.name);
+        m_keyboardDevice = new WInputDevice(qw_input_device::from(&m_keyboard.base));
+        m_seat->attachInputDevice(m_keyboardDevice);
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        for (int i = 0; i < 10 && !(m_compositor && m_clientSeat); ++i)
+            dispatchClient();
+        QVERIFY(m_compositor);
+        QVERIFY(m_clientSeat);
+
+        m_clientKeyboard = wl_seat_get_keyboard(m_clientSeat);
+        m_surface = wl_compositor_create_surface(m_compositor);
+        for (int i = 0; i < 10 && !m_wSurface; ++i)
+            dispatchClient();
+        QVERIFY(m_wSurface);
+
+        m_seat->setKeyboardFocusSurface(m_wSurface);
+        QCOMPARE(m_seat->keyboardFocusSurface(), m_wSurface.get());
+        // A shortcut which is never typed, the table isn't empty as a real compositor
+        m_seat->addShortcut(XKB_KEY_Tab, Qt::AltModifier);
+    }
+
+    void benchQtPath()
+    {
+        m_seat->setShortcutPreFilter(false);
+
+        QBENCHMARK {
+            typeKeys();
+            dispatchClient();
+        }
+    }
+
+    void benchShortcutPreFilter()
+    {
+        m_seat->setShortcutPreFilter(true);
+
+        QBENCHMARK {
+            typeKeys();
+            dispatchClient();
+        }
+    }
+
+    void cleanupTestCase()
+    {
+        m_seat->detachInputDevice(m_keyboardDevice);
+        wlr_keyboard_finish(&m_keyboard);
+
+        wl_keyboard_destroy(m_clientKeyboard);
+        wl_surface_destroy(m_surface);
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    WSeat *m_seat = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    QPointer<WSurface> m_wSurface;
+    wlr_keyboard m_keyboard;
+    WInputDevice *m_keyboardDevice = nullptr;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_seat *m_clientSeat = nullptr;
+    wl_keyboard *m_clientKeyboard = nullptr;
+    wl_surface *m_surface = nullptr;
+};
+
+int main(int argc, char *argv[])
+{
+    // WSeat adds the input devices to the wlroots QPA
+    WServer::initializeQPA();
+    QGuiApplication app(argc, argv);
+
+    SeatKeysBenchmark bench;
+    return QTest::qExec(&bench, argc, argv);
+}
+
+#include "main.moc"
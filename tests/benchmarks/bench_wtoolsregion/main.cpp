@@ -0,0 +1,122 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wtools.h>
+
+#include <QTest>
+#include <QtMath>
+
+#include <pixman.h>
+#include <wayland-server-protocol.h>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+static QRegion fragmentedRegion(int count)
+{
+    const int columns = qCeil(qSqrt(count));
+    QList<QRect> rects;
+    rects.reserve(count);
+    for (int i = 0; i < count; ++i)
+        rects.append(QRect((i % columns) * 16, (i / columns) * 16, 8, 8));
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+static void addRectCounts()
+{
+    QTest::addColumn<int>("rectCount");
+
+    for (int count : { 1, 10, 100, 1000, 10000 })
+        QTest::addRow("%d", count) << count;
+}
+
+class WToolsRegionBenchmark : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void benchFromPixmanRegion_data() { addRectCounts(); }
+    void benchFromPixmanRegion()
+    {
+        QFETCH(int, rectCount);
+        pixman_region32_t pixmanRegion;
+        WTools::toPixmanRegion(fragmentedRegion(rectCount), &pixmanRegion);
+
+        QBENCHMARK {
+            const auto region = WTools::fromPixmanRegion(&pixmanRegion);
+            Q_UNUSED(region);
+        }
+
+        pixman_region32_fini(&pixmanRegion);
+    }
+
+    void benchToPixmanRegion_data() { addRectCounts(); }
+    void benchToPixmanRegion()
+    {
+        QFETCH(int, rectCount);
+        const QRegion region = fragmentedRegion(rectCount);
+
+        QBENCHMARK {
+            pixman_region32_t pixmanRegion;
+            WTools::toPixmanRegion(region, &pixmanRegion);
+            pixman_region32_fini(&pixmanRegion);
+        }
+    }
+
+    void benchTransformRegion_data() { addRectCounts(); }
+    void benchTransformRegion()
+    {
+        QFETCH(int, rectCount);
+        const QRegion region = fragmentedRegion(rectCount);
+        const QSize size = region.boundingRect().size();
+
+        QBENCHMARK {
+            const auto result = WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_90, size);
+            Q_UNUSED(result);
+        }
+    }
+
+    void benchScaleRegion_data() { addRectCounts(); }
+    void benchScaleRegion()
+    {
+        QFETCH(int, rectCount);
+        const QRegion region = fragmentedRegion(rectCount);
+
+        QBENCHMARK {
+            const auto result = WTools::scaleRegion(region, 1.25);
+            Q_UNUSED(result);
+        }
+    }
+
+    // The baseline of benchScaleRegion, QTransform unites the mapped rectangles one by one
+    void benchQTransformScale_data() { addRectCounts(); }
+    void benchQTransformScale()
+    {
+        QFETCH(int, rectCount);
+        const QRegion region = fragmentedRegion(rectCount);
+        const auto transform = QTransform::fromScale(1.25, 1.25);
+
+        QBENCHMARK {
+            const auto result = transform.map(region);
+            Q_UNUSED(result);
+        }
+    }
+
+    void benchClipRegion_data() { addRectCounts(); }
+    void benchClipRegion()
+    {
+        QFETCH(int, rectCount);
+        const QRegion region = fragmentedRegion(rectCount);
+        const QRect clip = region.boundingRect().adjusted(5, 5, -5, -5);
+
+        QBENCHMARK {
+            const auto result = WTools::clipRegion(region, clip);
+            Q_UNUSED(result);
+        }
+    }
+};
+
+QTEST_MAIN(WToolsRegionBenchmark)
+#include "main.moc"
@@ -0,0 +1,96 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wglobal.h>
+
+#include <qwobject.h>
+
+#include <QTest>
+
+WAYLIB_SERVER_USE_NAMESPACE
+QW_USE_NAMESPACE
+
+static constexpr int ConnectionCount = 10000;
+static constexpr int ReceiverCount = 100;
+
+class FakeHandle : public qw_object_basic
+{
+    Q_OBJECT
+public:
+    using qw_object_basic::qw_object_basic;
+
+Q_SIGNALS:
+    void notify_event();
+};
+
+class FakeWrapObject : public WWrapObject
+{
+    Q_OBJECT
+public:
+    FakeWrapObject()
+    {
+        initHandle(&m_handle);
+    }
+
+    using WWrapObject::invalidate;
+
+private:
+    FakeHandle m_handle;
+};
+
+class WrapObjectBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    QList<QMetaObject::Connection> makeConnections(FakeWrapObject *object)
+    {
+        QList<QMetaObject::Connection> connections;
+        connections.reserve(ConnectionCount);
+        for (int i = 0; i < ConnectionCount; ++i) {
+            connections.append(object->safeConnect(&FakeHandle::notify_event,
+                                                   &m_receivers[i % ReceiverCount], [] {}));
+        }
+
+        return connections;
+    }
+
+private Q_SLOTS:
+    void benchConnectAndInvalidate()
+    {
+        QBENCHMARK {
+            FakeWrapObject object;
+            makeConnections(&object);
+            object.invalidate();
+        }
+    }
+
+    void benchDisconnectByReceiver()
+    {
+        QBENCHMARK {
+            FakeWrapObject object;
+            makeConnections(&object);
+            for (const auto &receiver : m_receivers)
+                QVERIFY(object.safeDisconnect(&receiver));
+            object.invalidate();
+        }
+    }
+
+    void benchDisconnectByConnection()
+    {
+        QBENCHMARK {
+            FakeWrapObject object;
+            const auto connections = makeConnections(&object);
+            // The newest connection first, it was the worst case for a flat list
+            for (auto it = connections.crbegin(); it != connections.crend(); ++it)
+                QVERIFY(object.safeDisconnect(*it));
+            object.invalidate();
+        }
+    }
+
+private:
+    QObject m_receivers[ReceiverCount];
+};
+
+QTEST_MAIN(WrapObjectBenchmark)
+#include "main.moc"
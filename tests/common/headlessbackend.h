@@ -0,0 +1,88 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#pragma once
+
+#include <wbackend.h>
+#include <woutput.h>
+#include <woutputrenderwindow.h>
+#include <woutputviewport.h>
+#include <wrenderhelper.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwallocator.h>
+#include <qwoutput.h>
+
+#include <functional>
+
+extern "C" {
+#include <wlr/backend/headless.h>
+#include <wlr/backend/multi.h>
+}
+
+// The helpers of the tests running on WLR_BACKENDS=headless
+namespace HeadlessBackend {
+
+// The headless backend in the multi backend of WBackend
+inline wlr_backend *find(WAYLIB_SERVER_NAMESPACE::WBackend *backend)
+{
+    wlr_backend *headless = nullptr;
+    wlr_multi_for_each_backend(backend->handle()->handle(), [] (wlr_backend *backend, void *data) {
+        if (wlr_backend_is_headless(backend))
+            *static_cast<wlr_backend**>(data) = backend;
+    }, &headless);
+
+    return headless;
+}
+
+// Add a headless output, return the WOutput created for it by the backend
+inline WAYLIB_SERVER_NAMESPACE::WOutput *addOutput(WAYLIB_SERVER_NAMESPACE::WBackend *backend,
+                                                   int width, int height)
+{
+    auto headless = find(backend);
+    if (!headless)
+        return nullptr;
+
+    WAYLIB_SERVER_NAMESPACE::WOutput *output = nullptr;
+    auto connection = QObject::connect(backend, &WAYLIB_SERVER_NAMESPACE::WBackend::outputAdded,
+                                       backend, [&output] (WAYLIB_SERVER_NAMESPACE::WOutput *o) {
+        output = o;
+    });
+    wlr_headless_add_output(headless, width, height);
+    QObject::disconnect(connection);
+
+    return output;
+}
+
+// Create the software renderer and an allocator for it, like the compositor running
+// with QSGRendererInterface::Software
+inline bool createRenderer(WAYLIB_SERVER_NAMESPACE::WBackend *backend,
+                           QW_NAMESPACE::qw_renderer **renderer,
+                           QW_NAMESPACE::qw_allocator **allocator)
+{
+    *renderer = WAYLIB_SERVER_NAMESPACE::WRenderHelper::createRenderer(backend->handle(),
+                                                                       QSGRendererInterface::Software);
+    if (!*renderer)
+        return false;
+    *allocator = QW_NAMESPACE::qw_allocator::autocreate(*backend->handle(), **renderer);
+    return *allocator;
+}
+
+// Enable the output of each viewport once it's initialized in the window,
+// the state can be changed by setupState before committing
+inline void enableOutputs(WAYLIB_SERVER_NAMESPACE::WOutputRenderWindow *window,
+                          const std::function<void(QW_NAMESPACE::qw_output_state &)> &setupState = {})
+{
+    QObject::connect(window, &WAYLIB_SERVER_NAMESPACE::WOutputRenderWindow::outputViewportInitialized,
+                     window, [setupState] (WAYLIB_SERVER_NAMESPACE::WOutputViewport *viewport) {
+        QW_NAMESPACE::qw_output_state state;
+        state.set_enabled(true);
+        if (setupState)
+            setupState(state);
+        bool ok = viewport->output()->handle()->commit_state(state);
+        Q_ASSERT(ok);
+    });
+}
+
+} // namespace HeadlessBackend
@@ -0,0 +1,474 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include "protocolreplayer.h"
+
+#include <QVarLengthArray>
+
+#include <xdg-shell-client-protocol.h>
+#include <viewporter-client-protocol.h>
+#include <linux-dmabuf-unstable-v1-client-protocol.h>
+
+#include <poll.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/resource.h>
+#include <sys/socket.h>
+
+#include <algorithm>
+
+WAYLIB_SERVER_USE_NAMESPACE
+using namespace WProtocolTrace;
+
+// The interfaces can be bound by the replay, the objects of the other globals are skipped
+static const wl_interface *const boundInterfaces[] = {
+    &wl_compositor_interface,
+    &wl_subcompositor_interface,
+    &wl_shm_interface,
+    &wl_seat_interface,
+    &wl_output_interface,
+    &wl_data_device_manager_interface,
+    &xdg_wm_base_interface,
+    &wp_viewporter_interface,
+    // The dmabufs can't be recreated, but the feedback and the formats are queried
+    &zwp_linux_dmabuf_v1_interface,
+};
+
+static const wl_interface *findInterface(const char *name)
+{
+    for (auto interface : boundInterfaces) {
+        if (qstrcmp(interface->name, name) == 0)
+            return interface;
+    }
+    return nullptr;
+}
+
+static int dispatchEvent(const void *data, void *target, uint32_t, const wl_message *message,
+                         wl_argument *args)
+{
+    auto client = static_cast<ReplayClient*>(const_cast<void*>(data));
+    client->handleEvent(static_cast<wl_proxy*>(target), message, args);
+    return 0;
+}
+
+ReplayClient::ReplayClient(Replayer *replayer, wl_display *display)
+    : m_replayer(replayer)
+    , m_display(display)
+{
+    m_objects.insert(1, reinterpret_cast<wl_proxy*>(display));
+}
+
+ReplayClient::~ReplayClient()
+{
+    for (const auto &pool : std::as_const(m_pools)) {
+        munmap(pool.data, pool.size);
+        close(pool.fd);
+    }
+
+    wl_display_disconnect(m_display);
+}
+
+wl_proxy *ReplayClient::addObject(quint32 id, wl_proxy *proxy)
+{
+    wl_proxy_add_dispatcher(proxy, dispatchEvent, this, nullptr);
+    m_objects.insert(id, proxy);
+    return proxy;
+}
+
+bool ReplayClient::createPool(quint32 id, qint32 size, wl_argument &fdArg)
+{
+    Pool pool;
+    pool.fd = memfd_create("waylib-replay", MFD_CLOEXEC);
+    if (pool.fd < 0 || ftruncate(pool.fd, size) < 0)
+        return false;
+
+    pool.size = size;
+    pool.data = static_cast<char*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, pool.fd, 0));
+    if (pool.data == MAP_FAILED) {
+        close(pool.fd);
+        return false;
+    }
+
+    m_pools.insert(id, pool);
+    fdArg.h = pool.fd;
+    return true;
+}
+
+void ReplayClient::resizePool(quint32 id, qint32 size)
+{
+    auto pool = m_pools.find(id);
+    if (pool == m_pools.end() || size <= pool->size || ftruncate(pool->fd, size) < 0)
+        return;
+
+    auto data = mremap(pool->data, pool->size, size, MREMAP_MAYMOVE);
+    if (data == MAP_FAILED)
+        return;
+    pool->data = static_cast<char*>(data);
+    pool->size = size;
+}
+
+bool ReplayClient::replayRequest(PayloadReader &reader)
+{
+    constexpr int MaxArguments = 20;
+
+    const quint32 id = reader.read<quint32>();
+    const quint16 opcode = reader.read<quint16>();
+    reader.read<quint16>();
+
+    wl_proxy *proxy = m_objects.value(id);
+    if (!proxy)
+        return false;
+
+    const wl_interface *interface = wl_proxy_get_interface(proxy);
+    if (opcode >= interface->method_count) {
+        qWarning() << "Unknown request" << opcode << "of" << interface->name;
+        return false;
+    }
+
+    const wl_message &message = interface->methods[opcode];
+    wl_argument args[MaxArguments] {};
+    wl_array arrays[MaxArguments] {};
+    const wl_interface *newInterface = nullptr;
+    quint32 newId = 0;
+    quint32 newVersion = wl_proxy_get_version(proxy);
+    bool skip = false;
+
+    int i = 0;
+    for (const char *signature = message.signature; *signature && i < MaxArguments; ++signature) {
+        switch (*signature) {
+        case 'i':
+        case 'f':
+            args[i].i = reader.read<qint32>();
+            break;
+        case 'u':
+            args[i].u = reader.read<quint32>();
+            break;
+        case 'o': {
+            const quint32 objectId = reader.read<quint32>();
+            if (objectId) {
+                auto object = m_objects.value(objectId);
+                skip |= !object;
+                args[i].o = reinterpret_cast<wl_object*>(object);
+            }
+            break;
+        }
+        case 'n':
+            newId = reader.read<quint32>();
+            newInterface = message.types[i];
+            break;
+        case 's': {
+            const quint32 size = reader.read<quint32>();
+            args[i].s = size ? reader.take(size) : nullptr;
+            break;
+        }
+        case 'a':
+            arrays[i].size = arrays[i].alloc = reader.read<quint32>();
+            arrays[i].data = const_cast<char*>(reader.take(arrays[i].size));
+            args[i].a = &arrays[i];
+            break;
+        case 'h':
+            // Only the shm pools can be replayed, their memory is recreated
+            skip |= !(interface == &wl_shm_interface && qstrcmp(message.name, "create_pool") == 0);
+            break;
+        default:
+            continue;
+        }
+
+        ++i;
+    }
+
+    if (!reader.isOk()) {
+        qWarning() << "Broken request" << message.name << "of" << interface->name;
+        return false;
+    }
+
+    if (interface == &wl_registry_interface && qstrcmp(message.name, "bind") == 0) {
+        // The names of the globals are different in this compositor
+        newInterface = findInterface(args[1].s);
+        auto global = m_globals.constFind(args[1].s);
+        if (!newInterface || global == m_globals.constEnd()) {
+            m_replayer->addUnboundInterface(args[1].s, !newInterface);
+            skip = true;
+        } else {
+            args[0].u = global->name;
+            args[2].u = newVersion = std::min({ args[2].u, global->version, quint32(newInterface->version) });
+        }
+    } else if (interface == &wl_shm_interface && qstrcmp(message.name, "create_pool") == 0) {
+        skip |= !createPool(newId, args[2].i, args[1]);
+    } else if (interface == &wl_shm_pool_interface && qstrcmp(message.name, "resize") == 0) {
+        resizePool(id, args[0].i);
+    } else if (interface == &wl_shm_pool_interface && qstrcmp(message.name, "create_buffer") == 0) {
+        m_buffers.insert(newId, { id, args[1].i });
+    } else if (qstrcmp(message.name, "ack_configure") == 0) {
+        // The serials are different in this compositor
+        args[0].u = m_configureSerials.value(proxy);
+    }
+
+    if (skip) {
+        // The new object is unknown, the requests of it are also skipped
+        m_objects.remove(newId);
+        return false;
+    }
+
+    if (!newInterface) {
+        wl_proxy_marshal_array(proxy, opcode, args);
+        return true;
+    }
+
+    auto newProxy = addObject(newId, wl_proxy_marshal_array_constructor_versioned(proxy, opcode, args,
+                                                                               newInterface, newVersion));
+    if (interface == &wl_display_interface && newInterface == &wl_registry_interface) {
+        // The globals are needed for binding
+        wl_display_roundtrip(m_display);
+    } else if (interface == &wl_surface_interface && qstrcmp(message.name, "frame") == 0) {
+        m_frameCallbacks.insert(newProxy, id);
+    }
+
+    return true;
+}
+
+void ReplayClient::deleteObject(quint32 id)
+{
+    auto proxy = m_objects.take(id);
+    if (!proxy || proxy == reinterpret_cast<wl_proxy*>(m_display))
+        return;
+
+    m_configureSerials.remove(proxy);
+    m_frameCallbacks.remove(proxy);
+    m_buffers.remove(id);
+    m_lastFrameTime.remove(id);
+    if (auto pool = m_pools.constFind(id); pool != m_pools.constEnd()) {
+        munmap(pool->data, pool->size);
+        close(pool->fd);
+        m_pools.erase(pool);
+    }
+
+    wl_proxy_destroy(proxy);
+}
+
+void ReplayClient::writeShmBuffer(PayloadReader &reader)
+{
+    const quint32 id = reader.read<quint32>();
+    reader.read<qint32>(); // width
+    reader.read<qint32>(); // height
+    reader.read<qint32>(); // stride
+    reader.read<quint32>(); // format
+    if (!reader.isOk())
+        return;
+
+    auto buffer = m_buffers.constFind(id);
+    if (buffer == m_buffers.constEnd())
+        return;
+    auto pool = m_pools.constFind(buffer->pool);
+    if (pool == m_pools.constEnd() || buffer->offset >= pool->size)
+        return;
+
+    const auto pixels = reader.remaining();
+    memcpy(pool->data + buffer->offset, pixels.data(),
+           std::min(pixels.size(), pool->size - buffer->offset));
+}
+
+void ReplayClient::handleEvent(wl_proxy *proxy, const wl_message *message, const wl_argument *args)
+{
+    if (wl_proxy_get_interface(proxy) == &wl_registry_interface && qstrcmp(message->name, "global") == 0) {
+        m_globals.insert(args[1].s, { args[0].u, args[2].u });
+    } else if (qstrcmp(message->name, "configure") == 0 && qstrcmp(message->signature, "u") == 0) {
+        m_configureSerials.insert(proxy, args[0].u);
+    } else if (auto surface = m_frameCallbacks.constFind(proxy); surface != m_frameCallbacks.constEnd()) {
+        const qint64 now = m_replayer->elapsed();
+        auto lastTime = m_lastFrameTime.find(*surface);
+        if (lastTime != m_lastFrameTime.end()) {
+            m_replayer->addFrameInterval(now - *lastTime);
+            *lastTime = now;
+        } else {
+            m_lastFrameTime.insert(*surface, now);
+        }
+    }
+}
+
+void Replayer::addUnboundInterface(const QByteArray &name, bool unsupported)
+{
+    // The requests of its objects are skipped, the result doesn't measure the whole trace
+    if (m_unboundInterfaces[name]++ == 0) {
+        if (unsupported)
+            qWarning() << "Can't replay" << name << ", its requests are skipped";
+        else
+            qWarning() << "The compositor doesn't provide" << name << ", its requests are skipped";
+    }
+}
+
+bool Replayer::open(const QString &fileName)
+{
+    m_file.setFileName(fileName);
+    if (!m_file.open(QIODevice::ReadOnly)) {
+        qWarning() << "Can't open" << fileName << m_file.errorString();
+        return false;
+    }
+
+    FileHeader header;
+    if (m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) != sizeof(header)
+        || memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version) {
+        qWarning() << fileName << "isn't a protocol trace of version" << Version;
+        return false;
+    }
+
+    return true;
+}
+
+void Replayer::dispatch(int timeout)
+{
+    QVarLengthArray<pollfd, 16> fds;
+    for (auto client : std::as_const(m_clients)) {
+        auto display = client->display();
+        while (wl_display_prepare_read(display) != 0)
+            wl_display_dispatch_pending(display);
+        wl_display_flush(display);
+        fds.append({ wl_display_get_fd(display), POLLIN, 0 });
+    }
+
+    if (fds.isEmpty()) {
+        if (timeout > 0)
+            usleep(timeout * 1000);
+        return;
+    }
+
+    poll(fds.data(), fds.size(), timeout);
+
+    int i = 0;
+    for (auto client : std::as_const(m_clients)) {
+        auto display = client->display();
+        if (fds[i++].revents & POLLIN)
+            wl_display_read_events(display);
+        else
+            wl_display_cancel_read(display);
+        wl_display_dispatch_pending(display);
+    }
+}
+
+bool Replayer::run(const QByteArray &socketName, bool maxSpeed)
+{
+    const qint64 replayCpuTime = processCpuTime(getpid());
+    qint64 compositorCpuTime = -1;
+    m_clock.start();
+
+    RecordHeader header;
+    QByteArray payload;
+    while (m_file.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)) {
+        payload.resize(header.size);
+        if (m_file.read(payload.data(), header.size) != header.size) {
+            qWarning() << "The trace file is truncated";
+            break;
+        }
+
+        while (!maxSpeed && qint64(header.timestamp) > m_clock.nsecsElapsed()) {
+            const qint64 wait = (qint64(header.timestamp) - m_clock.nsecsElapsed()) / 1000000;
+            dispatch(std::max<qint64>(wait, 0));
+        }
+
+        PayloadReader reader(payload);
+        auto client = m_clients.value(header.client);
+
+        switch (header.type) {
+        case ClientConnected: {
+            auto display = wl_display_connect(socketName.isEmpty() ? nullptr : socketName.constData());
+            if (!display) {
+                qWarning() << "Can't connect to the compositor";
+                return false;
+            }
+            m_clients.insert(header.client, new ReplayClient(this, display));
+
+            if (!m_compositorPid) {
+                ucred credentials;
+                socklen_t length = sizeof(credentials);
+                if (getsockopt(wl_display_get_fd(display), SOL_SOCKET, SO_PEERCRED, &credentials, &length) == 0) {
+                    m_compositorPid = credentials.pid;
+                    compositorCpuTime = processCpuTime(m_compositorPid);
+                }
+            }
+            break;
+        }
+        case ClientDisconnected:
+            if (client) {
+                wl_display_roundtrip(client->display());
+                delete m_clients.take(header.client);
+            }
+            break;
+        case Request:
+            ++m_requests;
+            if (!client || !client->replayRequest(reader))
+                ++m_skippedRequests;
+            break;
+        case ObjectDeleted:
+            if (client)
+                client->deleteObject(reader.read<quint32>());
+            break;
+        case ShmBufferContents:
+            if (client)
+                client->writeShmBuffer(reader);
+            break;
+        }
+
+        if (maxSpeed && (m_requests & 0x3f) == 0)
+            dispatch(0);
+    }
+
+    // Wait for the compositor to handle all the requests
+    for (auto client : std::as_const(m_clients))
+        wl_display_roundtrip(client->display());
+    m_duration = m_clock.nsecsElapsed();
+
+    if (compositorCpuTime >= 0)
+        m_compositorCpuTime = processCpuTime(m_compositorPid) - compositorCpuTime;
+    m_replayCpuTime = processCpuTime(getpid()) - replayCpuTime;
+
+    qDeleteAll(m_clients);
+    m_clients.clear();
+    return true;
+}
+
+qint64 Replayer::processCpuTime(pid_t pid)
+{
+    QFile file(QStringLiteral("/proc/%1/stat").arg(pid));
+    if (!file.open(QIODevice::ReadOnly))
+        return -1;
+
+    // The process's name may contain spaces, the fields are after its ')'
+    const QByteArray stat = file.readAll();
+    const auto fields = stat.sliced(stat.lastIndexOf(')') + 2).split(' ');
+    // utime and stime are the 14th and 15th fields
+    if (fields.size() < 13)
+        return -1;
+
+    const qint64 ticks = fields.at(11).toLongLong() + fields.at(12).toLongLong();
+    return ticks * 1000000000 / sysconf(_SC_CLK_TCK);
+}
+
+void Replayer::printReport() const
+{
+    auto ms = [] (qint64 nsecs) {
+        return QString::number(nsecs / 1000000.0, 'f', 2);
+    };
+
+    printf("Requests: %lld (%lld skipped)\n", m_requests, m_skippedRequests);
+    printf("Duration: %s ms\n", qPrintable(ms(m_duration)));
+    if (m_compositorCpuTime >= 0)
+        printf("Compositor CPU time: %s ms\n", qPrintable(ms(m_compositorCpuTime)));
+    printf("Replay CPU time: %s ms\n", qPrintable(ms(m_replayCpuTime)));
+    for (auto it = m_unboundInterfaces.constBegin(); it != m_unboundInterfaces.constEnd(); ++it)
+        printf("Unbound interface: %s (%d binds)\n", it.key().constData(), it.value());
+
+    if (m_frameIntervals.isEmpty())
+        return;
+
+    auto intervals = m_frameIntervals;
+    std::sort(intervals.begin(), intervals.end());
+    qint64 sum = 0;
+    for (auto interval : std::as_const(intervals))
+        sum += interval;
+
+    printf("Frame intervals: %lld, mean %s ms, p50 %s ms, p99 %s ms, max %s ms\n",
+           qint64(intervals.size()), qPrintable(ms(sum / intervals.size())),
+           qPrintable(ms(intervals.at(intervals.size() / 2))),
+           qPrintable(ms(intervals.at(intervals.size() * 99 / 100))),
+           qPrintable(ms(intervals.last())));
+}
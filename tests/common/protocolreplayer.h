@@ -0,0 +1,155 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+// Replay a trace recorded by WServer::startRecording (or WAYLIB_PROTOCOL_TRACE) against
+// a running compositor, used by bench_protocolreplay and the tests of the recording.
+
+#pragma once
+
+#include <wprotocoltrace_p.h>
+
+#include <QFile>
+#include <QElapsedTimer>
+#include <QHash>
+#include <QList>
+
+#include <wayland-client.h>
+
+#include <sys/types.h>
+
+class PayloadReader
+{
+public:
+    PayloadReader(QByteArrayView data)
+        : m_data(data) {}
+
+    template<typename T>
+    T read() {
+        T value {};
+        if (m_pos + qsizetype(sizeof(T)) > m_data.size()) {
+            m_ok = false;
+            return value;
+        }
+        memcpy(&value, m_data.data() + m_pos, sizeof(T));
+        m_pos += sizeof(T);
+        return value;
+    }
+
+    const char *take(qsizetype size) {
+        if (m_pos + size > m_data.size()) {
+            m_ok = false;
+            return nullptr;
+        }
+        auto data = m_data.data() + m_pos;
+        m_pos += size;
+        return data;
+    }
+
+    QByteArrayView remaining() const {
+        return m_data.sliced(m_pos);
+    }
+
+    bool isOk() const {
+        return m_ok;
+    }
+
+private:
+    QByteArrayView m_data;
+    qsizetype m_pos = 0;
+    bool m_ok = true;
+};
+
+class Replayer;
+class ReplayClient
+{
+public:
+    ReplayClient(Replayer *replayer, wl_display *display);
+    ~ReplayClient();
+
+    bool replayRequest(PayloadReader &reader);
+    void deleteObject(quint32 id);
+    void writeShmBuffer(PayloadReader &reader);
+    void handleEvent(wl_proxy *proxy, const wl_message *message, const wl_argument *args);
+
+    wl_display *display() const {
+        return m_display;
+    }
+
+private:
+    struct Global {
+        quint32 name;
+        quint32 version;
+    };
+
+    struct Pool {
+        int fd = -1;
+        char *data = nullptr;
+        qsizetype size = 0;
+    };
+
+    struct Buffer {
+        quint32 pool;
+        qint32 offset;
+    };
+
+    wl_proxy *addObject(quint32 id, wl_proxy *proxy);
+    bool createPool(quint32 id, qint32 size, wl_argument &fdArg);
+    void resizePool(quint32 id, qint32 size);
+
+    Replayer *m_replayer;
+    wl_display *m_display;
+    // By the object id in the trace
+    QHash<quint32, wl_proxy*> m_objects;
+    QHash<quint32, Pool> m_pools;
+    QHash<quint32, Buffer> m_buffers;
+    QHash<QByteArray, Global> m_globals;
+    QHash<wl_proxy*, quint32> m_configureSerials;
+    // The surface's id of the frame callbacks
+    QHash<wl_proxy*, quint32> m_frameCallbacks;
+    QHash<quint32, qint64> m_lastFrameTime;
+};
+
+class Replayer
+{
+public:
+    bool open(const QString &fileName);
+    bool run(const QByteArray &socketName, bool maxSpeed);
+    void printReport() const;
+
+    qint64 requests() const {
+        return m_requests;
+    }
+    qint64 skippedRequests() const {
+        return m_skippedRequests;
+    }
+    // The interfaces bound in the trace that aren't replayed, and the number of their binds
+    const QHash<QByteArray, int> &unboundInterfaces() const {
+        return m_unboundInterfaces;
+    }
+
+    void addFrameInterval(qint64 interval) {
+        m_frameIntervals.append(interval);
+    }
+    void addUnboundInterface(const QByteArray &name, bool unsupported);
+
+    qint64 elapsed() const {
+        return m_clock.nsecsElapsed();
+    }
+
+private:
+    void dispatch(int timeout);
+    static qint64 processCpuTime(pid_t pid);
+
+    QFile m_file;
+    QElapsedTimer m_clock;
+    QHash<quint16, ReplayClient*> m_clients;
+    QList<qint64> m_frameIntervals;
+    QHash<QByteArray, int> m_unboundInterfaces;
+    pid_t m_compositorPid = 0;
+
+    qint64 m_requests = 0;
+    qint64 m_skippedRequests = 0;
+    qint64 m_duration = 0;
+    qint64 m_compositorCpuTime = -1;
+    qint64 m_replayCpuTime = 0;
+};
@@ -0,0 +1,277 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <woutput.h>
+#include <woutputrenderwindow.h>
+#include <woutputviewport.h>
+#include <wrenderhelper.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwallocator.h>
+#include <qwoutput.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QQuickItem>
+#include <QElapsedTimer>
+#include <QEventLoop>
+#include <QTimer>
+#include <QtMath>
+
+#include <algorithm>
+
+#include "headlessbackend.h"
+
+extern "C" {
+#include <wlr/interfaces/wlr_output.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+static const wlr_output_impl *headlessImpl = nullptr;
+
+static wlr_output_state withoutAdaptiveSync(const wlr_output_state *state)
+{
+    wlr_output_state copy = *state;
+    copy.committed &= ~WLR_OUTPUT_STATE_ADAPTIVE_SYNC_ENABLED;
+    return copy;
+}
+
+// The headless output doesn't support adaptive sync, fake it like the DRM backend
+static void addFakeAdaptiveSync(wlr_output *output)
+{
+    static wlr_output_impl impl;
+    headlessImpl = output->impl;
+    impl = *output->impl;
+    impl.test = [] (wlr_output *output, const wlr_output_state *state) {
+        const auto copy = withoutAdaptiveSync(state);
+        return headlessImpl->test(output, &copy);
+    };
+    impl.commit = [] (wlr_output *output, const wlr_output_state *state) {
+        const auto copy = withoutAdaptiveSync(state);
+        return headlessImpl->commit(output, &copy);
+    };
+    output->impl = &impl;
+    output->adaptive_sync_supported = true;
+}
+
+// Unlike QTest::qWait, don't sleep between processing the events
+static void waitPrecisely(int msecs)
+{
+    QEventLoop loop;
+    QTimer::singleShot(msecs, Qt::PreciseTimer, &loop, &QEventLoop::quit);
+    loop.exec();
+}
+
+static const char *windowQml = R"(
+import QtQuick
+import Waylib.Server
+
+OutputRenderWindow {
+    id: window
+
+    required property WaylandOutput waylandOutput
+    readonly property Item contentsItem: contents
+
+    width: 800
+    height: 600
+
+    OutputViewport {
+        id: viewport
+
+        output: window.waylandOutput
+        devicePixelRatio: 1
+        anchors.fill: parent
+    }
+
+    // Like a fullscreen client, its every commit changes the color
+    Rectangle {
+        id: contents
+
+        anchors.fill: parent
+        color: "black"
+    }
+}
+)";
+
+class AdaptiveSyncTest : public QObject
+{
+    Q_OBJECT
+public:
+    AdaptiveSyncTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    inline qreal now() const {
+        return m_clock.nsecsElapsed() / 1000000.0;
+    }
+
+    // The shortest frame interval of the output, in milliseconds
+    inline qreal minimumFrameInterval() const {
+        const int refresh = m_output->handle()->handle()->refresh;
+        return 1000000.0 / (refresh > 0 ? refresh : 60000);
+    }
+
+    QList<qreal> replayCommits(int interval, int count)
+    {
+        QList<qreal> commits;
+        for (int i = 0; i < count; ++i) {
+            m_contents->setProperty("color", QColor::fromHsv((i * 37) % 360, 255, 255));
+            commits.append(now());
+            waitPrecisely(interval);
+        }
+
+        return commits;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        QVERIFY(HeadlessBackend::createRenderer(m_backend, &m_renderer, &m_allocator));
+
+        m_output = HeadlessBackend::addOutput(m_backend, 800, 600);
+        QVERIFY(m_output);
+        addFakeAdaptiveSync(m_output->nativeHandle());
+
+        QQmlComponent component(&m_engine);
+        component.setData(windowQml, QUrl());
+        m_window = qobject_cast<WOutputRenderWindow*>(component.createWithInitialProperties({
+            {"waylandOutput", QVariant::fromValue(m_output)},
+        }));
+        QVERIFY2(m_window, qPrintable(component.errorString()));
+        m_contents = m_window->property("contentsItem").value<QQuickItem*>();
+        QVERIFY(m_contents);
+
+        HeadlessBackend::enableOutputs(m_window, [] (qw_output_state &state) {
+            state.set_adaptive_sync_enabled(true);
+        });
+        connect(m_window, &WOutputRenderWindow::beforeRendering, this, [this] {
+            ++m_renders;
+        });
+        connect(m_output, &WOutput::bufferCommitted, this, [this] {
+            m_commits.append(now());
+        });
+        m_clock.start();
+        m_window->init(m_renderer, m_allocator);
+        m_backend->handle()->start();
+
+        QTRY_VERIFY(m_output->adaptiveSyncEnabled());
+        QTRY_VERIFY(!m_commits.isEmpty());
+    }
+
+    void idleDoesNotRender()
+    {
+        waitPrecisely(100);
+        m_renders = 0;
+        m_commits.clear();
+
+        waitPrecisely(300);
+        QCOMPARE(m_renders, 0);
+        QVERIFY(m_commits.isEmpty());
+    }
+
+    void commitPattern_data()
+    {
+        QTest::addColumn<int>("interval");
+        QTest::addColumn<int>("count");
+
+        QTest::addRow("24fps") << 41 << 12;
+        QTest::addRow("30fps") << 33 << 15;
+        QTest::addRow("48fps") << 21 << 20;
+        QTest::addRow("burst") << 2 << 50;
+    }
+
+    void commitPattern()
+    {
+        QFETCH(int, interval);
+        QFETCH(int, count);
+
+        waitPrecisely(100);
+        m_commits.clear();
+
+        const auto changes = replayCommits(interval, count);
+        // The last contents is always displayed
+        QTRY_VERIFY(!m_commits.isEmpty() && m_commits.last() >= changes.last());
+        // Only the changes are committed, not every refresh cycle
+        QVERIFY(m_commits.size() <= changes.size());
+
+        // Never faster than the highest refresh rate, the headless output's
+        // frame delay is rounded down to milliseconds. The times are taken when
+        // the compositor commits, a slow test doesn't make them closer.
+        const qreal minimumInterval = minimumFrameInterval();
+        for (int i = 1; i < m_commits.size(); ++i) {
+            const qreal commitInterval = m_commits.at(i) - m_commits.at(i - 1);
+            QVERIFY2(commitInterval >= minimumInterval - 1,
+                     qPrintable(QString::number(commitInterval)));
+        }
+
+        if (interval > minimumInterval) {
+            // Every commit is displayed as soon as possible, instead of waiting for
+            // the next refresh cycle of a fixed rate. A busy machine may delay some
+            // of them, so only the median is checked.
+            QList<qreal> latencies;
+            int change = 0;
+            for (qreal commit : std::as_const(m_commits)) {
+                while (change + 1 < changes.size() && changes.at(change + 1) <= commit)
+                    ++change;
+                if (changes.at(change) <= commit)
+                    latencies.append(commit - changes.at(change));
+            }
+            QVERIFY(latencies.size() >= changes.size() / 2);
+            std::sort(latencies.begin(), latencies.end());
+            const qreal median = latencies.at(latencies.size() / 2);
+            QVERIFY2(median < minimumInterval, qPrintable(QString::number(median)));
+        } else {
+            const qreal duration = changes.last() - changes.first();
+            QVERIFY(m_commits.size() <= qCeil(duration / minimumInterval) + 2);
+        }
+
+        // And it's idle again
+        m_renders = 0;
+        waitPrecisely(100);
+        QCOMPARE(m_renders, 0);
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_window;
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    WOutput *m_output = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    qw_allocator *m_allocator = nullptr;
+    QQmlEngine m_engine;
+    WOutputRenderWindow *m_window = nullptr;
+    QQuickItem *m_contents = nullptr;
+    QElapsedTimer m_clock;
+    QList<qreal> m_commits;
+    int m_renders = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    WServer::initializeQPA();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    QGuiApplication app(argc, argv);
+
+    AdaptiveSyncTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
@@ -0,0 +1,240 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wsocket.h>
+#include <wsurface.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwbuffer.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include <wayland-client.h>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+static constexpr int BufferSize = 256;
+static constexpr qint64 BufferBytes = qint64(BufferSize) * BufferSize * 4;
+
+class ClientResourceTest : public QObject
+{
+    Q_OBJECT
+public:
+    ClientResourceTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    void dispatch(int msecs)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    wl_shm_pool *createPool(int size)
+    {
+        int fd = memfd_create("test-client-resource", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, size) < 0)
+            return nullptr;
+
+        auto pool = wl_shm_create_pool(m_shm, fd, size);
+        close(fd);
+        return pool;
+    }
+
+    wl_buffer *createBuffer()
+    {
+        const int stride = BufferSize * 4;
+        auto pool = createPool(stride * BufferSize);
+        if (!pool)
+            return nullptr;
+
+        auto buffer = wl_shm_pool_create_buffer(pool, 0, BufferSize, BufferSize,
+                                                stride, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+        return buffer;
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<ClientResourceTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        } else if (qstrcmp(interface, wl_shm_interface.name) == 0) {
+            self->m_shm = static_cast<wl_shm*>(
+                wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        auto compositor = qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+        connect(compositor, &qw_compositor::notify_new_surface, this, [this] (wlr_surface *surface) {
+            m_wSurface = new WSurface(qw_surface::from(surface), this);
+            connect(m_wSurface->handle(), &qw_surface::before_destroy,
+                    m_wSurface, &WSurface::safeDeleteLater);
+        });
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        auto client = wl_client_create(m_server->handle()->handle(), fds[0]);
+        QVERIFY(client);
+        m_socket = new WSocket(false, nullptr, this);
+        m_client = m_socket->addClient(client);
+        QVERIFY(m_client);
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        dispatch(100);
+        QVERIFY(m_compositor && m_shm);
+
+        m_surface = wl_compositor_create_surface(m_compositor);
+        dispatch(100);
+        QVERIFY(m_wSurface);
+    }
+
+    void shmPoolLimit()
+    {
+        constexpr int PoolSize = 4 * 1024 * 1024;
+        m_client->setResourceLimit(WClient::Resource::ShmPoolBytes, PoolSize / 2, 0);
+        QSignalSpy spy(m_client, &WClient::resourceLimitExceeded);
+
+        auto pool = createPool(PoolSize);
+        QVERIFY(pool);
+        dispatch(100);
+
+        QCOMPARE(m_client->resourceUsage(WClient::Resource::ShmPoolBytes), PoolSize);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().at(0).value<WClient::Resource>(), WClient::Resource::ShmPoolBytes);
+        QCOMPARE(spy.first().at(1).toLongLong(), PoolSize);
+        QCOMPARE(spy.first().at(2).toBool(), false);
+
+        wl_shm_pool_destroy(pool);
+        dispatch(100);
+        QCOMPARE(m_client->resourceUsage(WClient::Resource::ShmPoolBytes), 0);
+
+        m_client->setResourceLimit(WClient::Resource::ShmPoolBytes, 0, 0);
+    }
+
+    void heldBufferLimit()
+    {
+        m_client->setResourceLimit(WClient::Resource::BufferBytes, BufferBytes * 3 / 2, 0);
+        m_client->setLimitActions(WClient::LimitAction::Throttle, WClient::LimitAction::Disconnect);
+        QSignalSpy spy(m_client, &WClient::resourceLimitExceeded);
+
+        auto firstBuffer = createBuffer();
+        QVERIFY(firstBuffer);
+        wl_surface_attach(m_surface, firstBuffer, 0, 0);
+        wl_surface_damage(m_surface, 0, 0, BufferSize, BufferSize);
+        wl_surface_commit(m_surface);
+        dispatch(100);
+
+        QCOMPARE(m_client->resourceUsage(WClient::Resource::BufferBytes), BufferBytes);
+        QCOMPARE(spy.count(), 0);
+        QVERIFY(!m_client->isResourceThrottled());
+
+        // Like a WSurfaceItem keeping the last frame
+        auto oldBuffer = m_wSurface->buffer();
+        QVERIFY(oldBuffer);
+        oldBuffer->lock();
+        QObject holder;
+        m_wSurface->setHeldBuffers(&holder, { oldBuffer });
+        QCOMPARE(m_client->resourceUsage(WClient::Resource::BufferBytes), BufferBytes);
+
+        auto secondBuffer = createBuffer();
+        QVERIFY(secondBuffer);
+        wl_surface_attach(m_surface, secondBuffer, 0, 0);
+        wl_surface_damage(m_surface, 0, 0, BufferSize, BufferSize);
+        wl_surface_commit(m_surface);
+        dispatch(100);
+
+        QCOMPARE(m_client->resourceUsage(WClient::Resource::BufferBytes), BufferBytes * 2);
+        QCOMPARE(spy.count(), 1);
+        QCOMPARE(spy.first().at(0).value<WClient::Resource>(), WClient::Resource::BufferBytes);
+        QCOMPARE(spy.first().at(2).toBool(), false);
+        QVERIFY(m_client->isResourceThrottled());
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::Reduced);
+
+        // Releasing the held buffer lifts the throttle
+        m_wSurface->setHeldBuffers(&holder, {});
+        oldBuffer->unlock();
+        QCOMPARE(m_client->resourceUsage(WClient::Resource::BufferBytes), BufferBytes);
+        QVERIFY(!m_client->isResourceThrottled());
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::FullRate);
+
+        wl_buffer_destroy(firstBuffer);
+        wl_buffer_destroy(secondBuffer);
+        m_client->setResourceLimit(WClient::Resource::BufferBytes, 0, 0);
+    }
+
+    void cleanupTestCase()
+    {
+        wl_surface_destroy(m_surface);
+        dispatch(100);
+
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    WSocket *m_socket = nullptr;
+    WClient *m_client = nullptr;
+    QPointer<WSurface> m_wSurface;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_shm *m_shm = nullptr;
+    wl_surface *m_surface = nullptr;
+};
+
+QTEST_MAIN(ClientResourceTest)
+#include "main.moc"
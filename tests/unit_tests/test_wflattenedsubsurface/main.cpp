@@ -0,0 +1,553 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wseat.h>
+#include <wcursor.h>
+#include <woutput.h>
+#include <woutputlayout.h>
+#include <woutputrenderwindow.h>
+#include <winputdevice.h>
+#include <wrenderhelper.h>
+#include <wxdgshell.h>
+#include <wxdgtoplevelsurface.h>
+#include <wxdgtoplevelsurfaceitem.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwallocator.h>
+#include <qwcompositor.h>
+#include <qwsubcompositor.h>
+#include <qwdisplay.h>
+#include <qwinputdevice.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QSGImageNode>
+#include <QElapsedTimer>
+#include <private/qquickitem_p.h>
+
+#include <wayland-client.h>
+#include <xdg-shell-client-protocol.h>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "headlessbackend.h"
+
+extern "C" {
+#include <wlr/interfaces/wlr_pointer.h>
+#include <wlr/interfaces/wlr_touch.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+static constexpr int OutputWidth = 800;
+static constexpr int OutputHeight = 600;
+// The position of the surface item in the window
+static constexpr QPointF ItemPosition(100, 100);
+
+static const char *windowQml = R"(
+import QtQuick
+import Waylib.Server
+
+OutputRenderWindow {
+    id: window
+
+    required property WaylandOutput waylandOutput
+    readonly property Item surfaceItem: item
+
+    width: 800
+    height: 600
+
+    OutputViewport {
+        output: window.waylandOutput
+        devicePixelRatio: 1
+        anchors.fill: parent
+    }
+
+    XdgToplevelSurfaceItem {
+        id: item
+
+        x: 100
+        y: 100
+        flags: SurfaceItem.FlattenSubsurfaces
+    }
+}
+)";
+
+// What the client received from wl_pointer and wl_touch
+struct ClientInput
+{
+    wl_surface *pointerFocus = nullptr;
+    QPointF enterPosition;
+    QPointF motionPosition;
+    int enters = 0;
+
+    wl_surface *touchSurface = nullptr;
+    QPointF touchDownPosition;
+    QPointF touchMotionPosition;
+};
+
+static inline QPointF fromFixed(wl_fixed_t x, wl_fixed_t y)
+{
+    return QPointF(wl_fixed_to_double(x), wl_fixed_to_double(y));
+}
+
+static const wl_pointer_listener pointerListener = {
+    .enter = [] (void *data, wl_pointer *, uint32_t, wl_surface *surface, wl_fixed_t x, wl_fixed_t y) {
+        auto input = static_cast<ClientInput*>(data);
+        input->pointerFocus = surface;
+        input->enterPosition = fromFixed(x, y);
+        ++input->enters;
+    },
+    .leave = [] (void *data, wl_pointer *, uint32_t, wl_surface *surface) {
+        auto input = static_cast<ClientInput*>(data);
+        if (input->pointerFocus == surface)
+            input->pointerFocus = nullptr;
+    },
+    .motion = [] (void *data, wl_pointer *, uint32_t, wl_fixed_t x, wl_fixed_t y) {
+        static_cast<ClientInput*>(data)->motionPosition = fromFixed(x, y);
+    },
+    .button = [] (void *, wl_pointer *, uint32_t, uint32_t, uint32_t, uint32_t) {},
+    .axis = [] (void *, wl_pointer *, uint32_t, uint32_t, wl_fixed_t) {},
+};
+
+static const wl_touch_listener touchListener = {
+    .down = [] (void *data, wl_touch *, uint32_t, uint32_t, wl_surface *surface, int32_t,
+                wl_fixed_t x, wl_fixed_t y) {
+        auto input = static_cast<ClientInput*>(data);
+        input->touchSurface = surface;
+        input->touchDownPosition = fromFixed(x, y);
+    },
+    .up = [] (void *, wl_touch *, uint32_t, uint32_t, int32_t) {},
+    .motion = [] (void *data, wl_touch *, uint32_t, int32_t, wl_fixed_t x, wl_fixed_t y) {
+        static_cast<ClientInput*>(data)->touchMotionPosition = fromFixed(x, y);
+    },
+    .frame = [] (void *, wl_touch *) {},
+    .cancel = [] (void *, wl_touch *) {},
+};
+
+class FlattenedSubsurfaceTest : public QObject
+{
+    Q_OBJECT
+public:
+    FlattenedSubsurfaceTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    // Run the server and read the events of the client for a while
+    void dispatch(int msecs = 100)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<FlattenedSubsurfaceTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        } else if (qstrcmp(interface, wl_subcompositor_interface.name) == 0) {
+            self->m_subcompositor = static_cast<wl_subcompositor*>(
+                wl_registry_bind(registry, name, &wl_subcompositor_interface, 1));
+        } else if (qstrcmp(interface, wl_shm_interface.name) == 0) {
+            self->m_shm = static_cast<wl_shm*>(
+                wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        } else if (qstrcmp(interface, wl_seat_interface.name) == 0) {
+            self->m_wlSeat = static_cast<wl_seat*>(
+                wl_registry_bind(registry, name, &wl_seat_interface, 1));
+        } else if (qstrcmp(interface, xdg_wm_base_interface.name) == 0) {
+            self->m_wmBase = static_cast<xdg_wm_base*>(
+                wl_registry_bind(registry, name, &xdg_wm_base_interface, 1));
+        }
+    }
+
+    wl_buffer *createBuffer(int width, int height)
+    {
+        const int stride = width * 4;
+        const int size = stride * height;
+        int fd = memfd_create("test-flattened-subsurface", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, size) < 0)
+            return nullptr;
+
+        auto pool = wl_shm_create_pool(m_shm, fd, size);
+        auto buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+        close(fd);
+
+        return buffer;
+    }
+
+    wl_subsurface *createSubsurface(wl_surface *surface, wl_surface *parent, const QRect &geometry)
+    {
+        auto subsurface = wl_subcompositor_get_subsurface(m_subcompositor, surface, parent);
+        wl_subsurface_set_position(subsurface, geometry.x(), geometry.y());
+        m_buffers.append(createBuffer(geometry.width(), geometry.height()));
+        wl_surface_attach(surface, m_buffers.last(), 0, 0);
+        return subsurface;
+    }
+
+    // The rects of the quads in the node of the flattened tree, in the painting order
+    QList<QRectF> quadRects() const
+    {
+        QList<QRectF> rects;
+        auto node = QQuickItemPrivate::get(m_item->contentItem())->paintNode;
+        if (!node)
+            return rects;
+
+        for (auto child = node->firstChild(); child; child = child->nextSibling()) {
+            if (auto imageNode = dynamic_cast<QSGImageNode*>(child))
+                rects.append(imageNode->rect());
+        }
+
+        return rects;
+    }
+
+    void movePointer(const QPointF &pos)
+    {
+        wlr_pointer_motion_absolute_event event {
+            .pointer = &m_pointer,
+            .time_msec = ++m_time,
+            .x = pos.x() / OutputWidth,
+            .y = pos.y() / OutputHeight,
+        };
+        wl_signal_emit_mutable(&m_pointer.events.motion_absolute, &event);
+        wl_signal_emit_mutable(&m_pointer.events.frame, nullptr);
+        dispatch(50);
+    }
+
+    void touchDown(const QPointF &pos)
+    {
+        wlr_touch_down_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = 0,
+            .x = pos.x() / OutputWidth,
+            .y = pos.y() / OutputHeight,
+        };
+        wl_signal_emit_mutable(&m_touch.events.down, &event);
+        wl_signal_emit_mutable(&m_touch.events.frame, nullptr);
+        dispatch(50);
+    }
+
+    void touchMotion(const QPointF &pos)
+    {
+        wlr_touch_motion_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = 0,
+            .x = pos.x() / OutputWidth,
+            .y = pos.y() / OutputHeight,
+        };
+        wl_signal_emit_mutable(&m_touch.events.motion, &event);
+        wl_signal_emit_mutable(&m_touch.events.frame, nullptr);
+        dispatch(50);
+    }
+
+    void touchUp()
+    {
+        wlr_touch_up_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = 0,
+        };
+        wl_signal_emit_mutable(&m_touch.events.up, &event);
+        wl_signal_emit_mutable(&m_touch.events.frame, nullptr);
+        dispatch(50);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_seat = m_server->attach<WSeat>();
+        auto xdgShell = m_server->attach<WXdgShell>(5);
+        m_server->start();
+
+        QVERIFY(HeadlessBackend::createRenderer(m_backend, &m_renderer, &m_allocator));
+        m_renderer->init_wl_display(*m_server->handle());
+        qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+        qw_subcompositor::create(*m_server->handle());
+
+        auto output = HeadlessBackend::addOutput(m_backend, OutputWidth, OutputHeight);
+        QVERIFY(output);
+
+        QQmlComponent component(&m_engine);
+        component.setData(windowQml, QUrl());
+        m_window = qobject_cast<WOutputRenderWindow*>(component.createWithInitialProperties({
+            {"waylandOutput", QVariant::fromValue(output)},
+        }));
+        QVERIFY2(m_window, qPrintable(component.errorString()));
+        m_item = m_window->property("surfaceItem").value<WXdgToplevelSurfaceItem*>();
+        QVERIFY(m_item);
+
+        connect(xdgShell, &WXdgShell::toplevelSurfaceAdded, this, [this] (WXdgToplevelSurface *surface) {
+            m_item->setShellSurface(surface);
+        });
+        HeadlessBackend::enableOutputs(m_window);
+        m_window->init(m_renderer, m_allocator);
+        m_backend->handle()->start();
+
+        m_layout = new WOutputLayout(m_server);
+        m_layout->add(output, QPoint(0, 0));
+        m_cursor = new WCursor(this);
+        m_cursor->setLayout(m_layout);
+        m_seat->setCursor(m_cursor);
+        m_cursor->setEventWindow(m_window);
+
+        static const wlr_pointer_impl pointerImpl = {
+            .name = "test-pointer",
+        };
+        wlr_pointer_init(&m_pointer, &pointerImpl, pointerImpl.name);
+        m_pointerDevice = new WInputDevice(qw_input_device::from(&m_pointer.base));
+        m_seat->attachInputDevice(m_pointerDevice);
+
+        static const wlr_touch_impl touchImpl = {
+            .name = "test-touch",
+        };
+        wlr_touch_init(&m_touch, &touchImpl, touchImpl.name);
+        m_touchDevice = new WInputDevice(qw_input_device::from(&m_touch.base));
+        m_seat->attachInputDevice(m_touchDevice);
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        dispatch();
+        QVERIFY(m_compositor && m_subcompositor && m_shm && m_wlSeat && m_wmBase);
+
+        static const xdg_wm_base_listener wmBaseListener = {
+            .ping = [] (void *, xdg_wm_base *wmBase, uint32_t serial) {
+                xdg_wm_base_pong(wmBase, serial);
+            },
+        };
+        xdg_wm_base_add_listener(m_wmBase, &wmBaseListener, nullptr);
+
+        static const wl_seat_listener seatListener = {
+            .capabilities = [] (void *data, wl_seat *seat, uint32_t capabilities) {
+                auto self = static_cast<FlattenedSubsurfaceTest*>(data);
+                if ((capabilities & WL_SEAT_CAPABILITY_POINTER) && !self->m_wlPointer) {
+                    self->m_wlPointer = wl_seat_get_pointer(seat);
+                    wl_pointer_add_listener(self->m_wlPointer, &pointerListener, &self->m_input);
+                }
+                if ((capabilities & WL_SEAT_CAPABILITY_TOUCH) && !self->m_wlTouch) {
+                    self->m_wlTouch = wl_seat_get_touch(seat);
+                    wl_touch_add_listener(self->m_wlTouch, &touchListener, &self->m_input);
+                }
+            },
+        };
+        wl_seat_add_listener(m_wlSeat, &seatListener, this);
+
+        static const xdg_surface_listener xdgSurfaceListener = {
+            .configure = [] (void *, xdg_surface *surface, uint32_t serial) {
+                xdg_surface_ack_configure(surface, serial);
+            },
+        };
+        static const xdg_toplevel_listener xdgToplevelListener = {
+            .configure = [] (void *, xdg_toplevel *, int32_t, int32_t, wl_array *) {},
+            .close = [] (void *, xdg_toplevel *) {},
+        };
+        m_root = wl_compositor_create_surface(m_compositor);
+        m_xdgSurface = xdg_wm_base_get_xdg_surface(m_wmBase, m_root);
+        xdg_surface_add_listener(m_xdgSurface, &xdgSurfaceListener, nullptr);
+        m_xdgToplevel = xdg_surface_get_toplevel(m_xdgSurface);
+        xdg_toplevel_add_listener(m_xdgToplevel, &xdgToplevelListener, nullptr);
+        wl_surface_commit(m_root);
+        dispatch(200);
+        QVERIFY(m_wlPointer && m_wlTouch);
+        QVERIFY(m_item->shellSurface());
+
+        // A subsurface of a subsurface above the root, and a subsurface below the root
+        m_child = wl_compositor_create_surface(m_compositor);
+        m_childSubsurface = createSubsurface(m_child, m_root, QRect(10, 10, 50, 50));
+        m_grandchild = wl_compositor_create_surface(m_compositor);
+        m_grandchildSubsurface = createSubsurface(m_grandchild, m_child, QRect(5, 5, 20, 20));
+        m_below = wl_compositor_create_surface(m_compositor);
+        m_belowSubsurface = createSubsurface(m_below, m_root, QRect(60, 60, 30, 30));
+        wl_subsurface_place_below(m_belowSubsurface, m_root);
+
+        // The subsurfaces are synchronized, their states are applied with the parent
+        wl_surface_commit(m_grandchild);
+        wl_surface_commit(m_child);
+        wl_surface_commit(m_below);
+        m_buffers.append(createBuffer(100, 100));
+        wl_surface_attach(m_root, m_buffers.last(), 0, 0);
+        wl_surface_commit(m_root);
+        dispatch(200);
+
+        QTRY_COMPARE(quadRects().size(), 4);
+    }
+
+    void quadOrder()
+    {
+        // Like wlr_surface_for_each_surface, the parent is between its subsurfaces
+        // below and above, the positions are local to the root surface.
+        const QList<QRectF> expected {
+            QRectF(60, 60, 30, 30),
+            QRectF(0, 0, 100, 100),
+            QRectF(10, 10, 50, 50),
+            QRectF(15, 15, 20, 20),
+        };
+        QCOMPARE(quadRects(), expected);
+        // The footprint node is always the last one
+        auto node = QQuickItemPrivate::get(m_item->contentItem())->paintNode;
+        QVERIFY(!dynamic_cast<QSGImageNode*>(node->lastChild()));
+    }
+
+    void pointerOnSubsurfaces()
+    {
+        m_input.enters = 0;
+        movePointer(ItemPosition + QPointF(20, 20));
+        QCOMPARE(m_input.pointerFocus, m_grandchild);
+        QCOMPARE(m_input.enterPosition, QPointF(5, 5));
+
+        // The focus moves between the surfaces of the tree with the coordinates local to them
+        movePointer(ItemPosition + QPointF(50, 50));
+        QCOMPARE(m_input.pointerFocus, m_child);
+        QCOMPARE(m_input.enterPosition, QPointF(40, 40));
+        QCOMPARE(m_input.motionPosition, QPointF(40, 40));
+
+        const int enters = m_input.enters;
+        movePointer(ItemPosition + QPointF(52, 50));
+        QCOMPARE(m_input.pointerFocus, m_child);
+        QCOMPARE(m_input.enters, enters);
+        QCOMPARE(m_input.motionPosition, QPointF(42, 40));
+
+        // The subsurface below is covered by the root surface
+        movePointer(ItemPosition + QPointF(70, 70));
+        QCOMPARE(m_input.pointerFocus, m_root);
+        QCOMPARE(m_input.enterPosition, QPointF(70, 70));
+
+        movePointer(QPointF(OutputWidth - 10, OutputHeight - 10));
+        QVERIFY(!m_input.pointerFocus);
+    }
+
+    void touchOnSubsurface()
+    {
+        touchDown(ItemPosition + QPointF(20, 20));
+        QCOMPARE(m_input.touchSurface, m_grandchild);
+        QCOMPARE(m_input.touchDownPosition, QPointF(5, 5));
+
+        // The motions stay local to the surface which the point is down on,
+        // even when it leaves that surface.
+        touchMotion(ItemPosition + QPointF(30, 25));
+        QCOMPARE(m_input.touchMotionPosition, QPointF(15, 10));
+        touchMotion(ItemPosition + QPointF(50, 50));
+        QCOMPARE(m_input.touchMotionPosition, QPointF(35, 35));
+
+        touchUp();
+    }
+
+    void cleanupTestCase()
+    {
+        m_cursor->setEventWindow(nullptr);
+        m_seat->detachInputDevice(m_pointerDevice);
+        m_seat->detachInputDevice(m_touchDevice);
+        wlr_pointer_finish(&m_pointer);
+        wlr_touch_finish(&m_touch);
+
+        wl_subsurface_destroy(m_belowSubsurface);
+        wl_subsurface_destroy(m_grandchildSubsurface);
+        wl_subsurface_destroy(m_childSubsurface);
+        wl_surface_destroy(m_below);
+        wl_surface_destroy(m_grandchild);
+        wl_surface_destroy(m_child);
+        xdg_toplevel_destroy(m_xdgToplevel);
+        xdg_surface_destroy(m_xdgSurface);
+        wl_surface_destroy(m_root);
+        for (auto buffer : std::as_const(m_buffers))
+            wl_buffer_destroy(buffer);
+        dispatch();
+
+        wl_display_disconnect(m_display);
+        delete m_window;
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    WSeat *m_seat = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    qw_allocator *m_allocator = nullptr;
+    WOutputLayout *m_layout = nullptr;
+    WCursor *m_cursor = nullptr;
+    QQmlEngine m_engine;
+    WOutputRenderWindow *m_window = nullptr;
+    WXdgToplevelSurfaceItem *m_item = nullptr;
+
+    wlr_pointer m_pointer;
+    WInputDevice *m_pointerDevice = nullptr;
+    wlr_touch m_touch;
+    WInputDevice *m_touchDevice = nullptr;
+    uint32_t m_time = 0;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_subcompositor *m_subcompositor = nullptr;
+    wl_shm *m_shm = nullptr;
+    wl_seat *m_wlSeat = nullptr;
+    xdg_wm_base *m_wmBase = nullptr;
+    wl_pointer *m_wlPointer = nullptr;
+    wl_touch *m_wlTouch = nullptr;
+    ClientInput m_input;
+
+    wl_surface *m_root = nullptr;
+    xdg_surface *m_xdgSurface = nullptr;
+    xdg_toplevel *m_xdgToplevel = nullptr;
+    wl_surface *m_child = nullptr;
+    wl_subsurface *m_childSubsurface = nullptr;
+    wl_surface *m_grandchild = nullptr;
+    wl_subsurface *m_grandchildSubsurface = nullptr;
+    wl_surface *m_below = nullptr;
+    wl_subsurface *m_belowSubsurface = nullptr;
+    QList<wl_buffer*> m_buffers;
+};
+
+int main(int argc, char *argv[])
+{
+    // WSeat adds the input devices to the wlroots QPA
+    WServer::initializeQPA();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    QGuiApplication app(argc, argv);
+
+    FlattenedSubsurfaceTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
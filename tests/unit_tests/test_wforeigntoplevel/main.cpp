@@ -0,0 +1,302 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wxdgshell.h>
+#include <wxdgtoplevelsurface.h>
+#include <wforeigntoplevelv1.h>
+#include <wextforeigntoplevellistv1.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QElapsedTimer>
+
+#include <wayland-client.h>
+#include <xdg-shell-client-protocol.h>
+#include <ext-foreign-toplevel-list-v1-client-protocol.h>
+#include <wlr-foreign-toplevel-management-unstable-v1-client-protocol.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+struct ToplevelEvents
+{
+    int title = 0;
+    int appId = 0;
+    int state = 0;
+    int done = 0;
+    QByteArray lastTitle;
+    QByteArray lastAppId;
+
+    void reset() {
+        title = appId = state = done = 0;
+    }
+};
+
+static const zwlr_foreign_toplevel_handle_v1_listener wlrHandleListener = {
+    .title = [] (void *data, zwlr_foreign_toplevel_handle_v1 *, const char *title) {
+        auto events = static_cast<ToplevelEvents*>(data);
+        ++events->title;
+        events->lastTitle = title;
+    },
+    .app_id = [] (void *data, zwlr_foreign_toplevel_handle_v1 *, const char *appId) {
+        auto events = static_cast<ToplevelEvents*>(data);
+        ++events->appId;
+        events->lastAppId = appId;
+    },
+    .output_enter = [] (void *, zwlr_foreign_toplevel_handle_v1 *, wl_output *) {},
+    .output_leave = [] (void *, zwlr_foreign_toplevel_handle_v1 *, wl_output *) {},
+    .state = [] (void *data, zwlr_foreign_toplevel_handle_v1 *, wl_array *) {
+        ++static_cast<ToplevelEvents*>(data)->state;
+    },
+    .done = [] (void *data, zwlr_foreign_toplevel_handle_v1 *) {
+        ++static_cast<ToplevelEvents*>(data)->done;
+    },
+    .closed = [] (void *, zwlr_foreign_toplevel_handle_v1 *) {},
+    .parent = [] (void *, zwlr_foreign_toplevel_handle_v1 *, zwlr_foreign_toplevel_handle_v1 *) {},
+};
+
+static const ext_foreign_toplevel_handle_v1_listener extHandleListener = {
+    .closed = [] (void *, ext_foreign_toplevel_handle_v1 *) {},
+    .done = [] (void *data, ext_foreign_toplevel_handle_v1 *) {
+        ++static_cast<ToplevelEvents*>(data)->done;
+    },
+    .title = [] (void *data, ext_foreign_toplevel_handle_v1 *, const char *title) {
+        auto events = static_cast<ToplevelEvents*>(data);
+        ++events->title;
+        events->lastTitle = title;
+    },
+    .app_id = [] (void *data, ext_foreign_toplevel_handle_v1 *, const char *appId) {
+        auto events = static_cast<ToplevelEvents*>(data);
+        ++events->appId;
+        events->lastAppId = appId;
+    },
+    .identifier = [] (void *, ext_foreign_toplevel_handle_v1 *, const char *) {},
+};
+
+class ForeignToplevelTest : public QObject
+{
+    Q_OBJECT
+public:
+    ForeignToplevelTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    // Run the server and read the events of the client for a while
+    void dispatch(int msecs = 100)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t version)
+    {
+        auto self = static_cast<ForeignToplevelTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        } else if (qstrcmp(interface, xdg_wm_base_interface.name) == 0) {
+            self->m_wmBase = static_cast<xdg_wm_base*>(
+                wl_registry_bind(registry, name, &xdg_wm_base_interface, 1));
+        } else if (qstrcmp(interface, zwlr_foreign_toplevel_manager_v1_interface.name) == 0) {
+            self->m_wlrManager = static_cast<zwlr_foreign_toplevel_manager_v1*>(
+                wl_registry_bind(registry, name, &zwlr_foreign_toplevel_manager_v1_interface,
+                                 qMin(version, 3u)));
+        } else if (qstrcmp(interface, ext_foreign_toplevel_list_v1_interface.name) == 0) {
+            self->m_extList = static_cast<ext_foreign_toplevel_list_v1*>(
+                wl_registry_bind(registry, name, &ext_foreign_toplevel_list_v1_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        auto xdgShell = m_server->attach<WXdgShell>(5);
+        auto foreignToplevel = m_server->attach<WForeignToplevel>(xdgShell);
+        auto extForeignToplevelList = m_server->attach<WExtForeignToplevelListV1>();
+
+        connect(xdgShell, &WXdgShell::toplevelSurfaceAdded, this,
+                [foreignToplevel, extForeignToplevelList] (WXdgToplevelSurface *surface) {
+            foreignToplevel->addSurface(surface);
+            extForeignToplevelList->addSurface(surface);
+        });
+        connect(xdgShell, &WXdgShell::toplevelSurfaceRemoved, this,
+                [foreignToplevel, extForeignToplevelList] (WXdgToplevelSurface *surface) {
+            foreignToplevel->removeSurface(surface);
+            extForeignToplevelList->removeSurface(surface);
+        });
+
+        m_server->start();
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        dispatch();
+        QVERIFY(m_compositor && m_wmBase && m_wlrManager && m_extList);
+
+        static const xdg_wm_base_listener wmBaseListener = {
+            .ping = [] (void *, xdg_wm_base *wmBase, uint32_t serial) {
+                xdg_wm_base_pong(wmBase, serial);
+            },
+        };
+        xdg_wm_base_add_listener(m_wmBase, &wmBaseListener, nullptr);
+
+        static const zwlr_foreign_toplevel_manager_v1_listener wlrManagerListener = {
+            .toplevel = [] (void *data, zwlr_foreign_toplevel_manager_v1 *,
+                            zwlr_foreign_toplevel_handle_v1 *handle) {
+                auto self = static_cast<ForeignToplevelTest*>(data);
+                self->m_wlrHandle = handle;
+                zwlr_foreign_toplevel_handle_v1_add_listener(handle, &wlrHandleListener,
+                                                             &self->m_wlrEvents);
+            },
+            .finished = [] (void *, zwlr_foreign_toplevel_manager_v1 *) {},
+        };
+        zwlr_foreign_toplevel_manager_v1_add_listener(m_wlrManager, &wlrManagerListener, this);
+
+        static const ext_foreign_toplevel_list_v1_listener extListListener = {
+            .toplevel = [] (void *data, ext_foreign_toplevel_list_v1 *,
+                            ext_foreign_toplevel_handle_v1 *handle) {
+                auto self = static_cast<ForeignToplevelTest*>(data);
+                self->m_extHandle = handle;
+                ext_foreign_toplevel_handle_v1_add_listener(handle, &extHandleListener,
+                                                            &self->m_extEvents);
+            },
+            .finished = [] (void *, ext_foreign_toplevel_list_v1 *) {},
+        };
+        ext_foreign_toplevel_list_v1_add_listener(m_extList, &extListListener, this);
+
+        static const xdg_surface_listener xdgSurfaceListener = {
+            .configure = [] (void *, xdg_surface *surface, uint32_t serial) {
+                xdg_surface_ack_configure(surface, serial);
+            },
+        };
+        static const xdg_toplevel_listener xdgToplevelListener = {
+            .configure = [] (void *, xdg_toplevel *, int32_t, int32_t, wl_array *) {},
+            .close = [] (void *, xdg_toplevel *) {},
+        };
+        m_surface = wl_compositor_create_surface(m_compositor);
+        m_xdgSurface = xdg_wm_base_get_xdg_surface(m_wmBase, m_surface);
+        xdg_surface_add_listener(m_xdgSurface, &xdgSurfaceListener, nullptr);
+        m_xdgToplevel = xdg_surface_get_toplevel(m_xdgSurface);
+        xdg_toplevel_add_listener(m_xdgToplevel, &xdgToplevelListener, nullptr);
+        wl_surface_commit(m_surface);
+        dispatch(200);
+
+        QVERIFY(m_wlrHandle);
+        QVERIFY(m_extHandle);
+    }
+
+    void testCoalescedChanges()
+    {
+        m_wlrEvents.reset();
+        m_extEvents.reset();
+
+        xdg_toplevel_set_title(m_xdgToplevel, "first");
+        xdg_toplevel_set_title(m_xdgToplevel, "second");
+        xdg_toplevel_set_title(m_xdgToplevel, "third");
+        xdg_toplevel_set_app_id(m_xdgToplevel, "org.waylib.test");
+        dispatch(200);
+
+        QCOMPARE(m_wlrEvents.title, 1);
+        QCOMPARE(m_wlrEvents.lastTitle, QByteArrayLiteral("third"));
+        QCOMPARE(m_wlrEvents.appId, 1);
+        QCOMPARE(m_wlrEvents.lastAppId, QByteArrayLiteral("org.waylib.test"));
+        QCOMPARE(m_wlrEvents.done, 1);
+
+        QCOMPARE(m_extEvents.title, 1);
+        QCOMPARE(m_extEvents.lastTitle, QByteArrayLiteral("third"));
+        QCOMPARE(m_extEvents.lastAppId, QByteArrayLiteral("org.waylib.test"));
+        QCOMPARE(m_extEvents.done, 1);
+    }
+
+    void testRevertedChanges()
+    {
+        m_wlrEvents.reset();
+        m_extEvents.reset();
+
+        // The title is changed back before the flush, nothing to send
+        xdg_toplevel_set_title(m_xdgToplevel, "fourth");
+        xdg_toplevel_set_title(m_xdgToplevel, "third");
+        dispatch(200);
+
+        QCOMPARE(m_wlrEvents.title, 0);
+        QCOMPARE(m_wlrEvents.done, 0);
+        QCOMPARE(m_extEvents.title, 0);
+        QCOMPARE(m_extEvents.done, 0);
+    }
+
+    void cleanupTestCase()
+    {
+        xdg_toplevel_destroy(m_xdgToplevel);
+        xdg_surface_destroy(m_xdgSurface);
+        wl_surface_destroy(m_surface);
+        dispatch();
+
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    xdg_wm_base *m_wmBase = nullptr;
+    zwlr_foreign_toplevel_manager_v1 *m_wlrManager = nullptr;
+    ext_foreign_toplevel_list_v1 *m_extList = nullptr;
+
+    wl_surface *m_surface = nullptr;
+    xdg_surface *m_xdgSurface = nullptr;
+    xdg_toplevel *m_xdgToplevel = nullptr;
+
+    zwlr_foreign_toplevel_handle_v1 *m_wlrHandle = nullptr;
+    ToplevelEvents m_wlrEvents;
+    ext_foreign_toplevel_handle_v1 *m_extHandle = nullptr;
+    ToplevelEvents m_extEvents;
+};
+
+QTEST_MAIN(ForeignToplevelTest)
+#include "main.moc"
@@ -0,0 +1,195 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <woutput.h>
+#include <woutputrenderwindow.h>
+#include <woutputviewport.h>
+#include <wrenderhelper.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwallocator.h>
+#include <qwoutput.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QQuickItem>
+
+#include "headlessbackend.h"
+
+extern "C" {
+#include <wlr/interfaces/wlr_output.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+static int setCursorCount = 0;
+static int moveCursorCount = 0;
+
+// The headless output has no cursor plane, fake one like the DRM backend
+static void addFakeCursorPlane(wlr_output *output)
+{
+    static wlr_output_impl impl;
+    impl = *output->impl;
+    impl.set_cursor = [] (wlr_output *, wlr_buffer *, int, int) {
+        ++setCursorCount;
+        return true;
+    };
+    impl.move_cursor = [] (wlr_output *output, int, int) {
+        ++moveCursorCount;
+        // The cursor plane's position is applied in the next commit
+        wlr_output_update_needs_frame(output);
+        return true;
+    };
+    output->impl = &impl;
+}
+
+static const char *windowQml = R"(
+import QtQuick
+import Waylib.Server
+
+OutputRenderWindow {
+    id: window
+
+    required property WaylandOutput waylandOutput
+    readonly property Item cursorItem: cursor
+
+    width: 800
+    height: 600
+
+    OutputViewport {
+        id: viewport
+
+        output: window.waylandOutput
+        devicePixelRatio: 1
+        anchors.fill: parent
+    }
+
+    Rectangle {
+        id: cursor
+
+        x: 100
+        y: 100
+        width: 32
+        height: 32
+        color: "white"
+        OutputLayer.enabled: true
+        OutputLayer.keepLayer: true
+        OutputLayer.flags: OutputLayer.Cursor
+        OutputLayer.outputs: [viewport]
+    }
+}
+)";
+
+class HardwareCursorTest : public QObject
+{
+    Q_OBJECT
+public:
+    HardwareCursorTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        QVERIFY(HeadlessBackend::createRenderer(m_backend, &m_renderer, &m_allocator));
+
+        auto output = HeadlessBackend::addOutput(m_backend, 800, 600);
+        QVERIFY(output);
+        addFakeCursorPlane(output->nativeHandle());
+
+        QQmlComponent component(&m_engine);
+        component.setData(windowQml, QUrl());
+        m_window = qobject_cast<WOutputRenderWindow*>(component.createWithInitialProperties({
+            {"waylandOutput", QVariant::fromValue(output)},
+        }));
+        QVERIFY2(m_window, qPrintable(component.errorString()));
+        m_cursor = m_window->property("cursorItem").value<QQuickItem*>();
+        QVERIFY(m_cursor);
+
+        HeadlessBackend::enableOutputs(m_window);
+        connect(m_window, &WOutputRenderWindow::beforeRendering, this, [this] {
+            ++m_renders;
+        });
+        m_window->init(m_renderer, m_allocator);
+        m_backend->handle()->start();
+
+        QTRY_VERIFY(setCursorCount > 0);
+    }
+
+    void testMoveWithoutRender()
+    {
+        QTest::qWait(100);
+        m_renders = 0;
+        setCursorCount = 0;
+        moveCursorCount = 0;
+
+        constexpr int motions = 20;
+        for (int i = 1; i <= motions; ++i) {
+            m_cursor->setPosition(QPointF(100 + i * 5, 100 + i * 3));
+            QTest::qWait(20);
+        }
+
+        QCOMPARE(m_renders, 0);
+        QCOMPARE(setCursorCount, 0);
+        QVERIFY2(moveCursorCount >= motions, qPrintable(QString::number(moveCursorCount)));
+    }
+
+    void testImageChange()
+    {
+        m_renders = 0;
+        setCursorCount = 0;
+
+        m_cursor->setProperty("color", QColor(Qt::red));
+        QTRY_VERIFY(m_renders > 0);
+        QTest::qWait(100);
+        QCOMPARE(setCursorCount, 1);
+    }
+
+    void testMoveToEdge()
+    {
+        m_renders = 0;
+
+        // The cursor is clipped by the output's edge, it needs to render again
+        m_cursor->setPosition(QPointF(790, 590));
+        QTRY_VERIFY(m_renders > 0);
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_window;
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    qw_allocator *m_allocator = nullptr;
+    QQmlEngine m_engine;
+    WOutputRenderWindow *m_window = nullptr;
+    QQuickItem *m_cursor = nullptr;
+    int m_renders = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    WServer::initializeQPA();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    QGuiApplication app(argc, argv);
+
+    HardwareCursorTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
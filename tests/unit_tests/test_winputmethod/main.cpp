@@ -0,0 +1,323 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wseat.h>
+#include <wsurface.h>
+#include <winputmethodhelper.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include <wayland-client.h>
+#include <text-input-unstable-v3-client-protocol.h>
+#include <input-method-unstable-v2-client-protocol.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+// The events received by the input method client
+struct InputMethodEvents
+{
+    int activate = 0;
+    int surroundingText = 0;
+    int textChangeCause = 0;
+    int contentType = 0;
+    int done = 0;
+    int cursorRect = 0;
+    QByteArray lastSurroundingText;
+    QRect lastCursorRect;
+
+    void reset() {
+        activate = surroundingText = textChangeCause = contentType = done = cursorRect = 0;
+    }
+
+    int total() const {
+        return activate + surroundingText + textChangeCause + contentType + done + cursorRect;
+    }
+};
+
+static const zwp_input_method_v2_listener inputMethodListener = {
+    .activate = [] (void *data, zwp_input_method_v2 *) {
+        ++static_cast<InputMethodEvents*>(data)->activate;
+    },
+    .deactivate = [] (void *, zwp_input_method_v2 *) {},
+    .surrounding_text = [] (void *data, zwp_input_method_v2 *, const char *text, uint32_t, uint32_t) {
+        auto events = static_cast<InputMethodEvents*>(data);
+        ++events->surroundingText;
+        events->lastSurroundingText = text;
+    },
+    .text_change_cause = [] (void *data, zwp_input_method_v2 *, uint32_t) {
+        ++static_cast<InputMethodEvents*>(data)->textChangeCause;
+    },
+    .content_type = [] (void *data, zwp_input_method_v2 *, uint32_t, uint32_t) {
+        ++static_cast<InputMethodEvents*>(data)->contentType;
+    },
+    .done = [] (void *data, zwp_input_method_v2 *) {
+        ++static_cast<InputMethodEvents*>(data)->done;
+    },
+    .unavailable = [] (void *, zwp_input_method_v2 *) {},
+};
+
+static const zwp_input_popup_surface_v2_listener popupSurfaceListener = {
+    .text_input_rectangle = [] (void *data, zwp_input_popup_surface_v2 *,
+                                int32_t x, int32_t y, int32_t width, int32_t height) {
+        auto events = static_cast<InputMethodEvents*>(data);
+        ++events->cursorRect;
+        events->lastCursorRect = QRect(x, y, width, height);
+    },
+};
+
+class InputMethodTest : public QObject
+{
+    Q_OBJECT
+public:
+    InputMethodTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    // Run the server and read the events of the client for a while
+    void dispatch(int msecs = 100)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    // Like the editors, all the state is sent on every commit
+    void commitTextInput(const char *text, int cursor, const QRect &cursorRect)
+    {
+        zwp_text_input_v3_set_surrounding_text(m_textInput, text, cursor, cursor);
+        zwp_text_input_v3_set_text_change_cause(m_textInput, ZWP_TEXT_INPUT_V3_CHANGE_CAUSE_OTHER);
+        zwp_text_input_v3_set_content_type(m_textInput, ZWP_TEXT_INPUT_V3_CONTENT_HINT_NONE,
+                                           ZWP_TEXT_INPUT_V3_CONTENT_PURPOSE_TERMINAL);
+        zwp_text_input_v3_set_cursor_rectangle(m_textInput, cursorRect.x(), cursorRect.y(),
+                                               cursorRect.width(), cursorRect.height());
+        zwp_text_input_v3_commit(m_textInput);
+    }
+
+    void enableTextInput()
+    {
+        zwp_text_input_v3_enable(m_textInput);
+        zwp_text_input_v3_commit(m_textInput);
+        dispatch();
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<InputMethodTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        } else if (qstrcmp(interface, wl_seat_interface.name) == 0) {
+            self->m_clientSeat = static_cast<wl_seat*>(
+                wl_registry_bind(registry, name, &wl_seat_interface, 1));
+        } else if (qstrcmp(interface, zwp_text_input_manager_v3_interface.name) == 0) {
+            self->m_textInputManager = static_cast<zwp_text_input_manager_v3*>(
+                wl_registry_bind(registry, name, &zwp_text_input_manager_v3_interface, 1));
+        } else if (qstrcmp(interface, zwp_input_method_manager_v2_interface.name) == 0) {
+            self->m_inputMethodManager = static_cast<zwp_input_method_manager_v2*>(
+                wl_registry_bind(registry, name, &zwp_input_method_manager_v2_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_seat = m_server->attach<WSeat>();
+        new WInputMethodHelper(m_server, m_seat);
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        auto compositor = qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+        connect(compositor, &qw_compositor::notify_new_surface, this, [this] (wlr_surface *surface) {
+            auto wSurface = new WSurface(qw_surface::from(surface), this);
+            connect(wSurface->handle(), &qw_surface::before_destroy,
+                    wSurface, &WSurface::safeDeleteLater);
+            if (!m_wSurface)
+                m_wSurface = wSurface;
+        });
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        dispatch();
+        QVERIFY(m_compositor && m_clientSeat && m_textInputManager && m_inputMethodManager);
+
+        static const zwp_text_input_v3_listener textInputListener = {
+            .enter = [] (void *data, zwp_text_input_v3 *, wl_surface *) {
+                static_cast<InputMethodTest*>(data)->m_entered = true;
+            },
+            .leave = [] (void *data, zwp_text_input_v3 *, wl_surface *) {
+                static_cast<InputMethodTest*>(data)->m_entered = false;
+            },
+            .preedit_string = [] (void *, zwp_text_input_v3 *, const char *, int32_t, int32_t) {},
+            .commit_string = [] (void *, zwp_text_input_v3 *, const char *) {},
+            .delete_surrounding_text = [] (void *, zwp_text_input_v3 *, uint32_t, uint32_t) {},
+            .done = [] (void *, zwp_text_input_v3 *, uint32_t) {},
+        };
+        m_surface = wl_compositor_create_surface(m_compositor);
+        m_textInput = zwp_text_input_manager_v3_get_text_input(m_textInputManager, m_clientSeat);
+        zwp_text_input_v3_add_listener(m_textInput, &textInputListener, this);
+        m_inputMethod = zwp_input_method_manager_v2_get_input_method(m_inputMethodManager, m_clientSeat);
+        zwp_input_method_v2_add_listener(m_inputMethod, &inputMethodListener, &m_events);
+        dispatch();
+        QVERIFY(m_wSurface);
+
+        m_seat->setKeyboardFocusSurface(m_wSurface);
+        dispatch();
+        QVERIFY(m_entered);
+
+        enableTextInput();
+        QCOMPARE(m_events.activate, 1);
+
+        m_popupParent = wl_compositor_create_surface(m_compositor);
+        m_popupSurface = zwp_input_method_v2_get_input_popup_surface(m_inputMethod, m_popupParent);
+        zwp_input_popup_surface_v2_add_listener(m_popupSurface, &popupSurfaceListener, &m_events);
+        dispatch();
+        QCOMPARE(m_events.cursorRect, 1);
+    }
+
+    void testFirstCommit()
+    {
+        m_events.reset();
+
+        commitTextInput("hello", 5, QRect(50, 10, 1, 20));
+        dispatch();
+
+        QCOMPARE(m_events.surroundingText, 1);
+        QCOMPARE(m_events.lastSurroundingText, QByteArrayLiteral("hello"));
+        QCOMPARE(m_events.textChangeCause, 1);
+        QCOMPARE(m_events.contentType, 1);
+        QCOMPARE(m_events.done, 1);
+        QCOMPARE(m_events.cursorRect, 1);
+        QCOMPARE(m_events.lastCursorRect, QRect(50, 10, 1, 20));
+    }
+
+    void testUnchangedCommits()
+    {
+        m_events.reset();
+
+        // Such as the caret is blinking
+        for (int i = 0; i < 10; ++i)
+            commitTextInput("hello", 5, QRect(50, 10, 1, 20));
+        dispatch();
+
+        QCOMPARE(m_events.total(), 0);
+    }
+
+    void testCursorMove()
+    {
+        m_events.reset();
+
+        commitTextInput("hello", 3, QRect(30, 10, 1, 20));
+        dispatch();
+
+        QCOMPARE(m_events.surroundingText, 1);
+        // Sent again with every surrounding text
+        QCOMPARE(m_events.textChangeCause, 1);
+        QCOMPARE(m_events.contentType, 0);
+        QCOMPARE(m_events.done, 1);
+        QCOMPARE(m_events.cursorRect, 1);
+        QCOMPARE(m_events.lastCursorRect, QRect(30, 10, 1, 20));
+    }
+
+    void testReactivate()
+    {
+        zwp_text_input_v3_disable(m_textInput);
+        zwp_text_input_v3_commit(m_textInput);
+        dispatch();
+
+        m_events.reset();
+        enableTextInput();
+        QCOMPARE(m_events.activate, 1);
+
+        // The input method resets its state on activate, all of it is sent again
+        m_events.reset();
+        commitTextInput("hello", 3, QRect(30, 10, 1, 20));
+        dispatch();
+
+        QCOMPARE(m_events.surroundingText, 1);
+        QCOMPARE(m_events.textChangeCause, 1);
+        QCOMPARE(m_events.contentType, 1);
+        QCOMPARE(m_events.done, 1);
+    }
+
+    void cleanupTestCase()
+    {
+        zwp_input_popup_surface_v2_destroy(m_popupSurface);
+        zwp_input_method_v2_destroy(m_inputMethod);
+        zwp_text_input_v3_destroy(m_textInput);
+        wl_surface_destroy(m_popupParent);
+        wl_surface_destroy(m_surface);
+        dispatch();
+
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    WSeat *m_seat = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    QPointer<WSurface> m_wSurface;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_seat *m_clientSeat = nullptr;
+    zwp_text_input_manager_v3 *m_textInputManager = nullptr;
+    zwp_input_method_manager_v2 *m_inputMethodManager = nullptr;
+
+    wl_surface *m_surface = nullptr;
+    zwp_text_input_v3 *m_textInput = nullptr;
+    bool m_entered = false;
+
+    zwp_input_method_v2 *m_inputMethod = nullptr;
+    wl_surface *m_popupParent = nullptr;
+    zwp_input_popup_surface_v2 *m_popupSurface = nullptr;
+    InputMethodEvents m_events;
+};
+
+QTEST_MAIN(InputMethodTest)
+#include "main.moc"
@@ -0,0 +1,210 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wkeyrepeat_p.h>
+
+#include <QTest>
+#include <QThread>
+
+#include <wayland-server-core.h>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+// 20 repeats per second
+static constexpr int Rate = 50;
+static constexpr int Interval = 1000 / Rate;
+static constexpr int Delay = 100;
+
+static inline qint64 monotonicMsecs()
+{
+    return WKeyRepeat::monotonicNsecs() / 1000000;
+}
+
+// The milliseconds from the timestamp t1 to t2, they may wrap around
+static inline int32_t elapsed(uint32_t t1, qint64 t2)
+{
+    return int32_t(uint32_t(t2) - t1);
+}
+
+class KeyRepeatTest : public QObject
+{
+    Q_OBJECT
+public:
+    KeyRepeatTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    struct Repeat {
+        uint32_t timestamp;
+        qint64 sendTime;
+    };
+
+    // Run the event loop until count repeats are sent
+    bool waitRepeats(int count, int timeout = 2000)
+    {
+        const qint64 end = monotonicMsecs() + timeout;
+        while (m_repeats.size() < count) {
+            const qint64 remaining = end - monotonicMsecs();
+            if (remaining <= 0)
+                return false;
+            wl_event_loop_dispatch(m_loop, int(remaining));
+        }
+        return true;
+    }
+
+    void checkGrid(int from, int to)
+    {
+        for (int i = from + 1; i < to; ++i)
+            QCOMPARE(m_repeats.at(i).timestamp - m_repeats.at(i - 1).timestamp, uint32_t(Interval));
+    }
+
+private Q_SLOTS:
+    void init()
+    {
+        m_loop = wl_event_loop_create();
+        m_repeats.clear();
+        m_load = 0;
+        m_repeat = new WKeyRepeat(m_loop, [this] (uint32_t timestamp) {
+            m_repeats.append({ timestamp, monotonicMsecs() });
+            if (m_load > 0)
+                QThread::msleep(m_load);
+        });
+    }
+
+    void cleanup()
+    {
+        delete m_repeat;
+        m_repeat = nullptr;
+        wl_event_loop_destroy(m_loop);
+    }
+
+    void delayAndInterval()
+    {
+        const qint64 beforeStart = monotonicMsecs();
+        m_repeat->start(Delay, Rate);
+        const qint64 afterStart = monotonicMsecs();
+        QVERIFY(m_repeat->isActive());
+        QVERIFY(waitRepeats(5));
+
+        // The first deadline is the delay after the start, whenever it's sent
+        const auto &first = m_repeats.first();
+        QVERIFY(-elapsed(first.timestamp, beforeStart) >= Delay);
+        QVERIFY(-elapsed(first.timestamp, afterStart) <= Delay);
+        checkGrid(0, m_repeats.size());
+
+        for (const auto &repeat : std::as_const(m_repeats)) {
+            // Never sent before its deadline
+            QVERIFY(elapsed(repeat.timestamp, repeat.sendTime) >= 0);
+        }
+    }
+
+    // The work in the callback, such as rendering, doesn't delay the next deadlines
+    void noDriftUnderLoad()
+    {
+        m_load = Interval / 2;
+        m_repeat->start(0, Rate);
+        QVERIFY(waitRepeats(20));
+        checkGrid(0, m_repeats.size());
+        QCOMPARE(m_repeats.last().timestamp - m_repeats.first().timestamp, uint32_t(19 * Interval));
+    }
+
+    void dropMissed()
+    {
+        QCOMPARE(m_repeat->policy(), WKeyRepeat::Policy::DropMissed);
+        m_repeat->start(0, Rate);
+        QVERIFY(waitRepeats(1));
+
+        // The event loop is blocked for 5 intervals
+        QThread::msleep(Interval * 5 + Interval / 2);
+        const qint64 wakeup = monotonicMsecs();
+        QVERIFY(waitRepeats(2));
+
+        // Only the last missed repeat is sent, with the time of its deadline
+        const auto &repeat = m_repeats.at(1);
+        QCOMPARE((repeat.timestamp - m_repeats.at(0).timestamp) % Interval, 0u);
+        QVERIFY(repeat.timestamp - m_repeats.at(0).timestamp >= uint32_t(Interval * 5));
+        // It's the last deadline before sending, which is after the wakeup
+        QVERIFY(elapsed(repeat.timestamp, repeat.sendTime) >= 0);
+        QVERIFY(elapsed(repeat.timestamp, wakeup) < Interval);
+
+        // And then it's back on the grid
+        QVERIFY(waitRepeats(4));
+        checkGrid(1, m_repeats.size());
+    }
+
+    void catchUp()
+    {
+        m_repeat->setPolicy(WKeyRepeat::Policy::CatchUp);
+        m_repeat->start(0, Rate);
+        QVERIFY(waitRepeats(1));
+
+        QThread::msleep(Interval * 5 + Interval / 2);
+        const qint64 wakeup = monotonicMsecs();
+        QVERIFY(waitRepeats(6));
+
+        // All the missed repeats are sent at once, each one has the time of its deadline
+        checkGrid(0, 6);
+        for (int i = 1; i < 6; ++i)
+            QVERIFY(m_repeats.at(i).sendTime >= wakeup);
+    }
+
+    void catchUpIsBounded()
+    {
+        m_repeat->setPolicy(WKeyRepeat::Policy::CatchUp);
+        m_repeat->start(0, Rate);
+        QVERIFY(waitRepeats(1));
+
+        QThread::msleep(Interval * (WKeyRepeat::MaxCatchUp * 2) + Interval / 2);
+        const qint64 wakeup = monotonicMsecs();
+        wl_event_loop_dispatch(m_loop, 0);
+
+        QCOMPARE(m_repeats.size(), 1 + WKeyRepeat::MaxCatchUp);
+        // The oldest ones are dropped
+        checkGrid(1, m_repeats.size());
+        QVERIFY(elapsed(m_repeats.last().timestamp, wakeup) < Interval);
+    }
+
+    void stopInCallback()
+    {
+        delete m_repeat;
+        m_repeat = new WKeyRepeat(m_loop, [this] (uint32_t timestamp) {
+            m_repeats.append({ timestamp, monotonicMsecs() });
+            m_repeat->stop();
+        });
+        m_repeat->setPolicy(WKeyRepeat::Policy::CatchUp);
+        m_repeat->start(0, Rate);
+        QVERIFY(waitRepeats(1));
+        QVERIFY(!m_repeat->isActive());
+
+        QThread::msleep(Interval * 3);
+        wl_event_loop_dispatch(m_loop, Interval * 2);
+        QCOMPARE(m_repeats.size(), 1);
+    }
+
+    void restart()
+    {
+        m_repeat->start(Delay, Rate);
+        wl_event_loop_dispatch(m_loop, 0);
+        QVERIFY(m_repeats.isEmpty());
+
+        // A new key press starts the delay again
+        const qint64 start = monotonicMsecs();
+        m_repeat->start(Delay, Rate);
+        QVERIFY(waitRepeats(1));
+        QVERIFY(-elapsed(m_repeats.first().timestamp, start) >= Delay);
+
+        m_repeat->start(Delay, 0);
+        QVERIFY(!m_repeat->isActive());
+    }
+
+private:
+    wl_event_loop *m_loop = nullptr;
+    WKeyRepeat *m_repeat = nullptr;
+    QList<Repeat> m_repeats;
+    int m_load = 0;
+};
+
+QTEST_GUILESS_MAIN(KeyRepeatTest)
+#include "main.moc"
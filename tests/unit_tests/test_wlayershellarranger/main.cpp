@@ -0,0 +1,447 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wlayershellarranger.h>
+#include <wserver.h>
+#include <wbackend.h>
+#include <wxdgshell.h>
+#include <wlayershell.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QElapsedTimer>
+
+#include <wayland-client.h>
+#include <wlr-layer-shell-unstable-v1-client-protocol.h>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+using Layer = WLayerSurface::LayerType;
+using Anchor = WLayerSurface::AnchorType;
+using State = WLayerShellArranger::State;
+
+static const QRect OutputGeometry(0, 0, 1920, 1080);
+
+static State panel(Layer layer, Anchor edge, int zone)
+{
+    State state;
+    state.layer = layer;
+    state.exclusiveZone = zone;
+    switch (edge) {
+    case Anchor::Top:
+    case Anchor::Bottom:
+        state.anchor = edge | Anchor::Left | Anchor::Right;
+        state.desiredSize = QSize(0, zone);
+        break;
+    default:
+        state.anchor = edge | Anchor::Top | Anchor::Bottom;
+        state.desiredSize = QSize(zone, 0);
+        break;
+    }
+
+    return state;
+}
+
+struct LayerSurfaceEvents
+{
+    int configure = 0;
+    uint32_t serial = 0;
+    QSize size;
+};
+
+static const zwlr_layer_surface_v1_listener layerSurfaceListener = {
+    .configure = [] (void *data, zwlr_layer_surface_v1 *, uint32_t serial,
+                     uint32_t width, uint32_t height) {
+        auto events = static_cast<LayerSurfaceEvents*>(data);
+        ++events->configure;
+        events->serial = serial;
+        events->size = QSize(width, height);
+    },
+    .closed = [] (void *, zwlr_layer_surface_v1 *) {},
+};
+
+class TestLayerShellArranger : public QObject
+{
+    Q_OBJECT
+
+private:
+    // Run the server and read the events of the client for a while
+    void dispatch(int msecs = 100)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t version)
+    {
+        auto self = static_cast<TestLayerShellArranger*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        } else if (qstrcmp(interface, wl_shm_interface.name) == 0) {
+            self->m_shm = static_cast<wl_shm*>(
+                wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        } else if (qstrcmp(interface, zwlr_layer_shell_v1_interface.name) == 0) {
+            self->m_layerShellVersion = version;
+            self->m_layerShell = static_cast<zwlr_layer_shell_v1*>(
+                wl_registry_bind(registry, name, &zwlr_layer_shell_v1_interface, qMin(version, 5u)));
+        }
+    }
+
+    wl_buffer *createBuffer(int width, int height)
+    {
+        const int stride = width * 4;
+        const int size = stride * height;
+        int fd = memfd_create("test-layershellarranger", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, size) < 0)
+            return nullptr;
+
+        auto pool = wl_shm_create_pool(m_shm, fd, size);
+        auto buffer = wl_shm_pool_create_buffer(pool, 0, width, height, stride, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+        close(fd);
+
+        return buffer;
+    }
+
+    void createLayerSurface()
+    {
+        m_events = {};
+        m_serverSurface = nullptr;
+        m_surface = wl_compositor_create_surface(m_compositor);
+        m_layerSurface = zwlr_layer_shell_v1_get_layer_surface(m_layerShell, m_surface, nullptr,
+                                                               ZWLR_LAYER_SHELL_V1_LAYER_TOP, "test");
+        zwlr_layer_surface_v1_add_listener(m_layerSurface, &layerSurfaceListener, &m_events);
+    }
+
+    void destroyLayerSurface()
+    {
+        zwlr_layer_surface_v1_destroy(m_layerSurface);
+        wl_surface_destroy(m_surface);
+        m_layerSurface = nullptr;
+        m_surface = nullptr;
+        dispatch();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        auto xdgShell = m_server->attach<WXdgShell>(5);
+        auto layerShell = m_server->attach<WLayerShell>(xdgShell);
+
+        connect(layerShell, &WLayerShell::surfaceAdded, this, [this] (WLayerSurface *surface) {
+            m_serverSurface = surface;
+            m_arranger->addSurface(surface);
+        });
+
+        m_server->start();
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        dispatch();
+        QVERIFY(m_compositor && m_shm && m_layerShell);
+    }
+
+    void cleanupTestCase()
+    {
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+    void init()
+    {
+        m_arranger = new WLayerShellArranger(this);
+        m_arranger->setOutputGeometry(OutputGeometry);
+    }
+
+    void cleanup()
+    {
+        delete m_arranger;
+        m_arranger = nullptr;
+    }
+
+    void anchorsAndMargins()
+    {
+        QObject stretched, corner, centered;
+
+        m_arranger->setState(&stretched, panel(Layer::Top, Anchor::Bottom, 40));
+        QCOMPARE(m_arranger->geometry(&stretched), QRect(0, 1040, 1920, 40));
+        QCOMPARE(m_arranger->usableArea(), QRect(0, 0, 1920, 1040));
+
+        State state;
+        state.layer = Layer::Overlay;
+        state.anchor = Anchor::Top | Anchor::Right;
+        state.margins = QMargins(0, 10, 20, 0);
+        state.desiredSize = QSize(100, 50);
+        m_arranger->setState(&corner, state);
+        QCOMPARE(m_arranger->geometry(&corner), QRect(1800, 10, 100, 50));
+
+        state.anchor = {};
+        m_arranger->setState(&centered, state);
+        QCOMPARE(m_arranger->geometry(&centered), QRect(910, 495, 100, 50));
+    }
+
+    void exclusiveOrder()
+    {
+        QObject topPanel, overlayPanel, leftDock, window;
+
+        // Added first, but the overlay layer takes its area before it
+        m_arranger->setState(&topPanel, panel(Layer::Top, Anchor::Top, 30));
+        m_arranger->setState(&overlayPanel, panel(Layer::Overlay, Anchor::Top, 20));
+        m_arranger->setState(&leftDock, panel(Layer::Bottom, Anchor::Left, 60));
+
+        QCOMPARE(m_arranger->geometry(&overlayPanel), QRect(0, 0, 1920, 20));
+        QCOMPARE(m_arranger->geometry(&topPanel), QRect(0, 20, 1920, 30));
+        QCOMPARE(m_arranger->geometry(&leftDock), QRect(0, 50, 60, 1030));
+        QCOMPARE(m_arranger->usableArea(), QRect(60, 50, 1860, 1030));
+
+        State state;
+        state.layer = Layer::Overlay;
+        state.anchor = Anchor::Top | Anchor::Left;
+        state.desiredSize = QSize(200, 100);
+        m_arranger->setState(&window, state);
+        QCOMPARE(m_arranger->geometry(&window), QRect(60, 50, 200, 100));
+
+        m_arranger->remove(&overlayPanel);
+        QCOMPARE(m_arranger->geometry(&topPanel), QRect(0, 0, 1920, 30));
+        QCOMPARE(m_arranger->geometry(&window), QRect(60, 30, 200, 100));
+        QCOMPARE(m_arranger->usableArea(), QRect(60, 30, 1860, 1050));
+    }
+
+    void exclusiveZoneWithMargin()
+    {
+        QObject topPanel;
+
+        auto state = panel(Layer::Top, Anchor::Top, 30);
+        state.margins = QMargins(0, 5, 0, 0);
+        m_arranger->setState(&topPanel, state);
+        QCOMPARE(m_arranger->geometry(&topPanel), QRect(0, 5, 1920, 30));
+        QCOMPARE(m_arranger->usableArea(), QRect(0, 35, 1920, 1045));
+    }
+
+    void ignoreExclusiveZones()
+    {
+        QObject topPanel, wallpaper;
+
+        m_arranger->setState(&topPanel, panel(Layer::Top, Anchor::Top, 30));
+
+        State state;
+        state.layer = Layer::Background;
+        state.anchor = Anchor::Top | Anchor::Bottom | Anchor::Left | Anchor::Right;
+        state.exclusiveZone = -1;
+        m_arranger->setState(&wallpaper, state);
+        QCOMPARE(m_arranger->geometry(&wallpaper), OutputGeometry);
+
+        state.exclusiveZone = 0;
+        m_arranger->setState(&wallpaper, state);
+        QCOMPARE(m_arranger->geometry(&wallpaper), QRect(0, 30, 1920, 1050));
+    }
+
+    void exclusiveEdge()
+    {
+        QObject surface;
+
+        // Anchored to three edges, the edge is deduced from the opposite one
+        State state;
+        state.layer = Layer::Top;
+        state.anchor = Anchor::Top | Anchor::Bottom | Anchor::Left;
+        state.exclusiveZone = 50;
+        state.desiredSize = QSize(50, 0);
+        m_arranger->setState(&surface, state);
+        QCOMPARE(m_arranger->exclusiveEdge(&surface), Anchor::Left);
+        QCOMPARE(m_arranger->usableArea(), QRect(50, 0, 1870, 1080));
+
+        state.exclusiveEdge = Anchor::Top;
+        m_arranger->setState(&surface, state);
+        QCOMPARE(m_arranger->exclusiveEdge(&surface), Anchor::Top);
+        QCOMPARE(m_arranger->usableArea(), QRect(0, 50, 1920, 1030));
+
+        // The edge must be one of the anchors
+        state.exclusiveEdge = Anchor::Right;
+        m_arranger->setState(&surface, state);
+        QCOMPARE(m_arranger->exclusiveEdge(&surface), Anchor::None);
+        QCOMPARE(m_arranger->usableArea(), OutputGeometry);
+
+        // Can't deduce the edge from two opposite anchors
+        state.exclusiveEdge = Anchor::None;
+        state.anchor = Anchor::Top | Anchor::Bottom;
+        m_arranger->setState(&surface, state);
+        QCOMPARE(m_arranger->exclusiveEdge(&surface), Anchor::None);
+        QCOMPARE(m_arranger->usableArea(), OutputGeometry);
+    }
+
+    void incrementalUpdate()
+    {
+        QObject topPanel, first, second;
+
+        m_arranger->setState(&topPanel, panel(Layer::Top, Anchor::Top, 30));
+
+        State state;
+        state.layer = Layer::Top;
+        state.anchor = Anchor::Top;
+        state.desiredSize = QSize(100, 100);
+        m_arranger->setState(&first, state);
+        m_arranger->setState(&second, state);
+
+        QSignalSpy geometrySpy(m_arranger, &WLayerShellArranger::geometryChanged);
+        QSignalSpy usableAreaSpy(m_arranger, &WLayerShellArranger::usableAreaChanged);
+
+        state.desiredSize = QSize(200, 100);
+        m_arranger->setState(&first, state);
+        QCOMPARE(geometrySpy.count(), 1);
+        QCOMPARE(geometrySpy.first().at(0).value<QObject*>(), &first);
+        QCOMPARE(m_arranger->geometry(&first), QRect(860, 30, 200, 100));
+        QCOMPARE(usableAreaSpy.count(), 0);
+
+        // Setting the same state again is a no-op
+        m_arranger->setState(&first, state);
+        QCOMPARE(geometrySpy.count(), 1);
+
+        // The panel's size doesn't change its exclusive zone
+        auto panelState = panel(Layer::Top, Anchor::Top, 30);
+        panelState.desiredSize.setHeight(40);
+        m_arranger->setState(&topPanel, panelState);
+        QCOMPARE(geometrySpy.count(), 2);
+        QCOMPARE(usableAreaSpy.count(), 0);
+
+        // Everything below the panel moves
+        panelState.exclusiveZone = 40;
+        m_arranger->setState(&topPanel, panelState);
+        QCOMPARE(geometrySpy.count(), 4);
+        QCOMPARE(usableAreaSpy.count(), 1);
+        QCOMPARE(m_arranger->geometry(&second), QRect(910, 40, 100, 100));
+    }
+
+    void surfaceExclusiveEdge()
+    {
+        // set_exclusive_edge is added in version 5
+        QCOMPARE_GE(m_layerShellVersion, 5u);
+
+        createLayerSurface();
+        zwlr_layer_surface_v1_set_anchor(m_layerSurface, ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP
+                                                         | ZWLR_LAYER_SURFACE_V1_ANCHOR_BOTTOM
+                                                         | ZWLR_LAYER_SURFACE_V1_ANCHOR_LEFT);
+        zwlr_layer_surface_v1_set_size(m_layerSurface, 50, 0);
+        zwlr_layer_surface_v1_set_exclusive_zone(m_layerSurface, 50);
+        zwlr_layer_surface_v1_set_exclusive_edge(m_layerSurface, ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP);
+        wl_surface_commit(m_surface);
+        dispatch();
+
+        QVERIFY(m_serverSurface);
+        QCOMPARE(m_serverSurface->getExclusiveZoneEdge(), Anchor::Top);
+        QCOMPARE(m_arranger->exclusiveEdge(m_serverSurface), Anchor::Top);
+        QCOMPARE(m_arranger->usableArea(), QRect(0, 50, 1920, 1030));
+        QCOMPARE(m_events.configure, 1);
+        QCOMPARE(m_events.size, QSize(50, 1080));
+
+        destroyLayerSurface();
+        QCOMPARE(m_arranger->usableArea(), OutputGeometry);
+    }
+
+    void surfaceReconfigureAfterUnmap()
+    {
+        createLayerSurface();
+        zwlr_layer_surface_v1_set_anchor(m_layerSurface, ZWLR_LAYER_SURFACE_V1_ANCHOR_TOP);
+        zwlr_layer_surface_v1_set_size(m_layerSurface, 100, 30);
+        wl_surface_commit(m_surface);
+        dispatch();
+        QCOMPARE(m_events.configure, 1);
+        QCOMPARE(m_events.size, QSize(100, 30));
+
+        auto buffer = createBuffer(100, 30);
+        QVERIFY(buffer);
+        zwlr_layer_surface_v1_ack_configure(m_layerSurface, m_events.serial);
+        wl_surface_attach(m_surface, buffer, 0, 0);
+        wl_surface_commit(m_surface);
+        dispatch();
+        QVERIFY(m_serverSurface->surface()->mapped());
+
+        wl_surface_attach(m_surface, nullptr, 0, 0);
+        wl_surface_commit(m_surface);
+        dispatch();
+        QVERIFY(!m_serverSurface->surface()->mapped());
+
+        // The initial commit after unmapping waits for a new configure, even with the same size
+        wl_surface_commit(m_surface);
+        dispatch();
+        QCOMPARE(m_events.configure, 2);
+        QCOMPARE(m_events.size, QSize(100, 30));
+
+        wl_buffer_destroy(buffer);
+        destroyLayerSurface();
+    }
+
+    void outputGeometry()
+    {
+        QObject topPanel;
+
+        m_arranger->setState(&topPanel, panel(Layer::Top, Anchor::Top, 30));
+        m_arranger->setOutputGeometry(QRect(1920, 0, 1280, 720));
+        QCOMPARE(m_arranger->geometry(&topPanel), QRect(1920, 0, 1280, 30));
+        QCOMPARE(m_arranger->usableArea(), QRect(1920, 30, 1280, 690));
+    }
+
+private:
+    WLayerShellArranger *m_arranger = nullptr;
+
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_shm *m_shm = nullptr;
+    zwlr_layer_shell_v1 *m_layerShell = nullptr;
+    uint32_t m_layerShellVersion = 0;
+
+    wl_surface *m_surface = nullptr;
+    zwlr_layer_surface_v1 *m_layerSurface = nullptr;
+    LayerSurfaceEvents m_events;
+    WLayerSurface *m_serverSurface = nullptr;
+};
+
+QTEST_MAIN(TestLayerShellArranger)
+#include "main.moc"
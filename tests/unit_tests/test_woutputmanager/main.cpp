@@ -0,0 +1,171 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <woutput.h>
+#include <woutputmanagerv1.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwallocator.h>
+#include <qwoutput.h>
+
+#include <QTest>
+#include <QGuiApplication>
+
+#include "headlessbackend.h"
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+class OutputManagerTest : public QObject
+{
+    Q_OBJECT
+public:
+    OutputManagerTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    WOutputState currentState(WOutput *output) const
+    {
+        const auto *handle = output->nativeHandle();
+        return WOutputState {
+            .output = output,
+            .enabled = handle->enabled,
+            .mode = handle->current_mode,
+            .x = 0,
+            .y = 0,
+            .customModeSize = { handle->width, handle->height },
+            .customModeRefresh = handle->refresh,
+            .transform = static_cast<WOutput::Transform>(handle->transform),
+            .scale = handle->scale,
+            .adaptiveSyncEnabled = false,
+        };
+    }
+
+    QList<WOutputState> currentStates() const
+    {
+        QList<WOutputState> states;
+        for (auto output : std::as_const(m_outputs))
+            states.append(currentState(output));
+        return states;
+    }
+
+    void resetCommits()
+    {
+        m_commits.clear();
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_manager = m_server->attach<WOutputManagerV1>();
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_allocator = qw_allocator::autocreate(*m_backend->handle(), *m_renderer);
+        QVERIFY(m_allocator);
+
+        connect(m_backend, &WBackend::outputAdded, this, [this] (WOutput *output) {
+            output->handle()->init_render(m_allocator->handle(), m_renderer->handle());
+            connect(output->handle(), &qw_output::notify_commit, this, [this, output] {
+                ++m_commits[output];
+            });
+            m_outputs.append(output);
+        });
+
+        QVERIFY(HeadlessBackend::addOutput(m_backend, 800, 600));
+        QVERIFY(HeadlessBackend::addOutput(m_backend, 1024, 768));
+        QCOMPARE(m_outputs.size(), 2);
+    }
+
+    void testEnable()
+    {
+        auto states = currentStates();
+        for (auto &state : states) {
+            QVERIFY(!state.enabled);
+            state.enabled = true;
+        }
+
+        resetCommits();
+        QVERIFY(m_manager->applyStates(states));
+        for (auto output : std::as_const(m_outputs)) {
+            QVERIFY(output->nativeHandle()->enabled);
+            QCOMPARE(m_commits.value(output), 1);
+        }
+    }
+
+    void testPositionOnly()
+    {
+        auto states = currentStates();
+        states[1].x = 800;
+
+        resetCommits();
+        QVERIFY(m_manager->applyStates(states));
+        QVERIFY(m_commits.isEmpty());
+    }
+
+    void testUnchanged()
+    {
+        resetCommits();
+        QVERIFY(m_manager->applyStates(currentStates()));
+        QVERIFY(m_commits.isEmpty());
+    }
+
+    void testScale()
+    {
+        auto states = currentStates();
+        for (auto &state : states)
+            state.scale = 2;
+
+        resetCommits();
+        QVERIFY(m_manager->applyStates(states));
+        for (auto output : std::as_const(m_outputs)) {
+            QCOMPARE(output->nativeHandle()->scale, 2.0f);
+            QCOMPARE(m_commits.value(output), 1);
+        }
+    }
+
+    void testOnlyTest()
+    {
+        auto states = currentStates();
+        states[0].transform = WOutput::R90;
+
+        resetCommits();
+        QVERIFY(m_manager->applyStates(states, true));
+        QVERIFY(m_commits.isEmpty());
+        QCOMPARE(m_outputs[0]->nativeHandle()->transform, WL_OUTPUT_TRANSFORM_NORMAL);
+    }
+
+    void cleanupTestCase()
+    {
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    WOutputManagerV1 *m_manager = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    qw_allocator *m_allocator = nullptr;
+    QList<WOutput*> m_outputs;
+    QHash<WOutput*, int> m_commits;
+};
+
+int main(int argc, char *argv[])
+{
+    // WBackend adds the outputs as the screens of the QPA
+    WServer::initializeQPA();
+    QGuiApplication app(argc, argv);
+
+    OutputManagerTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
@@ -0,0 +1,198 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <woutput.h>
+#include <woutputrenderwindow.h>
+#include <woutputviewport.h>
+#include <wrenderhelper.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwallocator.h>
+#include <qwoutput.h>
+
+#include <QTest>
+#include <QSignalSpy>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QQuickItem>
+
+#include "headlessbackend.h"
+
+extern "C" {
+#include <wlr/types/wlr_buffer.h>
+}
+
+#include <drm_fourcc.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+static const char *windowQml = R"(
+import QtQuick
+import Waylib.Server
+
+OutputRenderWindow {
+    id: window
+
+    required property WaylandOutput primaryOutput
+    required property WaylandOutput mirrorOutput
+    readonly property OutputViewport primaryViewport: primary
+    readonly property OutputViewport mirrorViewport: mirror
+
+    width: 800
+    height: 600
+
+    Rectangle {
+        id: primaryContents
+
+        width: 800
+        height: 600
+        color: "red"
+    }
+
+    // Only shown when the mirror renders the scene itself
+    Rectangle {
+        id: mirrorContents
+
+        width: 400
+        height: 300
+        color: "blue"
+    }
+
+    OutputViewport {
+        id: primary
+
+        output: window.primaryOutput
+        devicePixelRatio: 1
+        input: primaryContents
+    }
+
+    OutputViewport {
+        id: mirror
+
+        output: window.mirrorOutput
+        devicePixelRatio: 1
+        input: mirrorContents
+        mirrorSource: primary
+    }
+}
+)";
+
+class OutputMirrorTest : public QObject
+{
+    Q_OBJECT
+public:
+    OutputMirrorTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    // The color at the center of the committed buffer, as 0xRRGGBB
+    static QRgb centerColor(wlr_buffer *buffer)
+    {
+        void *data = nullptr;
+        uint32_t format = 0;
+        size_t stride = 0;
+        if (!wlr_buffer_begin_data_ptr_access(buffer, WLR_BUFFER_DATA_PTR_ACCESS_READ,
+                                              &data, &format, &stride)) {
+            return 0;
+        }
+
+        QRgb color = 0;
+        if (format == DRM_FORMAT_XRGB8888 || format == DRM_FORMAT_ARGB8888) {
+            auto line = static_cast<const uchar*>(data) + stride * (buffer->height / 2);
+            color = reinterpret_cast<const quint32*>(line)[buffer->width / 2] & 0xffffff;
+        }
+        wlr_buffer_end_data_ptr_access(buffer);
+
+        return color;
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        QVERIFY(HeadlessBackend::createRenderer(m_backend, &m_renderer, &m_allocator));
+
+        const QList<WOutput*> outputs {
+            HeadlessBackend::addOutput(m_backend, 800, 600),
+            // Smaller than the source, the mirror must scale its buffers
+            HeadlessBackend::addOutput(m_backend, 400, 300),
+        };
+        QVERIFY(outputs.at(0) && outputs.at(1));
+
+        QQmlComponent component(&m_engine);
+        component.setData(windowQml, QUrl());
+        m_window = qobject_cast<WOutputRenderWindow*>(component.createWithInitialProperties({
+            {"primaryOutput", QVariant::fromValue(outputs.at(0))},
+            {"mirrorOutput", QVariant::fromValue(outputs.at(1))},
+        }));
+        QVERIFY2(m_window, qPrintable(component.errorString()));
+        m_primary = m_window->property("primaryViewport").value<WOutputViewport*>();
+        m_mirror = m_window->property("mirrorViewport").value<WOutputViewport*>();
+        QVERIFY(m_primary && m_mirror);
+        QCOMPARE(m_mirror->mirrorSource(), m_primary);
+
+        HeadlessBackend::enableOutputs(m_window);
+        connect(outputs.at(1)->handle(), qOverload<wlr_output_event_commit*>(&qw_output::notify_commit),
+                this, [this] (wlr_output_event_commit *event) {
+            if (event->state->committed & WLR_OUTPUT_STATE_BUFFER)
+                m_mirrorColor = centerColor(event->state->buffer);
+        });
+        m_window->init(m_renderer, m_allocator);
+        m_backend->handle()->start();
+    }
+
+    void showsSource()
+    {
+        // The mirror doesn't render its own contents
+        QTRY_COMPARE(m_mirrorColor, QRgb(0xff0000));
+    }
+
+    void fallbackWhenSourceIsGone()
+    {
+        QSignalSpy spy(m_mirror, &WOutputViewport::mirrorSourceChanged);
+        delete m_primary;
+
+        QCOMPARE(spy.count(), 1);
+        QVERIFY(!m_mirror->mirrorSource());
+        QTRY_COMPARE(m_mirrorColor, QRgb(0x0000ff));
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_window;
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    qw_allocator *m_allocator = nullptr;
+    QQmlEngine m_engine;
+    WOutputRenderWindow *m_window = nullptr;
+    WOutputViewport *m_primary = nullptr;
+    WOutputViewport *m_mirror = nullptr;
+    QRgb m_mirrorColor = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    WServer::initializeQPA();
+    QQuickWindow::setGraphicsApi(QSGRendererInterface::Software);
+    QGuiApplication app(argc, argv);
+
+    OutputMirrorTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
@@ -0,0 +1,247 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wsocket.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QElapsedTimer>
+#include <QMap>
+#include <QTemporaryDir>
+#include <QThread>
+
+#include <wayland-client.h>
+
+#include <poll.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include "protocolreplayer.h"
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+using namespace WProtocolTrace;
+
+static constexpr int BufferSize = 64;
+
+class ProtocolTraceTest : public QObject
+{
+    Q_OBJECT
+public:
+    ProtocolTraceTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    void dispatch(int msecs)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    wl_buffer *createBuffer()
+    {
+        const int stride = BufferSize * 4;
+        const int size = stride * BufferSize;
+        int fd = memfd_create("test-protocol-trace", MFD_CLOEXEC);
+        if (fd < 0 || ftruncate(fd, size) < 0)
+            return nullptr;
+
+        auto data = static_cast<quint32*>(mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0));
+        if (data == MAP_FAILED) {
+            close(fd);
+            return nullptr;
+        }
+        std::fill(data, data + BufferSize * BufferSize, 0xffff0000);
+        munmap(data, size);
+
+        auto pool = wl_shm_create_pool(m_shm, fd, size);
+        auto buffer = wl_shm_pool_create_buffer(pool, 0, BufferSize, BufferSize, stride, WL_SHM_FORMAT_XRGB8888);
+        wl_shm_pool_destroy(pool);
+        close(fd);
+
+        return buffer;
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<ProtocolTraceTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 4));
+        } else if (qstrcmp(interface, wl_shm_interface.name) == 0) {
+            self->m_shm = static_cast<wl_shm*>(
+                wl_registry_bind(registry, name, &wl_shm_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QVERIFY(m_runtimeDir.isValid());
+        m_traceFile = m_runtimeDir.filePath("trace");
+
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        auto compositor = qw_compositor::create(*m_server->handle(), 4, *m_renderer);
+        connect(compositor, &qw_compositor::notify_new_surface, this, [this] (wlr_surface *surface) {
+            ++m_surfaces;
+            connect(qw_surface::from(surface), &qw_surface::notify_commit, this, [this, surface] {
+                if (wlr_surface_has_buffer(surface))
+                    ++m_bufferCommits;
+            });
+        });
+
+        m_socket = new WSocket(false, nullptr, this);
+        QVERIFY(m_socket->autoCreate(m_runtimeDir.path()));
+        m_server->addSocket(m_socket);
+    }
+
+    void record()
+    {
+        QVERIFY(m_server->startRecording(m_traceFile));
+        QVERIFY(m_server->isRecording());
+
+        m_display = wl_display_connect(qPrintable(m_socket->fullServerName()));
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        auto registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(registry, &registryListener, this);
+        dispatch(100);
+        QVERIFY(m_compositor && m_shm);
+
+        auto surface = wl_compositor_create_surface(m_compositor);
+        auto buffer = createBuffer();
+        QVERIFY(buffer);
+        wl_surface_attach(surface, buffer, 0, 0);
+        wl_surface_damage(surface, 0, 0, BufferSize, BufferSize);
+        wl_surface_commit(surface);
+        dispatch(100);
+        QCOMPARE(m_surfaces, 1);
+        QCOMPARE(m_bufferCommits, 1);
+
+        wl_surface_destroy(surface);
+        wl_buffer_destroy(buffer);
+        wl_registry_destroy(registry);
+        dispatch(50);
+        wl_display_disconnect(m_display);
+        m_display = nullptr;
+        QTest::qWait(50);
+
+        m_server->stopRecording();
+        QVERIFY(!m_server->isRecording());
+    }
+
+    void parse()
+    {
+        QFile file(m_traceFile);
+        QVERIFY(file.open(QIODevice::ReadOnly));
+
+        FileHeader fileHeader;
+        QCOMPARE(file.read(reinterpret_cast<char*>(&fileHeader), sizeof(fileHeader)), qint64(sizeof(fileHeader)));
+        QCOMPARE(memcmp(fileHeader.magic, Magic, sizeof(Magic)), 0);
+        QCOMPARE(fileHeader.version, Version);
+
+        QMap<RecordType, int> records;
+        quint64 lastTimestamp = 0;
+        RecordHeader header;
+        while (file.read(reinterpret_cast<char*>(&header), sizeof(header)) == sizeof(header)) {
+            QVERIFY(header.timestamp >= lastTimestamp);
+            lastTimestamp = header.timestamp;
+            QCOMPARE(header.client, quint16(0));
+            QVERIFY(header.type >= ClientConnected && header.type <= ShmBufferContents);
+            QCOMPARE(file.read(header.size).size(), qsizetype(header.size));
+            ++records[header.type];
+        }
+        // No partial record at the end
+        QVERIFY(file.atEnd());
+
+        QCOMPARE(records.value(ClientConnected), 1);
+        QCOMPARE(records.value(ClientDisconnected), 1);
+        QCOMPARE(records.value(ShmBufferContents), 1);
+        // get_registry, 2 binds, create_surface, create_pool, create_buffer, destroy of the
+        // pool, attach, damage, commit, destroy of the surface and the buffer
+        QVERIFY2(records.value(Request) >= 12, qPrintable(QString::number(records.value(Request))));
+        QVERIFY(records.value(ObjectDeleted) > 0);
+        m_recordedRequests = records.value(Request);
+    }
+
+    void replay()
+    {
+        Replayer replayer;
+        QVERIFY(replayer.open(m_traceFile));
+
+        m_surfaces = 0;
+        m_bufferCommits = 0;
+        bool ok = false;
+        const QByteArray socketName = m_socket->fullServerName().toLocal8Bit();
+        // The replay blocks on the roundtrips, the server runs in this thread
+        std::unique_ptr<QThread> thread(QThread::create([&replayer, &ok, socketName] {
+            ok = replayer.run(socketName, true);
+        }));
+        thread->start();
+        QTRY_VERIFY_WITH_TIMEOUT(thread->isFinished(), 10000);
+
+        QVERIFY(ok);
+        QCOMPARE(replayer.requests(), m_recordedRequests);
+        QCOMPARE(replayer.skippedRequests(), qint64(0));
+        QVERIFY(replayer.unboundInterfaces().isEmpty());
+        QCOMPARE(m_surfaces, 1);
+        QCOMPARE(m_bufferCommits, 1);
+    }
+
+    void cleanupTestCase()
+    {
+        m_server->stop();
+    }
+
+private:
+    QTemporaryDir m_runtimeDir;
+    QString m_traceFile;
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    WSocket *m_socket = nullptr;
+    int m_surfaces = 0;
+    int m_bufferCommits = 0;
+    qint64 m_recordedRequests = 0;
+
+    wl_display *m_display = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_shm *m_shm = nullptr;
+};
+
+QTEST_MAIN(ProtocolTraceTest)
+#include "main.moc"
@@ -0,0 +1,171 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wqmlcreator.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QQmlEngine>
+#include <QQmlComponent>
+#include <QQuickItem>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+static const char *creatorQml = R"(
+import QtQuick
+import Waylib.Server
+
+Item {
+    readonly property DynamicCreator creator: creator
+
+    DynamicCreator {
+        id: creator
+    }
+
+    DynamicCreatorComponent {
+        creator: creator
+        chooserRole: "type"
+        chooserRoleValue: "plain"
+        poolSize: 2
+
+        Item {
+            property string type
+            property string title: "default"
+        }
+    }
+
+    DynamicCreatorComponent {
+        creator: creator
+        chooserRole: "type"
+        chooserRoleValue: "hooked"
+        poolSize: 2
+
+        Item {
+            property string type
+            property string title: "default"
+            property int counter: 0
+
+            function resetForReuse() {
+                title = "default"
+                counter = 0
+            }
+        }
+    }
+
+    DynamicCreatorComponent {
+        creator: creator
+        chooserRole: "type"
+        chooserRoleValue: "required"
+        poolSize: 2
+
+        Item {
+            property string type
+            required property string title
+        }
+    }
+}
+)";
+
+class QmlCreatorTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        QQmlComponent component(&m_engine);
+        component.setData(creatorQml, QUrl());
+        m_root = component.create();
+        QVERIFY2(m_root, qPrintable(component.errorString()));
+        m_creator = m_root->property("creator").value<WQmlCreator*>();
+        QVERIFY(m_creator);
+    }
+
+    void plainDoesNotLeakState()
+    {
+        QObject owner1, owner2, owner3;
+        m_creator->add(&owner1, properties({{"type", "plain"}, {"title", "first"}}));
+        QPointer<QObject> first = m_creator->getByOwner(&owner1);
+        QVERIFY(first);
+        QCOMPARE(first->property("title").toString(), QStringLiteral("first"));
+        QVERIFY(m_creator->removeByOwner(&owner1));
+        QVERIFY(first);
+
+        // The title of the last owner can't be reset, so the pooled object is not reused
+        m_creator->add(&owner2, properties({{"type", "plain"}}));
+        auto second = m_creator->getByOwner(&owner2);
+        QVERIFY(second);
+        QVERIFY(second != first);
+        QCOMPARE(second->property("title").toString(), QStringLiteral("default"));
+
+        // It's reused as soon as the new owner overwrites the same properties
+        m_creator->add(&owner3, properties({{"type", "plain"}, {"title", "third"}}));
+        QCOMPARE(m_creator->getByOwner(&owner3), first.get());
+        QCOMPARE(first->property("title").toString(), QStringLiteral("third"));
+
+        m_creator->removeByOwner(&owner2);
+        m_creator->removeByOwner(&owner3);
+    }
+
+    void hookResetsState()
+    {
+        QObject owner1, owner2;
+        m_creator->add(&owner1, properties({{"type", "hooked"}, {"title", "first"}}));
+        QPointer<QObject> first = m_creator->getByOwner(&owner1);
+        QVERIFY(first);
+        first->setProperty("counter", 5);
+        QVERIFY(m_creator->removeByOwner(&owner1));
+
+        m_creator->add(&owner2, properties({{"type", "hooked"}}));
+        QCOMPARE(m_creator->getByOwner(&owner2), first.get());
+        QCOMPARE(first->property("title").toString(), QStringLiteral("default"));
+        QCOMPARE(first->property("counter").toInt(), 0);
+
+        m_creator->removeByOwner(&owner2);
+    }
+
+    void missingRequiredProperties()
+    {
+        QObject owner1, owner2, owner3;
+        m_creator->add(&owner1, properties({{"type", "required"}, {"title", "first"}}));
+        QPointer<QObject> first = m_creator->getByOwner(&owner1);
+        QVERIFY(first);
+        QVERIFY(m_creator->removeByOwner(&owner1));
+
+        // Falls back to creating, which fails like it does without a pool
+        m_creator->add(&owner2, properties({{"type", "required"}}));
+        QVERIFY(!m_creator->getByOwner(&owner2));
+
+        m_creator->add(&owner3, properties({{"type", "required"}, {"title", "third"}}));
+        QCOMPARE(m_creator->getByOwner(&owner3), first.get());
+        QCOMPARE(first->property("title").toString(), QStringLiteral("third"));
+
+        m_creator->removeByOwner(&owner2);
+        m_creator->removeByOwner(&owner3);
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_root;
+    }
+
+private:
+    QJSValue properties(const QVariantMap &map)
+    {
+        return m_engine.toScriptValue(map);
+    }
+
+    QQmlEngine m_engine;
+    QObject *m_root = nullptr;
+    WQmlCreator *m_creator = nullptr;
+};
+
+int main(int argc, char *argv[])
+{
+    QGuiApplication app(argc, argv);
+
+    QmlCreatorTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
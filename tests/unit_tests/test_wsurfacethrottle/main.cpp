@@ -0,0 +1,213 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wsurface.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include <wayland-client.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+// The interval of the fake rendering
+static constexpr int FrameInterval = 16;
+
+class SurfaceThrottleTest : public QObject
+{
+    Q_OBJECT
+public:
+    SurfaceThrottleTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    // Run the server like rendering a frame every FrameInterval, and read the events of the client
+    void render(int msecs, bool renderFrames = true)
+    {
+        QElapsedTimer timer;
+        timer.start();
+        qint64 lastFrame = 0;
+
+        do {
+            if (renderFrames && m_wSurface && timer.elapsed() - lastFrame >= FrameInterval) {
+                lastFrame = timer.elapsed();
+                m_wSurface->notifyFrameDone();
+            }
+
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    void requestFrame()
+    {
+        static const wl_callback_listener callbackListener = {
+            .done = [] (void *data, wl_callback *callback, uint32_t) {
+                auto self = static_cast<SurfaceThrottleTest*>(data);
+                wl_callback_destroy(callback);
+                ++self->m_frames;
+                // Like a client always has something to draw
+                self->requestFrame();
+            },
+        };
+
+        wl_callback_add_listener(wl_surface_frame(m_surface), &callbackListener, this);
+        wl_surface_commit(m_surface);
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<SurfaceThrottleTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        auto compositor = qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+        connect(compositor, &qw_compositor::notify_new_surface, this, [this] (wlr_surface *surface) {
+            m_wSurface = new WSurface(qw_surface::from(surface), this);
+            connect(m_wSurface->handle(), &qw_surface::before_destroy,
+                    m_wSurface, &WSurface::safeDeleteLater);
+        });
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        render(100);
+        QVERIFY(m_compositor);
+
+        m_surface = wl_compositor_create_surface(m_compositor);
+        requestFrame();
+        render(100);
+        QVERIFY(m_wSurface);
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::FullRate);
+
+        m_wSurface->setReducedFrameInterval(100);
+    }
+
+    void testFullRate()
+    {
+        m_frames = 0;
+        render(500);
+        // About 30 frames, the fake rendering isn't precise
+        QVERIFY2(m_frames >= 15, qPrintable(QString::number(m_frames)));
+    }
+
+    void testReduced()
+    {
+        m_wSurface->requestFrameThrottle(this, WSurface::FrameThrottle::Reduced);
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::Reduced);
+
+        m_frames = 0;
+        render(500);
+        QVERIFY2(m_frames >= 3 && m_frames <= 6, qPrintable(QString::number(m_frames)));
+    }
+
+    void testSuspended()
+    {
+        m_wSurface->requestFrameThrottle(this, WSurface::FrameThrottle::Suspended);
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::Suspended);
+
+        m_frames = 0;
+        render(300);
+        QCOMPARE(m_frames, 0);
+    }
+
+    void testLeastThrottled()
+    {
+        QObject visibleView;
+        m_wSurface->requestFrameThrottle(&visibleView, WSurface::FrameThrottle::FullRate);
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::FullRate);
+
+        m_frames = 0;
+        render(300);
+        QVERIFY2(m_frames >= 9, qPrintable(QString::number(m_frames)));
+
+        // Destroying the requester removes its request
+        {
+            QObject hiddenView;
+            m_wSurface->requestFrameThrottle(&hiddenView, WSurface::FrameThrottle::Reduced);
+        }
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::FullRate);
+    }
+
+    void testResume()
+    {
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::Suspended);
+
+        // The pending frame callback is sent at once, not at the next rendering
+        m_frames = 0;
+        m_wSurface->removeFrameThrottleRequest(this);
+        QCOMPARE(m_wSurface->frameThrottle(), WSurface::FrameThrottle::FullRate);
+        render(50, false);
+        QCOMPARE(m_frames, 1);
+    }
+
+    void cleanupTestCase()
+    {
+        wl_surface_destroy(m_surface);
+        render(100);
+
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    QPointer<WSurface> m_wSurface;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_surface *m_surface = nullptr;
+    int m_frames = 0;
+};
+
+QTEST_MAIN(SurfaceThrottleTest)
+#include "main.moc"
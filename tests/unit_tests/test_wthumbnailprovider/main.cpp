@@ -0,0 +1,209 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wsurface.h>
+#include <woutputrenderwindow.h>
+#include <wthumbnailprovider.h>
+#include <wbufferrenderer_p.h>
+
+#include <qwbackend.h>
+#include <qwrenderer.h>
+#include <qwcompositor.h>
+#include <qwdisplay.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QQuickItem>
+#include <QElapsedTimer>
+#include <QPointer>
+
+#include <wayland-client.h>
+
+#include <poll.h>
+#include <sys/socket.h>
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+class ThumbnailProviderTest : public QObject
+{
+    Q_OBJECT
+public:
+    ThumbnailProviderTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    void dispatch(int msecs)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        do {
+            wl_display_flush(m_display);
+            QTest::qWait(5);
+
+            if (wl_display_prepare_read(m_display) == 0) {
+                pollfd fd { wl_display_get_fd(m_display), POLLIN, 0 };
+                if (poll(&fd, 1, 0) > 0)
+                    wl_display_read_events(m_display);
+                else
+                    wl_display_cancel_read(m_display);
+            }
+            wl_display_dispatch_pending(m_display);
+        } while (timer.elapsed() < msecs);
+    }
+
+    // Like a window item of the compositor, it shows its surface and decorations
+    QQuickItem *createWindowItem()
+    {
+        auto item = new QQuickItem(m_window->contentItem());
+        item->setSize(QSizeF(200, 100));
+        item->setProperty("surface", QVariant::fromValue(m_wSurface.data()));
+        return item;
+    }
+
+    static void registryGlobal(void *data, wl_registry *registry, uint32_t name,
+                               const char *interface, uint32_t)
+    {
+        auto self = static_cast<ThumbnailProviderTest*>(data);
+        if (qstrcmp(interface, wl_compositor_interface.name) == 0) {
+            self->m_compositor = static_cast<wl_compositor*>(
+                wl_registry_bind(registry, name, &wl_compositor_interface, 1));
+        }
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_server->start();
+
+        m_renderer = qw_renderer::autocreate(*m_backend->handle());
+        QVERIFY(m_renderer);
+        m_renderer->init_wl_display(*m_server->handle());
+        auto compositor = qw_compositor::create(*m_server->handle(), 6, *m_renderer);
+        connect(compositor, &qw_compositor::notify_new_surface, this, [this] (wlr_surface *surface) {
+            m_wSurface = new WSurface(qw_surface::from(surface), this);
+            connect(m_wSurface->handle(), &qw_surface::before_destroy,
+                    m_wSurface, &WSurface::safeDeleteLater);
+        });
+
+        int fds[2];
+        QCOMPARE(socketpair(AF_UNIX, SOCK_STREAM | SOCK_CLOEXEC, 0, fds), 0);
+        QVERIFY(wl_client_create(m_server->handle()->handle(), fds[0]));
+        m_display = wl_display_connect_to_fd(fds[1]);
+        QVERIFY(m_display);
+
+        static const wl_registry_listener registryListener = {
+            .global = registryGlobal,
+            .global_remove = [] (void *, wl_registry *, uint32_t) {},
+        };
+        m_registry = wl_display_get_registry(m_display);
+        wl_registry_add_listener(m_registry, &registryListener, this);
+        dispatch(100);
+        QVERIFY(m_compositor);
+
+        m_surface = wl_compositor_create_surface(m_compositor);
+        wl_surface_commit(m_surface);
+        dispatch(100);
+        QVERIFY(m_wSurface);
+
+        m_window = new WOutputRenderWindow(this);
+    }
+
+    void testSharedPerSurface()
+    {
+        auto provider = m_window->thumbnailProvider();
+        QCOMPARE(provider->count(), 0);
+
+        QScopedPointer<QQuickItem> window(createWindowItem());
+        QScopedPointer<QQuickItem> taskBarItem(createWindowItem());
+        QCOMPARE(WThumbnailProvider::sourceKey(window.data()), m_wSurface.data());
+
+        QObject workspaceOwner;
+        QObject taskBarOwner;
+        QPointer<WBufferRenderer> renderer = provider->acquire(window.data(), &workspaceOwner);
+        QVERIFY(renderer);
+        // Different items of the same surface don't render it twice
+        QCOMPARE(provider->acquire(taskBarItem.data(), &taskBarOwner), renderer.data());
+        QCOMPARE(provider->count(), 1);
+
+        provider->release(&workspaceOwner);
+        QCOMPARE(provider->count(), 1);
+        // The rendered item is gone, the other owner keeps the thumbnail
+        window.reset();
+        QVERIFY(renderer);
+        QCOMPARE(provider->count(), 1);
+
+        provider->release(&taskBarOwner);
+        QCOMPARE(provider->count(), 0);
+        QCoreApplication::sendPostedEvents(nullptr, QEvent::DeferredDelete);
+        QVERIFY(!renderer);
+    }
+
+    void testSharedPerItem()
+    {
+        auto provider = m_window->thumbnailProvider();
+
+        QScopedPointer<QQuickItem> first(new QQuickItem(m_window->contentItem()));
+        QScopedPointer<QQuickItem> second(new QQuickItem(m_window->contentItem()));
+        QCOMPARE(WThumbnailProvider::sourceKey(first.data()), first.data());
+
+        QObject owner1;
+        QObject owner2;
+        QObject owner3;
+        auto renderer = provider->acquire(first.data(), &owner1);
+        QCOMPARE(provider->acquire(first.data(), &owner2), renderer);
+        // Items without a surface are only shared by the owners of the same item
+        QVERIFY(provider->acquire(second.data(), &owner3) != renderer);
+        QCOMPARE(provider->count(), 2);
+
+        // Owners are released when switching to another source
+        QCOMPARE(provider->acquire(second.data(), &owner1), provider->acquire(second.data(), &owner3));
+        provider->release(&owner2);
+        QCOMPARE(provider->count(), 1);
+
+        provider->release(&owner1);
+        provider->release(&owner3);
+        QCOMPARE(provider->count(), 0);
+    }
+
+    void cleanupTestCase()
+    {
+        delete m_window;
+
+        wl_surface_destroy(m_surface);
+        dispatch(100);
+
+        wl_display_disconnect(m_display);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    qw_renderer *m_renderer = nullptr;
+    QPointer<WSurface> m_wSurface;
+    WOutputRenderWindow *m_window = nullptr;
+
+    wl_display *m_display = nullptr;
+    wl_registry *m_registry = nullptr;
+    wl_compositor *m_compositor = nullptr;
+    wl_surface *m_surface = nullptr;
+};
+
+int main(int argc, char *argv[])
+{
+    WServer::initializeQPA();
+    QGuiApplication app(argc, argv);
+
+    ThumbnailProviderTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"
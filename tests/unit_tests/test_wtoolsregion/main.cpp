@@ -0,0 +1,219 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wtools.h>
+
+#include <QTest>
+#include <QtMath>
+
+#include <pixman.h>
+#include <wayland-server-protocol.h>
+
+WAYLIB_SERVER_USE_NAMESPACE
+
+// A grid of count rectangles, every rectangle doesn't touch the others
+static QRegion fragmentedRegion(int count, int cellSize = 8)
+{
+    const int columns = qCeil(qSqrt(count));
+    QList<QRect> rects;
+    rects.reserve(count);
+    for (int i = 0; i < count; ++i)
+        rects.append(QRect((i % columns) * cellSize * 2, (i / columns) * cellSize * 2, cellSize, cellSize));
+
+    QRegion region;
+    region.setRects(rects.constData(), rects.size());
+    return region;
+}
+
+static QPoint transformPoint(const QPoint &p, uint32_t transform, const QSize &size)
+{
+    const int w = size.width();
+    const int h = size.height();
+
+    switch (transform) {
+    case WL_OUTPUT_TRANSFORM_90:
+        return { h - p.y(), p.x() };
+    case WL_OUTPUT_TRANSFORM_180:
+        return { w - p.x(), h - p.y() };
+    case WL_OUTPUT_TRANSFORM_270:
+        return { p.y(), w - p.x() };
+    case WL_OUTPUT_TRANSFORM_FLIPPED:
+        return { w - p.x(), p.y() };
+    case WL_OUTPUT_TRANSFORM_FLIPPED_90:
+        return { p.y(), p.x() };
+    case WL_OUTPUT_TRANSFORM_FLIPPED_180:
+        return { p.x(), h - p.y() };
+    case WL_OUTPUT_TRANSFORM_FLIPPED_270:
+        return { h - p.y(), w - p.x() };
+    default:
+        return p;
+    }
+}
+
+// The representations of the same area may have different bands
+static bool sameArea(const QRegion &r1, const QRegion &r2)
+{
+    return r1.xored(r2).isEmpty();
+}
+
+class TestWToolsRegion : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void pixmanRoundTrip_data()
+    {
+        QTest::addColumn<int>("rectCount");
+
+        for (int count : { 1, 10, 100, 1000, 10000 })
+            QTest::addRow("%d", count) << count;
+    }
+
+    void pixmanRoundTrip()
+    {
+        QFETCH(int, rectCount);
+        const QRegion region = fragmentedRegion(rectCount);
+        QCOMPARE(region.rectCount(), rectCount);
+
+        pixman_region32_t pixmanRegion;
+        QVERIFY(WTools::toPixmanRegion(region, &pixmanRegion));
+        QCOMPARE(pixman_region32_n_rects(&pixmanRegion), rectCount);
+
+        const QRect first = *region.begin();
+        const auto extents = pixman_region32_extents(&pixmanRegion);
+        QCOMPARE(extents->x1, region.boundingRect().x());
+        QCOMPARE(extents->x2, region.boundingRect().right() + 1);
+        QVERIFY(pixman_region32_contains_point(&pixmanRegion, first.right(), first.bottom(), nullptr));
+        QVERIFY(!pixman_region32_contains_point(&pixmanRegion, first.right() + 1, first.bottom(), nullptr));
+
+        const QRegion result = WTools::fromPixmanRegion(&pixmanRegion);
+        pixman_region32_fini(&pixmanRegion);
+
+        QCOMPARE(result, region);
+    }
+
+    void emptyRegion()
+    {
+        pixman_region32_t pixmanRegion;
+        QVERIFY(WTools::toPixmanRegion(QRegion(), &pixmanRegion));
+        QVERIFY(!pixman_region32_not_empty(&pixmanRegion));
+        QVERIFY(WTools::fromPixmanRegion(&pixmanRegion).isEmpty());
+        pixman_region32_fini(&pixmanRegion);
+
+        QVERIFY(WTools::transformRegion({}, WL_OUTPUT_TRANSFORM_90, QSize(100, 100)).isEmpty());
+        QVERIFY(WTools::scaleRegion({}, 1.5).isEmpty());
+        QVERIFY(WTools::clipRegion({}, QRect(0, 0, 10, 10)).isEmpty());
+    }
+
+    void transformRect()
+    {
+        const QSize size(100, 50);
+        const QRegion region(QRect(0, 0, 10, 20));
+
+        QCOMPARE(WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_NORMAL, size), region);
+        QCOMPARE(WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_90, size), QRegion(30, 0, 20, 10));
+        QCOMPARE(WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_180, size), QRegion(90, 30, 10, 20));
+        QCOMPARE(WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_270, size), QRegion(0, 90, 20, 10));
+        QCOMPARE(WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_FLIPPED, size), QRegion(90, 0, 10, 20));
+        QCOMPARE(WTools::transformRegion(region, WL_OUTPUT_TRANSFORM_FLIPPED_90, size), QRegion(0, 0, 20, 10));
+    }
+
+    void transform_data()
+    {
+        QTest::addColumn<uint32_t>("transform");
+
+        QTest::addRow("normal") << uint32_t(WL_OUTPUT_TRANSFORM_NORMAL);
+        QTest::addRow("90") << uint32_t(WL_OUTPUT_TRANSFORM_90);
+        QTest::addRow("180") << uint32_t(WL_OUTPUT_TRANSFORM_180);
+        QTest::addRow("270") << uint32_t(WL_OUTPUT_TRANSFORM_270);
+        QTest::addRow("flipped") << uint32_t(WL_OUTPUT_TRANSFORM_FLIPPED);
+        QTest::addRow("flipped-90") << uint32_t(WL_OUTPUT_TRANSFORM_FLIPPED_90);
+        QTest::addRow("flipped-180") << uint32_t(WL_OUTPUT_TRANSFORM_FLIPPED_180);
+        QTest::addRow("flipped-270") << uint32_t(WL_OUTPUT_TRANSFORM_FLIPPED_270);
+    }
+
+    void transform()
+    {
+        QFETCH(uint32_t, transform);
+
+        const QRegion region = fragmentedRegion(1000, 4);
+        const QSize size = region.boundingRect().size() + QSize(30, 10);
+
+        QRegion expected;
+        for (const QRect &r : region) {
+            const QPoint p1 = transformPoint(r.topLeft(), transform, size);
+            const QPoint p2 = transformPoint(r.bottomRight() + QPoint(1, 1), transform, size);
+            expected += QRect(QPoint(qMin(p1.x(), p2.x()), qMin(p1.y(), p2.y())),
+                              QPoint(qMax(p1.x(), p2.x()) - 1, qMax(p1.y(), p2.y()) - 1));
+        }
+
+        const QRegion result = WTools::transformRegion(region, transform, size);
+        QCOMPARE(result.rectCount(), region.rectCount());
+        QVERIFY(sameArea(result, expected));
+    }
+
+    void scale_data()
+    {
+        QTest::addColumn<qreal>("scale");
+
+        QTest::addRow("1") << 1.0;
+        QTest::addRow("2") << 2.0;
+        QTest::addRow("1.25") << 1.25;
+        QTest::addRow("1.5") << 1.5;
+        QTest::addRow("0.5") << 0.5;
+    }
+
+    void scale()
+    {
+        QFETCH(qreal, scale);
+
+        const QRegion region = fragmentedRegion(1000, 3);
+        QRegion expected;
+        for (const QRect &r : region) {
+            expected += QRect(QPoint(qFloor(r.x() * scale), qFloor(r.y() * scale)),
+                              QPoint(qCeil((r.right() + 1) * scale) - 1, qCeil((r.bottom() + 1) * scale) - 1));
+        }
+
+        QVERIFY(sameArea(WTools::scaleRegion(region, scale), expected));
+    }
+
+    void clip_data()
+    {
+        QTest::addColumn<QRect>("clip");
+
+        QTest::addRow("inside") << QRect(0, 0, 10000, 10000);
+        QTest::addRow("outside") << QRect(-100, -100, 50, 50);
+        QTest::addRow("partial") << QRect(5, 5, 200, 123);
+        QTest::addRow("single") << QRect(17, 17, 3, 3);
+    }
+
+    void clip()
+    {
+        QFETCH(QRect, clip);
+
+        const QRegion region = fragmentedRegion(1000);
+        const QRegion result = WTools::clipRegion(region, clip);
+        QVERIFY(sameArea(result, region.intersected(clip)));
+        QVERIFY(clip.contains(result.boundingRect()) || result.isEmpty());
+    }
+
+    void clipCoalescesBands()
+    {
+        // The bands differ only on the right of the clip
+        const QRect rects[] = {
+            QRect(0, 0, 10, 10), QRect(20, 0, 10, 10),
+            QRect(0, 10, 10, 10), QRect(40, 10, 10, 10),
+            QRect(0, 20, 10, 10), QRect(50, 20, 10, 10),
+            QRect(5, 40, 10, 10),
+        };
+        QRegion region;
+        region.setRects(rects, std::size(rects));
+
+        const QRegion result = WTools::clipRegion(region, QRect(0, 0, 15, 100));
+        QCOMPARE(result.rectCount(), 2);
+        QCOMPARE(result, QRegion(QRect(0, 0, 10, 30)) + QRect(5, 40, 10, 10));
+    }
+};
+
+QTEST_MAIN(TestWToolsRegion)
+#include "main.moc"
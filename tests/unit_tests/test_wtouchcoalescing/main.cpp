@@ -0,0 +1,294 @@
+// Copyright (C) 2024 UnionTech Software Technology Co., Ltd.
+// SPDX-License-Identifier: Apache-2.0 OR LGPL-3.0-only OR GPL-2.0-only OR GPL-3.0-only
+
+#include <wserver.h>
+#include <wbackend.h>
+#include <wseat.h>
+#include <wcursor.h>
+#include <woutput.h>
+#include <woutputlayout.h>
+#include <winputdevice.h>
+
+#include <qwbackend.h>
+#include <qwinputdevice.h>
+
+#include <QTest>
+#include <QGuiApplication>
+#include <QWindow>
+
+#include "headlessbackend.h"
+
+extern "C" {
+#include <wlr/interfaces/wlr_touch.h>
+}
+
+QW_USE_NAMESPACE
+WAYLIB_SERVER_USE_NAMESPACE
+
+struct TouchRecord
+{
+    QEvent::Type type;
+    QList<QEventPoint> points;
+
+    const QEventPoint *point(int id) const {
+        for (const auto &p : points) {
+            if (p.id() == id)
+                return &p;
+        }
+        return nullptr;
+    }
+};
+
+class TouchRecordWindow : public QWindow
+{
+public:
+    QList<TouchRecord> records;
+
+protected:
+    bool event(QEvent *event) override {
+        switch (event->type()) {
+        case QEvent::TouchBegin:
+        case QEvent::TouchUpdate:
+        case QEvent::TouchEnd:
+        case QEvent::TouchCancel: {
+            auto e = static_cast<QTouchEvent*>(event);
+            records.append({ e->type(), e->points() });
+            e->accept();
+            return true;
+        }
+        default:
+            return QWindow::event(event);
+        }
+    }
+};
+
+class TouchCoalescingTest : public QObject
+{
+    Q_OBJECT
+public:
+    TouchCoalescingTest(QObject *parent = nullptr)
+        : QObject(parent)
+    {
+    }
+
+private:
+    void down(int32_t id, double x, double y)
+    {
+        wlr_touch_down_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = id,
+            .x = x,
+            .y = y,
+        };
+        wl_signal_emit_mutable(&m_touch.events.down, &event);
+    }
+
+    void motion(int32_t id, double x, double y)
+    {
+        wlr_touch_motion_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = id,
+            .x = x,
+            .y = y,
+        };
+        wl_signal_emit_mutable(&m_touch.events.motion, &event);
+    }
+
+    void up(int32_t id)
+    {
+        wlr_touch_up_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = id,
+        };
+        wl_signal_emit_mutable(&m_touch.events.up, &event);
+    }
+
+    void cancel(int32_t id)
+    {
+        wlr_touch_cancel_event event {
+            .touch = &m_touch,
+            .time_msec = ++m_time,
+            .touch_id = id,
+        };
+        wl_signal_emit_mutable(&m_touch.events.cancel, &event);
+    }
+
+    void frame()
+    {
+        wl_signal_emit_mutable(&m_touch.events.frame, nullptr);
+    }
+
+private Q_SLOTS:
+    void initTestCase()
+    {
+        m_server = new WServer(this);
+        m_backend = m_server->attach<WBackend>();
+        m_seat = m_server->attach<WSeat>();
+        m_server->start();
+
+        auto output = HeadlessBackend::addOutput(m_backend, 800, 600);
+        QVERIFY(output);
+
+        m_layout = new WOutputLayout(m_server);
+        m_layout->add(output, QPoint(0, 0));
+
+        m_cursor = new WCursor(this);
+        m_cursor->setLayout(m_layout);
+        m_seat->setCursor(m_cursor);
+        m_cursor->setEventWindow(&m_window);
+
+        static const wlr_touch_impl touchImpl = {
+            .name = "test-touch",
+        };
+        wlr_touch_init(&m_touch, &touchImpl, touchImpl.name);
+        m_touchDevice = new WInputDevice(qw_input_device::from(&m_touch.base));
+        m_seat->attachInputDevice(m_touchDevice);
+    }
+
+    void init()
+    {
+        m_window.records.clear();
+    }
+
+    void motionsMergedPerFrame()
+    {
+        down(0, 0.1, 0.1);
+        down(1, 0.5, 0.5);
+        frame();
+        QCOMPARE(m_window.records.size(), 1);
+        QCOMPARE(m_window.records.at(0).type, QEvent::TouchBegin);
+        QCOMPARE(m_window.records.at(0).points.size(), 2);
+
+        // A fast touchscreen reports many motions before the frame
+        for (int i = 1; i <= 100; ++i) {
+            motion(0, 0.1 + i * 0.001, 0.1);
+            motion(1, 0.5, 0.5 + i * 0.001);
+        }
+        QCOMPARE(m_window.records.size(), 1);
+        frame();
+
+        QCOMPARE(m_window.records.size(), 2);
+        const auto &update = m_window.records.at(1);
+        QCOMPARE(update.type, QEvent::TouchUpdate);
+        QCOMPARE(update.points.size(), 2);
+        QCOMPARE(update.point(0)->state(), QEventPoint::Updated);
+        QCOMPARE(update.point(0)->globalPosition(), QPointF(160, 60));
+        QCOMPARE(update.point(1)->state(), QEventPoint::Updated);
+        QCOMPARE(update.point(1)->globalPosition(), QPointF(400, 360));
+
+        up(0);
+        up(1);
+        frame();
+        QCOMPARE(m_window.records.size(), 3);
+        QCOMPARE(m_window.records.at(2).type, QEvent::TouchEnd);
+    }
+
+    void downBetweenMotions()
+    {
+        down(0, 0.1, 0.1);
+        frame();
+
+        motion(0, 0.2, 0.1);
+        down(1, 0.5, 0.5);
+        motion(0, 0.3, 0.1);
+        motion(1, 0.5, 0.6);
+        frame();
+
+        QCOMPARE(m_window.records.size(), 2);
+        const auto &update = m_window.records.at(1);
+        QCOMPARE(update.type, QEvent::TouchUpdate);
+        // The motion after 'down' in the same frame keeps the Pressed state
+        QCOMPARE(update.point(1)->state(), QEventPoint::Pressed);
+        QCOMPARE(update.point(1)->globalPosition(), QPointF(400, 360));
+        QCOMPARE(update.point(0)->state(), QEventPoint::Updated);
+        QCOMPARE(update.point(0)->globalPosition(), QPointF(240, 60));
+        // The cursor is at the last touch motion
+        QCOMPARE(m_cursor->position(), QPointF(240, 60));
+
+        up(0);
+        up(1);
+        frame();
+        QCOMPARE(m_window.records.last().type, QEvent::TouchEnd);
+    }
+
+    void upAfterMotion()
+    {
+        down(0, 0.1, 0.1);
+        down(1, 0.5, 0.5);
+        frame();
+
+        motion(0, 0.25, 0.5);
+        motion(1, 0.75, 0.5);
+        up(0);
+        frame();
+
+        QCOMPARE(m_window.records.size(), 2);
+        const auto &update = m_window.records.at(1);
+        QCOMPARE(update.point(0)->state(), QEventPoint::Released);
+        QCOMPARE(update.point(0)->globalPosition(), QPointF(200, 300));
+        QCOMPARE(update.point(1)->state(), QEventPoint::Updated);
+        QCOMPARE(update.point(1)->globalPosition(), QPointF(600, 300));
+
+        up(1);
+        frame();
+        QCOMPARE(m_window.records.size(), 3);
+        QCOMPARE(m_window.records.at(2).type, QEvent::TouchEnd);
+        QCOMPARE(m_window.records.at(2).points.size(), 1);
+    }
+
+    void cancelAfterMotion()
+    {
+        down(0, 0.1, 0.1);
+        frame();
+
+        motion(0, 0.2, 0.2);
+        cancel(0);
+        frame();
+
+        QCOMPARE(m_window.records.size(), 2);
+        QCOMPARE(m_window.records.at(1).type, QEvent::TouchCancel);
+
+        // The touch id can be used again after the cancel
+        down(0, 0.5, 0.5);
+        frame();
+        QCOMPARE(m_window.records.size(), 3);
+        QCOMPARE(m_window.records.at(2).type, QEvent::TouchBegin);
+        up(0);
+        frame();
+        QCOMPARE(m_window.records.last().type, QEvent::TouchEnd);
+    }
+
+    void cleanupTestCase()
+    {
+        m_cursor->setEventWindow(nullptr);
+        m_seat->detachInputDevice(m_touchDevice);
+        wlr_touch_finish(&m_touch);
+        m_server->stop();
+    }
+
+private:
+    WServer *m_server = nullptr;
+    WBackend *m_backend = nullptr;
+    WSeat *m_seat = nullptr;
+    WOutputLayout *m_layout = nullptr;
+    WCursor *m_cursor = nullptr;
+    TouchRecordWindow m_window;
+    wlr_touch m_touch;
+    WInputDevice *m_touchDevice = nullptr;
+    uint32_t m_time = 0;
+};
+
+int main(int argc, char *argv[])
+{
+    // WSeat adds the input devices to the wlroots QPA
+    WServer::initializeQPA();
+    QGuiApplication app(argc, argv);
+
+    TouchCoalescingTest test;
+    return QTest::qExec(&test, argc, argv);
+}
+
+#include "main.moc"